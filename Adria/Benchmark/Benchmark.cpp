@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <numeric>
+#include <filesystem>
+#include <new>
+#include <cstdlib>
+#include "Benchmark.h"
+#include "Core/Paths.h"
+#include "Logging/Logger.h"
+#include "Utilities/JsonUtil.h"
+
+namespace adria
+{
+	namespace
+	{
+		BenchmarkResult ComputeResult(Char const* name, std::span<Float64 const> samples, Uint32 iterations, Uint32 repetitions, Uint64 items_per_iteration)
+		{
+			BenchmarkResult result{};
+			result.name = name;
+			result.iterations = iterations;
+			result.repetitions = repetitions;
+			if (samples.empty()) return result;
+
+			std::vector<Float64> sorted_samples(samples.begin(), samples.end());
+			std::sort(sorted_samples.begin(), sorted_samples.end());
+
+			Uint64 const count = sorted_samples.size();
+			result.min_ns = sorted_samples.front();
+			result.max_ns = sorted_samples.back();
+			result.median_ns = count % 2 ? sorted_samples[count / 2] : 0.5 * (sorted_samples[count / 2 - 1] + sorted_samples[count / 2]);
+			result.mean_ns = std::accumulate(sorted_samples.begin(), sorted_samples.end(), 0.0) / count;
+
+			Float64 variance = 0.0;
+			for (Float64 sample : sorted_samples) variance += (sample - result.mean_ns) * (sample - result.mean_ns);
+			result.stddev_ns = std::sqrt(variance / count);
+
+			if (items_per_iteration > 0 && result.median_ns > 0.0)
+			{
+				result.items_per_second = items_per_iteration * 1e9 / result.median_ns;
+			}
+			return result;
+		}
+	}
+
+	namespace
+	{
+		thread_local BenchmarkAllocationCounter* active_allocation_counter = nullptr;
+	}
+
+	void CountBenchmarkAllocation()
+	{
+		for (BenchmarkAllocationCounter* counter = active_allocation_counter; counter != nullptr; counter = counter->parent) ++counter->count;
+	}
+
+	BenchmarkAllocationCounter::BenchmarkAllocationCounter() : parent(active_allocation_counter)
+	{
+		active_allocation_counter = this;
+	}
+
+	BenchmarkAllocationCounter::~BenchmarkAllocationCounter()
+	{
+		active_allocation_counter = parent;
+	}
+
+	std::vector<BenchmarkRegistry::BenchmarkEntry>& BenchmarkRegistry::GetEntries()
+	{
+		static std::vector<BenchmarkEntry> entries;
+		return entries;
+	}
+
+	Bool BenchmarkRegistry::Register(Char const* name, BenchmarkFunction function, std::initializer_list<Sint64> args)
+	{
+		GetEntries().emplace_back(name, function, std::vector<Sint64>(args));
+		return true;
+	}
+
+	std::vector<BenchmarkResult> BenchmarkRegistry::RunAll(BenchmarkContext const& context, std::string_view filter)
+	{
+		std::vector<BenchmarkEntry> entries = GetEntries();
+		std::sort(entries.begin(), entries.end(), [](BenchmarkEntry const& a, BenchmarkEntry const& b) { return std::string_view(a.name) < std::string_view(b.name); });
+
+		std::vector<BenchmarkResult> results;
+		for (BenchmarkEntry const& entry : entries)
+		{
+			if (!filter.empty() && std::string_view(entry.name).find(filter) == std::string_view::npos) continue;
+
+			std::vector<Sint64> args = entry.args;
+			if (args.empty()) args.push_back(0);
+			for (Sint64 arg : args)
+			{
+				BenchmarkState state(context, arg);
+				entry.function(state);
+				for (std::string const& failure : state.failures)
+				{
+					ADRIA_LOG(ERROR, "[Benchmark] %s/%lld failed: %s", entry.name, arg, failure.c_str());
+				}
+				if (state.samples.empty() && state.failures.empty())
+				{
+					ADRIA_LOG(WARNING, "[Benchmark] %s was skipped", entry.name);
+					continue;
+				}
+
+				BenchmarkResult& result = results.emplace_back(ComputeResult(entry.name, state.samples, state.iterations, state.repetitions, state.items_per_iteration));
+				result.arg = arg;
+				result.counters = std::move(state.counters);
+				result.failures = std::move(state.failures);
+				if (entry.args.empty())
+				{
+					ADRIA_LOG(INFO, "[Benchmark] %s: median %.1f ns, min %.1f ns, max %.1f ns", entry.name, result.median_ns, result.min_ns, result.max_ns);
+				}
+				else
+				{
+					ADRIA_LOG(INFO, "[Benchmark] %s/%lld: median %.1f ns, min %.1f ns, max %.1f ns", entry.name, arg, result.median_ns, result.min_ns, result.max_ns);
+				}
+			}
+		}
+		return results;
+	}
+
+	Bool BenchmarkRegistry::Passed(std::span<BenchmarkResult const> results)
+	{
+		return std::all_of(results.begin(), results.end(), [](BenchmarkResult const& result) { return result.failures.empty(); });
+	}
+
+	Bool BenchmarkRegistry::WriteResults(std::span<BenchmarkResult const> results, std::string const& file_name)
+	{
+		json benchmarks = json::array();
+		for (BenchmarkResult const& result : results)
+		{
+			json counters = json::object();
+			for (BenchmarkCounter const& counter : result.counters) counters[counter.name] = counter.value;
+
+			benchmarks.push_back({
+				{ "name", result.name },
+				{ "arg", result.arg },
+				{ "iterations", result.iterations },
+				{ "repetitions", result.repetitions },
+				{ "mean_ns", result.mean_ns },
+				{ "median_ns", result.median_ns },
+				{ "min_ns", result.min_ns },
+				{ "max_ns", result.max_ns },
+				{ "stddev_ns", result.stddev_ns },
+				{ "items_per_second", result.items_per_second },
+				{ "counters", counters },
+				{ "failures", result.failures }
+			});
+		}
+
+		json output = json::object();
+#if _DEBUG
+		output["configuration"] = "Debug";
+#else
+		output["configuration"] = "Release";
+#endif
+		output["hardware_concurrency"] = std::thread::hardware_concurrency();
+		output["passed"] = Passed(results);
+		output["benchmarks"] = benchmarks;
+
+		std::error_code error;
+		std::filesystem::create_directories(paths::BenchmarksDir, error);
+		std::string const output_path = paths::BenchmarksDir + file_name;
+		std::ofstream output_file(output_path);
+		if (!output_file.is_open())
+		{
+			ADRIA_LOG(ERROR, "[Benchmark] Failed to open %s for writing!", output_path.c_str());
+			return false;
+		}
+		output_file << output.dump(4);
+		ADRIA_LOG(INFO, "[Benchmark] Results for %llu benchmarks written to %s", results.size(), output_path.c_str());
+		return true;
+	}
+}
+
+#if ADRIA_BENCHMARK_ALLOCATION_HOOKS
+//the global allocation functions are replaced so BenchmarkAllocationCounter sees every heap allocation. array, nothrow and sized
+//forms forward to these, outside of a counter scope the only cost is reading a thread local pointer
+void* operator new(std::size_t size)
+{
+	adria::CountBenchmarkAllocation();
+	while (true)
+	{
+		if (void* memory = std::malloc(size ? size : 1)) return memory;
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) throw std::bad_alloc();
+		handler();
+	}
+}
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	adria::CountBenchmarkAllocation();
+	while (true)
+	{
+		if (void* memory = _aligned_malloc(size ? size : 1, static_cast<std::size_t>(alignment))) return memory;
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) throw std::bad_alloc();
+		handler();
+	}
+}
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	_aligned_free(memory);
+}
+#endif
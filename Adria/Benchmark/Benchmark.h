@@ -0,0 +1,163 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <span>
+#include <initializer_list>
+#include "Utilities/Timer.h"
+
+//replaces the global operator new and delete of the whole executable so BenchmarkAllocationCounter can count heap allocations,
+//only enable it in builds that measure allocations
+#if !defined(ADRIA_BENCHMARK_ALLOCATION_HOOKS)
+#define ADRIA_BENCHMARK_ALLOCATION_HOOKS 0
+#endif
+
+namespace adria
+{
+	class GfxDevice;
+
+	struct BenchmarkContext
+	{
+		GfxDevice* gfx = nullptr;
+	};
+
+	struct BenchmarkCounter
+	{
+		std::string name;
+		Float64 value;
+	};
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		Sint64 arg = 0;
+		Uint32 iterations = 0;
+		Uint32 repetitions = 0;
+		Float64 mean_ns = 0.0;
+		Float64 median_ns = 0.0;
+		Float64 min_ns = 0.0;
+		Float64 max_ns = 0.0;
+		Float64 stddev_ns = 0.0;
+		Float64 items_per_second = 0.0;
+		std::vector<BenchmarkCounter> counters;
+		std::vector<std::string> failures;
+	};
+
+	class BenchmarkState
+	{
+		friend class BenchmarkRegistry;
+	public:
+		BenchmarkState(BenchmarkContext const& context, Sint64 arg) : context(context), arg(arg) {}
+
+		GfxDevice* GetDevice() const { return context.gfx; }
+		Sint64 GetArg() const { return arg; }
+
+		void SetIterations(Uint32 _iterations, Uint32 _repetitions = 10)
+		{
+			iterations = _iterations;
+			repetitions = _repetitions;
+		}
+		void SetItemsPerIteration(Uint64 items)
+		{
+			items_per_iteration = items;
+		}
+		void SetCounter(Char const* name, Float64 value)
+		{
+			counters.emplace_back(name, value);
+		}
+		//a failed check fails the benchmark run, the benchmark itself keeps going
+		Bool Check(Bool condition, std::string_view message)
+		{
+			if (!condition) failures.emplace_back(message);
+			return condition;
+		}
+
+		template<typename F>
+		void Run(F&& f)
+		{
+			for (Uint32 i = 0; i < warmup_iterations; ++i) f();
+			samples.clear();
+			samples.reserve(repetitions);
+			for (Uint32 r = 0; r < repetitions; ++r)
+			{
+				Timer<std::chrono::nanoseconds> timer;
+				for (Uint32 i = 0; i < iterations; ++i) f();
+				samples.push_back(static_cast<Float64>(timer.Elapsed()) / iterations);
+			}
+		}
+
+		template<typename F>
+		void RunManual(F&& f)
+		{
+			for (Uint32 i = 0; i < warmup_iterations; ++i) f();
+			samples.clear();
+			samples.reserve(repetitions);
+			for (Uint32 r = 0; r < repetitions; ++r)
+			{
+				Float64 elapsed_ns = 0.0;
+				for (Uint32 i = 0; i < iterations; ++i) elapsed_ns += f();
+				samples.push_back(elapsed_ns / iterations);
+			}
+		}
+
+	private:
+		BenchmarkContext const& context;
+		Sint64 const arg;
+		Uint32 warmup_iterations = 2;
+		Uint32 iterations = 100;
+		Uint32 repetitions = 10;
+		Uint64 items_per_iteration = 0;
+		std::vector<Float64> samples;
+		std::vector<BenchmarkCounter> counters;
+		std::vector<std::string> failures;
+	};
+
+	//counts the heap allocations (global operator new) of the current thread while it is alive, counters can be nested.
+	//counts stay at zero unless ADRIA_BENCHMARK_ALLOCATION_HOOKS is enabled
+	class BenchmarkAllocationCounter
+	{
+		friend void CountBenchmarkAllocation();
+	public:
+		BenchmarkAllocationCounter();
+		ADRIA_NONCOPYABLE_NONMOVABLE(BenchmarkAllocationCounter)
+		~BenchmarkAllocationCounter();
+
+		Uint64 GetCount() const { return count; }
+
+	private:
+		Uint64 count = 0;
+		BenchmarkAllocationCounter* parent = nullptr;
+	};
+
+	template<typename T>
+	ADRIA_FORCEINLINE void DoNotOptimize(T const& value)
+	{
+		static Char volatile sink;
+		sink = *reinterpret_cast<Char const volatile*>(&value);
+	}
+
+	using BenchmarkFunction = void(*)(BenchmarkState&);
+
+	class BenchmarkRegistry
+	{
+		struct BenchmarkEntry
+		{
+			Char const* name;
+			BenchmarkFunction function;
+			std::vector<Sint64> args;
+		};
+
+	public:
+		static Bool Register(Char const* name, BenchmarkFunction function, std::initializer_list<Sint64> args = {});
+		static std::vector<BenchmarkResult> RunAll(BenchmarkContext const& context, std::string_view filter = "");
+		static Bool Passed(std::span<BenchmarkResult const> results);
+		static Bool WriteResults(std::span<BenchmarkResult const> results, std::string const& file_name);
+
+	private:
+		static std::vector<BenchmarkEntry>& GetEntries();
+	};
+
+	#define ADRIA_BENCHMARK(name, ...) \
+		static void name(adria::BenchmarkState&); \
+		ADRIA_MAYBE_UNUSED static Bool const ADRIA_CONCAT(name, _registered) = adria::BenchmarkRegistry::Register(#name, name __VA_OPT__(, { __VA_ARGS__ })); \
+		static void name(adria::BenchmarkState& state)
+}
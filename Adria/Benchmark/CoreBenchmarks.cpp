@@ -0,0 +1,756 @@
+#include <random>
+#include <fstream>
+#include <filesystem>
+#include <stb_image.h>
+#include "Benchmark.h"
+#include "Core/ConsoleManager.h"
+#include "Core/Paths.h"
+#include "Graphics/GfxShaderKey.h"
+#include "Graphics/GfxShader.h"
+#include "Rendering/ShaderManager.h"
+#include "Logging/Logger.h"
+#include "Utilities/Image.h"
+#include "Utilities/Heightmap.h"
+#include "Utilities/AtlasAllocator.h"
+#include "Utilities/OffsetAllocator.h"
+#include "Utilities/ReadbackScheduler.h"
+#include "Utilities/ConcurrentQueue.h"
+#include "Utilities/BoundedConcurrentQueue.h"
+#include "Utilities/InlineFunction.h"
+#include "Utilities/ImageEncoders.h"
+#include "Utilities/PakFile.h"
+#include "Utilities/VirtualFileSystem.h"
+
+namespace adria
+{
+	namespace
+	{
+		class NullLogger : public ILogger
+		{
+		public:
+			virtual void Log(LogLevel, Char const*, Char const*, Uint32) override {}
+		};
+
+		//arg producers and arg consumers move ItemsPerProducer values each through the queue
+		template<typename QueueT>
+		void RunQueueContention(BenchmarkState& state, QueueT& queue)
+		{
+			static constexpr Uint64 ItemsPerProducer = 20000;
+			Uint32 const thread_pairs = (Uint32)state.GetArg();
+			Uint64 const total_items = ItemsPerProducer * thread_pairs;
+
+			state.SetIterations(1, 10);
+			state.SetItemsPerIteration(total_items);
+			state.Run([&]()
+				{
+					std::atomic<Uint64> consumed = 0;
+					std::vector<std::thread> threads;
+					for (Uint32 t = 0; t < thread_pairs; ++t)
+					{
+						threads.emplace_back([&queue]()
+							{
+								for (Uint64 i = 0; i < ItemsPerProducer; ++i)
+								{
+									if constexpr (requires(QueueT& q, Uint64 v) { q.TryPush(v); }) while (!queue.TryPush(i)) std::this_thread::yield();
+									else queue.Push(i);
+								}
+							});
+						threads.emplace_back([&queue, &consumed, total_items]()
+							{
+								Uint64 value = 0;
+								while (consumed.load(std::memory_order_relaxed) < total_items)
+								{
+									if (queue.TryPop(value)) consumed.fetch_add(1, std::memory_order_relaxed);
+								}
+							});
+					}
+					for (std::thread& thread : threads) thread.join();
+				});
+		}
+
+		//capture about as large as a typical render graph execute lambda, too big for the small buffer of std::function
+		struct CallbackCapture
+		{
+			Float values[16];
+			Uint64 handles[4];
+		};
+		static constexpr Uint64 CallbackCapacity = 128;
+
+		//reference QOI decoder straight from the specification, stb cannot read QOI. returns RGBA8 pixels
+		Bool DecodeQOI(std::span<Uint8 const> file, Uint32& width, Uint32& height, std::vector<Uint8>& pixels)
+		{
+			static constexpr Uint64 HeaderSize = 14;
+			static constexpr Uint64 EndMarkerSize = 8;
+			if (file.size() < HeaderSize + EndMarkerSize || memcmp(file.data(), "qoif", 4) != 0) return false;
+			auto ReadBigEndian = [&](Uint64 offset) { return Uint32(file[offset]) << 24 | Uint32(file[offset + 1]) << 16 | Uint32(file[offset + 2]) << 8 | file[offset + 3]; };
+			width = ReadBigEndian(4);
+			height = ReadBigEndian(8);
+			pixels.resize(Uint64(width) * height * 4);
+
+			Uint8 index[64][4] = {};
+			Uint8 pixel[4] = { 0, 0, 0, 255 };
+			Uint64 position = HeaderSize;
+			Uint64 const chunks_end = file.size() - EndMarkerSize;
+			Uint32 run = 0;
+			for (Uint64 i = 0; i < pixels.size(); i += 4)
+			{
+				if (run > 0) --run;
+				else
+				{
+					if (position >= chunks_end) return false;
+					Uint8 const tag = file[position++];
+					if (tag == 0xfe || tag == 0xff)
+					{
+						Uint64 const channels = tag == 0xfe ? 3 : 4;
+						if (position + channels > chunks_end) return false;
+						memcpy(pixel, &file[position], channels);
+						position += channels;
+					}
+					else if ((tag & 0xc0) == 0x00) memcpy(pixel, index[tag], 4);
+					else if ((tag & 0xc0) == 0x40)
+					{
+						pixel[0] += ((tag >> 4) & 0x03) - 2;
+						pixel[1] += ((tag >> 2) & 0x03) - 2;
+						pixel[2] += (tag & 0x03) - 2;
+					}
+					else if ((tag & 0xc0) == 0x80)
+					{
+						if (position >= chunks_end) return false;
+						Uint8 const next = file[position++];
+						Sint32 const dg = (tag & 0x3f) - 32;
+						pixel[0] += dg - 8 + ((next >> 4) & 0x0f);
+						pixel[1] += dg;
+						pixel[2] += dg - 8 + (next & 0x0f);
+					}
+					else run = tag & 0x3f;
+					memcpy(index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64], pixel, 4);
+				}
+				memcpy(&pixels[i], pixel, 4);
+			}
+			return position == chunks_end;
+		}
+
+		//PFM written by EncodePFM: RGB floats, little endian, rows bottom to top
+		Bool DecodePFM(std::span<Uint8 const> file, Uint32& width, Uint32& height, std::vector<Float>& pixels)
+		{
+			Uint64 header_size = 0;
+			for (Uint32 line_count = 0; header_size < file.size() && line_count < 3; ++header_size) line_count += file[header_size] == '\n';
+			std::string const header(reinterpret_cast<Char const*>(file.data()), header_size);
+			Float scale = 0.0f;
+			if (sscanf_s(header.c_str(), "PF %u %u %f", &width, &height, &scale) != 3 || scale >= 0.0f) return false;
+			Uint64 const pixel_count = Uint64(width) * height * 3;
+			if (file.size() != header_size + pixel_count * sizeof(Float)) return false;
+			pixels.resize(pixel_count);
+			memcpy(pixels.data(), file.data() + header_size, pixel_count * sizeof(Float));
+			return true;
+		}
+	}
+
+	ADRIA_BENCHMARK(ConsoleManager_FindVariable)
+	{
+		std::vector<std::string> names;
+		g_ConsoleManager.ForAllObjects(ConsoleObjectDelegate::CreateLambda([&names](IConsoleObject* const obj)
+			{
+				if (obj->AsVariable()) names.emplace_back(obj->GetName());
+			}));
+		names.emplace_back("r.DoesNotExist");
+		std::sort(names.begin(), names.end());
+
+		state.SetIterations(1000);
+		state.SetItemsPerIteration(names.size());
+		state.SetCounter("variables", (Float64)names.size() - 1);
+		state.Run([&]()
+			{
+				for (std::string const& name : names) DoNotOptimize(g_ConsoleManager.FindConsoleVariable(name));
+			});
+	}
+
+	//arg selects the callback type: 0 = std::function, 1 = InlineFunction
+	ADRIA_BENCHMARK(Callback_Construct, 0, 1)
+	{
+		static constexpr Uint32 CallbacksPerIteration = 256;
+		CallbackCapture capture{};
+		auto Construct = [&](auto& callbacks)
+			{
+				callbacks.clear();
+				for (Uint32 i = 0; i < CallbacksPerIteration; ++i)
+				{
+					capture.handles[0] = i;
+					callbacks.emplace_back([capture](Uint32 x) { return capture.values[x % 16] + (Float)capture.handles[0]; });
+				}
+				DoNotOptimize(callbacks.data());
+			};
+
+		std::vector<std::function<Float(Uint32)>> std_callbacks;
+		std::vector<InlineFunction<Float(Uint32), CallbackCapacity>> inline_callbacks;
+		std_callbacks.reserve(CallbacksPerIteration);
+		inline_callbacks.reserve(CallbacksPerIteration);
+
+		state.SetIterations(100);
+		state.SetItemsPerIteration(CallbacksPerIteration);
+		if (state.GetArg() == 0) state.Run([&]() { Construct(std_callbacks); });
+		else state.Run([&]() { Construct(inline_callbacks); });
+	}
+
+	//arg selects the callback type: 0 = std::function, 1 = InlineFunction
+	ADRIA_BENCHMARK(Callback_Invoke, 0, 1)
+	{
+		static constexpr Uint32 CallbacksPerIteration = 256;
+		CallbackCapture capture{};
+		for (Uint32 i = 0; i < 16; ++i) capture.values[i] = (Float)i;
+
+		std::vector<std::function<Float(Uint32)>> std_callbacks;
+		std::vector<InlineFunction<Float(Uint32), CallbackCapacity>> inline_callbacks;
+		for (Uint32 i = 0; i < CallbacksPerIteration; ++i)
+		{
+			capture.handles[0] = i;
+			std_callbacks.emplace_back([capture](Uint32 x) { return capture.values[x % 16] + (Float)capture.handles[0]; });
+			inline_callbacks.emplace_back([capture](Uint32 x) { return capture.values[x % 16] + (Float)capture.handles[0]; });
+		}
+		auto Invoke = [](auto const& callbacks)
+			{
+				Float sum = 0.0f;
+				for (Uint32 i = 0; i < callbacks.size(); ++i) sum += callbacks[i](i);
+				DoNotOptimize(sum);
+			};
+
+		state.SetIterations(1000);
+		state.SetItemsPerIteration(CallbacksPerIteration);
+		if (state.GetArg() == 0) state.Run([&]() { Invoke(std_callbacks); });
+		else state.Run([&]() { Invoke(inline_callbacks); });
+	}
+
+	ADRIA_BENCHMARK(GfxShaderKey_Hash, 0, 4, 16)
+	{
+		Sint64 const define_count = state.GetArg();
+		std::vector<GfxShaderKey> keys;
+		keys.reserve(64);
+		for (Uint32 i = 0; i < 64; ++i)
+		{
+			GfxShaderKey& key = keys.emplace_back(static_cast<ShaderID>(1 + i % (ShaderId_Count - 1)));
+			for (Sint64 j = 0; j < define_count; ++j)
+			{
+				key.AddDefine(j % 2 ? "BENCHMARK_DEFINE_ODD" : "BENCHMARK_DEFINE_EVEN", j % 3 ? "1" : "0");
+			}
+		}
+
+		state.SetIterations(1000);
+		state.SetItemsPerIteration(keys.size());
+		state.Run([&]()
+			{
+				for (GfxShaderKey const& key : keys) DoNotOptimize(GfxShaderKeyHash{}(key));
+			});
+	}
+
+	ADRIA_BENCHMARK(GfxShaderKey_MapLookup)
+	{
+		std::unordered_map<GfxShaderKey, Uint32, GfxShaderKeyHash> shader_map;
+		std::vector<GfxShaderKey> keys;
+		for (Uint32 i = 1; i < ShaderId_Count; ++i)
+		{
+			GfxShaderKey key(static_cast<ShaderID>(i));
+			if (i % 2) key.AddDefine("BENCHMARK_PERMUTATION", "1");
+			shader_map[key] = i;
+			keys.push_back(key);
+		}
+
+		state.SetIterations(1000);
+		state.SetItemsPerIteration(keys.size());
+		state.Run([&]()
+			{
+				for (GfxShaderKey const& key : keys) DoNotOptimize(shader_map.find(key));
+			});
+	}
+
+	ADRIA_BENCHMARK(Log_Throughput)
+	{
+		LogManager log_manager;
+		log_manager.Register(new NullLogger);
+
+		static constexpr Uint32 MessagesPerIteration = 1000;
+		state.SetIterations(20);
+		state.SetItemsPerIteration(MessagesPerIteration);
+		state.Run([&]()
+			{
+				for (Uint32 i = 0; i < MessagesPerIteration; ++i)
+				{
+					log_manager.LogFormat<true>(LogLevel::LOG_DEBUG, __FILE__, __LINE__, "Benchmark message %u with payload %f", i, i * 0.5f);
+				}
+				log_manager.Flush();
+			});
+	}
+
+	//arg selects the overflow policy: 0 = block, 1 = drop
+	ADRIA_BENCHMARK(Log_Throughput_8Producers, 0, 1)
+	{
+		LogManager log_manager;
+		log_manager.Register(new NullLogger);
+		log_manager.SetOverflowPolicy(state.GetArg() ? LogOverflowPolicy::Drop : LogOverflowPolicy::Block);
+
+		static constexpr Uint32 ProducerCount = 8;
+		static constexpr Uint32 MessagesPerProducer = 10000;
+		state.SetIterations(1, 10);
+		state.SetItemsPerIteration(ProducerCount * MessagesPerProducer);
+		state.Run([&]()
+			{
+				std::vector<std::thread> producers;
+				for (Uint32 p = 0; p < ProducerCount; ++p)
+				{
+					producers.emplace_back([&log_manager, p]()
+						{
+							for (Uint32 i = 0; i < MessagesPerProducer; ++i)
+							{
+								log_manager.LogFormat<true>(LogLevel::LOG_DEBUG, __FILE__, __LINE__, "Producer %u message %u: %s", p, i, "payload");
+							}
+						});
+				}
+				for (std::thread& producer : producers) producer.join();
+				log_manager.Flush();
+			});
+		state.SetCounter("dropped", (Float64)log_manager.GetDroppedCount());
+	}
+
+	ADRIA_BENCHMARK(ConcurrentQueue_Contention, 1, 2, 4)
+	{
+		ConcurrentQueue<Uint64> queue;
+		RunQueueContention(state, queue);
+	}
+
+	ADRIA_BENCHMARK(BoundedConcurrentQueue_Contention, 1, 2, 4)
+	{
+		BoundedConcurrentQueue<Uint64> queue(4096);
+		RunQueueContention(state, queue);
+	}
+
+	ADRIA_BENCHMARK(Image_LoadPNG)
+	{
+		std::string const image_path = paths::ResourcesDir + "Models/Sponza/5061699253647017043.png";
+		state.SetIterations(4, 5);
+		state.Run([&]()
+			{
+				Image image(image_path);
+				DoNotOptimize(image.Width());
+			});
+	}
+
+	ADRIA_BENCHMARK(Image_LoadDDS)
+	{
+		std::string const image_path = paths::TexturesDir + "LensDirt.dds";
+		state.SetIterations(10, 5);
+		state.Run([&]()
+			{
+				Image image(image_path);
+				DoNotOptimize(image.Width());
+			});
+	}
+
+	//0 - PNG, 1 - QOI, 2 - PFM
+	ADRIA_BENCHMARK(ImageEncode, 0, 1, 2)
+	{
+		static constexpr Uint32 Width = 1920;
+		static constexpr Uint32 Height = 1080;
+		std::vector<Uint8> pixels(Width * Height * 4);
+		std::mt19937 rng(42);
+		for (Uint32 y = 0; y < Height; ++y)
+		{
+			for (Uint32 x = 0; x < Width; ++x)
+			{
+				Uint8* pixel = &pixels[(y * Width + x) * 4];
+				pixel[0] = (Uint8)(x * 255 / Width);
+				pixel[1] = (Uint8)(y * 255 / Height);
+				pixel[2] = (Uint8)((x / 64 + y / 64) % 2 ? 200 + rng() % 8 : 40);
+				pixel[3] = 255;
+			}
+		}
+		ImageView image{ .data = pixels.data(), .width = Width, .height = Height, .row_pitch = Width * 4, .format = ImagePixelFormat::RGBA8 };
+
+		std::vector<Uint8> output;
+		state.SetIterations(4, 5);
+		state.SetItemsPerIteration((Uint64)Width * Height);
+		state.Run([&]()
+			{
+				output.clear();
+				switch (state.GetArg())
+				{
+				case 0: EncodePNG(image, output); break;
+				case 1: EncodeQOI(image, output); break;
+				case 2: EncodePFM(image, output); break;
+				}
+				DoNotOptimize(output.data());
+			});
+		state.SetCounter("CompressionRatio", (Float64)pixels.size() / output.size());
+
+		//the encoded file decodes back to the source pixels, exactly for PNG and QOI, PFM stores them as x / 255
+		Uint32 decoded_width = 0, decoded_height = 0;
+		Bool decoded = false;
+		Bool matches = false;
+		if (state.GetArg() == 2)
+		{
+			std::vector<Float> decoded_pixels;
+			decoded = DecodePFM(output, decoded_width, decoded_height, decoded_pixels);
+			matches = decoded && decoded_width == Width && decoded_height == Height;
+			for (Uint32 y = 0; matches && y < Height; ++y)
+			{
+				for (Uint32 x = 0; x < Width * 3; ++x)
+				{
+					Uint8 const source = pixels[((Height - 1 - y) * Width + x / 3) * 4 + x % 3];
+					if (std::abs(decoded_pixels[y * Width * 3 + x] - source / 255.0f) > 1e-6f) matches = false;
+				}
+			}
+		}
+		else
+		{
+			std::vector<Uint8> decoded_pixels;
+			if (state.GetArg() == 1) decoded = DecodeQOI(output, decoded_width, decoded_height, decoded_pixels);
+			else
+			{
+				Sint32 png_width = 0, png_height = 0, png_channels = 0;
+				if (Uint8* png_pixels = stbi_load_from_memory(output.data(), (Sint32)output.size(), &png_width, &png_height, &png_channels, 4))
+				{
+					decoded = true;
+					decoded_width = (Uint32)png_width;
+					decoded_height = (Uint32)png_height;
+					decoded_pixels.assign(png_pixels, png_pixels + Uint64(png_width) * png_height * 4);
+					stbi_image_free(png_pixels);
+				}
+			}
+			matches = decoded && decoded_width == Width && decoded_height == Height && decoded_pixels == pixels;
+		}
+		state.Check(decoded, "encoded image could not be decoded");
+		state.Check(!decoded || matches, "decoded image differs from the source pixels");
+	}
+
+	ADRIA_BENCHMARK(Heightmap_Noise, 512, 2048)
+	{
+		Uint32 const size = (Uint32)state.GetArg();
+		NoiseDesc noise_desc{ .width = size + 1, .depth = size + 1, .max_height = 200, .fractal_type = FractalType::FBM, .octaves = 4 };
+
+		state.SetIterations(1, 5);
+		state.SetItemsPerIteration((Uint64)noise_desc.width * noise_desc.depth);
+		state.Run([&]()
+			{
+				Heightmap heightmap(noise_desc);
+				DoNotOptimize(heightmap.HeightAt(0, 0));
+			});
+	}
+
+	ADRIA_BENCHMARK(Heightmap_BoundsQuery)
+	{
+		NoiseDesc noise_desc{ .width = 1025, .depth = 1025, .max_height = 200, .fractal_type = FractalType::FBM };
+		Heightmap heightmap(noise_desc);
+
+		static constexpr Uint32 QueriesPerIteration = 1024;
+		state.SetIterations(100);
+		state.SetItemsPerIteration(QueriesPerIteration);
+		state.Run([&]()
+			{
+				for (Uint32 i = 0; i < QueriesPerIteration; ++i)
+				{
+					Uint64 const x = (i * 37) % 960;
+					Uint64 const z = (i * 91) % 960;
+					DoNotOptimize(heightmap.GetHeightBounds(x, z, x + 64, z + 64));
+				}
+			});
+	}
+
+	ADRIA_BENCHMARK(AtlasAllocator_Churn)
+	{
+		//shadow atlas like workload: a mostly full 8k atlas where tiles of 128 to 2048 are freed and allocated again
+		AtlasAllocator allocator(8192, 128);
+		std::vector<AtlasTile> tiles;
+		std::mt19937 rng(42);
+		auto RandomTileSize = [&]() { return 128u << (rng() % 5); };
+		for (AtlasTile tile = allocator.Allocate(RandomTileSize()); tile.IsValid(); tile = allocator.Allocate(RandomTileSize()))
+		{
+			tiles.push_back(tile);
+		}
+
+		static constexpr Uint32 OperationsPerIteration = 1024;
+		Uint32 failed_allocations = 0;
+		state.SetIterations(100);
+		state.SetItemsPerIteration(OperationsPerIteration);
+		state.Run([&]()
+			{
+				for (Uint32 i = 0; i < OperationsPerIteration; ++i)
+				{
+					Uint64 const index = rng() % tiles.size();
+					allocator.Free(tiles[index]);
+					tiles[index] = allocator.Allocate(RandomTileSize());
+					if (!tiles[index].IsValid())
+					{
+						++failed_allocations;
+						tiles[index] = allocator.Allocate(128);
+					}
+				}
+			});
+		state.SetCounter("Fragmentation", allocator.GetStats().fragmentation);
+		state.SetCounter("FailedAllocations", failed_allocations);
+
+		//live tiles are aligned to their size, inside the atlas and do not overlap
+		static constexpr Uint32 CellsPerRow = 8192 / 128;
+		std::vector<Uint8> cells(CellsPerRow * CellsPerRow, 0);
+		Bool tiles_valid = true;
+		for (AtlasTile const& tile : tiles)
+		{
+			if (!tile.IsValid()) continue;
+			if (tile.x % tile.size || tile.y % tile.size || tile.x + tile.size > 8192 || tile.y + tile.size > 8192)
+			{
+				tiles_valid = false;
+				continue;
+			}
+			for (Uint32 y = tile.y / 128; y < (tile.y + tile.size) / 128; ++y)
+			{
+				for (Uint32 x = tile.x / 128; x < (tile.x + tile.size) / 128; ++x)
+				{
+					tiles_valid &= cells[y * CellsPerRow + x]++ == 0;
+				}
+			}
+		}
+		state.Check(tiles_valid, "live tiles overlap or lie outside the atlas");
+
+		//freed tiles merge back until the whole atlas is one free tile again
+		for (AtlasTile const& tile : tiles) allocator.Free(tile);
+		AtlasAllocatorStats const stats = allocator.GetStats();
+		state.Check(stats.allocation_count == 0 && stats.allocated_area == 0, "atlas has allocations left after freeing every tile");
+		AtlasTile const full_tile = allocator.Allocate(8192);
+		state.Check(full_tile.IsValid() && full_tile.x == 0 && full_tile.y == 0 && full_tile.size == 8192, "freed tiles did not merge into a full size tile");
+	}
+
+	ADRIA_BENCHMARK(OffsetAllocator_Churn)
+	{
+		OffsetAllocator allocator(1u << 24, 64 * 1024);
+		std::vector<OffsetAllocation> allocations;
+		std::mt19937 rng(42);
+		auto RandomSize = [&]() { return 1u + (rng() % 8 == 0 ? rng() % 65536 : rng() % 1024); };
+		for (Uint32 i = 0; i < 4096; ++i)
+		{
+			OffsetAllocation allocation = allocator.Allocate(RandomSize());
+			if (allocation.IsValid()) allocations.push_back(allocation);
+		}
+
+		static constexpr Uint32 OperationsPerIteration = 4096;
+		Uint32 failed_allocations = 0;
+		state.SetIterations(100);
+		state.SetItemsPerIteration(OperationsPerIteration);
+		state.Run([&]()
+			{
+				for (Uint32 i = 0; i < OperationsPerIteration; ++i)
+				{
+					Uint64 const index = rng() % allocations.size();
+					allocator.Free(allocations[index]);
+					allocations[index] = allocator.Allocate(RandomSize());
+					if (!allocations[index].IsValid())
+					{
+						++failed_allocations;
+						allocations[index] = allocator.Allocate(1);
+					}
+				}
+			});
+		state.SetCounter("Fragmentation", allocator.GetStats().fragmentation);
+		state.SetCounter("FailedAllocations", failed_allocations);
+
+		//live allocations lie inside the range, do not overlap and together with the free space cover the whole range
+		auto CheckAllocations = [&](Char const* message)
+		{
+			std::vector<std::pair<Uint32, Uint32>> ranges;
+			for (OffsetAllocation const& allocation : allocations)
+			{
+				if (allocation.IsValid()) ranges.emplace_back(allocation.offset, allocator.GetAllocationSize(allocation));
+			}
+			std::sort(ranges.begin(), ranges.end());
+			Bool valid = true;
+			Uint64 allocated_size = 0;
+			for (Uint64 i = 0; i < ranges.size(); ++i)
+			{
+				Uint64 const end = (Uint64)ranges[i].first + ranges[i].second;
+				valid &= end <= allocator.GetSize() && (i + 1 == ranges.size() || end <= ranges[i + 1].first);
+				allocated_size += ranges[i].second;
+			}
+			valid &= allocated_size + allocator.GetFreeSize() == allocator.GetSize();
+			state.Check(valid, message);
+		};
+		CheckAllocations("live allocations overlap or do not add up to the allocator size");
+
+		std::unordered_map<Uint32, Uint64> allocation_indices;
+		for (Uint64 i = 0; i < allocations.size(); ++i)
+		{
+			if (allocations[i].IsValid()) allocation_indices[allocations[i].node] = i;
+		}
+		Uint64 moved_size = 0;
+		for (OffsetAllocatorMove const& move : allocator.CreateDefragmentationPlan(1u << 20))
+		{
+			allocations[allocation_indices[move.from.node]] = move.to;
+			allocator.Free(move.from);
+			moved_size += move.size;
+		}
+		state.SetCounter("DefragmentedFragmentation", allocator.GetStats().fragmentation);
+		state.SetCounter("DefragmentationMovedSize", (Float64)moved_size);
+		CheckAllocations("allocations overlap after defragmentation");
+
+		//freed regions coalesce until the whole range is one free region again
+		for (OffsetAllocation const& allocation : allocations) allocator.Free(allocation);
+		OffsetAllocatorStats const stats = allocator.GetStats();
+		state.Check(stats.allocation_count == 0 && stats.free_size == allocator.GetSize() && stats.free_region_count == 1,
+			"freed regions did not coalesce into a single free region");
+		OffsetAllocation const full_allocation = allocator.Allocate(allocator.GetSize());
+		state.Check(full_allocation.IsValid() && full_allocation.offset == 0, "full size allocation failed after freeing everything");
+	}
+
+	//drives the readback scheduler with a mock fence that completes arg frames after a frame is submitted
+	ADRIA_BENCHMARK(ReadbackScheduler_MockFence, 1, 2, 3)
+	{
+		static constexpr Uint32 FrameCount = 256;
+		static constexpr Uint32 RequestsPerFrame = 64;
+		Uint64 const gpu_lag = (Uint64)state.GetArg();
+
+		ReadbackScheduler scheduler(64 * 1024, 1, 16);
+		std::vector<std::vector<Uint8>> page_storage;
+		Uint64 fence_value = 0;
+		struct ReadbackResults
+		{
+			Uint32 resolved = 0;
+			Uint32 corrupted = 0;
+			Uint32 out_of_order = 0;
+			Uint64 max_latency = 0;
+		} results;
+		Uint64 requested = 0;
+		state.SetIterations(10);
+		state.SetItemsPerIteration(FrameCount * RequestsPerFrame);
+		state.Run([&]()
+			{
+				for (Uint32 frame = 0; frame < FrameCount; ++frame)
+				{
+					Uint64 const completed_fence_value = fence_value > gpu_lag ? fence_value - gpu_lag : 0;
+					scheduler.Update(completed_fence_value, [&](Uint32 page) -> void const* { return page_storage[page].data(); });
+					for (Uint32 i = 0; i < RequestsPerFrame; ++i)
+					{
+						Uint32 const value = frame * RequestsPerFrame + i;
+						Uint64 const size = i == 0 ? 256 * 1024 : 16 + (i % 8) * 64;
+						ReadbackAllocation const allocation = scheduler.Allocate(size, 16, [&results, &fence_value, value, request_fence_value = fence_value](void const* data, Uint64)
+							{
+								Uint32 readback_value;
+								memcpy(&readback_value, data, sizeof(Uint32));
+								if (readback_value != value) ++results.corrupted;
+								//every iteration requests the same values again, in order
+								if (value != results.resolved % (FrameCount * RequestsPerFrame)) ++results.out_of_order;
+								results.max_latency = std::max(results.max_latency, fence_value - request_fence_value);
+								++results.resolved;
+							});
+						++requested;
+						if (allocation.new_page)
+						{
+							if (page_storage.size() <= allocation.page) page_storage.resize(allocation.page + 1);
+							page_storage[allocation.page].resize(scheduler.GetPageSize(allocation.page));
+						}
+						//stands in for the gpu copy
+						memcpy(page_storage[allocation.page].data() + allocation.offset, &value, sizeof(Uint32));
+					}
+					scheduler.Submit(++fence_value);
+				}
+			});
+
+		//a request is submitted with the next fence value, which the mock gpu completes gpu_lag frames later
+		ReadbackSchedulerStats const& stats = scheduler.GetStats();
+		state.Check(results.corrupted == 0, "readbacks returned the data of another request");
+		state.Check(results.out_of_order == 0, "readbacks did not resolve in request order");
+		state.Check(results.max_latency <= gpu_lag + 1, "readbacks resolved later than the fence allowed");
+		state.Check(results.resolved + scheduler.GetPendingRequestCount() == requested, "readback requests were lost");
+		state.SetCounter("resolved", results.resolved);
+		state.SetCounter("pending", (Float64)scheduler.GetPendingRequestCount());
+		state.SetCounter("created_pages", stats.created_pages);
+		state.SetCounter("peak_pool_kb", stats.peak_pool_size / 1024.0);
+		state.SetCounter("max_resolve_latency", stats.max_resolve_latency);
+	}
+
+	//packs synthetic files, mounts the pak and reads everything back in one batch. half of the files compress well, half are noise.
+	//arg 0 stores the files, arg 1 compresses them
+	ADRIA_BENCHMARK(Pak_RoundTrip, 0, 1)
+	{
+		static constexpr Uint32 FileCount = 256;
+		static constexpr Uint32 MaxFileSize = 256 * 1024;
+		std::string const pak_path = paths::SavedDir + "Benchmark.pak";
+
+		std::mt19937 rng{ 7 };
+		std::vector<std::string> file_paths(FileCount);
+		std::vector<std::string> request_paths(FileCount);
+		std::vector<std::vector<Uint8>> file_contents(FileCount);
+		PakWriter writer(PakWriteOptions{ .compress = state.GetArg() == 1 });
+		for (Uint32 i = 0; i < FileCount; ++i)
+		{
+			std::string const folder = "Folder" + std::to_string(i % 8);
+			std::string const file = "File" + std::to_string(i) + ".bin";
+			file_paths[i] = "Benchmark/Pak/" + folder + "/" + file;
+			//loaders do not spell the paths the same way
+			request_paths[i] = i % 3 == 0 ? "./Benchmark\\PAK\\" + folder + "\\..\\" + folder + "\\" + file : file_paths[i];
+
+			std::vector<Uint8>& contents = file_contents[i];
+			contents.resize(rng() % MaxFileSize);
+			if (i % 2 == 0) for (Uint8& byte : contents) byte = (Uint8)rng();
+			else for (Uint64 j = 0; j < contents.size(); ++j) contents[j] = (Uint8)("adria pak "[j % 10] + (j / 4096) % 4);
+			writer.AddData(file_paths[i], contents);
+		}
+		if (!state.Check(writer.Write(pak_path) && g_VirtualFileSystem.Mount(pak_path), "failed to write or mount the benchmark pak")) return;
+
+		std::vector<VFSFile> files;
+		state.SetIterations(10);
+		state.SetItemsPerIteration(FileCount);
+		state.Run([&]()
+			{
+				files = g_VirtualFileSystem.ReadFiles(request_paths);
+				DoNotOptimize(files.data());
+			});
+
+		Uint32 mismatches = 0;
+		for (Uint32 i = 0; i < FileCount; ++i)
+		{
+			if (!files[i].IsValid() || !std::equal(files[i].Bytes().begin(), files[i].Bytes().end(), file_contents[i].begin(), file_contents[i].end())) ++mismatches;
+		}
+		Uint32 corrupted = 0;
+		{
+			PakArchive archive(pak_path);
+			for (PakEntry const& entry : archive.GetEntries()) corrupted += !archive.VerifyEntry(entry);
+		}
+		files.clear();
+		g_VirtualFileSystem.Unmount(pak_path);
+		std::remove(pak_path.c_str());
+
+		state.Check(mismatches == 0, "files did not round trip through the pak");
+		state.Check(corrupted == 0, "pak entries failed verification");
+		PakWriteStats const& stats = writer.GetStats();
+		state.Check(state.GetArg() == 0 ? stats.compressed_count == 0 : stats.compressed_count > 0, "compression did not match the write options");
+
+		//files packed from disk with PackDirectory are removed before the pak is mounted, so they can only come from the pak.
+		//the last file is outside of the packed directory and comes from the disk
+		std::string const directory = paths::SavedDir + "BenchmarkPak";
+		std::string const directory_pak_path = paths::SavedDir + "BenchmarkPak.pak";
+		std::vector<std::string> const directory_paths = { directory + "/Packed.bin", directory + "/Nested/Packed.bin", paths::SavedDir + "BenchmarkLoose.bin" };
+		std::error_code error;
+		std::filesystem::create_directories(directory + "/Nested", error);
+		Bool packed = true;
+		for (Uint32 i = 0; i < directory_paths.size(); ++i)
+		{
+			std::ofstream file(directory_paths[i], std::ios::binary);
+			file.write(reinterpret_cast<Char const*>(file_contents[i].data()), file_contents[i].size());
+			packed &= file.good();
+		}
+		packed = packed && PackDirectory(directory, directory_pak_path, PakWriteOptions{ .compress = state.GetArg() == 1 });
+		std::filesystem::remove_all(directory, error);
+		if (state.Check(packed && g_VirtualFileSystem.Mount(directory_pak_path), "failed to pack or mount the benchmark directory"))
+		{
+			std::vector<VFSFile> const directory_files = g_VirtualFileSystem.ReadFiles(directory_paths);
+			Uint32 directory_mismatches = 0;
+			for (Uint32 i = 0; i < directory_paths.size(); ++i)
+			{
+				if (!directory_files[i].IsValid() || !std::equal(directory_files[i].Bytes().begin(), directory_files[i].Bytes().end(), file_contents[i].begin(), file_contents[i].end())) ++directory_mismatches;
+			}
+			state.Check(directory_mismatches == 0, "packed directory files or the loose file did not round trip");
+			g_VirtualFileSystem.Unmount(directory_pak_path);
+		}
+		std::remove(directory_pak_path.c_str());
+		std::remove(directory_paths.back().c_str());
+		state.SetCounter("mismatches", mismatches);
+		state.SetCounter("compressed_files", stats.compressed_count);
+		state.SetCounter("total_mb", stats.total_size / (1024.0 * 1024.0));
+		state.SetCounter("stored_mb", stats.stored_size / (1024.0 * 1024.0));
+	}
+}
@@ -0,0 +1,1225 @@
+#include <random>
+#include <numeric>
+#include "cgltf.h"
+#include "meshoptimizer.h"
+#include "Benchmark.h"
+#include "Core/Paths.h"
+#include "Core/ConsoleManager.h"
+#include "Core/FramePipeline.h"
+#include "Logging/Logger.h"
+#include "Rendering/Components.h"
+#include "Rendering/Camera.h"
+#include "Rendering/RenderSnapshot.h"
+#include "Rendering/ShaderStructs.h"
+#include "Rendering/Meshlet.h"
+#include "Rendering/MeshletCuller.h"
+#include "Rendering/MeshletLOD.h"
+#include "Rendering/AccelerationStructureTracker.h"
+#include "Rendering/SoftwareOcclusionCuller.h"
+#include "Rendering/ClusterLightBinner.h"
+#include "Rendering/DynamicResolutionController.h"
+#include "Rendering/TextureResidency.h"
+#include "Math/Packing.h"
+#include "RenderGraph/RenderGraph.h"
+#include "entt/entity/registry.hpp"
+
+using namespace DirectX;
+
+namespace adria
+{
+	namespace
+	{
+		RGTextureDesc SyntheticTextureDesc(Uint32 width, Uint32 height, GfxFormat format = GfxFormat::R16G16B16A16_FLOAT)
+		{
+			RGTextureDesc desc{};
+			desc.width = width;
+			desc.height = height;
+			desc.format = format;
+			return desc;
+		}
+
+		struct SyntheticFrameBuilder
+		{
+			RenderGraph& rg;
+			Uint64 pass_count = 0;
+
+			void AddPass(Char const* name, std::vector<RGResourceName> const& inputs, std::vector<RGResourceName> const& outputs,
+				RGTextureDesc const& desc, RGPassType type = RGPassType::Compute, RGPassFlags flags = RGPassFlags::None)
+			{
+				rg.AddPass<void>(name,
+					[=](RenderGraphBuilder& builder)
+					{
+						for (RGResourceName const& input : inputs) std::ignore = builder.ReadTexture(input, ReadAccess_NonPixelShader);
+						for (RGResourceName const& output : outputs)
+						{
+							builder.DeclareTexture(output, desc);
+							std::ignore = builder.WriteTexture(output);
+						}
+					},
+					[](RenderGraphContext&, GfxCommandList*) {}, type, flags);
+				++pass_count;
+			}
+
+			//writes to resources declared by earlier passes
+			void AddModifyPass(Char const* name, std::vector<RGResourceName> const& inputs, std::vector<RGResourceName> const& outputs, RGPassType type = RGPassType::Compute)
+			{
+				rg.AddPass<void>(name,
+					[=](RenderGraphBuilder& builder)
+					{
+						for (RGResourceName const& input : inputs) std::ignore = builder.ReadTexture(input, ReadAccess_NonPixelShader);
+						for (RGResourceName const& output : outputs) std::ignore = builder.WriteTexture(output);
+					},
+					[](RenderGraphContext&, GfxCommandList*) {}, type);
+				++pass_count;
+			}
+		};
+
+		//mirrors the shape of Renderer::Render_Deferred: gbuffer, hi-z, ao, shadows, clustered lighting,
+		//volumetrics, sky, bloom, dof, taa, exposure, tonemap and a few debug passes that get culled
+		Uint64 AddSyntheticFrame(RenderGraph& rg)
+		{
+			static constexpr Uint32 Width = 1920;
+			static constexpr Uint32 Height = 1080;
+			static constexpr Uint32 HiZMips = 8;
+			static constexpr Uint32 ShadowMaps = 8;
+			static constexpr Uint32 BloomMips = 6;
+
+			SyntheticFrameBuilder frame{ rg };
+			RGTextureDesc const full_res_desc = SyntheticTextureDesc(Width, Height);
+			RGTextureDesc const half_res_desc = SyntheticTextureDesc(Width / 2, Height / 2);
+			RGTextureDesc const shadow_desc = SyntheticTextureDesc(2048, 2048, GfxFormat::R32_FLOAT);
+
+			frame.AddPass("GBuffer Pass", {}, { RG_NAME(GBufferNormal), RG_NAME(GBufferAlbedo), RG_NAME(GBufferEmissive), RG_NAME(DepthStencil) },
+				SyntheticTextureDesc(Width, Height, GfxFormat::R8G8B8A8_UNORM), RGPassType::Graphics);
+			frame.AddPass("Decals Pass", { RG_NAME(DepthStencil), RG_NAME(GBufferAlbedo) }, { RG_NAME(DecalAlbedo) }, full_res_desc, RGPassType::Graphics);
+			frame.AddPass("Motion Vectors Pass", { RG_NAME(DepthStencil) }, { RG_NAME(VelocityBuffer) }, full_res_desc);
+
+			frame.AddPass("HiZ Pass", { RG_NAME(DepthStencil) }, { RG_NAME_IDX(HiZ, 0) }, half_res_desc);
+			for (Uint32 i = 1; i < HiZMips; ++i)
+			{
+				frame.AddPass("HiZ Pass", { RG_NAME_IDX(HiZ, i - 1) }, { RG_NAME_IDX(HiZ, i) }, SyntheticTextureDesc(Width >> (i + 1), Height >> (i + 1), GfxFormat::R32_FLOAT));
+			}
+
+			frame.AddPass("SSAO Pass", { RG_NAME(DepthStencil), RG_NAME(GBufferNormal), RG_NAME_IDX(HiZ, HiZMips - 1) }, { RG_NAME(AmbientOcclusion) }, half_res_desc);
+			frame.AddPass("SSAO Blur Horizontal Pass", { RG_NAME(AmbientOcclusion) }, { RG_NAME(AmbientOcclusionBlurX) }, half_res_desc);
+			frame.AddPass("SSAO Blur Vertical Pass", { RG_NAME(AmbientOcclusionBlurX) }, { RG_NAME(AmbientOcclusionBlurY) }, half_res_desc);
+
+			std::vector<RGResourceName> shadow_maps;
+			for (Uint32 i = 0; i < ShadowMaps; ++i)
+			{
+				shadow_maps.push_back(RG_NAME_IDX(ShadowMap, i));
+				frame.AddPass("Shadow Map Pass", {}, { shadow_maps.back() }, shadow_desc, RGPassType::Graphics);
+			}
+			shadow_maps.push_back(RG_NAME(DepthStencil));
+			frame.AddPass("Shadow Mask Pass", shadow_maps, { RG_NAME(ShadowMask) }, full_res_desc);
+
+			frame.AddPass("Cluster Building Pass", {}, { RG_NAME(ClusterAABBs) }, SyntheticTextureDesc(16, 16));
+			frame.AddPass("Cluster Culling Pass", { RG_NAME(ClusterAABBs), RG_NAME(DepthStencil) }, { RG_NAME(LightGrid) }, SyntheticTextureDesc(16, 16));
+			frame.AddPass("Clustered Deferred Lighting Pass",
+				{ RG_NAME(GBufferNormal), RG_NAME(DecalAlbedo), RG_NAME(GBufferEmissive), RG_NAME(DepthStencil), RG_NAME(AmbientOcclusionBlurY), RG_NAME(ShadowMask), RG_NAME(LightGrid) },
+				{ RG_NAME(HDR_RenderTarget) }, full_res_desc);
+			frame.AddPass("SSR Pass", { RG_NAME(HDR_RenderTarget), RG_NAME(GBufferNormal), RG_NAME_IDX(HiZ, HiZMips - 1) }, { RG_NAME(SSR_Output) }, full_res_desc);
+			//write after the read of the ssr pass
+			frame.AddModifyPass("Sun Pass", { RG_NAME(DepthStencil) }, { RG_NAME(HDR_RenderTarget) }, RGPassType::Graphics);
+
+			frame.AddPass("Volumetric Fog Light Injection Pass", { RG_NAME(ShadowMask) }, { RG_NAME(FogLightInjection) }, SyntheticTextureDesc(160, 90));
+			frame.AddPass("Volumetric Fog Scattering Integration Pass", { RG_NAME(FogLightInjection) }, { RG_NAME(FogScattering) }, SyntheticTextureDesc(160, 90));
+			frame.AddPass("Volumetric Fog Combine Pass", { RG_NAME(FogScattering), RG_NAME(SSR_Output), RG_NAME(HDR_RenderTarget), RG_NAME(DepthStencil) }, { RG_NAME(FogOutput) }, full_res_desc);
+
+			frame.AddPass("Clouds Pass", { RG_NAME(DepthStencil) }, { RG_NAME(CloudsOutput) }, half_res_desc);
+			frame.AddPass("Clouds Reprojection Pass", { RG_NAME(CloudsOutput), RG_NAME(VelocityBuffer) }, { RG_NAME(CloudsReprojected) }, half_res_desc);
+			frame.AddPass("Sky Pass", { RG_NAME(FogOutput), RG_NAME(CloudsReprojected), RG_NAME(DepthStencil) }, { RG_NAME(SkyOutput) }, full_res_desc, RGPassType::Graphics);
+
+			frame.AddPass("Bloom Downsample Pass", { RG_NAME(SkyOutput) }, { RG_NAME_IDX(BloomDownsample, 0) }, half_res_desc);
+			for (Uint32 i = 1; i < BloomMips; ++i)
+			{
+				frame.AddPass("Bloom Downsample Pass", { RG_NAME_IDX(BloomDownsample, i - 1) }, { RG_NAME_IDX(BloomDownsample, i) }, SyntheticTextureDesc(Width >> (i + 1), Height >> (i + 1)));
+			}
+			frame.AddPass("Bloom Upsample Pass", { RG_NAME_IDX(BloomDownsample, BloomMips - 1) }, { RG_NAME_IDX(BloomUpsample, BloomMips - 1) }, SyntheticTextureDesc(Width >> BloomMips, Height >> BloomMips));
+			for (Sint32 i = BloomMips - 2; i >= 0; --i)
+			{
+				frame.AddPass("Bloom Upsample Pass", { RG_NAME_IDX(BloomUpsample, i + 1), RG_NAME_IDX(BloomDownsample, i) }, { RG_NAME_IDX(BloomUpsample, i) }, SyntheticTextureDesc(Width >> (i + 1), Height >> (i + 1)));
+			}
+			frame.AddPass("Bloom Composite Pass", { RG_NAME(SkyOutput), RG_NAME_IDX(BloomUpsample, 0) }, { RG_NAME(BloomOutput) }, full_res_desc);
+
+			frame.AddPass("DoF Circle of Confusion Pass", { RG_NAME(DepthStencil) }, { RG_NAME(DoF_CoC) }, full_res_desc);
+			frame.AddPass("DoF Bokeh Pass", { RG_NAME(BloomOutput), RG_NAME(DoF_CoC) }, { RG_NAME(DoF_Bokeh) }, half_res_desc);
+			frame.AddPass("DoF Composite Pass", { RG_NAME(BloomOutput), RG_NAME(DoF_Bokeh), RG_NAME(DoF_CoC) }, { RG_NAME(DoF_Output) }, full_res_desc);
+
+			frame.AddPass("TAA Pass", { RG_NAME(DoF_Output), RG_NAME(VelocityBuffer), RG_NAME(DepthStencil) }, { RG_NAME(TAAOutput) }, full_res_desc);
+			frame.AddPass("Build Histogram Pass", { RG_NAME(TAAOutput) }, { RG_NAME(Histogram) }, SyntheticTextureDesc(256, 1, GfxFormat::R32_UINT));
+			frame.AddPass("Exposure Pass", { RG_NAME(Histogram) }, { RG_NAME(Exposure) }, SyntheticTextureDesc(1, 1, GfxFormat::R32_FLOAT));
+			frame.AddPass("Tonemap Pass", { RG_NAME(TAAOutput), RG_NAME(Exposure) }, { RG_NAME(TonemapOutput) }, SyntheticTextureDesc(Width, Height, GfxFormat::R8G8B8A8_UNORM));
+			frame.AddPass("FXAA Pass", { RG_NAME(TonemapOutput) }, { RG_NAME(FinalTexture) }, SyntheticTextureDesc(Width, Height, GfxFormat::R8G8B8A8_UNORM), RGPassType::Compute, RGPassFlags::ForceNoCull);
+
+			frame.AddPass("Debug Normals Pass", { RG_NAME(GBufferNormal) }, { RG_NAME(DebugNormals) }, full_res_desc);
+			frame.AddPass("Debug AO Pass", { RG_NAME(AmbientOcclusion) }, { RG_NAME(DebugAO) }, full_res_desc);
+			frame.AddPass("Debug Shadow Mask Pass", { RG_NAME(ShadowMask) }, { RG_NAME(DebugShadowMask) }, full_res_desc);
+			frame.AddPass("Debug Velocity Pass", { RG_NAME(VelocityBuffer) }, { RG_NAME(DebugVelocity) }, full_res_desc);
+			return frame.pass_count;
+		}
+
+		BoundingBox RandomBoundingBox(std::mt19937& rng, Float range)
+		{
+			std::uniform_real_distribution<Float> position(-range, range);
+			std::uniform_real_distribution<Float> extent(0.1f, 5.0f);
+			//one draw per statement, the evaluation order of function arguments is unspecified
+			Float const x = position(rng), y = position(rng), z = position(rng);
+			Float const extent_x = extent(rng), extent_y = extent(rng), extent_z = extent(rng);
+			return BoundingBox(Vector3(x, y, z), Vector3(extent_x, extent_y, extent_z));
+		}
+
+		Matrix RandomWorldTransform(std::mt19937& rng, Float range)
+		{
+			std::uniform_real_distribution<Float> position(-range, range);
+			std::uniform_real_distribution<Float> angle(0.0f, XM_2PI);
+			std::uniform_real_distribution<Float> scale(0.5f, 2.0f);
+			Float const s = scale(rng), rotation = angle(rng);
+			Float const x = position(rng), y = position(rng), z = position(rng);
+			return Matrix::CreateScale(s) * Matrix::CreateRotationY(rotation) * Matrix::CreateTranslation(x, y, z);
+		}
+
+		//unit uv sphere with bumps, the seam column is duplicated like in exported meshes
+		void CreateBumpySphere(Uint32 stacks, Uint32 slices, std::vector<Vector3>& positions, std::vector<Uint32>& indices)
+		{
+			for (Uint32 stack = 0; stack <= stacks; ++stack)
+			{
+				for (Uint32 slice = 0; slice <= slices; ++slice)
+				{
+					Float const theta = XM_PI * stack / stacks;
+					Float const phi = XM_2PI * slice / slices;
+					Float const radius = 1.0f + 0.05f * std::sin(8.0f * theta) * std::cos(6.0f * phi);
+					positions.emplace_back(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi));
+				}
+			}
+			for (Uint32 stack = 0; stack < stacks; ++stack)
+			{
+				for (Uint32 slice = 0; slice < slices; ++slice)
+				{
+					Uint32 const a = stack * (slices + 1) + slice;
+					Uint32 const b = a + slices + 1;
+					indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+				}
+			}
+		}
+
+		struct GLTFPrimitiveData
+		{
+			std::vector<Vector3> positions;
+			std::vector<Uint32> indices;
+		};
+
+		std::vector<GLTFPrimitiveData> ReadGLTFPrimitives(cgltf_data const* gltf_data)
+		{
+			std::vector<GLTFPrimitiveData> primitives;
+			for (Uint64 i = 0; i < gltf_data->meshes_count; ++i)
+			{
+				cgltf_mesh const& gltf_mesh = gltf_data->meshes[i];
+				for (Uint64 j = 0; j < gltf_mesh.primitives_count; ++j)
+				{
+					cgltf_primitive const& gltf_primitive = gltf_mesh.primitives[j];
+					if (!gltf_primitive.indices || gltf_primitive.type != cgltf_primitive_type_triangles) continue;
+
+					GLTFPrimitiveData& primitive = primitives.emplace_back();
+					primitive.indices.resize(gltf_primitive.indices->count);
+					for (Uint64 k = 0; k < gltf_primitive.indices->count; ++k)
+					{
+						primitive.indices[k] = (Uint32)cgltf_accessor_read_index(gltf_primitive.indices, k);
+					}
+					for (Uint64 k = 0; k < gltf_primitive.attributes_count; ++k)
+					{
+						cgltf_attribute const& gltf_attribute = gltf_primitive.attributes[k];
+						if (gltf_attribute.type != cgltf_attribute_type_position) continue;
+
+						primitive.positions.resize(gltf_attribute.data->count);
+						for (Uint64 v = 0; v < gltf_attribute.data->count; ++v)
+						{
+							cgltf_accessor_read_float(gltf_attribute.data, v, &primitive.positions[v].x, 3);
+						}
+					}
+				}
+			}
+			return primitives;
+		}
+	}
+
+	ADRIA_BENCHMARK(RenderGraph_Build)
+	{
+		RGResourcePool resource_pool(state.GetDevice());
+		Uint64 pass_count = 0;
+		Uint64 peak_transient_bytes = 0;
+		Uint32 barrier_count = 0;
+		RGAllocatorStats allocator_stats{};
+		Uint64 frame_allocations = 0;
+		Uint64 build_allocations = 0;
+
+		state.SetIterations(50);
+		state.Run([&]()
+			{
+				BenchmarkAllocationCounter frame_allocation_counter;
+				{
+					RenderGraph render_graph(resource_pool);
+					pass_count = AddSyntheticFrame(render_graph);
+					{
+						BenchmarkAllocationCounter build_allocation_counter;
+						render_graph.Build();
+						build_allocations = build_allocation_counter.GetCount();
+					}
+					allocator_stats = render_graph.GetAllocatorStats();
+					peak_transient_bytes = render_graph.GetStats().peak_transient_bytes;
+					barrier_count = render_graph.GetStats().barrier_count;
+				}
+				frame_allocations = frame_allocation_counter.GetCount();
+			});
+		state.SetCounter("passes", (Float64)pass_count);
+		state.SetCounter("barriers", (Float64)barrier_count);
+		state.SetCounter("peak_transient_mb", peak_transient_bytes / (1024.0 * 1024.0));
+		//values of the last iteration, the arena has grown to the size of the frame by then. the frame count includes
+		//the std::vector captures of the synthetic pass setup lambdas, Build itself has to stay off the heap
+		state.SetCounter("arena_bytes", (Float64)allocator_stats.used_bytes);
+		state.SetCounter("arena_block_allocations", (Float64)allocator_stats.block_allocations);
+#if ADRIA_BENCHMARK_ALLOCATION_HOOKS
+		state.SetCounter("frame_heap_allocations", (Float64)frame_allocations);
+		state.SetCounter("build_heap_allocations", (Float64)build_allocations);
+		state.Check(build_allocations == 0, "RenderGraph::Build allocated from the heap");
+#endif
+	}
+
+	ADRIA_BENCHMARK(RenderGraph_Schedule)
+	{
+		IConsoleVariable* schedule_cvar = g_ConsoleManager.FindConsoleVariable("r.RenderGraph.Schedule");
+		ADRIA_ASSERT(schedule_cvar != nullptr);
+		Sint32 const schedule_mode = schedule_cvar->GetInt();
+		schedule_cvar->Set(1);
+
+		RGResourcePool resource_pool(state.GetDevice());
+		RGScheduleStats schedule_stats{};
+		state.SetIterations(50);
+		state.Run([&]()
+			{
+				RenderGraph render_graph(resource_pool);
+				AddSyntheticFrame(render_graph);
+				render_graph.Build();
+				schedule_stats = render_graph.GetScheduleStats();
+			});
+
+		state.SetCounter("peak_mb_before", schedule_stats.peak_bytes_before / (1024.0 * 1024.0));
+		state.SetCounter("peak_mb_after", schedule_stats.peak_bytes_after / (1024.0 * 1024.0));
+		state.SetCounter("barriers_before", (Float64)schedule_stats.barriers_before);
+		state.SetCounter("barriers_after", (Float64)schedule_stats.barriers_after);
+		state.SetCounter("applied", schedule_stats.applied ? 1.0 : 0.0);
+		state.Check(!schedule_stats.applied || schedule_stats.peak_bytes_after <= schedule_stats.peak_bytes_before, "schedule increased the transient memory peak");
+		state.Check(!schedule_stats.applied || schedule_stats.barriers_after <= schedule_stats.barriers_before, "schedule increased the barrier count");
+
+		//a reader runs in a later level than the writer before it. a writer runs after the readers before it, in the same level
+		//only if it keeps the declaration order which the dependency level order does and the schedule does not promise
+		{
+			RenderGraph render_graph(resource_pool);
+			AddSyntheticFrame(render_graph);
+			render_graph.Build();
+			RGStats const& stats = render_graph.GetStats();
+			Bool const applied = stats.schedule.applied;
+			auto Accesses = [](RGVector<Uint64> const& ids, Uint64 id) { return std::find(ids.begin(), ids.end(), id) != ids.end(); };
+			Uint32 read_after_write_edges = 0, write_after_read_edges = 0, violated_edges = 0;
+			for (Uint64 i = 0; i < stats.passes.size(); ++i)
+			{
+				RGPassStats const& pass = stats.passes[i];
+				if (pass.culled) continue;
+				for (Uint64 j = i + 1; j < stats.passes.size(); ++j)
+				{
+					RGPassStats const& later_pass = stats.passes[j];
+					if (later_pass.culled) continue;
+					Bool read_after_write = false, write_after_read = false;
+					for (Uint64 id : pass.textures_written) read_after_write |= Accesses(later_pass.textures_read, id) || Accesses(later_pass.textures_written, id);
+					for (Uint64 id : pass.textures_read) write_after_read |= Accesses(later_pass.textures_written, id);
+					read_after_write_edges += read_after_write;
+					write_after_read_edges += write_after_read;
+					if (read_after_write && pass.dependency_level >= later_pass.dependency_level) ++violated_edges;
+					if (write_after_read && (pass.dependency_level > later_pass.dependency_level || (applied && pass.dependency_level == later_pass.dependency_level))) ++violated_edges;
+				}
+			}
+			state.Check(read_after_write_edges > 0 && write_after_read_edges > 0, "synthetic frame has no read after write or write after read dependencies");
+			state.Check(violated_edges == 0, "pass order breaks read after write or write after read dependencies");
+		}
+		schedule_cvar->Set(schedule_mode);
+	}
+
+	ADRIA_BENCHMARK(RenderGraphResourcePool_Churn, 16, 64)
+	{
+		Uint32 const texture_count = (Uint32)state.GetArg();
+		std::vector<GfxTextureDesc> texture_descs(texture_count);
+		for (Uint32 i = 0; i < texture_count; ++i)
+		{
+			GfxTextureDesc& desc = texture_descs[i];
+			desc.width = 16 + 16 * (i % 8);
+			desc.height = 16 + 16 * ((i / 8) % 8);
+			desc.format = i % 2 ? GfxFormat::R16G16B16A16_FLOAT : GfxFormat::R8G8B8A8_UNORM;
+			desc.bind_flags = GfxBindFlag::ShaderResource | GfxBindFlag::UnorderedAccess;
+		}
+
+		RGResourcePool resource_pool(state.GetDevice());
+		std::vector<GfxTexture*> textures(texture_count);
+		state.SetIterations(100);
+		state.SetItemsPerIteration(texture_count);
+		state.Run([&]()
+			{
+				resource_pool.Tick();
+				for (Uint32 i = 0; i < texture_count; ++i) textures[i] = resource_pool.AllocateTexture(texture_descs[i]);
+				for (Uint32 i = 0; i < texture_count; ++i) resource_pool.ReleaseTexture(textures[i]);
+			});
+	}
+
+	ADRIA_BENCHMARK(Renderer_InstancePacking, 1000, 10000)
+	{
+		Uint32 const instance_count = (Uint32)state.GetArg();
+		static constexpr Uint32 SubmeshCount = 64;
+
+		std::mt19937 rng{ 42 };
+		Mesh mesh{};
+		mesh.submeshes.resize(SubmeshCount);
+		for (Uint32 i = 0; i < SubmeshCount; ++i)
+		{
+			mesh.submeshes[i].material_index = i % 8;
+			mesh.submeshes[i].bounding_box = RandomBoundingBox(rng, 10.0f);
+		}
+		mesh.instances.resize(instance_count);
+		for (Uint32 i = 0; i < instance_count; ++i)
+		{
+			mesh.instances[i].submesh_index = i % SubmeshCount;
+			mesh.instances[i].world_transform = RandomWorldTransform(rng, 500.0f);
+		}
+
+		entt::registry reg;
+		std::vector<InstanceGPU> instances;
+		state.SetIterations(10);
+		state.SetItemsPerIteration(instance_count);
+		state.Run([&]()
+			{
+				reg.clear<Batch>();
+				instances.clear();
+				Uint32 instance_id = 0;
+				for (SubMeshInstance const& instance : mesh.instances)
+				{
+					SubMeshGPU& submesh = mesh.submeshes[instance.submesh_index];
+
+					entt::entity batch_entity = reg.create();
+					Batch& batch = reg.emplace<Batch>(batch_entity);
+					batch.instance_id = instance_id;
+					batch.submesh = &submesh;
+					batch.world_transform = instance.world_transform;
+					submesh.bounding_box.Transform(batch.bounding_box, batch.world_transform);
+
+					InstanceGPU& instance_hlsl = instances.emplace_back();
+					instance_hlsl.instance_id = instance_id;
+					instance_hlsl.material_idx = submesh.material_index;
+					instance_hlsl.mesh_index = instance.submesh_index;
+					instance_hlsl.world_matrix = instance.world_transform;
+					instance_hlsl.inverse_world_matrix = XMMatrixInverse(nullptr, instance.world_transform);
+					instance_hlsl.bb_origin = submesh.bounding_box.Center;
+					instance_hlsl.bb_extents = submesh.bounding_box.Extents;
+					++instance_id;
+				}
+				DoNotOptimize(instances.data());
+			});
+	}
+
+	ADRIA_BENCHMARK(AccelerationStructure_ScheduleUpdate, 10000, 100000)
+	{
+		Uint32 const instance_count = (Uint32)state.GetArg();
+		static constexpr Uint32 BLASCount = 256;
+		static constexpr Uint32 DynamicInstanceRatio = 10;
+
+		std::mt19937 rng{ 42 };
+		AccelerationStructureTracker tracker;
+		for (Uint32 i = 0; i < BLASCount; ++i) tracker.AddBLAS(i % 16 == 0);
+		std::vector<Matrix> transforms(instance_count);
+		for (Uint32 i = 0; i < instance_count; ++i)
+		{
+			transforms[i] = RandomWorldTransform(rng, 500.0f);
+			tracker.AddInstance(i % BLASCount, transforms[i], i % DynamicInstanceRatio == 0);
+		}
+		tracker.MarkBuilt();
+
+		//every frame all transforms are submitted and a tenth of them moved
+		Uint64 frame = 0;
+		state.SetIterations(10);
+		state.SetItemsPerIteration(instance_count);
+		state.Run([&]()
+			{
+				++frame;
+				for (Uint32 i = 0; i < instance_count; i += DynamicInstanceRatio)
+				{
+					transforms[i] = transforms[i] * Matrix::CreateTranslation(0.0f, 0.01f * frame, 0.0f);
+				}
+				for (Uint32 i = 0; i < instance_count; ++i) tracker.SetInstanceTransform(i, transforms[i]);
+				for (Uint32 i = 0; i < BLASCount; i += 16) tracker.MarkBLASDeformed(i);
+				DoNotOptimize(tracker.ScheduleUpdate());
+			});
+	}
+
+	ADRIA_BENCHMARK(Renderer_FrustumCulling, 1000, 10000, 100000)
+	{
+		Uint32 const instance_count = (Uint32)state.GetArg();
+
+		std::mt19937 rng{ 42 };
+		entt::registry reg;
+		for (Uint32 i = 0; i < instance_count; ++i)
+		{
+			Batch& batch = reg.emplace<Batch>(reg.create());
+			batch.bounding_box = RandomBoundingBox(rng, 500.0f);
+		}
+
+		Matrix const view = XMMatrixLookAtLH(Vector3(0.0f, 50.0f, -100.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+		BoundingFrustum camera_frustum(XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f));
+		camera_frustum.Transform(camera_frustum, view.Invert());
+
+		Uint32 visible_count = 0;
+		state.SetIterations(10);
+		state.SetItemsPerIteration(instance_count);
+		state.Run([&]()
+			{
+				visible_count = 0;
+				auto batch_view = reg.view<Batch>();
+				for (auto e : batch_view)
+				{
+					Batch& batch = batch_view.get<Batch>(e);
+					batch.camera_visibility = camera_frustum.Intersects(batch.bounding_box);
+					visible_count += batch.camera_visibility;
+				}
+			});
+		state.SetCounter("visible", (Float64)visible_count);
+	}
+
+	ADRIA_BENCHMARK(Renderer_OcclusionCulling, 1000, 10000, 100000)
+	{
+		Uint32 const instance_count = (Uint32)state.GetArg();
+
+		//rows of walls in front of the camera hide most of the random boxes behind them
+		Vector3 const cube_positions[] =
+		{
+			Vector3(-1, -1, -1), Vector3(1, -1, -1), Vector3(1, 1, -1), Vector3(-1, 1, -1),
+			Vector3(-1, -1,  1), Vector3(1, -1,  1), Vector3(1, 1,  1), Vector3(-1, 1,  1)
+		};
+		Uint32 const cube_indices[] =
+		{
+			0, 2, 1, 0, 3, 2,  4, 5, 6, 4, 6, 7,  0, 1, 5, 0, 5, 4,
+			3, 6, 2, 3, 7, 6,  0, 4, 7, 0, 7, 3,  1, 2, 6, 1, 6, 5
+		};
+		std::vector<Matrix> wall_transforms;
+		for (Sint32 row = 0; row < 4; ++row)
+		{
+			for (Sint32 column = -4; column <= 4; ++column)
+			{
+				wall_transforms.push_back(Matrix::CreateScale(12.0f, 20.0f, 0.5f) * Matrix::CreateTranslation(column * 30.0f + row * 10.0f, 20.0f, row * 60.0f - 50.0f));
+			}
+		}
+
+		std::mt19937 rng{ 42 };
+		std::vector<BoundingBox> boxes(instance_count);
+		for (BoundingBox& box : boxes) box = RandomBoundingBox(rng, 500.0f);
+
+		Matrix const view = XMMatrixLookAtLH(Vector3(0.0f, 20.0f, -100.0f), Vector3(0.0f, 20.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+		Matrix const view_projection = view * XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+		SoftwareOcclusionCuller culler;
+		Uint32 visible_count = 0;
+		state.SetIterations(10);
+		state.SetItemsPerIteration(instance_count);
+		state.Run([&]()
+			{
+				culler.BeginFrame(view_projection, 0.1f);
+				for (Matrix const& wall_transform : wall_transforms) culler.AddOccluder(cube_positions, cube_indices, (Uint32)std::size(cube_indices), wall_transform);
+				culler.RasterizeOccluders();
+
+				visible_count = 0;
+				for (BoundingBox const& box : boxes) visible_count += culler.IsVisible(box);
+			});
+		state.SetCounter("visible", (Float64)visible_count);
+		state.SetCounter("occluded", (Float64)culler.GetStats().occluded_boxes);
+
+		//one wall 20 units in front of the camera that covers the middle of the screen and the whole height of it.
+		//boxes well inside its silhouette behind it have to be culled, everything else must never be
+		Matrix const test_view = XMMatrixLookAtLH(Vector3(0.0f, 0.0f, -10.0f), Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+		culler.BeginFrame(test_view * XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f), 0.1f);
+		culler.AddOccluder(cube_positions, cube_indices, (Uint32)std::size(cube_indices), Matrix::CreateScale(10.0f, 10.0f, 0.5f) * Matrix::CreateTranslation(0.0f, 0.0f, 10.0f));
+		culler.RasterizeOccluders();
+
+		BoundingBox const hidden_boxes[] =
+		{
+			BoundingBox(Vector3(0.0f, 0.0f, 30.0f), Vector3(2.0f, 2.0f, 2.0f)),
+			BoundingBox(Vector3(-6.0f, 4.0f, 40.0f), Vector3(1.5f, 1.5f, 1.5f)),
+			BoundingBox(Vector3(3.0f, -3.0f, 15.0f), Vector3(1.0f, 1.0f, 1.0f))
+		};
+		BoundingBox const visible_boxes[] =
+		{
+			BoundingBox(Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f)),		//in front of the wall
+			BoundingBox(Vector3(25.0f, 0.0f, 30.0f), Vector3(1.0f, 1.0f, 1.0f)),	//next to the wall
+			BoundingBox(Vector3(21.0f, 0.0f, 30.0f), Vector3(3.0f, 3.0f, 3.0f)),	//partially behind the edge of the wall
+			BoundingBox(Vector3(0.0f, 0.0f, -10.0f), Vector3(1.0f, 1.0f, 1.0f)),	//around the camera
+			BoundingBox(Vector3(0.0f, 0.0f, -30.0f), Vector3(1.0f, 1.0f, 1.0f))		//behind the camera
+		};
+		Uint32 false_culls = 0;
+		Uint32 missed_culls = 0;
+		for (BoundingBox const& box : visible_boxes) false_culls += !culler.IsVisible(box);
+		for (BoundingBox const& box : hidden_boxes) missed_culls += culler.IsVisible(box);
+		state.Check(false_culls == 0, "a visible box was culled");
+		state.Check(missed_culls == 0, "a box hidden behind the wall was not culled");
+	}
+
+	//arg view space point and spot lights binned into the 16x16x16 clusters of the clustered deferred path with spot cone culling.
+	//one light moves every iteration so the lists are always rebinned
+	ADRIA_BENCHMARK(ClusterLightBinner_Bin, 256, 1024, 4096)
+	{
+		Uint32 const light_count = (Uint32)state.GetArg();
+
+		std::mt19937 rng{ 42 };
+		std::uniform_real_distribution<Float> unit(-1.0f, 1.0f);
+		std::vector<LightGPU> lights(light_count);
+		for (Uint32 i = 0; i < light_count; ++i)
+		{
+			LightGPU& light = lights[i];
+			light.active = true;
+			light.type = static_cast<Sint32>(i % 2 ? LightType::Point : LightType::Spot);
+			light.position.x = unit(rng) * 300.0f;
+			light.position.y = unit(rng) * 100.0f;
+			light.position.z = (unit(rng) + 1.0f) * 500.0f;
+			light.position.w = 1.0f;
+			light.direction.x = unit(rng);
+			light.direction.y = unit(rng);
+			light.direction.z = unit(rng);
+			light.direction.w = 0.0f;
+			light.range = 20.0f + (unit(rng) + 1.0f) * 20.0f;
+			light.outer_cosine = 0.8f;
+		}
+
+		//reversed depth like the camera, the frame constants store the far plane as near and the other way around
+		Matrix const projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 16.0f / 9.0f, 3000.0f, 1.0f);
+		Uint32 const max_cluster_lights = 128;
+		ClusterLightBinner binner(16, 16, 16, max_cluster_lights);
+		binner.BuildClusters(projection, 3000.0f, 1.0f);
+
+		binner.BinLights(lights, false);
+		Uint32 const sphere_index_count = binner.GetStats().light_index_count;
+
+		Uint32 frame = 0;
+		state.SetIterations(20);
+		state.SetItemsPerIteration(light_count);
+		state.Run([&]()
+			{
+				lights[frame++ % light_count].position.y += 0.1f;
+				binner.BinLights(lights, true);
+			});
+		ClusterLightBinnerStats const& stats = binner.GetStats();
+		state.SetCounter("sphere_light_indices", (Float64)sphere_index_count);
+		state.SetCounter("cone_light_indices", (Float64)stats.light_index_count);
+		state.SetCounter("max_cluster_lights", (Float64)stats.max_cluster_light_count);
+		state.SetCounter("overflowed_clusters", (Float64)stats.overflowed_clusters);
+
+		auto GetClusterLights = [](ClusterLightBinner const& cluster_binner, Uint32 cluster_index)
+			{
+				ClusterLightGrid const& grid = cluster_binner.GetLightGrid()[cluster_index];
+				return std::vector<Uint32>(cluster_binner.GetLightList().begin() + grid.offset, cluster_binner.GetLightList().begin() + grid.offset + grid.light_count);
+			};
+		std::vector<std::vector<Uint32>> cone_cluster_lights(binner.GetClusterCount());
+		for (Uint32 cluster_index = 0; cluster_index < binner.GetClusterCount(); ++cluster_index) cone_cluster_lights[cluster_index] = GetClusterLights(binner, cluster_index);
+
+		//slices binned on the thread pool give the same grid and list as binning them one after another
+		auto SameBinning = [](ClusterLightBinner const& a, ClusterLightBinner const& b)
+			{
+				return std::ranges::equal(a.GetLightList(), b.GetLightList()) && std::ranges::equal(a.GetLightGrid(), b.GetLightGrid(),
+					[](ClusterLightGrid const& x, ClusterLightGrid const& y) { return x.offset == y.offset && x.light_count == y.light_count; });
+			};
+		ClusterLightBinner serial_binner(16, 16, 16, max_cluster_lights);
+		serial_binner.BuildClusters(projection, 3000.0f, 1.0f);
+		serial_binner.BinLights(lights, true, false);
+		Bool const cone_serial_equal = SameBinning(binner, serial_binner);
+		binner.BinLights(lights, false);
+		serial_binner.BinLights(lights, false, false);
+		Bool const sphere_serial_equal = SameBinning(binner, serial_binner);
+		state.Check(cone_serial_equal && sphere_serial_equal, "multithreaded binning differs from serial binning");
+
+		//scalar sphere against box test of every light with the same operations as the sse path, lists keep the lowest light indices
+		Uint32 sphere_mismatches = 0, unordered_clusters = 0, cone_not_subset = 0, overflowed_clusters = 0;
+		for (Uint32 cluster_index = 0; cluster_index < binner.GetClusterCount(); ++cluster_index)
+		{
+			ClusterAABB const& cluster = binner.GetClusters()[cluster_index];
+			std::vector<Uint32> expected_lights;
+			for (Uint32 i = 0; i < light_count; ++i)
+			{
+				LightGPU const& light = lights[i];
+				Float const dx = std::max(cluster.min_point.x, std::min(light.position.x, cluster.max_point.x)) - light.position.x;
+				Float const dy = std::max(cluster.min_point.y, std::min(light.position.y, cluster.max_point.y)) - light.position.y;
+				Float const dz = std::max(cluster.min_point.z, std::min(light.position.z, cluster.max_point.z)) - light.position.z;
+				if (dx * dx + dy * dy + dz * dz <= light.range * light.range) expected_lights.push_back(i);
+			}
+			std::vector<Uint32> const& cone_lights = cone_cluster_lights[cluster_index];
+			cone_not_subset += !std::ranges::includes(expected_lights, cone_lights);
+			overflowed_clusters += expected_lights.size() > max_cluster_lights;
+			if (expected_lights.size() > max_cluster_lights) expected_lights.resize(max_cluster_lights);
+
+			std::vector<Uint32> const sphere_lights = GetClusterLights(binner, cluster_index);
+			sphere_mismatches += sphere_lights != expected_lights;
+			unordered_clusters += std::ranges::adjacent_find(sphere_lights, std::greater_equal<>{}) != sphere_lights.end() ||
+								  std::ranges::adjacent_find(cone_lights, std::greater_equal<>{}) != cone_lights.end() || cone_lights.size() > max_cluster_lights;
+		}
+		state.Check(sphere_mismatches == 0, "sse binning differs from the scalar sphere test");
+		state.Check(unordered_clusters == 0, "cluster light lists are not ascending or not truncated");
+		state.Check(cone_not_subset == 0, "cone culled lists contain lights outside of the sphere lists");
+		state.Check(overflowed_clusters == stats.overflowed_clusters, "overflowed clusters are miscounted");
+	}
+
+	ADRIA_BENCHMARK(Meshlet_CullReference, 0, 1)
+	{
+		Bool const cone_culling = state.GetArg() != 0;
+
+		//sphere instances around the camera, half of every visible sphere faces away from it
+		std::vector<Vector3> positions;
+		std::vector<Uint32> indices;
+		CreateBumpySphere(64, 128, positions, indices);
+		MeshletHierarchy hierarchy;
+		BuildMeshletHierarchy(hierarchy, positions.data(), positions.size(), indices.data(), indices.size(), MeshletHierarchyParams{});
+		std::vector<Meshlet> const& meshlets = hierarchy.meshlets;
+
+		std::mt19937 rng{ 42 };
+		std::vector<Matrix> transforms(256);
+		for (Matrix& transform : transforms) transform = RandomWorldTransform(rng, 100.0f);
+		//every other instance is mirrored and slightly squashed, the cone axis has to follow the normals through both.
+		//strong non uniform scale spreads the normals beyond the cone cutoff, so the squash is kept small
+		for (Uint64 i = 1; i < transforms.size(); i += 2) transforms[i] = Matrix::CreateScale(-1.0f, 0.8f, 1.0f) * transforms[i];
+
+		MeshletCullView view{};
+		view.camera_position = Vector3(0.0f, 0.0f, -150.0f);
+		view.view_projection = XMMatrixLookAtLH(view.camera_position, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f)) * XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+		view.cone_culling = cone_culling;
+		view.lod_error_scale = MeshletLODErrorScale(1.0f / std::tan(XM_PIDIV4 * 0.5f), 1080.0f, 1.0f);
+
+		auto CullInstances = [&](MeshletCullView const& cull_view)
+			{
+				MeshletCullStats total{};
+				for (Matrix const& transform : transforms)
+				{
+					MeshletCullStats const instance_stats = CullMeshlets(meshlets, transform, cull_view);
+					total.tested += instance_stats.tested;
+					total.lod_culled += instance_stats.lod_culled;
+					total.frustum_culled += instance_stats.frustum_culled;
+					total.backface_culled += instance_stats.backface_culled;
+					total.occlusion_culled += instance_stats.occlusion_culled;
+					total.visible += instance_stats.visible;
+				}
+				return total;
+			};
+
+		MeshletCullStats stats{};
+		state.SetIterations(10);
+		state.SetItemsPerIteration(meshlets.size() * transforms.size());
+		state.Run([&]() { stats = CullInstances(view); });
+		state.SetCounter("lod_culled", (Float64)stats.lod_culled);
+		state.SetCounter("frustum_culled", (Float64)stats.frustum_culled);
+		state.SetCounter("backface_culled", (Float64)stats.backface_culled);
+		state.SetCounter("visible", (Float64)stats.visible);
+
+		//cone culling only moves meshlets from visible to backface culled
+		MeshletCullView cone_view = view;
+		cone_view.cone_culling = true;
+		MeshletCullView no_cone_view = view;
+		no_cone_view.cone_culling = false;
+		MeshletCullStats const cone_stats = CullInstances(cone_view);
+		MeshletCullStats const no_cone_stats = CullInstances(no_cone_view);
+		state.Check(stats.lod_culled + stats.frustum_culled + stats.backface_culled + stats.visible == stats.tested, "meshlets are missing from the cull results");
+		state.Check(cone_stats.lod_culled == no_cone_stats.lod_culled && cone_stats.frustum_culled == no_cone_stats.frustum_culled,
+					"cone culling changed the lod or frustum results");
+		state.Check(no_cone_stats.backface_culled == 0 && no_cone_stats.visible - cone_stats.visible == cone_stats.backface_culled,
+					"cone culling removed meshlets that are not counted as backface culled");
+		state.Check(cone_stats.backface_culled > 0, "no meshlet was cone culled");
+
+		//all triangles of a cone culled meshlet face away from the camera
+		Uint32 front_facing_culled = 0;
+		for (Matrix const& transform : transforms)
+		{
+			for (Meshlet const& meshlet : meshlets)
+			{
+				if (CullMeshlet(meshlet, transform, cone_view) != MeshletCullResult::BackfaceCulled) continue;
+				Bool front_facing = false;
+				for (Uint32 t = 0; t < meshlet.triangle_count && !front_facing; ++t)
+				{
+					MeshletTriangle const& triangle = hierarchy.meshlet_triangles[meshlet.triangle_offset + t];
+					Vector3 const p0 = Vector3::Transform(positions[hierarchy.meshlet_vertices[meshlet.vertex_offset + triangle.V0]], transform);
+					Vector3 const p1 = Vector3::Transform(positions[hierarchy.meshlet_vertices[meshlet.vertex_offset + triangle.V1]], transform);
+					Vector3 const p2 = Vector3::Transform(positions[hierarchy.meshlet_vertices[meshlet.vertex_offset + triangle.V2]], transform);
+					Vector3 const normal = (p1 - p0).Cross(p2 - p0);
+					Vector3 const view_direction = p0 - view.camera_position;
+					front_facing = normal.Dot(view_direction) < -1e-4f * normal.Length() * view_direction.Length();
+				}
+				front_facing_culled += front_facing;
+			}
+		}
+		state.Check(front_facing_culled == 0, "cone culled meshlets have triangles facing the camera");
+
+		//hzb of an occluder at a view depth of 50 that covers the left half of the screen, the right half is empty.
+		//mips are the max of the texels below, so every texel of the left half of a mip is the occluder depth
+		Matrix const hzb_projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 2.0f, 1.0f, 1000.0f);
+		Float const occluder_depth = (50.0f * hzb_projection._33 + hzb_projection._43) / 50.0f;
+		MeshletHZB hzb{};
+		hzb.width = 64;
+		hzb.height = 32;
+		for (Uint32 mip_width = hzb.width, mip_height = hzb.height; ; mip_width = std::max(mip_width / 2, 1u), mip_height = std::max(mip_height / 2, 1u))
+		{
+			std::vector<Float>& mip = hzb.mips.emplace_back(mip_width * mip_height, 1.0f);
+			for (Uint32 y = 0; y < mip_height; ++y)
+			{
+				for (Uint32 x = 0; x < mip_width / 2; ++x) mip[y * mip_width + x] = occluder_depth;
+			}
+			if (mip_width == 1 && mip_height == 1) break;
+		}
+
+		MeshletCullView hzb_view{};
+		hzb_view.camera_position = Vector3(0.0f, 0.0f, 0.0f);
+		hzb_view.view_projection = XMMatrixLookAtLH(hzb_view.camera_position, Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 1.0f, 0.0f)) * hzb_projection;
+		hzb_view.hzb = &hzb;
+		hzb_view.cone_culling = false;
+
+		Sint8 const no_cone_axis[3] = { 0, 0, 0 };
+		Meshlet unit_meshlet{};
+		unit_meshlet.radius = 1.0f;
+		unit_meshlet.cone_axis_cutoff = PackMeshletCone(no_cone_axis, 127);
+		unit_meshlet.lod_bounds = MeshletLODBounds{ .radius = 1.0f, .error = 0.0f };
+		unit_meshlet.parent_lod_bounds = MeshletLODBounds{ .radius = 1.0f, .error = FLT_MAX };
+		state.Check(CullMeshlet(unit_meshlet, Matrix::CreateTranslation(-30.0f, 0.0f, 100.0f), hzb_view) == MeshletCullResult::OcclusionCulled,
+					"meshlet behind the hzb occluder was not culled");
+		state.Check(CullMeshlet(unit_meshlet, Matrix::CreateTranslation(-6.0f, 0.0f, 20.0f), hzb_view) == MeshletCullResult::Visible,
+					"meshlet in front of the hzb occluder was culled");
+		state.Check(CullMeshlet(unit_meshlet, Matrix::CreateTranslation(30.0f, 0.0f, 100.0f), hzb_view) == MeshletCullResult::Visible,
+					"meshlet next to the hzb occluder was culled");
+	}
+
+	//cluster lod hierarchy of a 262k triangle mesh, the triangles of every level and the invariants of the hierarchy are logged
+	ADRIA_BENCHMARK(Meshlet_BuildHierarchy)
+	{
+		std::vector<Vector3> positions;
+		std::vector<Uint32> indices;
+		CreateBumpySphere(256, 512, positions, indices);
+
+		MeshletHierarchy hierarchy;
+		state.SetIterations(1, 3);
+		state.SetItemsPerIteration(indices.size() / 3);
+		state.Run([&]()
+			{
+				BuildMeshletHierarchy(hierarchy, positions.data(), positions.size(), indices.data(), indices.size(), MeshletHierarchyParams{});
+			});
+
+		for (Uint64 i = 0; i < hierarchy.levels.size(); ++i)
+		{
+			MeshletHierarchyLevel const& level = hierarchy.levels[i];
+			ADRIA_LOG(INFO, "[Benchmark] Meshlet hierarchy level %llu: %u meshlets, %llu triangles, max error %g", i, level.meshlet_count, level.triangle_count, level.max_error);
+		}
+		MeshletHierarchyValidation const validation = ValidateMeshletHierarchy(hierarchy);
+		if (!validation.IsValid())
+		{
+			ADRIA_LOG(WARNING, "[Benchmark] Meshlet hierarchy invariants violated: %u error, %u bounds, %u link violations",
+				validation.error_violations, validation.bounds_violations, validation.link_violations);
+		}
+		state.Check(validation.IsValid(), "meshlet hierarchy invariants violated");
+
+		//the cut seen from far away, a sphere a few pixels tall is drawn with the root meshlets
+		Float const error_scale = MeshletLODErrorScale(1.0f / std::tan(XM_PIDIV4 * 0.5f), 1080.0f, 1.0f);
+		Uint64 near_cut_triangles = 0, far_cut_triangles = 0;
+		for (Meshlet const& meshlet : hierarchy.meshlets)
+		{
+			if (IsMeshletInLODCut(meshlet, Matrix::Identity, Vector3(0.0f, 0.0f, -3.0f), error_scale)) near_cut_triangles += meshlet.triangle_count;
+			if (IsMeshletInLODCut(meshlet, Matrix::Identity, Vector3(0.0f, 0.0f, -1000.0f), error_scale)) far_cut_triangles += meshlet.triangle_count;
+		}
+		state.SetCounter("levels", (Float64)hierarchy.levels.size());
+		state.SetCounter("meshlets", (Float64)hierarchy.meshlets.size());
+		state.SetCounter("near_cut_triangles", (Float64)near_cut_triangles);
+		state.SetCounter("far_cut_triangles", (Float64)far_cut_triangles);
+		state.SetCounter("valid", validation.IsValid() ? 1.0 : 0.0);
+	}
+
+	//round trip of the quantized vertex layout, the errors are checked against the bounds of the encodings
+	ADRIA_BENCHMARK(VertexQuantization_RoundTrip)
+	{
+		constexpr Uint32 VertexCount = 1 << 20;
+		std::mt19937 rng{ 42 };
+		std::uniform_real_distribution<Float> dist(-1.0f, 1.0f);
+
+		Vector3 const position_bias(-37.0f, 2.0f, -0.5f);
+		Vector3 const position_scale(80.0f, 0.25f, 1000.0f);
+		std::vector<Vector3> positions(VertexCount);
+		std::vector<Vector3> normals(VertexCount);
+		std::vector<Vector4> tangents(VertexCount);
+		std::vector<Vector2> uvs(VertexCount);
+		for (Uint32 i = 0; i < VertexCount; ++i)
+		{
+			positions[i] = position_bias + Vector3(dist(rng) * 0.5f + 0.5f, dist(rng) * 0.5f + 0.5f, dist(rng) * 0.5f + 0.5f) * position_scale;
+			normals[i] = Vector3(dist(rng), dist(rng), dist(rng));
+			normals[i].Normalize();
+			tangents[i] = Vector4(normals[i].y, normals[i].z, normals[i].x, dist(rng) < 0.0f ? -1.0f : 1.0f);
+			uvs[i] = Vector2(dist(rng) * 4.0f, dist(rng) * 4.0f);
+		}
+
+		auto AngleInDegrees = [](Vector3 const& a, Vector3 const& b)
+			{
+				Float64 const cross_x = (Float64)a.y * b.z - (Float64)a.z * b.y;
+				Float64 const cross_y = (Float64)a.z * b.x - (Float64)a.x * b.z;
+				Float64 const cross_z = (Float64)a.x * b.y - (Float64)a.y * b.x;
+				Float64 const dot = (Float64)a.x * b.x + (Float64)a.y * b.y + (Float64)a.z * b.z;
+				return std::atan2(std::sqrt(cross_x * cross_x + cross_y * cross_y + cross_z * cross_z), dot) * 180.0 / XM_PI;
+			};
+
+		Float64 max_position_error = 0.0, max_normal_error = 0.0, max_tangent_error = 0.0, max_uv_error = 0.0;
+		Uint32 tangent_sign_errors = 0;
+		state.SetIterations(5);
+		state.SetItemsPerIteration(VertexCount);
+		state.Run([&]()
+			{
+				for (Uint32 i = 0; i < VertexCount; ++i)
+				{
+					Vector3 const position = DequantizePosition(QuantizePosition(positions[i], position_bias, position_scale), position_bias, position_scale);
+					max_position_error = std::max<Float64>(max_position_error, std::abs(position.x - positions[i].x) / position_scale.x);
+					max_position_error = std::max<Float64>(max_position_error, std::abs(position.y - positions[i].y) / position_scale.y);
+					max_position_error = std::max<Float64>(max_position_error, std::abs(position.z - positions[i].z) / position_scale.z);
+
+					Vector3 const normal = DecodeNormal16x2(EncodeNormal16x2(normals[i]));
+					max_normal_error = std::max(max_normal_error, AngleInDegrees(normal, normals[i]));
+
+					Vector4 const tangent = DecodeTangent15x2(EncodeTangent15x2(tangents[i]));
+					max_tangent_error = std::max(max_tangent_error, AngleInDegrees(Vector3(tangent.x, tangent.y, tangent.z), Vector3(tangents[i].x, tangents[i].y, tangents[i].z)));
+					tangent_sign_errors += tangent.w != tangents[i].w;
+
+					Vector2 const uv = UnpackTwoFloatsFromUint32(PackTwoFloatsToUint32(uvs[i].x, uvs[i].y));
+					max_uv_error = std::max<Float64>(max_uv_error, std::max(std::abs(uv.x - uvs[i].x), std::abs(uv.y - uvs[i].y)));
+				}
+			});
+
+		//half a quantization step for positions (plus float rounding), a hundredth of a degree for 16 bit and twice that for 15 bit
+		//octahedral vectors, half an ulp of a half at 4 for uvs
+		Bool within_bounds = true;
+		within_bounds &= state.Check(max_position_error <= 0.51 / 65535.0, "position quantization error out of bounds");
+		within_bounds &= state.Check(max_normal_error <= 0.01, "normal encoding error out of bounds");
+		within_bounds &= state.Check(max_tangent_error <= 0.02 && tangent_sign_errors == 0, "tangent encoding error out of bounds");
+		within_bounds &= state.Check(max_uv_error <= 1.0 / 1024.0, "uv packing error out of bounds");
+		if (!within_bounds)
+		{
+			ADRIA_LOG(WARNING, "[Benchmark] Vertex quantization errors: position %g, normal %g deg, tangent %g deg, uv %g",
+				max_position_error, max_normal_error, max_tangent_error, max_uv_error);
+		}
+		state.SetCounter("position_error_steps", max_position_error * 65535.0);
+		state.SetCounter("normal_error_deg", max_normal_error);
+		state.SetCounter("tangent_error_deg", max_tangent_error);
+		state.SetCounter("uv_error", max_uv_error);
+		state.SetCounter("within_bounds", within_bounds ? 1.0 : 0.0);
+	}
+
+	ADRIA_BENCHMARK(GLTF_ParseSponza)
+	{
+		std::string const model_path = paths::ResourcesDir + "Models/Sponza/Sponza.gltf";
+		state.SetIterations(1, 5);
+		state.Run([&]()
+			{
+				cgltf_options options{};
+				cgltf_data* gltf_data = nullptr;
+				if (cgltf_parse_file(&options, model_path.c_str(), &gltf_data) == cgltf_result_success)
+				{
+					cgltf_load_buffers(&options, gltf_data, model_path.c_str());
+					DoNotOptimize(gltf_data->meshes_count);
+				}
+				cgltf_free(gltf_data);
+			});
+	}
+
+	ADRIA_BENCHMARK(GLTF_OptimizeSponza)
+	{
+		std::string const model_path = paths::ResourcesDir + "Models/Sponza/Sponza.gltf";
+		cgltf_options options{};
+		cgltf_data* gltf_data = nullptr;
+		cgltf_result result = cgltf_parse_file(&options, model_path.c_str(), &gltf_data);
+		if (result == cgltf_result_success) result = cgltf_load_buffers(&options, gltf_data, model_path.c_str());
+		if (result != cgltf_result_success)
+		{
+			ADRIA_LOG(WARNING, "[Benchmark] GLTF - Failed to load '%s'", model_path.c_str());
+			cgltf_free(gltf_data);
+			return;
+		}
+		std::vector<GLTFPrimitiveData> const primitives = ReadGLTFPrimitives(gltf_data);
+		cgltf_free(gltf_data);
+
+		Uint64 triangle_count = 0;
+		for (GLTFPrimitiveData const& primitive : primitives) triangle_count += primitive.indices.size() / 3;
+
+		Uint64 total_meshlet_count = 0;
+		state.SetIterations(1, 5);
+		state.SetItemsPerIteration(triangle_count);
+		state.Run([&]()
+			{
+				total_meshlet_count = 0;
+				for (GLTFPrimitiveData const& primitive : primitives)
+				{
+					if (primitive.positions.empty()) continue;
+
+					Uint64 const vertex_count = primitive.positions.size();
+					std::vector<Uint32> indices = primitive.indices;
+					std::vector<Vector3> positions = primitive.positions;
+
+					meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertex_count);
+					meshopt_optimizeOverdraw(indices.data(), indices.data(), indices.size(), &positions[0].x, vertex_count, sizeof(Vector3), 1.05f);
+					std::vector<Uint32> remap(vertex_count);
+					meshopt_optimizeVertexFetchRemap(&remap[0], indices.data(), indices.size(), vertex_count);
+					meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), &remap[0]);
+					meshopt_remapVertexBuffer(positions.data(), positions.data(), vertex_count, sizeof(Vector3), &remap[0]);
+
+					Uint64 const max_meshlets = meshopt_buildMeshletsBound(indices.size(), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+					std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+					std::vector<Uint32> meshlet_vertices(max_meshlets * MESHLET_MAX_VERTICES);
+					std::vector<unsigned char> meshlet_triangles(max_meshlets * MESHLET_MAX_TRIANGLES * 3);
+					total_meshlet_count += meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(),
+						indices.data(), indices.size(), &positions[0].x, vertex_count, sizeof(Vector3), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, 0.25f);
+				}
+			});
+		state.SetCounter("triangles", (Float64)triangle_count);
+		state.SetCounter("meshlets", (Float64)total_meshlet_count);
+	}
+
+	//headless scene driven through the frame pipeline, arg 0 runs it serially and arg 1 pipelined.
+	//the simulation moves the camera and prepares the snapshot, the render stage hashes it and edits the registry like the editor would.
+	//a last run switches the mode every few frames, so the simulation is handed over between the threads in both directions
+	ADRIA_BENCHMARK(FramePipeline_Determinism, 0, 1)
+	{
+		static constexpr Uint32 FrameCount = 120;
+		static constexpr Uint32 InstanceCount = 4096;
+		static constexpr Uint32 LightCount = 16;
+		static constexpr Uint32 StageWork = 20000;
+		Bool const pipelined = state.GetArg() != 0;
+
+		std::mt19937 rng{ 42 };
+		entt::registry reg;
+		Mesh& mesh = reg.emplace<Mesh>(reg.create());
+		mesh.submeshes.resize(64);
+		for (SubMeshGPU& submesh : mesh.submeshes) submesh.bounding_box = RandomBoundingBox(rng, 10.0f);
+		mesh.instances.resize(InstanceCount);
+		for (Uint32 i = 0; i < InstanceCount; ++i)
+		{
+			mesh.instances[i].submesh_index = i % 64;
+			mesh.instances[i].world_transform = RandomWorldTransform(rng, 500.0f);
+		}
+		std::vector<entt::entity> lights(LightCount);
+		for (entt::entity& light : lights) light = reg.create();
+
+		auto StageWorkload = [](Uint64 frame)
+		{
+			Matrix work = Matrix::CreateRotationY(frame * 0.01f);
+			for (Uint32 i = 0; i < StageWork; ++i) work = work * Matrix::CreateRotationX(0.0001f);
+			return work;
+		};
+		auto RunFrames = [&](auto IsPipelined, std::vector<Uint64>& hashes)
+		{
+			for (Uint32 i = 0; i < LightCount; ++i)
+			{
+				Light& light = reg.emplace_or_replace<Light>(lights[i]);
+				light.type = LightType::Point;
+				light.position = Vector4((Float)i, 10.0f, 0.0f, 1.0f);
+			}
+			Camera camera(CameraParameters{ .near_plane = 1.0f, .far_plane = 3000.0f, .fov = XM_PIDIV2, .position = Vector3(0.0f, 10.0f, 0.0f), .look_at = Vector3(0.0f, 10.0f, 10.0f) });
+			hashes.clear();
+
+			FramePipeline pipeline(
+				[&](Uint64 frame, RenderSnapshot& snapshot)
+				{
+					Matrix const work = StageWorkload(frame);
+					DoNotOptimize(&work);
+					camera.SetPosition(Vector3(frame * 0.5f, 10.0f, 0.0f));
+					snapshot.frame = frame;
+					snapshot.dt = 1.0f / 60.0f + (frame % 7) * 0.001f;
+					snapshot.camera = camera;
+					PrepareRenderSnapshot(snapshot);
+				},
+				[&](RenderSnapshot& snapshot) { ExtractRenderSnapshot(reg, snapshot); },
+				[&](RenderSnapshot const& snapshot)
+				{
+					hashes.push_back(HashRenderSnapshot(snapshot));
+					Matrix const work = StageWorkload(snapshot.frame);
+					DoNotOptimize(&work);
+					Light& light = reg.get<Light>(lights[snapshot.frame % LightCount]);
+					light.position.y += snapshot.dt;
+				});
+			for (Uint32 frame = 0; frame < FrameCount; ++frame) pipeline.Tick(IsPipelined(frame));
+		};
+
+		std::vector<Uint64> reference_hashes, hashes, switched_hashes;
+		RunFrames([pipelined](Uint32) { return !pipelined; }, reference_hashes);
+
+		state.SetIterations(5);
+		state.SetItemsPerIteration(FrameCount);
+		state.Run([&]() { RunFrames([pipelined](Uint32) { return pipelined; }, hashes); });
+		RunFrames([pipelined](Uint32 frame) { return (frame / 13) % 2 == 0 ? pipelined : !pipelined; }, switched_hashes);
+
+		Uint32 mismatched_frames = 0, switched_mismatched_frames = 0;
+		for (Uint32 i = 0; i < FrameCount; ++i)
+		{
+			mismatched_frames += hashes[i] != reference_hashes[i];
+			switched_mismatched_frames += switched_hashes[i] != reference_hashes[i];
+		}
+		state.Check(mismatched_frames == 0, "snapshots differ between serial and pipelined mode");
+		state.Check(switched_mismatched_frames == 0, "snapshots differ after switching between serial and pipelined mode");
+		state.SetCounter("mismatched_frames", mismatched_frames);
+		state.SetCounter("switched_mismatched_frames", switched_mismatched_frames);
+	}
+
+	//synthetic gpu frame time traces, the cost of a frame grows with the pixel count and reaches the controller a few frames late.
+	//arg 0 steps the load up and down with a short spike in between, arg 1 is a load that does not fit even at the minimum scale,
+	//arg 2 always fits at full resolution
+	ADRIA_BENCHMARK(DynamicResolution_Trace, 0, 1, 2)
+	{
+		static constexpr Uint32 FrameCount = 900;
+		static constexpr Uint32 ReadbackLatency = 3;
+		static constexpr Float FixedCost = 2.0f;
+		static constexpr Uint32 MaxScaleChanges = 16;
+		static constexpr Float SceneCosts[3][3] = { { 12.0f, 24.0f, 14.0f }, { 70.0f, 70.0f, 70.0f }, { 10.0f, 10.0f, 10.0f } };
+		Uint64 const trace = state.GetArg();
+
+		struct TraceResult
+		{
+			std::vector<Float> scales;
+			Uint32 frames_over_budget = 0;
+			Uint32 scale_changes = 0;
+		};
+		auto RunTrace = [&](TraceResult& result)
+		{
+			DynamicResolutionController controller{};
+			Float const target = controller.GetSettings().target_frame_time_ms;
+			std::mt19937 rng{ 42 };
+			std::normal_distribution<Float> noise(0.0f, 0.4f);
+			std::vector<Float> in_flight;
+			result = TraceResult{};
+			result.scales.reserve(FrameCount);
+			for (Uint32 frame = 0; frame < FrameCount; ++frame)
+			{
+				Float scene_cost = SceneCosts[trace][frame / (FrameCount / 3)];
+				if (trace == 0 && frame >= 450 && frame < 455) scene_cost = 60.0f;
+				Float const scale = controller.GetScale();
+				Float const frame_time = FixedCost + scene_cost * scale * scale + noise(rng);
+				result.frames_over_budget += frame_time > target;
+				result.scales.push_back(scale);
+
+				in_flight.push_back(frame_time);
+				if (in_flight.size() > ReadbackLatency)
+				{
+					controller.Update(in_flight.front());
+					in_flight.erase(in_flight.begin());
+				}
+			}
+			result.scale_changes = controller.GetScaleChangeCount();
+		};
+
+		TraceResult result;
+		state.SetIterations(100);
+		state.SetItemsPerIteration(FrameCount);
+		state.Run([&]() { RunTrace(result); });
+
+		DynamicResolutionSettings const settings{};
+		Float const final_scale = result.scales.back();
+		Float const final_frame_time = FixedCost + SceneCosts[trace][2] * final_scale * final_scale;
+		switch (trace)
+		{
+		case 0:
+			//the expected frame time of the last scale is inside the hysteresis band, or under it at full resolution
+			state.Check(final_frame_time <= settings.target_frame_time_ms &&
+						(final_frame_time >= settings.target_frame_time_ms * (1.0f - settings.hysteresis) || final_scale == settings.max_scale),
+						"trace did not settle inside the hysteresis band");
+			state.Check(result.scale_changes <= MaxScaleChanges, "trace changed the scale too often");
+			break;
+		case 1:
+			state.Check(final_scale == settings.min_scale, "trace did not settle at the minimum scale");
+			break;
+		case 2:
+			state.Check(result.scale_changes == 0 && std::all_of(result.scales.begin(), result.scales.end(), [&](Float scale) { return scale == settings.max_scale; }),
+						"trace left the maximum scale");
+			break;
+		}
+		std::vector<Float> distinct_scales = result.scales;
+		std::sort(distinct_scales.begin(), distinct_scales.end());
+		distinct_scales.erase(std::unique(distinct_scales.begin(), distinct_scales.end()), distinct_scales.end());
+		state.SetCounter("scale_changes", result.scale_changes);
+		state.SetCounter("distinct_scales", (Float64)distinct_scales.size());
+		state.SetCounter("frames_over_budget", result.frames_over_budget);
+		state.SetCounter("final_scale", result.scales.back());
+	}
+
+	//a camera moving through a scene of 2048x2048 bc7 textures with a budget smaller than the textures at full resolution.
+	//arg is the number of textures, the working set of the camera covers 60% of them and moves to the other end halfway through
+	ADRIA_BENCHMARK(TextureResidency_Trace, 200, 1000)
+	{
+		static constexpr Uint32 FrameCount = 600;
+		static constexpr Uint32 MipCount = 12;
+		static constexpr Uint32 MaxDroppedMips = 3;
+		Uint32 const texture_count = (Uint32)state.GetArg();
+		Uint32 const working_set_count = texture_count * 3 / 5;
+
+		std::vector<Uint64> mip_sizes(MipCount);
+		for (Uint32 i = 0; i < MipCount; ++i) mip_sizes[i] = GetTextureMipByteSize(GfxFormat::BC7_UNORM, 2048, 2048, 1, i);
+		Uint64 const full_size = texture_count * std::accumulate(mip_sizes.begin(), mip_sizes.end(), Uint64(0));
+
+		TextureResidencySettings settings{};
+		settings.budget = full_size / 2;
+
+		struct TraceResult
+		{
+			std::vector<TextureResidencyChange> changes;
+			Uint64 max_resident_bytes = 0;
+			Uint32 frames_over_budget = 0;
+			Uint32 steady_state_changes = 0;
+			Uint32 working_set_dropped_mips = 0;
+			Uint32 unused_dropped_mips = 0;
+			Uint32 working_set_full_resolution = 0;
+			TextureResidencyStats final_stats;
+		};
+		auto RunTrace = [&](TraceResult& result)
+		{
+			TextureResidency residency{};
+			for (Uint32 i = 0; i < texture_count; ++i) residency.AddTexture(TextureHandle(TEXTURE_MANAGER_START_HANDLE + i), mip_sizes, MaxDroppedMips, 0);
+			std::vector<TextureResidencyChange> changes;
+			result = TraceResult{};
+			for (Uint64 frame = 1; frame <= FrameCount; ++frame)
+			{
+				Uint32 const first_used = frame <= FrameCount / 2 ? 0 : texture_count - working_set_count;
+				for (Uint32 i = first_used; i < first_used + working_set_count; ++i) residency.MarkUsed(TextureHandle(TEXTURE_MANAGER_START_HANDLE + i), frame);
+				residency.Update(frame, settings, changes);
+				result.changes.insert(result.changes.end(), changes.begin(), changes.end());
+
+				Uint64 const resident_bytes = residency.GetResidentBytes();
+				result.max_resident_bytes = std::max(result.max_resident_bytes, resident_bytes);
+				result.frames_over_budget += resident_bytes > settings.budget;
+				//the last frames of each half should not move textures anymore
+				if (frame % (FrameCount / 2) > FrameCount / 4) result.steady_state_changes += (Uint32)changes.size();
+			}
+			result.final_stats = residency.GetStats();
+			for (Uint32 i = 0; i < texture_count; ++i)
+			{
+				Uint32 const dropped_mips = residency.GetDroppedMips(TextureHandle(TEXTURE_MANAGER_START_HANDLE + i));
+				if (i < texture_count - working_set_count) result.unused_dropped_mips += dropped_mips;
+				else
+				{
+					result.working_set_dropped_mips += dropped_mips;
+					result.working_set_full_resolution += dropped_mips == 0;
+				}
+			}
+		};
+
+		TraceResult result;
+		state.SetIterations(20);
+		state.SetItemsPerIteration(FrameCount);
+		state.Run([&]() { RunTrace(result); });
+
+		state.Check(result.frames_over_budget == 0, "resident textures exceeded the budget");
+		state.Check(result.steady_state_changes == 0, "textures still changed residency after the working set settled");
+		//the moved working set streams its mips back in, on average it drops fewer mips than the textures it replaced
+		Uint32 const unused_count = texture_count - working_set_count;
+		state.Check((Uint64)result.working_set_dropped_mips * unused_count < (Uint64)result.unused_dropped_mips * working_set_count, "the new working set was not streamed back in");
+		state.SetCounter("changes", (Float64)result.changes.size());
+		state.SetCounter("steady_state_changes", result.steady_state_changes);
+		state.SetCounter("frames_over_budget", result.frames_over_budget);
+		state.SetCounter("max_resident_mb", result.max_resident_bytes / (1024.0 * 1024.0));
+		state.SetCounter("budget_mb", settings.budget / (1024.0 * 1024.0));
+		state.SetCounter("trimmed_textures", result.final_stats.trimmed_textures);
+		state.SetCounter("working_set_full_resolution", result.working_set_full_resolution);
+	}
+}
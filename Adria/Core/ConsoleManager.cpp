@@ -18,9 +18,9 @@ namespace adria
 		virtual Char const* GetName() const override { return name.c_str(); }
 		virtual void SetName(Char const* _name) override { name = _name; }
 
-		virtual void AddOnChanged(ConsoleVariableDelegate const& delegate)
+		virtual void AddOnChanged(ConsoleVariableDelegate&& delegate)
 		{
-			on_changed_callback.Add(delegate);
+			on_changed_callback.Add(std::move(delegate));
 		}
 		virtual ConsoleVariableMulticastDelegate& OnChangedDelegate() override { return on_changed_callback; }
 
@@ -437,8 +437,8 @@ namespace adria
 	{
 
 	public:
-		ConsoleCommand(ConsoleCommandDelegate const& delegate, Char const* name, Char const* help)
-			: ConsoleCommandBase(name, help), delegate(delegate)
+		ConsoleCommand(ConsoleCommandDelegate&& delegate, Char const* name, Char const* help)
+			: ConsoleCommandBase(name, help), delegate(std::move(delegate))
 		{}
 
 		virtual Bool Execute(std::span<Char const*> args) override
@@ -455,8 +455,8 @@ namespace adria
 	{
 
 	public:
-		ConsoleCommandWithArgs(ConsoleCommandWithArgsDelegate const& delegate, Char const* name, Char const* help)
-			: ConsoleCommandBase(name, help), delegate(delegate)
+		ConsoleCommandWithArgs(ConsoleCommandWithArgsDelegate&& delegate, Char const* name, Char const* help)
+			: ConsoleCommandBase(name, help), delegate(std::move(delegate))
 		{
 		}
 
@@ -521,14 +521,14 @@ namespace adria
 		return AddObject(name, new ConsoleVariableRef<std::string>(value, name, help))->AsVariable();
 	}
 
-	IConsoleCommand* ConsoleManager::RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandDelegate const& command)
+	IConsoleCommand* ConsoleManager::RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandDelegate&& command)
 	{
-		return AddObject(name, new ConsoleCommand(command, name, help))->AsCommand();
+		return AddObject(name, new ConsoleCommand(std::move(command), name, help))->AsCommand();
 	}
 
-	IConsoleCommand* ConsoleManager::RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandWithArgsDelegate const& command)
+	IConsoleCommand* ConsoleManager::RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandWithArgsDelegate&& command)
 	{
-		return AddObject(name, new ConsoleCommandWithArgs(command, name, help))->AsCommand();
+		return AddObject(name, new ConsoleCommandWithArgs(std::move(command), name, help))->AsCommand();
 	}
 
 	void ConsoleManager::UnregisterConsoleObject(IConsoleObject* console_obj)
@@ -23,8 +23,8 @@ namespace adria
 		virtual IConsoleVariable* RegisterConsoleVariableRef(Char const* name, Float& value, Char const* help) override;
 		virtual IConsoleVariable* RegisterConsoleVariableRef(Char const* name, std::string& value, Char const* help) override;
 
-		virtual IConsoleCommand* RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandDelegate const& command) override;
-		virtual IConsoleCommand* RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandWithArgsDelegate const& command) override;
+		virtual IConsoleCommand* RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandDelegate&& command) override;
+		virtual IConsoleCommand* RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandWithArgsDelegate&& command) override;
 
 		virtual void UnregisterConsoleObject(IConsoleObject* obj) override;
 		virtual void UnregisterConsoleObject(std::string const& name) override;
@@ -93,25 +93,25 @@ namespace adria
 		{
 		}
 
-		AutoConsoleVariable(Char const* name, Bool default_value, Char const* help, ConsoleVariableDelegate const& callback)
+		AutoConsoleVariable(Char const* name, Bool default_value, Char const* help, ConsoleVariableDelegate&& callback)
 			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleVariable(name, default_value, help))
 		{
-			AsVariable()->AddOnChanged(callback);
+			AsVariable()->AddOnChanged(std::move(callback));
 		}
-		AutoConsoleVariable(Char const* name, Sint32 default_value, Char const* help, ConsoleVariableDelegate const& callback)
+		AutoConsoleVariable(Char const* name, Sint32 default_value, Char const* help, ConsoleVariableDelegate&& callback)
 			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleVariable(name, default_value, help))
 		{
-			AsVariable()->AddOnChanged(callback);
+			AsVariable()->AddOnChanged(std::move(callback));
 		}
-		AutoConsoleVariable(Char const* name, Float default_value, Char const* help, ConsoleVariableDelegate const& callback)
+		AutoConsoleVariable(Char const* name, Float default_value, Char const* help, ConsoleVariableDelegate&& callback)
 			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleVariable(name, default_value, help))
 		{
-			AsVariable()->AddOnChanged(callback);
+			AsVariable()->AddOnChanged(std::move(callback));
 		}
-		AutoConsoleVariable(Char const* name, std::string const& default_value, Char const* help, ConsoleVariableDelegate const& callback)
+		AutoConsoleVariable(Char const* name, std::string const& default_value, Char const* help, ConsoleVariableDelegate&& callback)
 			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleVariable(name, default_value, help))
 		{
-			AsVariable()->AddOnChanged(callback);
+			AsVariable()->AddOnChanged(std::move(callback));
 		}
 
 		ADRIA_FORCEINLINE IConsoleVariable& operator*()
@@ -137,8 +137,8 @@ namespace adria
 	{
 	public:
 		TAutoConsoleVariable(Char const* name, std::type_identity_t<T> default_value, Char const* help) : AutoConsoleVariable(name, default_value, help) {}
-		TAutoConsoleVariable(Char const* name, std::type_identity_t<T> default_value, Char const* help, ConsoleVariableDelegate const& callback)
-			: AutoConsoleVariable(name, default_value, help, callback) {}
+		TAutoConsoleVariable(Char const* name, std::type_identity_t<T> default_value, Char const* help, ConsoleVariableDelegate&& callback)
+			: AutoConsoleVariable(name, default_value, help, std::move(callback)) {}
 
 		T Get() const
 		{
@@ -161,7 +161,7 @@ namespace adria
 	template <Uint32 N>
 	TAutoConsoleVariable(Char const* name, const Char(&)[N], Char const* help) -> TAutoConsoleVariable<std::string>;
 	template <Uint32 N>
-	TAutoConsoleVariable(Char const* name, const Char(&)[N], Char const* help, ConsoleVariableDelegate const& callback) -> TAutoConsoleVariable<std::string>;
+	TAutoConsoleVariable(Char const* name, const Char(&)[N], Char const* help, ConsoleVariableDelegate&& callback) -> TAutoConsoleVariable<std::string>;
 
 	class AutoConsoleVariableRef : private AutoConsoleObject
 	{
@@ -183,25 +183,25 @@ namespace adria
 		{
 		}
 
-		AutoConsoleVariableRef(Char const* name, Sint32& ref_value, Char const* help, ConsoleVariableDelegate const& callback)
+		AutoConsoleVariableRef(Char const* name, Sint32& ref_value, Char const* help, ConsoleVariableDelegate&& callback)
 			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleVariableRef(name, ref_value, help))
 		{
-			AsVariable()->AddOnChanged(callback);
+			AsVariable()->AddOnChanged(std::move(callback));
 		}
-		AutoConsoleVariableRef(Char const* name, Float& ref_value, Char const* help, ConsoleVariableDelegate const& callback)
+		AutoConsoleVariableRef(Char const* name, Float& ref_value, Char const* help, ConsoleVariableDelegate&& callback)
 			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleVariableRef(name, ref_value, help))
 		{
-			AsVariable()->AddOnChanged(callback);
+			AsVariable()->AddOnChanged(std::move(callback));
 		}
-		AutoConsoleVariableRef(Char const* name, Bool& ref_value, Char const* help, ConsoleVariableDelegate const& callback)
+		AutoConsoleVariableRef(Char const* name, Bool& ref_value, Char const* help, ConsoleVariableDelegate&& callback)
 			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleVariableRef(name, ref_value, help))
 		{
-			AsVariable()->AddOnChanged(callback);
+			AsVariable()->AddOnChanged(std::move(callback));
 		}
-		AutoConsoleVariableRef(Char const* name, std::string& ref_value, Char const* help, ConsoleVariableDelegate const& callback)
+		AutoConsoleVariableRef(Char const* name, std::string& ref_value, Char const* help, ConsoleVariableDelegate&& callback)
 			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleVariableRef(name, ref_value, help))
 		{
-			AsVariable()->AddOnChanged(callback);
+			AsVariable()->AddOnChanged(std::move(callback));
 		}
 
 		ADRIA_FORCEINLINE IConsoleVariable& operator*()
@@ -227,8 +227,8 @@ namespace adria
 	{
 	public:
 		TAutoConsoleVariableRef(Char const* name, std::type_identity_t<T>& default_value, Char const* help) : AutoConsoleVariableRef(name, default_value, help) {}
-		TAutoConsoleVariableRef(Char const* name, std::type_identity_t<T>& default_value, Char const* help, ConsoleVariableDelegate const& callback)
-			: AutoConsoleVariableRef(name, default_value, help, callback) {}
+		TAutoConsoleVariableRef(Char const* name, std::type_identity_t<T>& default_value, Char const* help, ConsoleVariableDelegate&& callback)
+			: AutoConsoleVariableRef(name, default_value, help, std::move(callback)) {}
 
 		T Get() const
 		{
@@ -252,12 +252,12 @@ namespace adria
 	class AutoConsoleCommand : private AutoConsoleObject
 	{
 	public:
-		AutoConsoleCommand(Char const* name, Char const* help, ConsoleCommandDelegate const& command)
-			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleCommand(name, help, command))
+		AutoConsoleCommand(Char const* name, Char const* help, ConsoleCommandDelegate&& command)
+			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleCommand(name, help, std::move(command)))
 		{
 		}
-		AutoConsoleCommand(Char const* name, Char const* help, ConsoleCommandWithArgsDelegate const& command)
-			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleCommand(name, help, command))
+		AutoConsoleCommand(Char const* name, Char const* help, ConsoleCommandWithArgsDelegate&& command)
+			: AutoConsoleObject(g_ConsoleManager.RegisterConsoleCommand(name, help, std::move(command)))
 		{
 		}
 	};
@@ -4,9 +4,11 @@
 #include "Input.h"
 #include "Paths.h"
 #include "ConsoleManager.h"
+#include "FramePipeline.h"
 #include "Logging/Logger.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxCommandList.h"
+#include "Graphics/GfxUploadManager.h"
 #include "Rendering/Renderer.h"
 #include "Rendering/Camera.h"
 #include "Rendering/EntityLoader.h"
@@ -17,14 +19,18 @@
 #include "Utilities/JsonUtil.h"
 #include "Utilities/StringUtil.h"
 #include "Utilities/FilesUtil.h"
+#include "Utilities/VirtualFileSystem.h"
 #include "Math/Constants.h"
 #include "Editor/EditorEvents.h"
+#include "Benchmark/Benchmark.h"
 
 using namespace DirectX;
 using json = nlohmann::json;
 
 namespace adria
 {
+	static TAutoConsoleVariable<Bool> PipelinedSimulation("engine.PipelinedSimulation", false, "Simulate the next frame on a separate thread while the current one is rendered");
+
 	struct SceneConfig
 	{
 		std::vector<ModelParameters> scene_models;
@@ -79,7 +85,13 @@ namespace adria
 				model_params.Find<Bool>("use_ccw", triangle_ccw);
 				Bool force_mask = false;
 				model_params.Find<Bool>("force_alpha_mask", force_mask);
-				config.scene_models.emplace_back(path, tex_path, transform, triangle_ccw, force_mask);
+				Float meshlet_cone_weight = 0.25f;
+				model_params.Find<Float>("meshlet_cone_weight", meshlet_cone_weight);
+				Bool quantize_vertices = false;
+				model_params.Find<Bool>("quantize_vertices", quantize_vertices);
+				Bool meshlet_lods = true;
+				model_params.Find<Bool>("meshlet_lods", meshlet_lods);
+				config.scene_models.emplace_back(path, tex_path, transform, triangle_ccw, force_mask, meshlet_cone_weight, quantize_vertices, meshlet_lods);
 			}
 
 			for (auto&& light_json : lights)
@@ -134,6 +146,7 @@ namespace adria
 				light.light_data.casts_shadows = light_params.FindOr<Bool>("shadows", true);
 				light.light_data.use_cascades = light_params.FindOr<Bool>("cascades", false);
 				light.light_data.ray_traced_shadows = light_params.FindOr<Bool>("rts", false);
+				light.light_data.shadow_importance = light_params.FindOr<Float>("shadow_importance", 1.0f);
 
 				light.light_data.active = light_params.FindOr<Bool>("active", true);
 				light.light_data.volumetric = light_params.FindOr<Bool>("volumetric", false);
@@ -225,6 +238,7 @@ namespace adria
 	Engine::Engine(EngineInit const& init) : window { init.window }
 	{
 		g_ThreadPool.Initialize();
+		if (!init.pak_file.empty()) g_VirtualFileSystem.Mount(init.pak_file);
 		GfxShaderCompiler::Initialize();
 		gfx = std::make_unique<GfxDevice>(window, init.gfx_options);
 		ShaderManager::Initialize();
@@ -246,11 +260,26 @@ namespace adria
 
 		input_events.window_resized_event.AddMember(&Camera::OnResize, *camera);
 		input_events.scroll_mouse_event.AddMember(&Camera::Zoom, *camera);
+
+		frame_pipeline = std::make_unique<FramePipeline>(
+			[this](Uint64 frame, RenderSnapshot& snapshot) { Simulate(frame, snapshot); },
+			[this](RenderSnapshot& snapshot) { ExtractRenderSnapshot(reg, snapshot); },
+			[this](RenderSnapshot const& snapshot) { Render(snapshot); });
+
+		if (!init.benchmark_file.empty())
+		{
+			std::vector<BenchmarkResult> benchmark_results = BenchmarkRegistry::RunAll(BenchmarkContext{ .gfx = gfx.get() }, init.benchmark_filter);
+			Bool const written = BenchmarkRegistry::WriteResults(benchmark_results, init.benchmark_file);
+			window->Quit(written && BenchmarkRegistry::Passed(benchmark_results) ? 0 : 1);
+		}
 	}
 
 	Engine::~Engine()
 	{
+		frame_pipeline.reset();
+		renderer->FlushScreenCaptures();
 		g_TextureManager.Destroy();
+		g_VirtualFileSystem.UnmountAll();
 		ShaderManager::Destroy();
 		GfxShaderCompiler::Destroy();
 		g_ThreadPool.Destroy();
@@ -264,21 +293,25 @@ namespace adria
 	void Engine::Run()
 	{
 		FrameMarkNamed("EngineFrame");
-		static Timer timer;
-		Float const dt = timer.MarkInSeconds();
 		g_Input.Tick();
-		Update(dt);
-		Render();
+		frame_pipeline->Tick(PipelinedSimulation.Get());
 	}
 
-	void Engine::Update(Float dt)
+	void Engine::Simulate(Uint64 frame, RenderSnapshot& snapshot)
 	{
+		static Timer timer;
+		Float const dt = timer.MarkInSeconds();
 		camera->Update(dt);
-		renderer->NewFrame(camera.get());
-		renderer->Update(dt);
+
+		snapshot.frame = frame;
+		snapshot.dt = dt;
+		snapshot.camera = *camera;
+		PrepareRenderSnapshot(snapshot);
 	}
-	void Engine::Render()
+	void Engine::Render(RenderSnapshot const& snapshot)
 	{
+		renderer->NewFrame(&snapshot);
+		renderer->Update(snapshot.dt);
 		gfx->BeginFrame();
 		renderer->Render();
 		gfx->EndFrame();
@@ -322,13 +355,17 @@ namespace adria
 		for (auto const& model : config.scene_models) entity_loader->ImportModel_GLTF(model);
 		for (auto const& light : config.scene_lights) entity_loader->LoadLight(light);
 
-		auto ray_tracing_view = reg.view<Mesh, RayTracing>();
-		for (auto entity : reg.view<Mesh, RayTracing>())
-		{
-			auto const& mesh = ray_tracing_view.get<Mesh>(entity);
-			GfxBuffer* buffer = g_GeometryBufferCache.GetGeometryBuffer(mesh.geometry_buffer_handle);
-			cmd_list->BufferBarrier(*buffer, GfxResourceState::CopyDst, GfxResourceState::AllSRV);
-		}
+		VertexStreamStats const& vertex_stats = entity_loader->GetVertexStreamStats();
+		ADRIA_LOG(INFO, "Vertex streams: %llu vertices (%llu quantized), %.1f MB stored, %.1f MB saved by quantization",
+			vertex_stats.vertex_count, vertex_stats.quantized_vertex_count, vertex_stats.stored_size / (1024.0 * 1024.0),
+			(vertex_stats.float_size - vertex_stats.stored_size) / (1024.0 * 1024.0));
+
+		//geometry is uploaded on the copy queue, the pages stay in the common state and are promoted on first use
+		GfxUploadManager* upload_manager = gfx->GetUploadManager();
+		upload_manager->Wait(cmd_list, upload_manager->Submit());
+		GfxUploadManagerStats const& upload_stats = upload_manager->GetStats();
+		ADRIA_LOG(INFO, "Uploaded %.1f MB of geometry in %u batches, peak staging usage %.1f MB, %u staging stalls",
+			upload_stats.uploaded_size / (1024.0 * 1024.0), upload_stats.submitted_batches, upload_stats.peak_staging_usage / (1024.0 * 1024.0), upload_stats.staging_stalls);
 
 		renderer->OnSceneInitialized();
 		cmd_list->End();
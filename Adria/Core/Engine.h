@@ -14,10 +14,15 @@ namespace adria
 	struct EditorEvents;
 	class ImGuiManager;
 	class Camera;
+	class FramePipeline;
+	struct RenderSnapshot;
 
 	struct EngineInit
 	{
 		std::string scene_file = "scene.json";
+		std::string benchmark_file;
+		std::string benchmark_filter;
+		std::string pak_file;
 		Window* window = nullptr;
 		GfxOptions gfx_options;
 	};
@@ -44,13 +49,14 @@ namespace adria
 		std::unique_ptr<EntityLoader> entity_loader;
 
 		ViewportData viewport_data;
+		std::unique_ptr<FramePipeline> frame_pipeline;
 
 	private:
 		void InitializeScene(SceneConfig const& config);
 		void ProcessCVarIniFile();
 
-		void Update(Float dt);
-		void Render();
+		void Simulate(Uint64 frame, RenderSnapshot& snapshot);
+		void Render(RenderSnapshot const& snapshot);
 
 		void SetViewportData(ViewportData* viewport_data);
 		void RegisterEditorEventCallbacks(EditorEvents&);
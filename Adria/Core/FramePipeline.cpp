@@ -0,0 +1,84 @@
+#include "FramePipeline.h"
+#include "tracy/Tracy.hpp"
+
+namespace adria
+{
+	FramePipeline::FramePipeline(SimulateFn&& simulate, ExtractFn&& extract, RenderFn&& render)
+		: simulate(std::move(simulate)), extract(std::move(extract)), render(std::move(render))
+	{
+		simulation_thread = std::thread(&FramePipeline::SimulationThread, this);
+	}
+
+	FramePipeline::~FramePipeline()
+	{
+		WaitSimulation();
+		{
+			std::lock_guard<std::mutex> lock(simulation_mutex);
+			exit = true;
+		}
+		simulation_cv.notify_one();
+		simulation_thread.join();
+	}
+
+	void FramePipeline::Tick(Bool pipelined)
+	{
+		Uint32 const slot = Uint32(frame_index % 2);
+		RenderSnapshot& snapshot = snapshots[slot];
+		if (frame_index == 0) extract(snapshot);
+		if (!simulation_ahead) simulate(frame_index, snapshot);
+
+		//the simulation thread is idle and the renderer has not started, the registry owned part of the next frame is copied at the handoff
+		extract(snapshots[slot ^ 1]);
+		render_slot = slot;
+
+		simulation_ahead = pipelined;
+		if (pipelined) KickSimulation(frame_index + 1);
+		render(snapshot);
+		WaitSimulation();
+		++frame_index;
+	}
+
+	void FramePipeline::SimulationThread()
+	{
+		while (true)
+		{
+			Uint64 frame = 0;
+			{
+				std::unique_lock<std::mutex> lock(simulation_mutex);
+				simulation_cv.wait(lock, [this] { return simulation_requested || exit; });
+				if (exit) return;
+				simulation_requested = false;
+				frame = simulation_frame;
+			}
+
+			{
+				ZoneScopedN("Simulation");
+				simulate(frame, snapshots[frame % 2]);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(simulation_mutex);
+				simulation_done = true;
+			}
+			simulation_cv.notify_all();
+		}
+	}
+
+	void FramePipeline::KickSimulation(Uint64 frame)
+	{
+		{
+			std::lock_guard<std::mutex> lock(simulation_mutex);
+			ADRIA_ASSERT(simulation_done);
+			simulation_frame = frame;
+			simulation_requested = true;
+			simulation_done = false;
+		}
+		simulation_cv.notify_all();
+	}
+
+	void FramePipeline::WaitSimulation()
+	{
+		std::unique_lock<std::mutex> lock(simulation_mutex);
+		simulation_cv.wait(lock, [this] { return simulation_done; });
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Rendering/RenderSnapshot.h"
+
+namespace adria
+{
+	//runs the simulation of frame N+1 on a dedicated thread while frame N is rendered.
+	//the stages only communicate through two snapshot slots. the registry owned part of frame N+1 is extracted at the
+	//handoff of frame N, before frame N is rendered, so the simulation of N+1 never reads the registry while the renderer
+	//and the editor write it. registry edits made while rendering frame N are seen by frame N+2.
+	//serial and pipelined mode produce the same sequence of snapshots, only the overlap differs
+	class FramePipeline
+	{
+	public:
+		using SimulateFn = std::function<void(Uint64 frame, RenderSnapshot&)>;
+		using ExtractFn = std::function<void(RenderSnapshot&)>;
+		using RenderFn = std::function<void(RenderSnapshot const&)>;
+
+		FramePipeline(SimulateFn&& simulate, ExtractFn&& extract, RenderFn&& render);
+		ADRIA_NONCOPYABLE_NONMOVABLE(FramePipeline)
+		~FramePipeline();
+
+		void Tick(Bool pipelined);
+
+		Uint64 GetFrameIndex() const { return frame_index; }
+		Bool IsSimulationAhead() const { return simulation_ahead; }
+		//snapshot of the frame currently being rendered or, between ticks, of the last rendered frame
+		RenderSnapshot const& GetRenderSnapshot() const { return snapshots[render_slot]; }
+
+	private:
+		SimulateFn simulate;
+		ExtractFn extract;
+		RenderFn render;
+
+		RenderSnapshot snapshots[2];
+		Uint64 frame_index = 0;
+		Uint32 render_slot = 0;
+		Bool simulation_ahead = false;
+
+		std::thread simulation_thread;
+		std::mutex simulation_mutex;
+		std::condition_variable simulation_cv;
+		Bool simulation_requested = false;
+		Bool simulation_done = true;
+		Bool exit = false;
+		Uint64 simulation_frame = 0;
+
+	private:
+		void SimulationThread();
+		void KickSimulation(Uint64 frame);
+		void WaitSimulation();
+	};
+}
@@ -57,7 +57,7 @@ namespace adria
 		virtual Bool GetBool() const = 0;
 		virtual std::string GetString() const = 0;
 
-		virtual void AddOnChanged(ConsoleVariableDelegate const&) = 0;
+		virtual void AddOnChanged(ConsoleVariableDelegate&&) = 0;
 		virtual ConsoleVariableMulticastDelegate& OnChangedDelegate() = 0;
 	};
 
@@ -84,8 +84,8 @@ namespace adria
 		virtual IConsoleVariable* RegisterConsoleVariableRef(Char const* name, Float& value, Char const* help) = 0;
 		virtual IConsoleVariable* RegisterConsoleVariableRef(Char const* name, std::string& value, Char const* help) = 0;
 
-		virtual IConsoleCommand* RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandDelegate const& command) = 0;
-		virtual IConsoleCommand* RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandWithArgsDelegate const& command) = 0;
+		virtual IConsoleCommand* RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandDelegate&& command) = 0;
+		virtual IConsoleCommand* RegisterConsoleCommand(Char const* name, Char const* help, ConsoleCommandWithArgsDelegate&& command) = 0;
 
 		virtual void UnregisterConsoleObject(IConsoleObject* obj) = 0;
 		virtual void UnregisterConsoleObject(std::string const& name) = 0;
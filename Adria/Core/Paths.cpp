@@ -38,5 +38,7 @@ namespace adria
 	std::string const paths::AftermathDir = SavedDir + "Aftermath/";
 
 	std::string const paths::PixCapturesDir = SavedDir + "PixCaptures/";
+
+	std::string const paths::BenchmarksDir = SavedDir + "Benchmarks/";
 }
 
@@ -121,7 +121,11 @@ namespace adria
         {
             TranslateMessage(&msg);
             DispatchMessage(&msg);
-            if (msg.message == WM_QUIT) return false;
+            if (msg.message == WM_QUIT)
+            {
+                exit_code = (Sint32)msg.wParam;
+                return false;
+            }
         }
         return true;
     }
@@ -37,6 +37,7 @@ namespace adria
 
 		Bool Loop();
 		void Quit(Sint32 exit_code);
+		Sint32 ExitCode() const { return exit_code; }
 
 		void* Handle() const;
 		Bool  IsActive() const;
@@ -47,5 +48,6 @@ namespace adria
 	private:
 		HWND hwnd = nullptr;
 		WindowEvent window_event;
+		Sint32 exit_code = 0;
 	};
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "EditorLogger.h"
 #include "EditorConsole.h"
 #include "Core/Engine.h"
+#include "Core/FramePipeline.h"
 #include "Core/Input.h"
 #include "Core/Paths.h"
 #include "IconsFontAwesome6.h"
@@ -84,12 +85,19 @@ namespace adria
 	void Editor::Run()
 	{
 		HandleInput();
+		if (pending_camera_edit.has_value())
+		{
+			engine->camera->SetPosition(pending_camera_edit->position);
+			engine->camera->SetNearAndFar(pending_camera_edit->near_plane, pending_camera_edit->far_plane);
+			engine->camera->SetFov(pending_camera_edit->fov);
+			pending_camera_edit.reset();
+		}
 		if (gui->IsVisible()) engine->SetViewportData(&viewport_data);
 		else engine->SetViewportData(nullptr);
 
 		engine->Run();
 
-		if (reload_shaders)
+		if (reload_shaders || ShaderManager::HasPendingChanges())
 		{
 			gfx->WaitForGPU();
 			ShaderManager::CheckIfShadersHaveChanged();
@@ -577,6 +585,10 @@ namespace adria
 						{
 							ImGui::Checkbox("Use Cascades", &light->use_cascades);
 						}
+						else
+						{
+							ImGui::SliderFloat("Shadow Importance", &light->shadow_importance, 0.0f, 4.0f);
+						}
 					}
 
 					ImGui::Checkbox("God Rays", &light->god_rays);
@@ -777,19 +789,18 @@ namespace adria
 	{
 		if (!visibility_flags[Flag_Camera]) return;
 
-		auto& camera = *engine->camera;
+		//the gui runs on the render thread, it shows the camera of the rendered frame and defers edits to the next frame
+		auto const& camera = engine->frame_pipeline->GetRenderSnapshot().camera;
 		if (ImGui::Begin(ICON_FA_CAMERA" Camera", &visibility_flags[Flag_Camera]))
 		{
 			Vector3 cam_pos = camera.Position();
-			ImGui::SliderFloat3("Position", (Float*)&cam_pos, 0.0f, 2000.0f);
-			camera.SetPosition(cam_pos);
+			Bool changed = ImGui::SliderFloat3("Position", (Float*)&cam_pos, 0.0f, 2000.0f);
 			Float near_plane = camera.Near(), far_plane = camera.Far();
 			Float fov = camera.Fov();
-			ImGui::SliderFloat("Near", &near_plane, 10.0f, 3000.0f);
-			ImGui::SliderFloat("Far", &far_plane, 0.001f, 2.0f);
-			ImGui::SliderFloat("FOV", &fov, 0.01f, 1.5707f);
-			camera.SetNearAndFar(near_plane, far_plane);
-			camera.SetFov(fov);
+			changed |= ImGui::SliderFloat("Near", &near_plane, 10.0f, 3000.0f);
+			changed |= ImGui::SliderFloat("Far", &far_plane, 0.001f, 2.0f);
+			changed |= ImGui::SliderFloat("FOV", &fov, 0.01f, 1.5707f);
+			if (changed) pending_camera_edit = CameraEdit{ .position = cam_pos, .near_plane = near_plane, .far_plane = far_plane, .fov = fov };
 			Vector3 look_at = camera.Forward();
 			ImGui::Text("Look Vector: (%f,%f,%f)", look_at.x, look_at.y, look_at.z);
 		}
@@ -873,7 +884,7 @@ namespace adria
 			ImGuizmo::SetRect(window_pos.x, window_pos.y,
 				window_size.x, window_size.y);
 
-			auto& camera = *engine->camera;
+			auto const& camera = engine->frame_pipeline->GetRenderSnapshot().camera;
 
 			Matrix camera_view = camera.View();
 			Matrix camera_proj = camera.Proj();
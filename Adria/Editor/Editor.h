@@ -71,6 +71,16 @@ namespace adria
 		Bool gizmo_enabled = false;
 		ImGuizmo::OPERATION gizmo_op = ImGuizmo::TRANSLATE;
 
+		//camera edits from the gui are applied between frames, when the simulation thread is idle
+		struct CameraEdit
+		{
+			Vector3 position;
+			Float near_plane;
+			Float far_plane;
+			Float fov;
+		};
+		std::optional<CameraEdit> pending_camera_edit;
+
 		Bool reload_shaders = false;
 		Bool visibility_flags[Flag_Count] = {false};
 		std::vector<GUICommand> commands;
@@ -11,6 +11,7 @@
 #include "GfxRayTracingShaderTable.h"
 #include "GfxStateObject.h"
 #include "Utilities/StringUtil.h"
+#include "Utilities/AllocatorUtil.h"
 
 namespace adria
 {
@@ -379,7 +380,9 @@ namespace adria
 	{
 		if (use_legacy_barriers)
 		{
-			if (flags_before == GfxResourceState::ComputeUAV && flags_after == GfxResourceState::ComputeUAV)
+			Bool const uav_barrier = flags_before == GfxResourceState::ComputeUAV && flags_after == GfxResourceState::ComputeUAV;
+			Bool const as_barrier = HasFlag(flags_before, GfxResourceState::ASWrite) && HasFlag(flags_after, GfxResourceState::ASRead);
+			if (uav_barrier || as_barrier)
 			{
 				D3D12_RESOURCE_BARRIER barrier{};
 				barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
@@ -483,7 +486,6 @@ namespace adria
 	{
 		GfxTextureDesc const& desc = src.GetDesc();
 
-
 		D3D12_TEXTURE_COPY_LOCATION dst_texture;
 		dst_texture.pResource = dst.GetNative();
 		dst_texture.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
@@ -492,14 +494,14 @@ namespace adria
 		dst_texture.PlacedFootprint.Footprint.Depth = 1;
 		dst_texture.PlacedFootprint.Footprint.Height = desc.height;
 		dst_texture.PlacedFootprint.Footprint.Format = ConvertGfxFormat(desc.format);
-		dst_texture.PlacedFootprint.Footprint.RowPitch = (Uint32) GetRowPitch(desc.format, dst_texture.PlacedFootprint.Footprint.Width); // (uint32)Align(, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+		dst_texture.PlacedFootprint.Footprint.RowPitch = (Uint32)AlignToPowerOfTwo(GetRowPitch(desc.format, desc.width), (Uint64)D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 
 		D3D12_TEXTURE_COPY_LOCATION src_texture;
 		src_texture.pResource = src.GetNative();
 		src_texture.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
 		src_texture.SubresourceIndex = src_mip + src.GetDesc().mip_levels * src_array;
 
-		cmd_list->CopyTextureRegion(&dst_texture, (Uint32)dst_offset, 0, 0, &src_texture, nullptr);
+		cmd_list->CopyTextureRegion(&dst_texture, 0, 0, 0, &src_texture, nullptr);
 		++command_count;
 	}
 
@@ -889,6 +891,14 @@ namespace adria
 		cmd_list->ClearDepthStencilView(dsv, d3d12_clear_flags, depth, stencil, 0, nullptr);
 	}
 
+	void GfxCommandList::ClearDepth(GfxDescriptor dsv, Uint32 x, Uint32 y, Uint32 width, Uint32 height, Float depth /*= 1.0f*/, Uint8 stencil /*= 0*/, Bool clear_stencil /*= false*/)
+	{
+		D3D12_CLEAR_FLAGS d3d12_clear_flags = D3D12_CLEAR_FLAG_DEPTH;
+		if (clear_stencil) d3d12_clear_flags |= D3D12_CLEAR_FLAG_STENCIL;
+		D3D12_RECT rect = { (LONG)x, (LONG)y, LONG(x + width), LONG(y + height) };
+		cmd_list->ClearDepthStencilView(dsv, d3d12_clear_flags, depth, stencil, 1, &rect);
+	}
+
 	void GfxCommandList::SetRenderTargets(std::span<GfxDescriptor const> rtvs, GfxDescriptor const* dsv /*= nullptr*/, Bool single_rt /*= false*/)
 	{
 		D3D12_CPU_DESCRIPTOR_HANDLE* d3d12_dsv = nullptr;
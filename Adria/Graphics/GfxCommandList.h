@@ -131,6 +131,7 @@ namespace adria
 
 		void ClearRenderTarget(GfxDescriptor rtv, Float const* clear_color);
 		void ClearDepth(GfxDescriptor dsv, Float depth = 1.0f, Uint8 stencil = 0, Bool clear_stencil = false);
+		void ClearDepth(GfxDescriptor dsv, Uint32 x, Uint32 y, Uint32 width, Uint32 height, Float depth = 1.0f, Uint8 stencil = 0, Bool clear_stencil = false);
 		void SetRenderTargets(std::span<GfxDescriptor const> rtvs, GfxDescriptor const* dsv = nullptr, Bool single_rt = false);
 
 		void SetContext(Context ctx);
@@ -10,6 +10,8 @@
 #include "GfxDescriptorAllocator.h"
 #include "GfxRingDescriptorAllocator.h"
 #include "GfxLinearDynamicAllocator.h"
+#include "GfxUploadManager.h"
+#include "GfxReadbackManager.h"
 #include "GfxQueryHeap.h"
 #include "GfxPipelineState.h"
 #include "GfxNsightAftermathGpuCrashTracker.h"
@@ -347,6 +349,8 @@ namespace adria
 		}
 		for (Uint32 i = 0; i < GFX_BACKBUFFER_COUNT; ++i) dynamic_allocators.emplace_back(new GfxLinearDynamicAllocator(this, 1 << 20));
 		dynamic_allocator_on_init.reset(new GfxLinearDynamicAllocator(this, 1 << 30));
+		upload_manager = std::make_unique<GfxUploadManager>(this, 64 << 20, 4 << 20);
+		readback_manager = std::make_unique<GfxReadbackManager>(this, 64 << 10);
 
 		GfxSwapchainDesc swapchain_desc{};
 		swapchain_desc.width = width;
@@ -419,6 +423,7 @@ namespace adria
 
 		graphics_cmd_list_pool[backbuffer_index]->BeginCmdLists();
 		copy_cmd_list_pool[backbuffer_index]->BeginCmdLists();
+		readback_manager->Update();
 	}
 	void GfxDevice::EndFrame()
 	{
@@ -427,7 +432,10 @@ namespace adria
 		graphics_cmd_list_pool[backbuffer_index]->EndCmdLists();
 		copy_cmd_list_pool[backbuffer_index]->EndCmdLists();
 
+		//uploads recorded until the end of the frame are visible to the frame
+		upload_manager->Wait(graphics_cmd_list_pool[backbuffer_index]->GetMainCmdList(), upload_manager->Submit());
 		graphics_queue.ExecuteCommandListPool(*graphics_cmd_list_pool[backbuffer_index]);
+		readback_manager->Submit(graphics_queue);
 		copy_queue.ExecuteCommandListPool(*copy_cmd_list_pool[backbuffer_index]);
 		ProcessReleaseQueue();
 
@@ -644,6 +652,16 @@ namespace adria
 		else return dynamic_allocators[swapchain->GetBackbufferIndex()].get();
 	}
 
+	GfxUploadManager* GfxDevice::GetUploadManager() const
+	{
+		return upload_manager.get();
+	}
+
+	GfxReadbackManager* GfxDevice::GetReadbackManager() const
+	{
+		return readback_manager.get();
+	}
+
 	void GfxDevice::InitShaderVisibleAllocator(Uint32 reserve)
 	{
 		gpu_descriptor_allocator = std::make_unique<GfxOnlineDescriptorAllocator>(this, 32767, reserve);
@@ -696,9 +714,13 @@ namespace adria
 	{
 		return std::make_unique<GfxRayTracingTLAS>(this, instances, flags);
 	}
-	std::unique_ptr<GfxRayTracingBLAS> GfxDevice::CreateRayTracingBLAS(std::span<GfxRayTracingGeometry> geometries, GfxRayTracingASFlags flags)
+	std::unique_ptr<GfxRayTracingBLAS> GfxDevice::CreateRayTracingBLAS(std::span<GfxRayTracingGeometry> geometries, GfxRayTracingASFlags flags, Uint64 compacted_size_address)
+	{
+		return std::make_unique<GfxRayTracingBLAS>(this, geometries, flags, compacted_size_address);
+	}
+	std::unique_ptr<GfxRayTracingBLAS> GfxDevice::CreateCompactedRayTracingBLAS(GfxRayTracingBLAS const& source, Uint64 compacted_size)
 	{
-		return std::make_unique<GfxRayTracingBLAS>(this, geometries, flags);
+		return std::make_unique<GfxRayTracingBLAS>(this, source, compacted_size);
 	}
 
 	GfxDescriptor GfxDevice::CreateBufferSRV(GfxBuffer const* buffer, GfxBufferDescriptorDesc const* desc)
@@ -61,6 +61,8 @@ namespace adria
 	class GfxMeshShaderPipelineState;
 
 	class GfxLinearDynamicAllocator;
+	class GfxUploadManager;
+	class GfxReadbackManager;
 	class GfxDescriptorAllocator;
 	template<Bool>
 	class GfxRingDescriptorAllocator;
@@ -138,6 +140,8 @@ namespace adria
 		void InitShaderVisibleAllocator(Uint32 reserve);
 
 		GfxLinearDynamicAllocator* GetDynamicAllocator() const;
+		GfxUploadManager* GetUploadManager() const;
+		GfxReadbackManager* GetReadbackManager() const;
 
 		std::unique_ptr<GfxTexture> CreateBackbufferTexture(GfxTextureDesc const& desc, void* backbuffer);
 		std::unique_ptr<GfxTexture> CreateTexture(GfxTextureDesc const& desc, GfxTextureData const& data);
@@ -152,7 +156,8 @@ namespace adria
 		std::unique_ptr<GfxQueryHeap>	   CreateQueryHeap(GfxQueryHeapDesc const& desc);
 
 		std::unique_ptr<GfxRayTracingTLAS> CreateRayTracingTLAS(std::span<GfxRayTracingInstance> instances, GfxRayTracingASFlags flags);
-		std::unique_ptr<GfxRayTracingBLAS> CreateRayTracingBLAS(std::span<GfxRayTracingGeometry> geometries, GfxRayTracingASFlags flags);
+		std::unique_ptr<GfxRayTracingBLAS> CreateRayTracingBLAS(std::span<GfxRayTracingGeometry> geometries, GfxRayTracingASFlags flags, Uint64 compacted_size_address = 0);
+		std::unique_ptr<GfxRayTracingBLAS> CreateCompactedRayTracingBLAS(GfxRayTracingBLAS const& source, Uint64 compacted_size);
 
 		GfxDescriptor CreateBufferSRV(GfxBuffer const*, GfxBufferDescriptorDesc const* = nullptr);
 		GfxDescriptor CreateBufferUAV(GfxBuffer const*, GfxBufferDescriptorDesc const* = nullptr);
@@ -244,6 +249,8 @@ namespace adria
 
 		std::vector<std::unique_ptr<GfxLinearDynamicAllocator>> dynamic_allocators;
 		std::unique_ptr<GfxLinearDynamicAllocator> dynamic_allocator_on_init;
+		std::unique_ptr<GfxUploadManager> upload_manager;
+		std::unique_ptr<GfxReadbackManager> readback_manager;
 
 		std::unique_ptr<DrawIndirectSignature> draw_indirect_signature;
 		std::unique_ptr<DrawIndexedIndirectSignature> draw_indexed_indirect_signature;
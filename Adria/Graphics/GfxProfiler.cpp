@@ -10,26 +10,35 @@
 #include "GfxDevice.h"
 #include "GfxCommandList.h"
 #include "GfxQueryHeap.h"
-#include "GfxBuffer.h"
+#include "GfxReadbackManager.h"
 
 
 namespace adria
 {
 	struct GfxProfiler::Impl
 	{
-		static constexpr Uint64 FRAME_COUNT = GFX_BACKBUFFER_COUNT;
 		static constexpr Uint64 MAX_PROFILES = 256;
 
 		struct QueryData
 		{
 			Bool query_started = false;
 			Bool query_finished = false;
+			Bool readback_requested = false;
 			GfxCommandList* cmd_list = nullptr;
 		};
 
+		//timestamps of one frame, filled by the readback callbacks of its queries
+		struct FrameTimestamps
+		{
+			std::vector<std::string> names;
+			std::vector<Float> times_ms;
+		};
+
 		GfxDevice* gfx = nullptr;
 		std::unique_ptr<GfxQueryHeap> query_heap;
-		std::unique_ptr<GfxBuffer> query_readback_buffer;
+		Uint64 gpu_frequency = 0;
+		std::shared_ptr<FrameTimestamps> current_timestamps;
+		std::shared_ptr<FrameTimestamps> resolved_timestamps;
 
 		std::array<QueryData, MAX_PROFILES> query_data;
 		std::unordered_map<std::string, Uint32> name_to_index_map;
@@ -44,7 +53,7 @@ namespace adria
 		void Init(GfxDevice* _gfx)
 		{
 			gfx = _gfx;
-			query_readback_buffer = gfx->CreateBuffer(ReadBackBufferDesc(MAX_PROFILES * 2 * FRAME_COUNT * sizeof(Uint64)));
+			gfx->GetTimestampFrequency(gpu_frequency);
 
 			GfxQueryHeapDesc query_heap_desc{};
 			query_heap_desc.count = MAX_PROFILES * 2;
@@ -54,17 +63,19 @@ namespace adria
 		void Destroy()
 		{
 			query_heap.reset();
-			query_readback_buffer.reset();
+			current_timestamps.reset();
+			resolved_timestamps.reset();
 			gfx = nullptr;
 		}
 		void NewFrame()
 		{
 			for (auto& profile_data : query_data)
 			{
-				profile_data.query_started = profile_data.query_finished = false;
+				profile_data.query_started = profile_data.query_finished = profile_data.readback_requested = false;
 				profile_data.cmd_list = nullptr;
 			}
 			name_to_index_map.clear();
+			current_timestamps.reset();
 			scope_counter = 0;
 		}
 		void BeginProfileScope(GfxCommandList* cmd_list, Char const* name)
@@ -108,41 +119,40 @@ namespace adria
 		}
 		std::vector<GfxTimestamp> GetResults()
 		{
-			Uint64 gpu_frequency = 0;
-			gfx->GetTimestampFrequency(gpu_frequency);
-			Uint64 current_backbuffer_index = gfx->GetBackbufferIndex();
-			for (auto const& [_, index] : name_to_index_map)
+			//results can be requested several times per frame, scopes finished since the last call join the same frame
+			if (!current_timestamps) current_timestamps = std::make_shared<FrameTimestamps>();
+			std::shared_ptr<FrameTimestamps> const& frame_timestamps = current_timestamps;
+			GfxReadbackManager* readback_manager = gfx->GetReadbackManager();
+			for (auto const& [name, index] : name_to_index_map)
 			{
 				ADRIA_ASSERT(index < MAX_PROFILES);
 				QueryData& profile_data = query_data[index];
-				if (profile_data.query_started && profile_data.query_finished)
+				if (profile_data.query_started && profile_data.query_finished && !profile_data.readback_requested)
 				{
-					Uint32 begin_query_index = Uint32(index * 2);
-					Uint32 end_query_index = Uint32(index * 2 + 1);
-					Uint64 readback_offset = ((current_backbuffer_index * MAX_PROFILES * 2) + begin_query_index) * sizeof(Uint64);
+					profile_data.readback_requested = true;
+					Uint32 const timestamp_index = (Uint32)frame_timestamps->names.size();
+					frame_timestamps->names.push_back(name);
+					frame_timestamps->times_ms.push_back(0.0f);
+
 					ADRIA_ASSERT(profile_data.cmd_list);
-					profile_data.cmd_list->ResolveQueryData(*query_heap, begin_query_index, 2, *query_readback_buffer, readback_offset);
+					readback_manager->ReadbackQueryData(profile_data.cmd_list, *query_heap, Uint32(index * 2), 2,
+						[this, frame_timestamps, timestamp_index](void const* data, Uint64)
+						{
+							Uint64 const* timestamps = static_cast<Uint64 const*>(data);
+							Uint64 const delta = timestamps[1] - timestamps[0];
+							frame_timestamps->times_ms[timestamp_index] = (delta / Float(gpu_frequency)) * 1000.0f;
+							resolved_timestamps = frame_timestamps;
+						});
 				}
 			}
-			Uint64 const* query_timestamps = query_readback_buffer->GetMappedData<Uint64>();
-			Uint64 const* frame_query_timestamps = query_timestamps + (current_backbuffer_index * MAX_PROFILES * 2);
 
+			//the timestamps of a frame are resolved together, a few frames after they were recorded
 			std::vector<GfxTimestamp> results{};
-			results.reserve(name_to_index_map.size());
-			for (auto const& [name, index] : name_to_index_map)
+			if (!resolved_timestamps) return results;
+			results.reserve(resolved_timestamps->names.size());
+			for (Uint64 i = 0; i < resolved_timestamps->names.size(); ++i)
 			{
-				ADRIA_ASSERT(index < MAX_PROFILES);
-				QueryData& profile_data = query_data[index];
-				if (profile_data.query_started && profile_data.query_finished)
-				{
-					Uint64 start_time = frame_query_timestamps[index * 2 + 0];
-					Uint64 end_time = frame_query_timestamps[index * 2 + 1];
-
-					Uint64 delta = end_time - start_time;
-					Float frequency = Float(gpu_frequency);
-					Float time_ms = (delta / frequency) * 1000.0f;
-					results.emplace_back(time_ms, name);
-				}
+				results.emplace_back(resolved_timestamps->times_ms[i], resolved_timestamps->names[i]);
 			}
 			return results;
 		}
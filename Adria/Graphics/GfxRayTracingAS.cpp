@@ -55,8 +55,11 @@ namespace adria
 		}
 	}
 
-	GfxRayTracingBLAS::GfxRayTracingBLAS(GfxDevice* gfx, std::span<GfxRayTracingGeometry> geometries, GfxRayTracingASFlags flags)
+	GfxRayTracingBLAS::GfxRayTracingBLAS(GfxDevice* gfx, std::span<GfxRayTracingGeometry> geometries, GfxRayTracingASFlags flags, Uint64 compacted_size_address)
+		: gfx(gfx), flags(flags)
 	{
+		ADRIA_ASSERT(compacted_size_address == 0 || (flags & GfxRayTracingASFlag_AllowCompaction));
+
 		std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geo_descs; geo_descs.reserve(geometries.size());
 		for (auto&& geometry : geometries)	geo_descs.push_back(ConvertRayTracingGeometry(geometry));
 
@@ -75,6 +78,7 @@ namespace adria
 		GfxBufferDesc scratch_buffer_desc{};
 		scratch_buffer_desc.bind_flags = GfxBindFlag::UnorderedAccess;
 		scratch_buffer_desc.size = bl_prebuild_info.ScratchDataSizeInBytes;
+		if (flags & GfxRayTracingASFlag_AllowUpdate) scratch_buffer_desc.size = std::max(scratch_buffer_desc.size, bl_prebuild_info.UpdateScratchDataSizeInBytes);
 		scratch_buffer = gfx->CreateBuffer(scratch_buffer_desc);
 		scratch_buffer->SetName("scratch buffer");
 
@@ -84,31 +88,81 @@ namespace adria
 		result_buffer_desc.misc_flags = GfxBufferMiscFlag::AccelStruct;
 		result_buffer_desc.stride = 4;
 		result_buffer = gfx->CreateBuffer(result_buffer_desc);
-		scratch_buffer->SetName("result buffer");
+		result_buffer->SetName("result buffer");
 
 		D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC blas_desc{};
 		blas_desc.Inputs = inputs;
 		blas_desc.DestAccelerationStructureData = result_buffer->GetGpuAddress();
 		blas_desc.ScratchAccelerationStructureData = scratch_buffer->GetGpuAddress();
 
+		D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC postbuild_info_desc{};
+		postbuild_info_desc.InfoType = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE;
+		postbuild_info_desc.DestBuffer = compacted_size_address;
+
 		GfxCommandList* cmd_list = gfx->GetCommandList();
-		cmd_list->GetNative()->BuildRaytracingAccelerationStructure(&blas_desc, 0, nullptr);
+		cmd_list->GetNative()->BuildRaytracingAccelerationStructure(&blas_desc, compacted_size_address ? 1 : 0, compacted_size_address ? &postbuild_info_desc : nullptr);
+	}
+
+	GfxRayTracingBLAS::GfxRayTracingBLAS(GfxDevice* gfx, GfxRayTracingBLAS const& source, Uint64 compacted_size)
+		: gfx(gfx), flags(source.flags)
+	{
+		ADRIA_ASSERT(compacted_size > 0);
+
+		GfxBufferDesc result_buffer_desc{};
+		result_buffer_desc.bind_flags = GfxBindFlag::UnorderedAccess | GfxBindFlag::ShaderResource;
+		result_buffer_desc.size = compacted_size;
+		result_buffer_desc.misc_flags = GfxBufferMiscFlag::AccelStruct;
+		result_buffer_desc.stride = 4;
+		result_buffer = gfx->CreateBuffer(result_buffer_desc);
+		result_buffer->SetName("compacted result buffer");
+
+		GfxCommandList* cmd_list = gfx->GetCommandList();
+		cmd_list->GetNative()->CopyRaytracingAccelerationStructure(result_buffer->GetGpuAddress(), source.GetGpuAddress(),
+																   D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_COMPACT);
 	}
 
 	GfxRayTracingBLAS::~GfxRayTracingBLAS() = default;
 
+	void GfxRayTracingBLAS::Update(std::span<GfxRayTracingGeometry> geometries, Bool refit)
+	{
+		ADRIA_ASSERT(!refit || (flags & GfxRayTracingASFlag_AllowUpdate));
+		ADRIA_ASSERT_MSG(scratch_buffer != nullptr, "Compacted BLAS cannot be updated");
+
+		std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geo_descs; geo_descs.reserve(geometries.size());
+		for (auto&& geometry : geometries)	geo_descs.push_back(ConvertRayTracingGeometry(geometry));
+
+		D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC blas_desc{};
+		blas_desc.Inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+		blas_desc.Inputs.Flags = ConvertASFlags(refit ? flags | GfxRayTracingASFlag_PerformUpdate : flags);
+		blas_desc.Inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+		blas_desc.Inputs.NumDescs = (Uint32)geo_descs.size();
+		blas_desc.Inputs.pGeometryDescs = geo_descs.data();
+		blas_desc.SourceAccelerationStructureData = refit ? result_buffer->GetGpuAddress() : 0;
+		blas_desc.DestAccelerationStructureData = result_buffer->GetGpuAddress();
+		blas_desc.ScratchAccelerationStructureData = scratch_buffer->GetGpuAddress();
+
+		GfxCommandList* cmd_list = gfx->GetCommandList();
+		cmd_list->GetNative()->BuildRaytracingAccelerationStructure(&blas_desc, 0, nullptr);
+	}
+
 	Uint64 GfxRayTracingBLAS::GetGpuAddress() const
 	{
 		return result_buffer->GetGpuAddress();
 	}
 
+	Uint64 GfxRayTracingBLAS::GetMemorySize() const
+	{
+		return result_buffer->GetSize() + (scratch_buffer ? scratch_buffer->GetSize() : 0);
+	}
+
 	GfxRayTracingTLAS::GfxRayTracingTLAS(GfxDevice* gfx, std::span<GfxRayTracingInstance> instances, GfxRayTracingASFlags flags)
+		: gfx(gfx), flags(flags), instance_count((Uint32)instances.size())
 	{
 		// First, get the size of the TLAS buffers and create them
 		D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs{};
 		inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
 		inputs.Flags = ConvertASFlags(flags);
-		inputs.NumDescs = (Uint32)instances.size();
+		inputs.NumDescs = instance_count;
 		inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
 
 		D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO tl_prebuild_info;
@@ -118,6 +172,7 @@ namespace adria
 		GfxBufferDesc scratch_buffer_desc{};
 		scratch_buffer_desc.bind_flags = GfxBindFlag::UnorderedAccess;
 		scratch_buffer_desc.size = tl_prebuild_info.ScratchDataSizeInBytes;
+		if (flags & GfxRayTracingASFlag_AllowUpdate) scratch_buffer_desc.size = std::max(scratch_buffer_desc.size, tl_prebuild_info.UpdateScratchDataSizeInBytes);
 		scratch_buffer = gfx->CreateBuffer(scratch_buffer_desc);
 
 		GfxBufferDesc result_buffer_desc{};
@@ -126,11 +181,30 @@ namespace adria
 		result_buffer_desc.misc_flags = GfxBufferMiscFlag::AccelStruct;
 		result_buffer = gfx->CreateBuffer(result_buffer_desc);
 
-		GfxBufferDesc instance_buffer_desc{};
-		instance_buffer_desc.bind_flags = GfxBindFlag::None;
-		instance_buffer_desc.size = sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * instances.size();
-		instance_buffer_desc.resource_usage = GfxResourceUsage::Upload;
-		instance_buffer = gfx->CreateBuffer(instance_buffer_desc);
+		Build(instances, false);
+	}
+
+	GfxRayTracingTLAS::~GfxRayTracingTLAS() = default;
+
+	void GfxRayTracingTLAS::Update(std::span<GfxRayTracingInstance> instances, Bool refit)
+	{
+		ADRIA_ASSERT(instances.size() == instance_count);
+		ADRIA_ASSERT(!refit || (flags & GfxRayTracingASFlag_AllowUpdate));
+		current_instance_buffer = (current_instance_buffer + 1) % GFX_BACKBUFFER_COUNT;
+		Build(instances, refit);
+	}
+
+	void GfxRayTracingTLAS::Build(std::span<GfxRayTracingInstance> instances, Bool refit)
+	{
+		std::unique_ptr<GfxBuffer>& instance_buffer = instance_buffers[current_instance_buffer];
+		if (!instance_buffer)
+		{
+			GfxBufferDesc instance_buffer_desc{};
+			instance_buffer_desc.bind_flags = GfxBindFlag::None;
+			instance_buffer_desc.size = sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * std::max<Uint64>(instance_count, 1);
+			instance_buffer_desc.resource_usage = GfxResourceUsage::Upload;
+			instance_buffer = gfx->CreateBuffer(instance_buffer_desc);
+		}
 
 		D3D12_RAYTRACING_INSTANCE_DESC* p_instance_desc = instance_buffer->GetMappedData<D3D12_RAYTRACING_INSTANCE_DESC>();
 		for (Uint64 i = 0; i < instances.size(); ++i)
@@ -142,11 +216,14 @@ namespace adria
 			p_instance_desc[i].AccelerationStructure = instances[i].blas->GetGpuAddress();
 			p_instance_desc[i].InstanceMask = instances[i].instance_mask;
 		}
-		instance_buffer->Unmap();
 
 		D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC tlas_desc{};
-		tlas_desc.Inputs = inputs;
+		tlas_desc.Inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+		tlas_desc.Inputs.Flags = ConvertASFlags(refit ? flags | GfxRayTracingASFlag_PerformUpdate : flags);
+		tlas_desc.Inputs.NumDescs = instance_count;
+		tlas_desc.Inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
 		tlas_desc.Inputs.InstanceDescs = instance_buffer->GetGpuAddress();
+		tlas_desc.SourceAccelerationStructureData = refit ? result_buffer->GetGpuAddress() : 0;
 		tlas_desc.DestAccelerationStructureData = result_buffer->GetGpuAddress();
 		tlas_desc.ScratchAccelerationStructureData = scratch_buffer->GetGpuAddress();
 
@@ -154,12 +231,17 @@ namespace adria
 		cmd_list->GetNative()->BuildRaytracingAccelerationStructure(&tlas_desc, 0, nullptr);
 	}
 
-	GfxRayTracingTLAS::~GfxRayTracingTLAS() = default;
-
 	Uint64 GfxRayTracingTLAS::GetGpuAddress() const
 	{
 		return result_buffer->GetGpuAddress();
 	}
 
+	Uint64 GfxRayTracingTLAS::GetMemorySize() const
+	{
+		Uint64 memory_size = result_buffer->GetSize() + scratch_buffer->GetSize();
+		for (auto const& instance_buffer : instance_buffers) memory_size += instance_buffer ? instance_buffer->GetSize() : 0;
+		return memory_size;
+	}
+
 }
 
@@ -2,6 +2,7 @@
 #include <span>
 #include <memory>
 #include "GfxFormat.h"
+#include "GfxMacros.h"
 
 namespace adria
 {
@@ -51,14 +52,25 @@ namespace adria
 	class GfxRayTracingBLAS
 	{
 	public:
-		GfxRayTracingBLAS(GfxDevice* gfx, std::span<GfxRayTracingGeometry> geometries, GfxRayTracingASFlags flags);
+		//compacted_size_address: optional gpu address (UAV, 8 bytes) that receives the compacted size, requires GfxRayTracingASFlag_AllowCompaction
+		GfxRayTracingBLAS(GfxDevice* gfx, std::span<GfxRayTracingGeometry> geometries, GfxRayTracingASFlags flags, Uint64 compacted_size_address = 0);
+		//records a compacting copy of source, source has to stay alive until the copy has executed
+		GfxRayTracingBLAS(GfxDevice* gfx, GfxRayTracingBLAS const& source, Uint64 compacted_size);
 		~GfxRayTracingBLAS();
 
+		//records an in-place refit (refit = true, requires GfxRayTracingASFlag_AllowUpdate) or rebuild of a non-compacted BLAS.
+		//geometries have to match the ones the BLAS was created with, only the vertex data is allowed to change
+		void Update(std::span<GfxRayTracingGeometry> geometries, Bool refit);
+
 		Uint64 GetGpuAddress() const;
+		Uint64 GetMemorySize() const;
+		GfxRayTracingASFlags GetFlags() const { return flags; }
 		GfxBuffer const& GetBuffer() const { return *result_buffer; }
 		GfxBuffer const& operator*() const { return *result_buffer; }
 
 	private:
+		GfxDevice* gfx;
+		GfxRayTracingASFlags flags = GfxRayTracingASFlag_None;
 		std::unique_ptr<GfxBuffer> result_buffer;
 		std::unique_ptr<GfxBuffer> scratch_buffer;
 	};
@@ -79,14 +91,28 @@ namespace adria
 		GfxRayTracingTLAS(GfxDevice* gfx, std::span<GfxRayTracingInstance> instances, GfxRayTracingASFlags flags);
 		~GfxRayTracingTLAS();
 
+		//records an in-place refit (refit = true, requires GfxRayTracingASFlag_AllowUpdate) or rebuild of the TLAS.
+		//the instance count has to match the one the TLAS was created with, should be called at most once per frame
+		void Update(std::span<GfxRayTracingInstance> instances, Bool refit);
+
 		Uint64 GetGpuAddress() const;
+		Uint64 GetMemorySize() const;
+		GfxRayTracingASFlags GetFlags() const { return flags; }
+		Uint32 GetInstanceCount() const { return instance_count; }
 		GfxBuffer const& GetBuffer() const { return *result_buffer; }
 		GfxBuffer const& operator*() const { return *result_buffer; }
 
 	private:
+		GfxDevice* gfx;
+		GfxRayTracingASFlags flags = GfxRayTracingASFlag_None;
+		Uint32 instance_count = 0;
 		std::unique_ptr<GfxBuffer> result_buffer;
 		std::unique_ptr<GfxBuffer> scratch_buffer;
-		std::unique_ptr<GfxBuffer> instance_buffer;
-		void* instance_buffer_cpu_address = nullptr;
+		//instance descs are read by the build on the gpu, updates rotate through one buffer per frame in flight
+		std::unique_ptr<GfxBuffer> instance_buffers[GFX_BACKBUFFER_COUNT];
+		Uint32 current_instance_buffer = 0;
+
+	private:
+		void Build(std::span<GfxRayTracingInstance> instances, Bool refit);
 	};
 }
\ No newline at end of file
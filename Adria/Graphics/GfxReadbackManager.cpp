@@ -0,0 +1,99 @@
+#include "GfxReadbackManager.h"
+#include "GfxDevice.h"
+#include "GfxBuffer.h"
+#include "GfxQueryHeap.h"
+#include "GfxCommandList.h"
+#include "GfxCommandQueue.h"
+#include "Core/ConsoleManager.h"
+
+namespace adria
+{
+	static TAutoConsoleVariable<int> ReadbackLatency("rhi.ReadbackLatency", 1, "Minimum number of frames between a readback request and its callback, 1 resolves readbacks as soon as the gpu finishes them");
+
+	GfxReadbackManager::GfxReadbackManager(GfxDevice* gfx, Uint64 page_size)
+		: gfx(gfx), scheduler(page_size, (Uint32)std::max(ReadbackLatency.Get(), 1))
+	{
+		fence.Create(gfx, "Readback Manager Fence");
+	}
+
+	GfxReadbackManager::~GfxReadbackManager()
+	{
+		std::lock_guard<std::recursive_mutex> guard(readback_mutex);
+		fence.Wait(fence_value);
+		scheduler.Reset();
+	}
+
+	GfxReadbackTicket GfxReadbackManager::ReadbackBuffer(GfxCommandList* cmd_list, GfxBuffer const& src, Uint64 src_offset, Uint64 size, GfxReadbackCallback&& callback)
+	{
+		ADRIA_ASSERT(src_offset + size <= src.GetSize());
+		std::lock_guard<std::recursive_mutex> guard(readback_mutex);
+		ReadbackAllocation const allocation = scheduler.Allocate(size, sizeof(Uint32), std::move(callback));
+		GfxBuffer& page = AllocatePage(allocation);
+		cmd_list->CopyBuffer(page, allocation.offset, src, src_offset, size);
+		return allocation.ticket;
+	}
+
+	GfxReadbackTicket GfxReadbackManager::ReadbackBuffer(GfxCommandList* cmd_list, GfxBuffer const& src, GfxReadbackCallback&& callback)
+	{
+		return ReadbackBuffer(cmd_list, src, 0, src.GetSize(), std::move(callback));
+	}
+
+	std::future<std::vector<Uint8>> GfxReadbackManager::ReadbackBufferAsync(GfxCommandList* cmd_list, GfxBuffer const& src, Uint64 src_offset, Uint64 size)
+	{
+		std::promise<std::vector<Uint8>> promise;
+		std::future<std::vector<Uint8>> future = promise.get_future();
+		ReadbackBuffer(cmd_list, src, src_offset, size, [promise = std::move(promise)](void const* data, Uint64 data_size) mutable
+			{
+				Uint8 const* bytes = static_cast<Uint8 const*>(data);
+				promise.set_value(std::vector<Uint8>(bytes, bytes + data_size));
+			});
+		return future;
+	}
+
+	GfxReadbackTicket GfxReadbackManager::ReadbackQueryData(GfxCommandList* cmd_list, GfxQueryHeap const& query_heap, Uint32 start, Uint32 count, GfxReadbackCallback&& callback)
+	{
+		std::lock_guard<std::recursive_mutex> guard(readback_mutex);
+		//resolved query data has to be 8 byte aligned
+		ReadbackAllocation const allocation = scheduler.Allocate(count * sizeof(Uint64), sizeof(Uint64), std::move(callback));
+		GfxBuffer& page = AllocatePage(allocation);
+		cmd_list->ResolveQueryData(query_heap, start, count, page, allocation.offset);
+		return allocation.ticket;
+	}
+
+	Bool GfxReadbackManager::Cancel(GfxReadbackTicket ticket)
+	{
+		std::lock_guard<std::recursive_mutex> guard(readback_mutex);
+		return scheduler.Cancel(ticket);
+	}
+
+	void GfxReadbackManager::Submit(GfxCommandQueue& queue)
+	{
+		std::lock_guard<std::recursive_mutex> guard(readback_mutex);
+		queue.Signal(fence, ++fence_value);
+		scheduler.Submit(fence_value);
+	}
+
+	void GfxReadbackManager::Update()
+	{
+		//callbacks can request new readbacks from the same thread
+		std::lock_guard<std::recursive_mutex> guard(readback_mutex);
+		scheduler.SetLatency((Uint32)std::max(ReadbackLatency.Get(), 1));
+		scheduler.Update(fence.GetCompletedValue(), [this](Uint32 page) -> void const* { return pages[page]->GetMappedData(); });
+
+		for (Uint32 i = 0; i < scheduler.GetPageCount(); ++i)
+		{
+			if (!scheduler.IsPageAllocated(i) && pages[i]) pages[i].reset();
+		}
+	}
+
+	GfxBuffer& GfxReadbackManager::AllocatePage(ReadbackAllocation const& allocation)
+	{
+		if (allocation.new_page)
+		{
+			if (pages.size() <= allocation.page) pages.resize(allocation.page + 1);
+			pages[allocation.page] = gfx->CreateBuffer(ReadBackBufferDesc(scheduler.GetPageSize(allocation.page)));
+			ADRIA_ASSERT(pages[allocation.page]->IsMapped());
+		}
+		return *pages[allocation.page];
+	}
+}
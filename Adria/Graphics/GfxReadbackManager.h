@@ -0,0 +1,55 @@
+#pragma once
+#include <mutex>
+#include <future>
+#include "GfxFence.h"
+#include "Utilities/ReadbackScheduler.h"
+
+namespace adria
+{
+	class GfxDevice;
+	class GfxBuffer;
+	class GfxQueryHeap;
+	class GfxCommandList;
+	class GfxCommandQueue;
+
+	using GfxReadbackTicket = ReadbackTicket;
+	using GfxReadbackCallback = ReadbackCallback;
+
+	//one service for all gpu to cpu readbacks. the copy is recorded into the given command list, into pooled readback pages,
+	//and the callback runs on the thread that calls Update a few frames later, once the fence of the frame has passed.
+	//requests never wait for the gpu. callbacks of requests that are cancelled or still pending when the manager is destroyed
+	//are never called, owners that are destroyed earlier have to cancel their requests
+	class GfxReadbackManager
+	{
+	public:
+		GfxReadbackManager(GfxDevice* gfx, Uint64 page_size);
+		ADRIA_NONCOPYABLE_NONMOVABLE(GfxReadbackManager)
+		~GfxReadbackManager();
+
+		//src has to be in the copy source state
+		GfxReadbackTicket ReadbackBuffer(GfxCommandList* cmd_list, GfxBuffer const& src, Uint64 src_offset, Uint64 size, GfxReadbackCallback&& callback);
+		GfxReadbackTicket ReadbackBuffer(GfxCommandList* cmd_list, GfxBuffer const& src, GfxReadbackCallback&& callback);
+		std::future<std::vector<Uint8>> ReadbackBufferAsync(GfxCommandList* cmd_list, GfxBuffer const& src, Uint64 src_offset, Uint64 size);
+		//resolved query data, e.g. 64 bit timestamps
+		GfxReadbackTicket ReadbackQueryData(GfxCommandList* cmd_list, GfxQueryHeap const& query_heap, Uint32 start, Uint32 count, GfxReadbackCallback&& callback);
+		Bool Cancel(GfxReadbackTicket ticket);
+
+		//closes the frame, call after the command lists of the frame were executed on queue
+		void Submit(GfxCommandQueue& queue);
+		//runs the callbacks of the finished readbacks and releases pages that were not used for a while, call once per frame
+		void Update();
+
+		ReadbackSchedulerStats const& GetStats() const { return scheduler.GetStats(); }
+
+	private:
+		GfxDevice* gfx;
+		ReadbackScheduler scheduler;
+		std::vector<std::unique_ptr<GfxBuffer>> pages;
+		GfxFence fence;
+		Uint64 fence_value = 0;
+		std::recursive_mutex readback_mutex;
+
+	private:
+		GfxBuffer& AllocatePage(ReadbackAllocation const& allocation);
+	};
+}
@@ -211,6 +211,7 @@ namespace adria
 		if (HasFlag(flags, IndexBuffer))	sync |= D3D12_BARRIER_SYNC_INDEX_INPUT;
 		if (HasFlag(flags, IndirectArgs))	sync |= D3D12_BARRIER_SYNC_EXECUTE_INDIRECT;
 		if (HasAnyFlag(flags, AllAS))		sync |= D3D12_BARRIER_SYNC_BUILD_RAYTRACING_ACCELERATION_STRUCTURE;
+		if (HasFlag(flags, ASRead))			sync |= D3D12_BARRIER_SYNC_RAYTRACING;
 		return sync;
 	}
 	inline D3D12_BARRIER_LAYOUT ToD3D12BarrierLayout(GfxResourceState flags)
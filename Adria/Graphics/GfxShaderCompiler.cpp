@@ -1,6 +1,7 @@
 #pragma comment(lib, "dxcompiler.lib")
 #include <d3dcompiler.h>
 #include <filesystem>
+#include <atomic>
 #include "dxcapi.h"
 #include "cereal/archives/binary.hpp"
 #include "cereal/types/string.hpp"
@@ -19,15 +20,44 @@ namespace adria
 {
 	namespace
 	{
-		Ref<IDxcLibrary> library = nullptr;
-		Ref<IDxcCompiler3> compiler = nullptr;
-		Ref<IDxcUtils> utils = nullptr;
-		Ref<IDxcIncludeHandler> include_handler = nullptr;
+		struct DxcContext
+		{
+			Ref<IDxcLibrary> library = nullptr;
+			Ref<IDxcCompiler3> compiler = nullptr;
+			Ref<IDxcUtils> utils = nullptr;
+			Ref<IDxcIncludeHandler> include_handler = nullptr;
+		};
+
+		//dxc objects must not be used by several threads at the same time, so every thread that compiles gets its own context.
+		//contexts are owned here and released in Destroy, the generation invalidates the thread local pointers
+		std::mutex dxc_context_mutex;
+		std::vector<std::unique_ptr<DxcContext>> dxc_contexts;
+		std::atomic<Uint32> dxc_context_generation = 0;
+
+		DxcContext& GetDxcContext()
+		{
+			thread_local DxcContext* thread_context = nullptr;
+			thread_local Uint32 thread_context_generation = 0;
+			Uint32 const generation = dxc_context_generation.load(std::memory_order_acquire);
+			if (!thread_context || thread_context_generation != generation)
+			{
+				std::unique_ptr<DxcContext> context = std::make_unique<DxcContext>();
+				GFX_CHECK_HR(DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(context->library.GetAddressOf())));
+				GFX_CHECK_HR(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(context->compiler.GetAddressOf())));
+				GFX_CHECK_HR(context->library->CreateIncludeHandler(context->include_handler.GetAddressOf()));
+				GFX_CHECK_HR(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(context->utils.GetAddressOf())));
+
+				std::lock_guard lock(dxc_context_mutex);
+				thread_context = dxc_contexts.emplace_back(std::move(context)).get();
+				thread_context_generation = generation;
+			}
+			return *thread_context;
+		}
 	}
 	class GfxIncludeHandler : public IDxcIncludeHandler
 	{
 	public:
-		GfxIncludeHandler() {}
+		explicit GfxIncludeHandler(DxcContext& context) : context(context) {}
 
 		HRESULT STDMETHODCALLTYPE LoadSource(_In_ LPCWSTR pFilename, _COM_Outptr_result_maybenull_ IDxcBlob** ppIncludeSource) override
 		{
@@ -52,13 +82,13 @@ namespace adria
 			if (already_included)
 			{
 				static const Char nullStr[] = " ";
-				utils->CreateBlob(nullStr, ARRAYSIZE(nullStr), CP_UTF8, encoding.GetAddressOf());
+				context.utils->CreateBlob(nullStr, ARRAYSIZE(nullStr), CP_UTF8, encoding.GetAddressOf());
 				*ppIncludeSource = encoding.Detach();
 				return S_OK;
 			}
 
 			std::wstring winclude_file = ToWideString(include_file);
-			HRESULT hr = utils->LoadFile(winclude_file.c_str(), nullptr, encoding.GetAddressOf());
+			HRESULT hr = context.utils->LoadFile(winclude_file.c_str(), nullptr, encoding.GetAddressOf());
 			if (SUCCEEDED(hr))
 			{
 				include_files.push_back(include_file);
@@ -70,13 +100,16 @@ namespace adria
 		}
 		HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, _COM_Outptr_ void __RPC_FAR* __RPC_FAR* ppvObject) override
 		{
-			return include_handler->QueryInterface(riid, ppvObject);
+			return context.include_handler->QueryInterface(riid, ppvObject);
 		}
 
 		ULONG STDMETHODCALLTYPE AddRef(void) override { return 1; }
 		ULONG STDMETHODCALLTYPE Release(void) override { return 1; }
 
 		std::vector<std::string> include_files;
+
+	private:
+		DxcContext& context;
 	};
 	
 	inline constexpr std::wstring GetTarget(GfxShaderStage stage, GfxShaderModel model)
@@ -195,19 +228,14 @@ namespace adria
 
 		void Initialize()
 		{
-			GFX_CHECK_HR(DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(library.GetAddressOf())));
-			GFX_CHECK_HR(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(compiler.GetAddressOf())));
-			GFX_CHECK_HR(library->CreateIncludeHandler(include_handler.GetAddressOf()));
-			GFX_CHECK_HR(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(utils.GetAddressOf())));
-
+			std::ignore = GetDxcContext();
 			std::filesystem::create_directory(paths::ShaderPDBDir);
 		}
 		void Destroy()
 		{
-			include_handler.Reset();
-			compiler.Reset();
-			library.Reset();
-			utils.Reset();
+			std::lock_guard lock(dxc_context_mutex);
+			dxc_contexts.clear();
+			dxc_context_generation.fetch_add(1, std::memory_order_release);
 		}
 		Bool CompileShader(GfxShaderCompileInput const& input, GfxShaderCompileOutput& output, Bool bypass_cache)
 		{
@@ -226,12 +254,13 @@ namespace adria
 			if (!bypass_cache && CheckCache(cache_path, input, output)) return true;
 			ADRIA_LOG(INFO, "Shader '%s.%s' not found in cache. Compiling...", input.file.c_str(), input.entry_point.c_str());
 
+			DxcContext& context = GetDxcContext();
 			compile:
 			Uint32 code_page = CP_UTF8;
 			Ref<IDxcBlobEncoding> source_blob;
 
 			std::wstring shader_source = ToWideString(input.file);
-			HRESULT hr = library->CreateBlobFromFile(shader_source.data(), &code_page, source_blob.GetAddressOf());
+			HRESULT hr = context.library->CreateBlobFromFile(shader_source.data(), &code_page, source_blob.GetAddressOf());
 			GFX_CHECK_HR(hr);
 
 			std::wstring name = ToWideString(GetFilenameWithoutExtension(input.file));
@@ -287,10 +316,10 @@ namespace adria
 			source_buffer.Ptr = source_blob->GetBufferPointer();
 			source_buffer.Size = source_blob->GetBufferSize();
 			source_buffer.Encoding = DXC_CP_ACP;
-			GfxIncludeHandler custom_include_handler{};
+			GfxIncludeHandler custom_include_handler(context);
 
 			Ref<IDxcResult> result;
-			hr = compiler->Compile(
+			hr = context.compiler->Compile(
 				&source_buffer,
 				compile_args.data(), (Uint32)compile_args.size(),
 				&custom_include_handler,
@@ -321,7 +350,7 @@ namespace adria
 				if (SUCCEEDED(result->GetOutput(DXC_OUT_PDB, IID_PPV_ARGS(pdb_blob.GetAddressOf()), pdb_path_utf16.GetAddressOf())))
 				{
 					Ref<IDxcBlobUtf8> pdb_path_utf8;
-					if (SUCCEEDED(utils->GetBlobAsUtf8(pdb_path_utf16.Get(), pdb_path_utf8.GetAddressOf())))
+					if (SUCCEEDED(context.utils->GetBlobAsUtf8(pdb_path_utf16.Get(), pdb_path_utf8.GetAddressOf())))
 					{
 						Char pdb_path[256];
 						sprintf_s(pdb_path, "%s%s", paths::ShaderPDBDir.c_str(), pdb_path_utf8->GetStringPointer());
@@ -354,7 +383,7 @@ namespace adria
 			std::wstring wide_filename = ToWideString(filename);
 			Uint32 code_page = CP_UTF8;
 			Ref<IDxcBlobEncoding> source_blob;
-			HRESULT hr = library->CreateBlobFromFile(wide_filename.data(), &code_page, source_blob.GetAddressOf());
+			HRESULT hr = GetDxcContext().library->CreateBlobFromFile(wide_filename.data(), &code_page, source_blob.GetAddressOf());
 			GFX_CHECK_HR(hr);
 			blob.resize(source_blob->GetBufferSize());
 			memcpy(blob.data(), source_blob->GetBufferPointer(), source_blob->GetBufferSize());
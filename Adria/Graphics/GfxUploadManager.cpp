@@ -0,0 +1,152 @@
+#include "GfxUploadManager.h"
+#include "GfxDevice.h"
+#include "GfxBuffer.h"
+#include "GfxCommandList.h"
+
+namespace adria
+{
+	GfxUploadManager::GfxUploadManager(GfxDevice* gfx, Uint64 staging_size, Uint64 chunk_size)
+		: gfx(gfx), staging_ring(staging_size), chunk_size(chunk_size), batch_size_limit(staging_size / 4)
+	{
+		//chunks up to a quarter of the ring always fit into an empty ring, wherever its head is
+		ADRIA_ASSERT(chunk_size > 0 && chunk_size <= staging_size / 4);
+
+		GfxBufferDesc staging_desc{};
+		staging_desc.size = staging_size;
+		staging_desc.resource_usage = GfxResourceUsage::Upload;
+		staging_buffer = gfx->CreateBuffer(staging_desc);
+		ADRIA_ASSERT(staging_buffer->IsMapped());
+		staging_data = static_cast<Uint8*>(staging_buffer->GetMappedData());
+
+		fence.Create(gfx, "Upload Manager Fence");
+	}
+
+	GfxUploadManager::~GfxUploadManager()
+	{
+		std::lock_guard<std::mutex> guard(upload_mutex);
+		if (current_batch.cmd_list) SubmitBatch();
+		fence.Wait(current_ticket - 1);
+	}
+
+	GfxUploadTicket GfxUploadManager::UploadBuffer(GfxBuffer& dst, Uint64 dst_offset, void const* data, Uint64 size)
+	{
+		std::lock_guard<std::mutex> guard(upload_mutex);
+		if (size == 0) return GetLastTicket();
+
+		Uint8 const* src_data = static_cast<Uint8 const*>(data);
+		for (Uint64 uploaded_size = 0; uploaded_size < size;)
+		{
+			Uint64 const upload_chunk_size = std::min(chunk_size, size - uploaded_size);
+			OffsetType const staging_offset = AllocateStaging(upload_chunk_size);
+			if (!current_batch.cmd_list) BeginBatch();
+
+			memcpy(staging_data + staging_offset, src_data + uploaded_size, upload_chunk_size);
+			current_batch.cmd_list->CopyBuffer(dst, dst_offset + uploaded_size, *staging_buffer, staging_offset, upload_chunk_size);
+			current_batch_size += upload_chunk_size;
+			uploaded_size += upload_chunk_size;
+
+			stats.uploaded_size += upload_chunk_size;
+			stats.peak_staging_usage = std::max<Uint64>(stats.peak_staging_usage, staging_ring.UsedSize());
+
+			//submit early so that the copy queue works while the caller keeps loading
+			if (current_batch_size >= batch_size_limit)
+			{
+				GfxUploadTicket const ticket = current_ticket;
+				SubmitBatch();
+				if (uploaded_size == size) return ticket;
+			}
+		}
+		return current_ticket;
+	}
+
+	GfxUploadTicket GfxUploadManager::Submit()
+	{
+		std::lock_guard<std::mutex> guard(upload_mutex);
+		if (current_batch.cmd_list) SubmitBatch();
+		ReleaseCompletedBatches();
+		return current_ticket - 1;
+	}
+
+	Bool GfxUploadManager::IsCompleted(GfxUploadTicket ticket)
+	{
+		return fence.GetCompletedValue() >= ticket;
+	}
+
+	void GfxUploadManager::Wait(GfxUploadTicket ticket)
+	{
+		std::lock_guard<std::mutex> guard(upload_mutex);
+		if (current_batch.cmd_list && ticket >= current_ticket) SubmitBatch();
+		fence.Wait(ticket);
+		ReleaseCompletedBatches();
+	}
+
+	void GfxUploadManager::Wait(GfxCommandList* cmd_list, GfxUploadTicket ticket)
+	{
+		std::lock_guard<std::mutex> guard(upload_mutex);
+		if (ticket == 0 || fence.GetCompletedValue() >= ticket) return;
+		if (current_batch.cmd_list && ticket >= current_ticket) SubmitBatch();
+		cmd_list->Wait(fence, ticket);
+	}
+
+	void GfxUploadManager::BeginBatch()
+	{
+		if (!free_cmd_lists.empty())
+		{
+			current_batch.cmd_list = std::move(free_cmd_lists.back());
+			free_cmd_lists.pop_back();
+		}
+		else
+		{
+			current_batch.cmd_list = std::make_unique<GfxCommandList>(gfx, GfxCommandListType::Copy, "Upload Manager Command List");
+		}
+		current_batch.ticket = current_ticket;
+		current_batch.cmd_list->ResetAllocator();
+		current_batch.cmd_list->Begin();
+		current_batch_size = 0;
+	}
+
+	void GfxUploadManager::SubmitBatch()
+	{
+		ADRIA_ASSERT(current_batch.cmd_list);
+		current_batch.cmd_list->End();
+		current_batch.cmd_list->Signal(fence, current_batch.ticket);
+		current_batch.cmd_list->Submit();
+		staging_ring.FinishCurrentFrame(current_batch.ticket);
+
+		in_flight_batches.push(std::move(current_batch));
+		current_batch = UploadBatch{};
+		current_batch_size = 0;
+		++current_ticket;
+		++stats.submitted_batches;
+	}
+
+	void GfxUploadManager::ReleaseCompletedBatches()
+	{
+		Uint64 const completed_value = fence.GetCompletedValue();
+		while (!in_flight_batches.empty() && in_flight_batches.front().ticket <= completed_value)
+		{
+			free_cmd_lists.push_back(std::move(in_flight_batches.front().cmd_list));
+			in_flight_batches.pop();
+		}
+		staging_ring.ReleaseCompletedFrames(completed_value);
+	}
+
+	OffsetType GfxUploadManager::AllocateStaging(Uint64 size)
+	{
+		ReleaseCompletedBatches();
+		OffsetType offset = staging_ring.Allocate(size);
+		if (offset != INVALID_OFFSET) return offset;
+
+		//the ring is full: submit what was recorded so far and wait for the oldest batches until there is space
+		if (current_batch.cmd_list) SubmitBatch();
+		++stats.staging_stalls;
+		while (offset == INVALID_OFFSET)
+		{
+			ADRIA_ASSERT(!in_flight_batches.empty());
+			fence.Wait(in_flight_batches.front().ticket);
+			ReleaseCompletedBatches();
+			offset = staging_ring.Allocate(size);
+		}
+		return offset;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <mutex>
+#include <queue>
+#include "GfxFence.h"
+#include "Utilities/RingAllocator.h"
+
+namespace adria
+{
+	class GfxDevice;
+	class GfxBuffer;
+	class GfxCommandList;
+
+	//fence value of the batch that contains an upload, 0 is always complete
+	using GfxUploadTicket = Uint64;
+
+	struct GfxUploadManagerStats
+	{
+		Uint64 uploaded_size = 0;
+		Uint64 peak_staging_usage = 0;
+		Uint32 submitted_batches = 0;
+		Uint32 staging_stalls = 0;
+	};
+
+	//uploads buffer data through a fixed size staging ring on the copy queue.
+	//large uploads are split into chunks and batches are submitted as they fill up, so uploading overlaps with loading
+	//and staging memory stays bounded by the ring size. staging space is recycled when the batch fence is reached,
+	//and the caller stalls only when the whole ring is still in flight
+	class GfxUploadManager
+	{
+		struct UploadBatch
+		{
+			std::unique_ptr<GfxCommandList> cmd_list;
+			GfxUploadTicket ticket;
+		};
+
+	public:
+		GfxUploadManager(GfxDevice* gfx, Uint64 staging_size, Uint64 chunk_size);
+		ADRIA_NONCOPYABLE_NONMOVABLE(GfxUploadManager)
+		~GfxUploadManager();
+
+		//dst has to be in the common state, the copy queue promotes it to copy destination
+		GfxUploadTicket UploadBuffer(GfxBuffer& dst, Uint64 dst_offset, void const* data, Uint64 size);
+		//submits the batch that is being recorded, returns the ticket of the last upload
+		GfxUploadTicket Submit();
+
+		Bool IsCompleted(GfxUploadTicket ticket);
+		//cpu wait
+		void Wait(GfxUploadTicket ticket);
+		//gpu wait, the commands of cmd_list are executed after the upload is finished
+		void Wait(GfxCommandList* cmd_list, GfxUploadTicket ticket);
+
+		GfxUploadTicket GetLastTicket() const { return current_ticket - (current_batch.cmd_list ? 0 : 1); }
+		GfxUploadManagerStats const& GetStats() const { return stats; }
+
+	private:
+		GfxDevice* gfx;
+		std::unique_ptr<GfxBuffer> staging_buffer;
+		Uint8* staging_data = nullptr;
+		RingAllocator staging_ring;
+		Uint64 chunk_size;
+		Uint64 batch_size_limit;
+
+		GfxFence fence;
+		GfxUploadTicket current_ticket = 1;
+		UploadBatch current_batch;
+		Uint64 current_batch_size = 0;
+		std::queue<UploadBatch> in_flight_batches;
+		std::vector<std::unique_ptr<GfxCommandList>> free_cmd_lists;
+
+		std::mutex upload_mutex;
+		GfxUploadManagerStats stats;
+
+	private:
+		void BeginBatch();
+		void SubmitBatch();
+		void ReleaseCompletedBatches();
+		OffsetType AllocateStaging(Uint64 size);
+	};
+}
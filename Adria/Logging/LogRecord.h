@@ -0,0 +1,229 @@
+#pragma once
+#include <cstring>
+#include <cstdio>
+#include <array>
+#include <utility>
+#include <type_traits>
+
+namespace adria
+{
+	enum class LogLevel : Uint8
+	{
+		LOG_DEBUG,
+		LOG_INFO,
+		LOG_WARNING,
+		LOG_ERROR
+	};
+
+	enum LogRecordFlags : Uint8
+	{
+		LogRecordFlag_None = 0x0,
+		LogRecordFlag_HeapMessage = 0x1,	//payload holds a Char* to a preformatted message owned by the record
+	};
+
+	//fixed-size record pushed through the log ring. Arguments are captured by value and formatted on the log thread,
+	//string arguments (and non-literal format strings) are copied into the payload so the record owns everything it needs
+	struct LogRecord
+	{
+		static constexpr Uint64 PayloadSize = 216;
+		using FormatFn = Sint32(*)(LogRecord const&, Char*, Uint64);
+
+		LogLevel level;
+		Uint8 flags;
+		Uint16 format_offset;
+		Uint32 line;
+		Char const* file;
+		Char const* format;
+		FormatFn format_fn;
+		alignas(8) Uint8 payload[PayloadSize];
+
+		Char const* GetFormat() const
+		{
+			return format ? format : reinterpret_cast<Char const*>(payload + format_offset);
+		}
+	};
+	static_assert(std::is_trivially_copyable_v<LogRecord>);
+
+	namespace log_detail
+	{
+		template<typename T>
+		concept LogStringArg = std::is_pointer_v<std::decay_t<T>> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<std::decay_t<T>>>, Char>;
+
+		template<typename T>
+		concept LogWideStringArg = std::is_pointer_v<std::decay_t<T>> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<std::decay_t<T>>>, wchar_t>;
+
+		template<typename T>
+		using LogArgStorage = std::conditional_t<LogStringArg<T>, Uint16, std::decay_t<T>>;
+
+		template<typename... Args>
+		constexpr std::array<Uint64, sizeof...(Args) + 1> LogArgOffsets()
+		{
+			std::array<Uint64, sizeof...(Args) + 1> offsets{};
+			Uint64 sizes[] = { sizeof(LogArgStorage<Args>)..., 0 };
+			for (Uint64 i = 0; i < sizeof...(Args); ++i) offsets[i + 1] = offsets[i] + sizes[i];
+			return offsets;
+		}
+
+		template<typename T>
+		auto ReadLogArg(LogRecord const& record, Uint64 offset)
+		{
+			LogArgStorage<T> value;
+			std::memcpy(&value, record.payload + offset, sizeof(value));
+			if constexpr (LogStringArg<T>) return reinterpret_cast<Char const*>(record.payload + value);
+			else return value;
+		}
+
+		template<typename... Args, Uint64... Is>
+		Sint32 FormatLogRecordImpl(LogRecord const& record, Char* buffer, Uint64 buffer_size, std::index_sequence<Is...>)
+		{
+			static constexpr auto offsets = LogArgOffsets<Args...>();
+			return snprintf(buffer, buffer_size, record.GetFormat(), ReadLogArg<Args>(record, offsets[Is])...);
+		}
+
+		template<typename... Args>
+		Sint32 FormatLogRecord(LogRecord const& record, Char* buffer, Uint64 buffer_size)
+		{
+			return FormatLogRecordImpl<Args...>(record, buffer, buffer_size, std::index_sequence_for<Args...>{});
+		}
+
+		inline Sint32 FormatLogMessage(LogRecord const& record, Char* buffer, Uint64 buffer_size)
+		{
+			Char const* message = nullptr;
+			if (record.flags & LogRecordFlag_HeapMessage) std::memcpy(&message, record.payload, sizeof(Char const*));
+			else message = record.GetFormat();
+			return snprintf(buffer, buffer_size, "%s", message);
+		}
+
+		//Char* arguments are copied as strings, which is only safe for %s conversions without a precision, the buffer
+		//might not be terminated otherwise. any other conversion (%p) or a '*' width makes the caller format on its thread
+		template<typename... Args>
+		Bool LogStringArgsMatchFormat(Char const* fmt)
+		{
+			static constexpr Bool is_string_arg[] = { LogStringArg<Args>..., false };
+			Uint64 arg = 0;
+			for (Char const* c = fmt; *c; ++c)
+			{
+				if (*c != '%') continue;
+				if (*++c == '%') continue;
+				while (*c == '-' || *c == '+' || *c == ' ' || *c == '#' || *c == '0') ++c;
+				if (*c == '*') return false;
+				while (*c >= '0' && *c <= '9') ++c;
+				Bool const has_precision = *c == '.';
+				if (has_precision)
+				{
+					if (*++c == '*') return false;
+					while (*c >= '0' && *c <= '9') ++c;
+				}
+				while (*c == 'h' || *c == 'l' || *c == 'j' || *c == 'z' || *c == 't' || *c == 'L') ++c;
+				if (*c == '\0') return false;
+				if (arg < sizeof...(Args) && is_string_arg[arg] && (*c != 's' || has_precision)) return false;
+				++arg;
+			}
+			return true;
+		}
+
+		class LogRecordWriter
+		{
+		public:
+			LogRecordWriter(LogRecord& record, Uint64 string_offset) : record(record), string_offset(string_offset) {}
+
+			Bool WriteString(Char const* str, Uint16& offset)
+			{
+				if (!str) str = "(null)";
+				Uint64 const length = std::strlen(str) + 1;
+				if (string_offset + length > LogRecord::PayloadSize) return false;
+				std::memcpy(record.payload + string_offset, str, length);
+				offset = static_cast<Uint16>(string_offset);
+				string_offset += length;
+				return true;
+			}
+
+			template<typename T>
+			Bool WriteArg(T const& arg, Uint64 offset)
+			{
+				if constexpr (LogStringArg<T>)
+				{
+					Uint16 string_offset = 0;
+					if (!WriteString(arg, string_offset)) return false;
+					std::memcpy(record.payload + offset, &string_offset, sizeof(Uint16));
+				}
+				else
+				{
+					static_assert(std::is_trivially_copyable_v<T>, "ADRIA_LOG arguments must be trivially copyable or strings");
+					std::memcpy(record.payload + offset, &arg, sizeof(T));
+				}
+				return true;
+			}
+
+		private:
+			LogRecord& record;
+			Uint64 string_offset;
+		};
+
+		//string literal formats are stored as pointers, everything else, including Char arrays, is copied into the payload.
+		//returns false if the arguments did not fit (or contain wide strings), the caller then formats on the calling thread
+		template<Bool FormatIsLiteral, typename Fmt, typename... Args>
+		Bool EncodeLogRecord(LogRecord& record, Fmt const& fmt, Args const&... args)
+		{
+			static constexpr auto offsets = LogArgOffsets<Args...>();
+			if constexpr (offsets.back() > LogRecord::PayloadSize || (LogWideStringArg<Args> || ...))
+			{
+				return false;
+			}
+			else
+			{
+				if constexpr ((LogStringArg<Args> || ...))
+				{
+					if (!LogStringArgsMatchFormat<Args...>(fmt)) return false;
+				}
+
+				LogRecordWriter writer(record, offsets.back());
+				if constexpr (FormatIsLiteral && std::is_array_v<Fmt>)
+				{
+					record.format = fmt;
+					record.format_fn = &FormatLogRecord<Args...>;
+				}
+				else
+				{
+					record.format = nullptr;
+					if (!writer.WriteString(fmt, record.format_offset)) return false;
+					record.format_fn = sizeof...(Args) > 0 ? &FormatLogRecord<Args...> : &FormatLogMessage;
+				}
+				return [&]<Uint64... Is>(std::index_sequence<Is...>)
+				{
+					return (writer.WriteArg(args, offsets[Is]) && ...);
+				}(std::index_sequence_for<Args...>{});
+			}
+		}
+
+		template<typename Fmt, typename... Args>
+		void EncodeLogRecordHeapMessage(LogRecord& record, Fmt const& fmt, Args const&... args)
+		{
+			Char* message = nullptr;
+			if constexpr (sizeof...(Args) == 0 && !std::is_array_v<Fmt>)
+			{
+				Uint64 const size = std::strlen(fmt) + 1;
+				message = new Char[size];
+				std::memcpy(message, fmt, size);
+			}
+			else
+			{
+				Uint64 const size = snprintf(nullptr, 0, fmt, args...) + 1;
+				message = new Char[size];
+				snprintf(message, size, fmt, args...);
+			}
+			record.flags |= LogRecordFlag_HeapMessage;
+			record.format = nullptr;
+			record.format_fn = &FormatLogMessage;
+			std::memcpy(record.payload, &message, sizeof(Char*));
+		}
+
+		inline void FreeLogRecordHeapMessage(LogRecord const& record)
+		{
+			if (!(record.flags & LogRecordFlag_HeapMessage)) return;
+			Char* message = nullptr;
+			std::memcpy(&message, record.payload, sizeof(Char*));
+			delete[] message;
+		}
+	}
+}
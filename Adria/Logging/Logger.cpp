@@ -3,26 +3,34 @@
 #include <ctime>   
 #include <vector>
 #include <thread>
-#include "Utilities/ConcurrentQueue.h"
+#include <atomic>
 
 namespace adria
 {
-	struct QueueEntry
-	{
-		LogLevel level;
-		std::string str;
-		std::string filename;
-		Uint32 line;
-	};
-
+	//bounded multi-producer single-consumer ring of fixed-size records, each slot carries a sequence number
+	//that tells producers and the consumer whether it is free or published for the current lap
 	class LogManagerImpl
 	{
+		static constexpr Uint64 RingSize = 4096;
+		static_assert((RingSize & (RingSize - 1)) == 0, "RingSize must be a power of two");
+
+		struct alignas(64) Slot
+		{
+			std::atomic<Uint64> sequence;
+			LogRecord record;
+		};
+
 	public:
 
-		LogManagerImpl() : log_thread(&LogManagerImpl::ProcessLogs, this) {}
+		LogManagerImpl() : slots(new Slot[RingSize])
+		{
+			for (Uint64 i = 0; i < RingSize; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+			log_thread = std::thread(&LogManagerImpl::ProcessLogs, this);
+		}
 		~LogManagerImpl()
 		{
 			exit.store(true);
+			WakeConsumer();
 			log_thread.join();
 		}
 
@@ -30,28 +38,129 @@ namespace adria
 		{
 			loggers.emplace_back(logger);
 		}
-		void Log(LogLevel level, Char const* str, Char const* filename, Uint32 line)
+		void SetOverflowPolicy(LogOverflowPolicy policy)
+		{
+			overflow_policy.store(policy, std::memory_order_relaxed);
+		}
+		Uint64 GetDroppedCount() const
+		{
+			return total_dropped.load(std::memory_order_relaxed);
+		}
+
+		void Push(LogRecord const& record)
+		{
+			Uint64 position = enqueue_position.load(std::memory_order_relaxed);
+			while (true)
+			{
+				Slot& slot = slots[position & (RingSize - 1)];
+				Uint64 const sequence = slot.sequence.load(std::memory_order_acquire);
+				Sint64 const diff = (Sint64)sequence - (Sint64)position;
+				if (diff == 0)
+				{
+					if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						slot.record = record;
+						slot.sequence.store(position + 1, std::memory_order_seq_cst);
+						if (consumer_waiting.load(std::memory_order_seq_cst)) WakeConsumer();
+						return;
+					}
+				}
+				else if (diff < 0)
+				{
+					if (overflow_policy.load(std::memory_order_relaxed) == LogOverflowPolicy::Drop)
+					{
+						log_detail::FreeLogRecordHeapMessage(record);
+						dropped.fetch_add(1, std::memory_order_relaxed);
+						total_dropped.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+					if (consumer_waiting.load(std::memory_order_seq_cst)) WakeConsumer();
+					std::this_thread::yield();
+					position = enqueue_position.load(std::memory_order_relaxed);
+				}
+				else
+				{
+					position = enqueue_position.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		void Flush()
 		{
-			log_queue.Push(QueueEntry{ level, str, filename, line });
+			Uint64 const target = enqueue_position.load(std::memory_order_acquire);
+			while (processed.load(std::memory_order_acquire) < target) std::this_thread::yield();
 		}
 
+	private:
 		std::vector<std::unique_ptr<ILogger>> loggers;
-		ConcurrentQueue<QueueEntry> log_queue;
-		std::thread log_thread;
+		std::unique_ptr<Slot[]> slots;
+		alignas(64) std::atomic<Uint64> enqueue_position = 0;
+		alignas(64) std::atomic<Uint64> processed = 0;
+		std::atomic<Uint64> dropped = 0;
+		std::atomic<Uint64> total_dropped = 0;
+		std::atomic<Uint32> wake_counter = 0;
+		std::atomic_bool consumer_waiting = false;
+		std::atomic<LogOverflowPolicy> overflow_policy = LogOverflowPolicy::Block;
 		std::atomic_bool exit = false;
+		std::thread log_thread;
+		std::vector<Char> format_buffer = std::vector<Char>(1024);
 
 	private:
+		void WakeConsumer()
+		{
+			wake_counter.fetch_add(1, std::memory_order_seq_cst);
+			wake_counter.notify_one();
+		}
+
+		Bool TryProcessRecord(Uint64 position)
+		{
+			Slot& slot = slots[position & (RingSize - 1)];
+			if (slot.sequence.load(std::memory_order_seq_cst) != position + 1) return false;
+
+			LogRecord const& record = slot.record;
+			Sint32 length = record.format_fn(record, format_buffer.data(), format_buffer.size());
+			if (length >= (Sint32)format_buffer.size())
+			{
+				format_buffer.resize(length + 1);
+				length = record.format_fn(record, format_buffer.data(), format_buffer.size());
+			}
+			Char const* message = length >= 0 ? format_buffer.data() : record.GetFormat();
+			for (auto&& logger : loggers) if (logger) logger->Log(record.level, message, record.file, record.line);
+			log_detail::FreeLogRecordHeapMessage(record);
+
+			slot.sequence.store(position + RingSize, std::memory_order_release);
+			processed.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		void ReportDroppedRecords()
+		{
+			Uint64 const dropped_count = dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped_count == 0) return;
+
+			snprintf(format_buffer.data(), format_buffer.size(), "%llu log messages were dropped because the log queue was full", dropped_count);
+			for (auto&& logger : loggers) if (logger) logger->Log(LogLevel::LOG_WARNING, format_buffer.data(), __FILE__, __LINE__);
+		}
+
 		void ProcessLogs()
 		{
-			QueueEntry entry{};
+			Uint64 position = 0;
 			while (true)
 			{
-				Bool success = log_queue.TryPop(entry);
-				if (success)
+				if (TryProcessRecord(position))
 				{
-					for (auto&& logger : loggers) if (logger) logger->Log(entry.level, entry.str.c_str(), entry.filename.c_str(), entry.line);
+					++position;
+					continue;
 				}
-				if (exit.load() && log_queue.Empty()) break;
+				ReportDroppedRecords();
+				if (exit.load()) break;
+
+				Uint32 const wake_ticket = wake_counter.load(std::memory_order_seq_cst);
+				consumer_waiting.store(true, std::memory_order_seq_cst);
+				Bool const processed_record = TryProcessRecord(position);
+				if (!processed_record && !exit.load()) wake_counter.wait(wake_ticket, std::memory_order_seq_cst);
+				consumer_waiting.store(false, std::memory_order_seq_cst);
+				if (processed_record) ++position;
 			}
 		}
 	};
@@ -92,12 +201,32 @@ namespace adria
 		pimpl->RegisterLogger(logger);
 	}
 
+	void LogManager::SetOverflowPolicy(LogOverflowPolicy policy)
+	{
+		pimpl->SetOverflowPolicy(policy);
+	}
+
+	Uint64 LogManager::GetDroppedCount() const
+	{
+		return pimpl->GetDroppedCount();
+	}
+
+	void LogManager::Flush()
+	{
+		pimpl->Flush();
+	}
+
 	void LogManager::Log(LogLevel level, Char const* str, Char const* filename, Uint32 line)
 	{
-		pimpl->Log(level, str, filename, line);
+		LogFormat(level, filename, line, str);
 	}
 	void LogManager::Log(LogLevel level, Char const* str, std::source_location location /*= std::source_location::current()*/)
 	{
 		Log(level, str, location.file_name(), location.line());
 	}
+
+	void LogManager::Push(LogRecord const& record)
+	{
+		pimpl->Push(record);
+	}
 }
\ No newline at end of file
@@ -1,19 +1,15 @@
 #pragma once
-#include <memory> 
+#include <memory>
 #include <string>
 #include <source_location>
+#include "LogRecord.h"
+
+#ifndef ADRIA_LOG_MIN_LEVEL
+#define ADRIA_LOG_MIN_LEVEL LOG_DEBUG
+#endif
 
 namespace adria
 {
-
-	enum class LogLevel : Uint8
-	{
-		LOG_DEBUG,
-		LOG_INFO,
-		LOG_WARNING,
-		LOG_ERROR
-	};
-
 	std::string LevelToString(LogLevel type);
 	std::string GetLogTime();
 	std::string LineInfoToString(Char const* file, Uint32 line);
@@ -25,6 +21,12 @@ namespace adria
 		virtual void Log(LogLevel level, Char const* entry, Char const* file, Uint32 line) = 0;
 	};
 
+	enum class LogOverflowPolicy : Uint8
+	{
+		Block,	//producers wait for the log thread to free a slot
+		Drop	//records are dropped and reported by the log thread once it catches up
+	};
+
 	class LogManager
 	{
 	public:
@@ -33,20 +35,46 @@ namespace adria
 		~LogManager();
 
 		void Register(ILogger* logger);
+		void SetOverflowPolicy(LogOverflowPolicy policy);
+		Uint64 GetDroppedCount() const;
+		void Flush();
+
 		void Log(LogLevel level, Char const* str, Char const* file, Uint32 line);
 		void Log(LogLevel level, Char const* str, std::source_location location = std::source_location::current());
 
+		//file is expected to point to a string with static storage duration (__FILE__).
+		//only a string literal format is kept as a pointer, ADRIA_LOG tells literals apart from named Char arrays
+		template<Bool FormatIsLiteral = false, typename Fmt, typename... Args>
+		void LogFormat(LogLevel level, Char const* file, Uint32 line, Fmt const& fmt, Args const&... args)
+		{
+			LogRecord record;
+			record.level = level;
+			record.flags = LogRecordFlag_None;
+			record.format_offset = 0;
+			record.line = line;
+			record.file = file;
+			if (!log_detail::EncodeLogRecord<FormatIsLiteral>(record, fmt, args...))
+			{
+				log_detail::EncodeLogRecordHeapMessage(record, fmt, args...);
+			}
+			Push(record);
+		}
+
 	private:
 		std::unique_ptr<class LogManagerImpl> pimpl;
+
+	private:
+		void Push(LogRecord const& record);
 	};
 	inline LogManager g_Log{};
 
-	#define ADRIA_LOG(level, ... ) [&]()  \
+	//decltype of a string literal is a reference to an array, decltype of a named array is the array type itself
+	#define ADRIA_LOG(level, fmt, ... ) [&]()  \
 	{ \
-		Uint64 const size = snprintf(nullptr, 0, __VA_ARGS__) + 1; \
-		std::unique_ptr<char[]> buf = std::make_unique<char[]>(size); \
-		snprintf(buf.get(), size, __VA_ARGS__); \
-		g_Log.Log(LogLevel::LOG_##level, buf.get(), __FILE__, __LINE__);  \
+		if constexpr (LogLevel::LOG_##level >= LogLevel::ADRIA_LOG_MIN_LEVEL) \
+		{ \
+			g_Log.LogFormat<std::is_reference_v<decltype(fmt)>>(LogLevel::LOG_##level, __FILE__, __LINE__, fmt __VA_OPT__(,) __VA_ARGS__); \
+		} \
 	}()
 
 }
\ No newline at end of file
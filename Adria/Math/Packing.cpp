@@ -40,4 +40,82 @@ namespace adria
 		Uint32 packed_value = (static_cast<Uint32>(value1) << 16) | static_cast<Uint32>(value2);
 		return packed_value;
 	}
+	Vector2 UnpackTwoFloatsFromUint32(Uint32 packed)
+	{
+		DirectX::PackedVector::XMHALF2 half2(packed);
+		return Vector2(DirectX::PackedVector::XMConvertHalfToFloat(half2.x), DirectX::PackedVector::XMConvertHalfToFloat(half2.y));
+	}
+
+	namespace
+	{
+		Float SignNotZero(Float v)
+		{
+			return v >= 0.0f ? 1.0f : -1.0f;
+		}
+
+		Vector2 EncodeOctahedron(Vector3 n)
+		{
+			Float const l1_norm = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+			if (l1_norm == 0.0f) return Vector2(0.0f, 0.0f);
+			n /= l1_norm;
+			if (n.z >= 0.0f) return Vector2(n.x, n.y);
+			return Vector2((1.0f - std::abs(n.y)) * SignNotZero(n.x), (1.0f - std::abs(n.x)) * SignNotZero(n.y));
+		}
+
+		Vector3 DecodeOctahedron(Vector2 f)
+		{
+			Vector3 n(f.x, f.y, 1.0f - std::abs(f.x) - std::abs(f.y));
+			Float const t = Clamp(-n.z);
+			n.x += n.x >= 0.0f ? -t : t;
+			n.y += n.y >= 0.0f ? -t : t;
+			n.Normalize();
+			return n;
+		}
+
+		Uint32 QuantizeUnorm(Float v, Float max_value)
+		{
+			return (Uint32)std::lround(Clamp(v) * max_value);
+		}
+	}
+
+	Uint64 QuantizePosition(Vector3 const& position, Vector3 const& bias, Vector3 const& scale)
+	{
+		auto Quantize = [](Float p, Float b, Float s) -> Uint64
+			{
+				return s > 0.0f ? QuantizeUnorm((p - b) / s, 65535.0f) : 0;
+			};
+		Uint64 const x = Quantize(position.x, bias.x, scale.x);
+		Uint64 const y = Quantize(position.y, bias.y, scale.y);
+		Uint64 const z = Quantize(position.z, bias.z, scale.z);
+		return x | (y << 16) | (z << 32);
+	}
+	Vector3 DequantizePosition(Uint64 packed, Vector3 const& bias, Vector3 const& scale)
+	{
+		Vector3 const unorm(Float(packed & 0xffff), Float((packed >> 16) & 0xffff), Float((packed >> 32) & 0xffff));
+		return bias + unorm / 65535.0f * scale;
+	}
+
+	Uint32 EncodeNormal16x2(Vector3 const& normal)
+	{
+		Vector2 const v = EncodeOctahedron(normal) * 0.5f + Vector2(0.5f, 0.5f);
+		return (QuantizeUnorm(v.x, 65535.0f) << 16) | QuantizeUnorm(v.y, 65535.0f);
+	}
+	Vector3 DecodeNormal16x2(Uint32 packed)
+	{
+		Vector2 const n(Float(packed >> 16) / 65535.0f, Float(packed & 0xffff) / 65535.0f);
+		return DecodeOctahedron(n * 2.0f - Vector2(1.0f, 1.0f));
+	}
+
+	Uint32 EncodeTangent15x2(Vector4 const& tangent)
+	{
+		Vector2 const v = EncodeOctahedron(Vector3(tangent.x, tangent.y, tangent.z)) * 0.5f + Vector2(0.5f, 0.5f);
+		Uint32 const sign = tangent.w < 0.0f ? 1u : 0u;
+		return (sign << 31) | (QuantizeUnorm(v.x, 32767.0f) << 15) | QuantizeUnorm(v.y, 32767.0f);
+	}
+	Vector4 DecodeTangent15x2(Uint32 packed)
+	{
+		Vector2 const n(Float((packed >> 15) & 0x7fff) / 32767.0f, Float(packed & 0x7fff) / 32767.0f);
+		Vector3 const t = DecodeOctahedron(n * 2.0f - Vector2(1.0f, 1.0f));
+		return Vector4(t.x, t.y, t.z, (packed >> 31) ? -1.0f : 1.0f);
+	}
 }
@@ -15,4 +15,16 @@ namespace adria
 	Uint64 PackFourFloatsToUint64(Float x, Float y, Float z, Float w);
 
 	Uint32 PackTwoUint16ToUint32(Uint16 value1, Uint16 value2);
+	Vector2 UnpackTwoFloatsFromUint32(Uint32 packed);
+
+	//vertex attribute encodings, the decode functions mirror the ones in Packing.hlsli
+	//positions are 16 bit unorm relative to a bounding box (bias = min corner, scale = size), x and y in the low uint, z in the high one
+	Uint64 QuantizePosition(Vector3 const& position, Vector3 const& bias, Vector3 const& scale);
+	Vector3 DequantizePosition(Uint64 packed, Vector3 const& bias, Vector3 const& scale);
+	//octahedral normal with 16 bits per component
+	Uint32 EncodeNormal16x2(Vector3 const& normal);
+	Vector3 DecodeNormal16x2(Uint32 packed);
+	//octahedral tangent with 15 bits per component and the bitangent sign in the highest bit
+	Uint32 EncodeTangent15x2(Vector4 const& tangent);
+	Vector4 DecodeTangent15x2(Uint32 packed);
 }
\ No newline at end of file
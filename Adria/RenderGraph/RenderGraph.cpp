@@ -9,7 +9,10 @@
 #include "Graphics/GfxTracyProfiler.h"
 #include "Utilities/StringUtil.h"
 #include "Utilities/FilesUtil.h"
+#include "Utilities/JsonUtil.h"
+#include "Utilities/Timer.h"
 #include "Core/Paths.h"
+#include "Core/ConsoleManager.h"
 #include "Logging/Logger.h"
 
 
@@ -23,11 +26,33 @@ namespace adria
 {
 	extern Bool dump_render_graph = false;
 
+	static TAutoConsoleVariable<int> RenderGraphSchedule("r.RenderGraph.Schedule", 0, "0 - Dependency level order, 1 - Reorder passes to minimize peak transient memory, 2 - Same as 1 and log the memory peaks");
+	static TAutoConsoleVariable<int> RenderGraphScheduleBudget("r.RenderGraph.ScheduleBudget", 100000, "Maximum number of candidate passes evaluated by the scheduler before it falls back to the dependency level order");
+	static TAutoConsoleVariable<int> RenderGraphExportStats("r.RenderGraph.ExportStats", 0, "0 - Off, 1 - Export the statistics of the next frame to Saved/RenderGraph/rendergraph_stats.json, 2 - Export them every frame");
+
+	namespace
+	{
+		Uint64 GetTextureSize(GfxTextureDesc const& desc)
+		{
+			return GetTextureByteSize(desc.format, desc.width, desc.height, std::max(desc.depth, 1u), desc.mip_levels) * desc.array_size;
+		}
+	}
+
+	RenderGraph::RenderGraph(RGResourcePool& pool) : pool(pool), gfx(pool.GetDevice()), allocator(pool.GetFrameAllocator()), allocator_scope(allocator), blackboard(allocator),
+		passes(&allocator), textures(&allocator), buffers(&allocator),
+		adjacency_lists(&allocator), topologically_sorted_passes(&allocator), dependency_levels(&allocator),
+		texture_name_id_map(&allocator), buffer_name_id_map(&allocator), buffer_uav_counter_map(&allocator),
+		texture_view_desc_map(&allocator), texture_view_map(&allocator), buffer_view_desc_map(&allocator), buffer_view_map(&allocator), stats(&allocator)
+	{
+	}
+
 	RGTextureId RenderGraph::DeclareTexture(RGResourceName name, RGTextureDesc const& desc)
 	{
 		ADRIA_ASSERT_MSG(texture_name_id_map.find(name) == texture_name_id_map.end(), "Texture with that name has already been declared");
 		GfxTextureDesc tex_desc{}; InitGfxTextureDesc(desc, tex_desc);
-		textures.emplace_back(new RGTexture(textures.size(), tex_desc, name));
+		textures.push_back(allocator.New<RGTexture>(textures.size(), tex_desc, name));
+		texture_view_desc_map.resize(textures.size());
+		texture_view_map.resize(textures.size());
 		texture_name_id_map[name] = RGTextureId(textures.size() - 1);
 		return RGTextureId(textures.size() - 1);
 	}
@@ -36,7 +61,9 @@ namespace adria
 	{
 		ADRIA_ASSERT_MSG(buffer_name_id_map.find(name) == buffer_name_id_map.end(), "Buffer with that name has already been declared");
 		GfxBufferDesc buf_desc{}; InitGfxBufferDesc(desc, buf_desc);
-		buffers.emplace_back(new RGBuffer(buffers.size(), buf_desc, name));
+		buffers.push_back(allocator.New<RGBuffer>(buffers.size(), buf_desc, name));
+		buffer_view_desc_map.resize(buffers.size());
+		buffer_view_map.resize(buffers.size());
 		buffer_name_id_map[name] = RGBufferId(buffers.size() - 1);
 		return RGBufferId(buffers.size() - 1);
 	}
@@ -54,16 +81,20 @@ namespace adria
 	void RenderGraph::ImportTexture(RGResourceName name, GfxTexture* texture)
 	{
 		ADRIA_ASSERT(texture);
-		textures.emplace_back(new RGTexture(textures.size(), texture, name));
+		textures.push_back(allocator.New<RGTexture>(textures.size(), texture, name));
 		textures.back()->SetName();
+		texture_view_desc_map.resize(textures.size());
+		texture_view_map.resize(textures.size());
 		texture_name_id_map[name] = RGTextureId(textures.size() - 1);
 	}
 
 	void RenderGraph::ImportBuffer(RGResourceName name, GfxBuffer* buffer)
 	{
 		ADRIA_ASSERT(buffer);
-		buffers.emplace_back(new RGBuffer(buffers.size(), buffer, name));
+		buffers.push_back(allocator.New<RGBuffer>(buffers.size(), buffer, name));
 		buffers.back()->SetName();
+		buffer_view_desc_map.resize(buffers.size());
+		buffer_view_map.resize(buffers.size());
 		buffer_name_id_map[name] = RGBufferId(buffers.size() - 1);
 	}
 
@@ -91,7 +122,7 @@ namespace adria
 
 	RenderGraph::~RenderGraph()
 	{
-		for (auto& [tex_id, view_vector] : texture_view_map)
+		for (auto& view_vector : texture_view_map)
 		{
 			for (auto [view, type] : view_vector)
 			{
@@ -111,7 +142,7 @@ namespace adria
 			}
 		}
 
-		for (auto& [buf_id, view_vector] : buffer_view_map)
+		for (auto& view_vector : buffer_view_map)
 		{
 			for (auto [view, type] : view_vector) gfx->FreeDescriptorCPU(view, GfxDescriptorHeapType::CBV_SRV_UAV);
 		}
@@ -119,12 +150,16 @@ namespace adria
 
 	void RenderGraph::Build()
 	{
+		Timer<std::chrono::microseconds> build_timer;
 		BuildAdjacencyLists();
 		TopologicalSort();
 		BuildDependencyLevels();
 		CullPasses();
+		if (RenderGraphSchedule.Get()) OptimizeSchedule();
 		CalculateResourcesLifetime();
 		for (auto& dependency_level : dependency_levels) dependency_level.Setup();
+		stats.build_time_ms = build_timer.Elapsed() / 1000.0;
+		CalculateStats();
 		if (dump_render_graph) Dump("rendergraph.gv");
 	}
 
@@ -135,6 +170,16 @@ namespace adria
 #else
 		Execute_Singlethreaded();
 #endif
+		stats.pool = pool.GetStats();
+		if (Sint32 const export_stats = RenderGraphExportStats.Get(); export_stats > 0)
+		{
+			ExportStats("rendergraph_stats.json");
+			if (export_stats == 1)
+			{
+				ADRIA_LOG(INFO, "[RenderGraph] Statistics written to %srendergraph_stats.json", paths::RenderGraphDir.c_str());
+				RenderGraphExportStats->Set(0);
+			}
+		}
 	}
 
 	void RenderGraph::Execute_Singlethreaded()
@@ -295,7 +340,7 @@ namespace adria
 		for (Uint64 i = 0; i < passes.size(); ++i)
 		{
 			auto& pass = passes[i];
-			std::vector<Uint64>& pass_adjacency_list = adjacency_lists[i];
+			RGVector<Uint64>& pass_adjacency_list = adjacency_lists[i];
 			for (Uint64 j = i + 1; j < passes.size(); ++j)
 			{
 				auto& other_pass = passes[j];
@@ -325,8 +370,7 @@ namespace adria
 
 	void RenderGraph::TopologicalSort()
 	{
-		std::vector<Uint64> sort{};
-		std::vector<Bool>  visited(passes.size(), false);
+		RGVector<Bool> visited(passes.size(), false, &allocator);
 		for (Uint64 i = 0; i < passes.size(); i++)
 		{
 			if (visited[i] == false) DepthFirstSearch(i, visited, topologically_sorted_passes);
@@ -336,7 +380,7 @@ namespace adria
 
 	void RenderGraph::BuildDependencyLevels()
 	{
-		std::vector<Uint64> distances(topologically_sorted_passes.size(), 0);
+		RGVector<Uint64> distances(topologically_sorted_passes.size(), 0, &allocator);
 		for (Uint64 u = 0; u < topologically_sorted_passes.size(); ++u)
 		{
 			Uint64 i = topologically_sorted_passes[u];
@@ -346,11 +390,13 @@ namespace adria
 			}
 		}
 
-		dependency_levels.resize(*std::max_element(std::begin(distances), std::end(distances)) + 1, DependencyLevel(*this));
+		Uint64 const dependency_level_count = *std::max_element(std::begin(distances), std::end(distances)) + 1;
+		dependency_levels.reserve(dependency_level_count);
+		for (Uint64 i = 0; i < dependency_level_count; ++i) dependency_levels.emplace_back(*this);
 		for (Uint64 i = 0; i < passes.size(); ++i)
 		{
 			Uint64 level = distances[i];
-			dependency_levels[level].AddPass(passes[i].get());
+			dependency_levels[level].AddPass(passes[i]);
 		}
 	}
 
@@ -373,18 +419,18 @@ namespace adria
 			for (auto id : pass->texture_writes)
 			{
 				auto* written = GetRGTexture(id);
-				written->writer = pass.get();
+				written->writer = pass;
 			}
 			for (auto id : pass->buffer_writes)
 			{
 				auto* written = GetRGBuffer(id);
-				written->writer = pass.get();
+				written->writer = pass;
 			}
 		}
 
-		std::stack<RenderGraphResource*> zero_ref_resources;
-		for (auto& texture : textures) if (texture->ref_count == 0) zero_ref_resources.push(texture.get());
-		for (auto& buffer : buffers)   if (buffer->ref_count == 0) zero_ref_resources.push(buffer.get());
+		std::stack<RenderGraphResource*, RGVector<RenderGraphResource*>> zero_ref_resources{ RGVector<RenderGraphResource*>(&allocator) };
+		for (auto& texture : textures) if (texture->ref_count == 0) zero_ref_resources.push(texture);
+		for (auto& buffer : buffers)   if (buffer->ref_count == 0) zero_ref_resources.push(buffer);
 
 		while (!zero_ref_resources.empty())
 		{
@@ -409,6 +455,86 @@ namespace adria
 		}
 	}
 
+	void RenderGraph::OptimizeSchedule()
+	{
+		static constexpr Uint64 ScheduleBeamWidth = 4;
+
+		Uint64 const texture_count = textures.size();
+		RGScheduler scheduler(allocator, passes.size(), texture_count + buffers.size());
+		for (Uint64 i = 0; i < textures.size(); ++i)
+		{
+			if (textures[i]->imported) continue;
+			scheduler.SetResourceSize(i, GetTextureSize(textures[i]->desc));
+		}
+		for (Uint64 i = 0; i < buffers.size(); ++i)
+		{
+			if (!buffers[i]->imported) scheduler.SetResourceSize(texture_count + i, buffers[i]->desc.size);
+		}
+
+		for (Uint64 i = 0; i < passes.size(); ++i)
+		{
+			RGPassBase* pass = passes[i];
+			if (pass->IsCulled())
+			{
+				scheduler.ExcludePass(i);
+				continue;
+			}
+			for (RGTextureId id : pass->texture_creates) scheduler.SetResourceCreator(id.id, i);
+			for (RGBufferId id : pass->buffer_creates) scheduler.SetResourceCreator(texture_count + id.id, i);
+			for (auto const& [id, state] : pass->texture_state_map) scheduler.AddResourceAccess(i, id.id, state);
+			for (auto const& [id, state] : pass->buffer_state_map) scheduler.AddResourceAccess(i, texture_count + id.id, state);
+		}
+
+		//adjacency lists only contain read after write dependencies, passes touching the same resource otherwise
+		//rely on declaration order inside a dependency level so the scheduler has to keep that order as well
+		auto Conflicts = [](auto const& writes, auto const& reads_or_writes)
+			{
+				for (auto id : writes) if (reads_or_writes.contains(id)) return true;
+				return false;
+			};
+		for (Uint64 i = 0; i < passes.size(); ++i)
+		{
+			RGPassBase* pass = passes[i];
+			for (Uint64 j = i + 1; j < passes.size(); ++j)
+			{
+				RGPassBase* other_pass = passes[j];
+				if (Conflicts(pass->texture_writes, other_pass->texture_reads) || Conflicts(pass->texture_writes, other_pass->texture_writes) ||
+					Conflicts(other_pass->texture_writes, pass->texture_reads) || Conflicts(pass->buffer_writes, other_pass->buffer_reads) ||
+					Conflicts(pass->buffer_writes, other_pass->buffer_writes) || Conflicts(other_pass->buffer_writes, pass->buffer_reads))
+				{
+					scheduler.AddDependency(i, j);
+				}
+			}
+		}
+
+		RGVector<Uint64> pass_levels(passes.size(), 0, &allocator);
+		for (Uint64 level = 0; level < dependency_levels.size(); ++level)
+		{
+			for (RGPassBase* pass : dependency_levels[level].passes) pass_levels[pass->id] = level;
+		}
+
+		Bool const rescheduled = scheduler.Schedule(pass_levels, ScheduleBeamWidth, (Uint64)std::max(RenderGraphScheduleBudget.Get(), 0));
+		RGScheduleStats const& schedule_stats = stats.schedule = scheduler.GetStats();
+		if (RenderGraphSchedule.Get() > 1)
+		{
+			ADRIA_LOG(INFO, "[RenderGraph] Schedule %s: peak transient memory %.2f MB -> %.2f MB, barriers %u -> %u, levels %u -> %u%s",
+				rescheduled ? "applied" : "kept", schedule_stats.peak_bytes_before / (1024.0 * 1024.0), schedule_stats.peak_bytes_after / (1024.0 * 1024.0),
+				schedule_stats.barriers_before, schedule_stats.barriers_after, schedule_stats.levels_before, schedule_stats.levels_after,
+				schedule_stats.budget_exceeded ? " (search budget exceeded)" : "");
+		}
+		if (!rescheduled) return;
+
+		Uint64 const dependency_level_count = *std::max_element(pass_levels.begin(), pass_levels.end()) + 1;
+		dependency_levels.clear();
+		dependency_levels.reserve(dependency_level_count);
+		for (Uint64 i = 0; i < dependency_level_count; ++i) dependency_levels.emplace_back(*this);
+		for (Uint64 pass_index : scheduler.GetSchedule()) dependency_levels[pass_levels[pass_index]].AddPass(passes[pass_index]);
+		for (RGPassBase* pass : passes)
+		{
+			if (pass->IsCulled()) dependency_levels[pass_levels[pass->id]].AddPass(pass);
+		}
+	}
+
 	void RenderGraph::CalculateResourcesLifetime()
 	{
 		for (auto& dependency_level : dependency_levels)
@@ -456,7 +582,160 @@ namespace adria
 		}
 	}
 
-	void RenderGraph::DepthFirstSearch(Uint64 i, std::vector<Bool>& visited, std::vector<Uint64>& topologically_sorted_passes)
+	void RenderGraph::CalculateStats()
+	{
+		RGVector<Uint64> pass_levels(passes.size(), 0, &allocator);
+		for (Uint64 level = 0; level < dependency_levels.size(); ++level)
+		{
+			for (RGPassBase* pass : dependency_levels[level].passes) pass_levels[pass->id] = level;
+		}
+
+		stats.passes.reserve(passes.size());
+		for (RGPassBase* pass : passes)
+		{
+			RGPassStats& pass_stats = stats.passes.emplace_back(&allocator);
+			pass_stats.name = pass->name;
+			pass_stats.type = pass->type;
+			pass_stats.culled = pass->IsCulled();
+			pass_stats.dependency_level = (Uint32)pass_levels[pass->id];
+			//writes to existing resources are also added as reads, only report the resources that are read but not written
+			for (RGTextureId id : pass->texture_reads) if (!pass->texture_writes.contains(id)) pass_stats.textures_read.push_back(id.id);
+			for (RGTextureId id : pass->texture_writes) pass_stats.textures_written.push_back(id.id);
+			for (RGBufferId id : pass->buffer_reads) if (!pass->buffer_writes.contains(id)) pass_stats.buffers_read.push_back(id.id);
+			for (RGBufferId id : pass->buffer_writes) pass_stats.buffers_written.push_back(id.id);
+			if (pass_stats.culled) ++stats.culled_pass_count;
+		}
+		stats.dependency_level_count = (Uint32)dependency_levels.size();
+
+		stats.textures.reserve(textures.size());
+		for (RGTexture* texture : textures)
+		{
+			stats.textures.push_back(RenderGraphResourceStats{ .name = texture->name, .id = texture->id, .imported = texture->imported, .size = GetTextureSize(texture->desc) });
+		}
+		stats.buffers.reserve(buffers.size());
+		for (RGBuffer* buffer : buffers)
+		{
+			stats.buffers.push_back(RenderGraphResourceStats{ .name = buffer->name, .id = buffer->id, .imported = buffer->imported, .size = buffer->desc.size });
+		}
+
+		//transient resources live from the level that creates them until the level of their last use
+		RGVector<Sint64> level_bytes_delta(dependency_levels.size() + 1, 0, &allocator);
+		auto AddTransientResource = [&](Uint64 size, Uint64 first_level, RGPassBase* last_used_by)
+			{
+				Uint64 const last_level = last_used_by ? pass_levels[last_used_by->id] : dependency_levels.size() - 1;
+				level_bytes_delta[first_level] += (Sint64)size;
+				level_bytes_delta[last_level + 1] -= (Sint64)size;
+				stats.transient_bytes += size;
+			};
+
+		//mirrors the barriers Execute issues, they are attributed to the first pass of the level that accesses the resource
+		auto AddBarrier = [&](Uint64 pass_id)
+			{
+				++stats.passes[pass_id].barriers;
+				++stats.barrier_count;
+			};
+		for (Uint64 i = 0; i < dependency_levels.size(); ++i)
+		{
+			DependencyLevel& dependency_level = dependency_levels[i];
+			for (RGTextureId tex_id : dependency_level.texture_creates)
+			{
+				RGTexture* rg_texture = GetRGTexture(tex_id);
+				AddTransientResource(stats.textures[tex_id.id].size, i, rg_texture->last_used_by);
+				++stats.transient_texture_count;
+			}
+			for (RGBufferId buf_id : dependency_level.buffer_creates)
+			{
+				RGBuffer* rg_buffer = GetRGBuffer(buf_id);
+				AddTransientResource(stats.buffers[buf_id.id].size, i, rg_buffer->last_used_by);
+				++stats.transient_buffer_count;
+			}
+
+			for (auto const& [tex_id, state] : dependency_level.texture_state_map)
+			{
+				RGTexture* rg_texture = GetRGTexture(tex_id);
+				Bool barrier = false;
+				if (dependency_level.texture_creates.contains(tex_id))
+				{
+					barrier = !HasAllFlags(rg_texture->desc.initial_state, state);
+				}
+				else
+				{
+					Bool found = false;
+					for (Sint32 j = (Sint32)i - 1; j >= 0 && !found; --j)
+					{
+						auto& prev_dependency_level = dependency_levels[j];
+						if (prev_dependency_level.texture_state_map.contains(tex_id))
+						{
+							barrier = prev_dependency_level.texture_state_map[tex_id] != state;
+							found = true;
+						}
+					}
+					if (!found && rg_texture->imported) barrier = rg_texture->desc.initial_state != state;
+				}
+				if (!barrier) continue;
+				for (RGPassBase* pass : dependency_level.passes)
+				{
+					if (!pass->IsCulled() && pass->texture_state_map.contains(tex_id))
+					{
+						AddBarrier(pass->id);
+						break;
+					}
+				}
+			}
+			for (auto const& [buf_id, state] : dependency_level.buffer_state_map)
+			{
+				RGBuffer* rg_buffer = GetRGBuffer(buf_id);
+				Bool barrier = false;
+				if (dependency_level.buffer_creates.contains(buf_id))
+				{
+					barrier = state != GfxResourceState::Common;
+				}
+				else
+				{
+					Bool found = false;
+					for (Sint32 j = (Sint32)i - 1; j >= 0 && !found; --j)
+					{
+						auto& prev_dependency_level = dependency_levels[j];
+						if (prev_dependency_level.buffer_state_map.contains(buf_id))
+						{
+							barrier = prev_dependency_level.buffer_state_map[buf_id] != state;
+							found = true;
+						}
+					}
+					if (!found && rg_buffer->imported) barrier = state != GfxResourceState::Common;
+				}
+				if (!barrier) continue;
+				for (RGPassBase* pass : dependency_level.passes)
+				{
+					if (!pass->IsCulled() && pass->buffer_state_map.contains(buf_id))
+					{
+						AddBarrier(pass->id);
+						break;
+					}
+				}
+			}
+
+			for (RGTextureId tex_id : dependency_level.texture_destroys)
+			{
+				RGTexture* rg_texture = GetRGTexture(tex_id);
+				if (rg_texture->desc.initial_state != dependency_level.texture_state_map[tex_id]) AddBarrier(rg_texture->last_used_by->id);
+			}
+			for (RGBufferId buf_id : dependency_level.buffer_destroys)
+			{
+				RGBuffer* rg_buffer = GetRGBuffer(buf_id);
+				if (dependency_level.buffer_state_map[buf_id] != GfxResourceState::Common) AddBarrier(rg_buffer->last_used_by->id);
+			}
+		}
+
+		Sint64 live_bytes = 0;
+		for (Uint64 level = 0; level < dependency_levels.size(); ++level)
+		{
+			live_bytes += level_bytes_delta[level];
+			stats.peak_transient_bytes = std::max(stats.peak_transient_bytes, (Uint64)live_bytes);
+		}
+	}
+
+	void RenderGraph::DepthFirstSearch(Uint64 i, RGVector<Bool>& visited, RGVector<Uint64>& topologically_sorted_passes)
 	{
 		visited[i] = true;
 		for (auto j : adjacency_lists[i])
@@ -468,12 +747,12 @@ namespace adria
 
 	RGTexture* RenderGraph::GetRGTexture(RGTextureId handle) const
 	{
-		return textures[handle.id].get();
+		return textures[handle.id];
 	}
 
 	RGBuffer* RenderGraph::GetRGBuffer(RGBufferId handle) const
 	{
-		return buffers[handle.id].get();
+		return buffers[handle.id];
 	}
 
 	GfxTexture* RenderGraph::GetTexture(RGTextureId res_id) const
@@ -488,7 +767,7 @@ namespace adria
 
 	void RenderGraph::CreateTextureViews(RGTextureId res_id)
 	{
-		auto const& view_descs = texture_view_desc_map[res_id];
+		auto const& view_descs = texture_view_desc_map[res_id.id];
 		for (auto const& [view_desc, type] : view_descs)
 		{
 			GfxTexture* texture = GetTexture(res_id);
@@ -510,13 +789,13 @@ namespace adria
 			default:
 				ADRIA_ASSERT_MSG(false, "invalid resource view type for texture");
 			}
-			texture_view_map[res_id].emplace_back(view, type);
+			texture_view_map[res_id.id].emplace_back(view, type);
 		}
 	}
 
 	void RenderGraph::CreateBufferViews(RGBufferId res_id)
 	{
-		auto const& view_descs = buffer_view_desc_map[res_id];
+		auto const& view_descs = buffer_view_desc_map[res_id.id];
 		for (Uint64 i = 0; i < view_descs.size(); ++i)
 		{
 			auto const& [view_desc, type] = view_descs[i];
@@ -545,7 +824,7 @@ namespace adria
 			default:
 				ADRIA_ASSERT_MSG(false, "invalid resource view type for buffer");
 			}
-			buffer_view_map[res_id].emplace_back(view, type);
+			buffer_view_map[res_id.id].emplace_back(view, type);
 		}
 	}
 
@@ -671,7 +950,7 @@ namespace adria
 		{
 			rg_texture->desc.initial_state = GfxResourceState::RTV;
 		}
-		std::vector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>& view_descs = texture_view_desc_map[handle];
+		RGVector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>& view_descs = texture_view_desc_map[handle.id];
 		for (Uint64 i = 0; i < view_descs.size(); ++i)
 		{
 			auto const& [_desc, _type] = view_descs[i];
@@ -692,7 +971,7 @@ namespace adria
 		{
 			rg_texture->desc.initial_state = GfxResourceState::DSV;
 		}
-		std::vector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>& view_descs = texture_view_desc_map[handle];
+		RGVector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>& view_descs = texture_view_desc_map[handle.id];
 		for (Uint64 i = 0; i < view_descs.size(); ++i)
 		{
 			auto const& [_desc, _type] = view_descs[i];
@@ -713,7 +992,7 @@ namespace adria
 		{
 			rg_texture->desc.initial_state = GfxResourceState::PixelSRV | GfxResourceState::ComputeSRV;
 		}
-		std::vector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>& view_descs = texture_view_desc_map[handle];
+		RGVector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>& view_descs = texture_view_desc_map[handle.id];
 		for (Uint64 i = 0; i < view_descs.size(); ++i)
 		{
 			auto const& [_desc, _type] = view_descs[i];
@@ -734,7 +1013,7 @@ namespace adria
 		{
 			rg_texture->desc.initial_state = GfxResourceState::AllUAV;
 		}
-		std::vector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>& view_descs = texture_view_desc_map[handle];
+		RGVector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>& view_descs = texture_view_desc_map[handle.id];
 		for (Uint64 i = 0; i < view_descs.size(); ++i)
 		{
 			auto const& [_desc, _type] = view_descs[i];
@@ -751,7 +1030,7 @@ namespace adria
 		ADRIA_ASSERT_MSG(IsValidBufferHandle(handle), "Resource has not been declared!");
 		RGBuffer* rg_buffer = GetRGBuffer(handle);
 		rg_buffer->desc.bind_flags |= GfxBindFlag::ShaderResource;
-		std::vector<std::pair<GfxBufferDescriptorDesc, RGDescriptorType>>& view_descs = buffer_view_desc_map[handle];
+		RGVector<std::pair<GfxBufferDescriptorDesc, RGDescriptorType>>& view_descs = buffer_view_desc_map[handle.id];
 		for (Uint64 i = 0; i < view_descs.size(); ++i)
 		{
 			auto const& [_desc, _type] = view_descs[i];
@@ -768,7 +1047,7 @@ namespace adria
 		ADRIA_ASSERT_MSG(IsValidBufferHandle(handle), "Resource has not been declared!");
 		RGBuffer* rg_buffer = GetRGBuffer(handle);
 		rg_buffer->desc.bind_flags |= GfxBindFlag::UnorderedAccess;
-		std::vector<std::pair<GfxBufferDescriptorDesc, RGDescriptorType>>& view_descs = buffer_view_desc_map[handle];
+		RGVector<std::pair<GfxBufferDescriptorDesc, RGDescriptorType>>& view_descs = buffer_view_desc_map[handle.id];
 		for (Uint64 i = 0; i < view_descs.size(); ++i)
 		{
 			auto const& [_desc, _type] = view_descs[i];
@@ -792,7 +1071,7 @@ namespace adria
 		rg_buffer->desc.bind_flags |= GfxBindFlag::UnorderedAccess;
 		rg_counter_buffer->desc.bind_flags |= GfxBindFlag::UnorderedAccess;
 
-		std::vector<std::pair<GfxBufferDescriptorDesc, RGDescriptorType>>& view_descs = buffer_view_desc_map[handle];
+		RGVector<std::pair<GfxBufferDescriptorDesc, RGDescriptorType>>& view_descs = buffer_view_desc_map[handle.id];
 		for (Uint64 i = 0; i < view_descs.size(); ++i)
 		{
 			auto const& [_desc, _type] = view_descs[i];
@@ -855,42 +1134,42 @@ namespace adria
 	GfxDescriptor RenderGraph::GetRenderTarget(RGRenderTargetId res_id) const
 	{
 		RGTextureId tex_id = res_id.GetResourceId();
-		auto const& views = texture_view_map[tex_id];
+		auto const& views = texture_view_map[tex_id.id];
 		return views[res_id.GetViewId()].first;
 	}
 
 	GfxDescriptor RenderGraph::GetDepthStencil(RGDepthStencilId res_id) const
 	{
 		RGTextureId tex_id = res_id.GetResourceId();
-		auto const& views = texture_view_map[tex_id];
+		auto const& views = texture_view_map[tex_id.id];
 		return views[res_id.GetViewId()].first;
 	}
 
 	GfxDescriptor RenderGraph::GetReadOnlyTexture(RGTextureReadOnlyId res_id) const
 	{
 		RGTextureId tex_id = res_id.GetResourceId();
-		auto const& views = texture_view_map[tex_id];
+		auto const& views = texture_view_map[tex_id.id];
 		return views[res_id.GetViewId()].first;
 	}
 
 	GfxDescriptor RenderGraph::GetReadWriteTexture(RGTextureReadWriteId res_id) const
 	{
 		RGTextureId tex_id = res_id.GetResourceId();
-		auto const& views = texture_view_map[tex_id];
+		auto const& views = texture_view_map[tex_id.id];
 		return views[res_id.GetViewId()].first;
 	}
 
 	GfxDescriptor RenderGraph::GetReadOnlyBuffer(RGBufferReadOnlyId res_id) const
 	{
 		RGBufferId buf_id = res_id.GetResourceId();
-		auto const& views = buffer_view_map[buf_id];
+		auto const& views = buffer_view_map[buf_id.id];
 		return views[res_id.GetViewId()].first;
 	}
 
 	GfxDescriptor RenderGraph::GetReadWriteBuffer(RGBufferReadWriteId res_id) const
 	{
 		RGBufferId buf_id = res_id.GetResourceId();
-		auto const& views = buffer_view_map[buf_id];
+		auto const& views = buffer_view_map[buf_id.id];
 		return views[res_id.GetViewId()].first;
 	}
 
@@ -1076,9 +1355,9 @@ namespace adria
 				render_pass_desc.height = pass->viewport_height;
 				render_pass_desc.legacy = pass->UseLegacyRenderPasses();
 
-				PIXScopedEvent(cmd_list->GetNative(), PIX_COLOR_DEFAULT, pass->name.c_str());
-				AdriaGfxProfileScope(cmd_list, pass->name.c_str());
-				TracyGfxProfileScope(cmd_list->GetNative(), pass->name.c_str());
+				PIXScopedEvent(cmd_list->GetNative(), PIX_COLOR_DEFAULT, pass->name);
+				AdriaGfxProfileScope(cmd_list, pass->name);
+				TracyGfxProfileScope(cmd_list->GetNative(), pass->name);
 				cmd_list->SetContext(GfxCommandList::Context::Graphics);
 				cmd_list->BeginRenderPass(render_pass_desc);
 				pass->Execute(rg_resources,cmd_list);
@@ -1086,9 +1365,9 @@ namespace adria
 			}
 			else
 			{
-				PIXScopedEvent(cmd_list->GetNative(), PIX_COLOR_DEFAULT, pass->name.c_str());
-				AdriaGfxProfileScope(cmd_list, pass->name.c_str());
-				TracyGfxProfileScope(cmd_list->GetNative(), pass->name.c_str());
+				PIXScopedEvent(cmd_list->GetNative(), PIX_COLOR_DEFAULT, pass->name);
+				AdriaGfxProfileScope(cmd_list, pass->name);
+				TracyGfxProfileScope(cmd_list->GetNative(), pass->name);
 				cmd_list->SetContext(GfxCommandList::Context::Compute);
 				pass->Execute(rg_resources, cmd_list);
 			}
@@ -1318,6 +1597,84 @@ namespace adria
 		ADRIA_LOG(DEBUG, "[RenderGraph]\n%s", render_graph_data.c_str());
 	}
 
-}
+	void RenderGraph::ExportStats(Char const* stats_file_name) const
+	{
+		auto IdsToJson = [](RGVector<Uint64> const& ids)
+			{
+				json ids_json = json::array();
+				for (Uint64 id : ids) ids_json.push_back(id);
+				return ids_json;
+			};
+		auto ResourcesToJson = [](RGVector<RenderGraphResourceStats> const& resources)
+			{
+				json resources_json = json::array();
+				for (RenderGraphResourceStats const& resource : resources)
+				{
+					resources_json.push_back({
+						{ "id", resource.id },
+						{ "name", resource.name },
+						{ "imported", resource.imported },
+						{ "size", resource.size }
+					});
+				}
+				return resources_json;
+			};
+
+		json passes_json = json::array();
+		for (RGPassStats const& pass_stats : stats.passes)
+		{
+			passes_json.push_back({
+				{ "name", pass_stats.name },
+				{ "queue", RGPassTypeToString(pass_stats.type) },
+				{ "culled", pass_stats.culled },
+				{ "dependency_level", pass_stats.dependency_level },
+				{ "barriers", pass_stats.barriers },
+				{ "textures_read", IdsToJson(pass_stats.textures_read) },
+				{ "textures_written", IdsToJson(pass_stats.textures_written) },
+				{ "buffers_read", IdsToJson(pass_stats.buffers_read) },
+				{ "buffers_written", IdsToJson(pass_stats.buffers_written) }
+			});
+		}
 
- 
\ No newline at end of file
+		json output = json::object();
+		output["pass_count"] = stats.passes.size();
+		output["culled_pass_count"] = stats.culled_pass_count;
+		output["dependency_level_count"] = stats.dependency_level_count;
+		output["barrier_count"] = stats.barrier_count;
+		output["transient_texture_count"] = stats.transient_texture_count;
+		output["transient_buffer_count"] = stats.transient_buffer_count;
+		output["transient_bytes"] = stats.transient_bytes;
+		output["peak_transient_bytes"] = stats.peak_transient_bytes;
+		output["build_time_ms"] = stats.build_time_ms;
+		output["pool"] = {
+			{ "texture_hits", stats.pool.texture_hits },
+			{ "texture_misses", stats.pool.texture_misses },
+			{ "buffer_hits", stats.pool.buffer_hits },
+			{ "buffer_misses", stats.pool.buffer_misses },
+			{ "pooled_textures", stats.pool.pooled_texture_count },
+			{ "pooled_buffers", stats.pool.pooled_buffer_count }
+		};
+		output["schedule"] = {
+			{ "applied", stats.schedule.applied },
+			{ "budget_exceeded", stats.schedule.budget_exceeded },
+			{ "peak_bytes_before", stats.schedule.peak_bytes_before },
+			{ "peak_bytes_after", stats.schedule.peak_bytes_after },
+			{ "barriers_before", stats.schedule.barriers_before },
+			{ "barriers_after", stats.schedule.barriers_after }
+		};
+		output["passes"] = passes_json;
+		output["textures"] = ResourcesToJson(stats.textures);
+		output["buffers"] = ResourcesToJson(stats.buffers);
+
+		std::error_code error;
+		std::filesystem::create_directories(paths::RenderGraphDir, error);
+		std::string const output_path = paths::RenderGraphDir + stats_file_name;
+		std::ofstream output_file(output_path);
+		if (!output_file.is_open())
+		{
+			ADRIA_LOG(ERROR, "[RenderGraph] Failed to open %s for writing!", output_path.c_str());
+			return;
+		}
+		output_file << output.dump(4);
+	}
+}
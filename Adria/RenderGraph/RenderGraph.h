@@ -3,6 +3,7 @@
 #include "RenderGraphBlackboard.h"
 #include "RenderGraphBuilder.h"
 #include "RenderGraphResourcePool.h"
+#include "RenderGraphStats.h"
 #include "Graphics/GfxDevice.h"
 
 namespace adria
@@ -17,7 +18,9 @@ namespace adria
 			friend RenderGraph;
 		public:
 
-			explicit DependencyLevel(RenderGraph& rg) : rg(rg) {}
+			explicit DependencyLevel(RenderGraph& rg) : rg(rg), passes(&rg.allocator),
+				texture_creates(&rg.allocator), texture_reads(&rg.allocator), texture_writes(&rg.allocator), texture_destroys(&rg.allocator), texture_state_map(&rg.allocator),
+				buffer_creates(&rg.allocator), buffer_reads(&rg.allocator), buffer_writes(&rg.allocator), buffer_destroys(&rg.allocator), buffer_state_map(&rg.allocator) {}
 			void AddPass(RenderGraphPassBase* pass);
 			void Setup();
 			void Execute(GfxDevice* gfx, GfxCommandList* cmd_list);
@@ -25,38 +28,37 @@ namespace adria
 
 		private:
 			RenderGraph& rg;
-			std::vector<RenderGraphPassBase*> passes;
-			std::unordered_set<RGTextureId> texture_creates;
-			std::unordered_set<RGTextureId> texture_reads;
-			std::unordered_set<RGTextureId> texture_writes;
-			std::unordered_set<RGTextureId> texture_destroys;
-			std::unordered_map<RGTextureId, GfxResourceState> texture_state_map;
-
-			std::unordered_set<RGBufferId> buffer_creates;
-			std::unordered_set<RGBufferId> buffer_reads;
-			std::unordered_set<RGBufferId> buffer_writes;
-			std::unordered_set<RGBufferId> buffer_destroys;
-			std::unordered_map<RGBufferId, GfxResourceState> buffer_state_map;
+			RGVector<RenderGraphPassBase*> passes;
+			RGFlatSet<RGTextureId> texture_creates;
+			RGFlatSet<RGTextureId> texture_reads;
+			RGFlatSet<RGTextureId> texture_writes;
+			RGFlatSet<RGTextureId> texture_destroys;
+			RGFlatMap<RGTextureId, GfxResourceState> texture_state_map;
+
+			RGFlatSet<RGBufferId> buffer_creates;
+			RGFlatSet<RGBufferId> buffer_reads;
+			RGFlatSet<RGBufferId> buffer_writes;
+			RGFlatSet<RGBufferId> buffer_destroys;
+			RGFlatMap<RGBufferId, GfxResourceState> buffer_state_map;
 		};
 
 	public:
 
-		RenderGraph(RGResourcePool& pool) : pool(pool), gfx(pool.GetDevice()) {}
-		ADRIA_NONCOPYABLE(RenderGraph)
-		ADRIA_DEFAULT_MOVABLE(RenderGraph)
+		explicit RenderGraph(RGResourcePool& pool);
+		ADRIA_NONCOPYABLE_NONMOVABLE(RenderGraph)
 		~RenderGraph();
 
 		void Build();
 		void Execute();
 
-		template<typename PassData, typename... Args> requires std::is_constructible_v<RenderGraphPass<PassData>, Args...>
+		template<typename PassData, typename... Args> requires std::is_constructible_v<RenderGraphPass<PassData>, RGAllocator&, Args...>
 		ADRIA_MAYBE_UNUSED decltype(auto) AddPass(Args&&... args)
 		{
-			passes.emplace_back(std::make_unique<RenderGraphPass<PassData>>(std::forward<Args>(args)...));
-			std::unique_ptr<RGPassBase>& pass = passes.back(); pass->id = passes.size() - 1;
+			RenderGraphPass<PassData>* pass = allocator.New<RenderGraphPass<PassData>>(allocator, std::forward<Args>(args)...);
+			passes.push_back(pass); pass->id = passes.size() - 1;
 			RenderGraphBuilder builder(*this, *pass);
 			pass->Setup(builder);
-			return *dynamic_cast<RenderGraphPass<PassData>*>(pass.get());
+			return *pass;
 		}
 
 		void ImportTexture(RGResourceName name, GfxTexture* texture);
@@ -70,29 +72,40 @@ namespace adria
 
 		void Dump(Char const* graph_file_name);
 		void DumpDebugData();
+		void ExportStats(Char const* stats_file_name) const;
+
+		RGAllocatorStats GetAllocatorStats() const { return allocator.GetStats(); }
+		RGScheduleStats const& GetScheduleStats() const { return stats.schedule; }
+		RGStats const& GetStats() const { return stats; }
 
 	private:
 		RGResourcePool& pool;
 		GfxDevice* gfx;
+		//everything below is allocated from the frame allocator of the pool and released at once when the graph is destroyed
+		RGAllocator& allocator;
+		RGAllocatorScope allocator_scope;
 		RGBlackboard blackboard;
 
-		std::vector<std::unique_ptr<RGPassBase>> passes;
-		std::vector<std::unique_ptr<RGTexture>> textures;
-		std::vector<std::unique_ptr<RGBuffer>> buffers;
+		RGVector<RGPassBase*> passes;
+		RGVector<RGTexture*> textures;
+		RGVector<RGBuffer*> buffers;
+
+		RGVector<RGVector<Uint64>> adjacency_lists;
+		RGVector<Uint64> topologically_sorted_passes;
+		RGVector<DependencyLevel> dependency_levels;
 
-		std::vector<std::vector<Uint64>> adjacency_lists;
-		std::vector<Uint64> topologically_sorted_passes;
-		std::vector<DependencyLevel> dependency_levels;
+		std::pmr::unordered_map<RGResourceName, RGTextureId> texture_name_id_map;
+		std::pmr::unordered_map<RGResourceName, RGBufferId>  buffer_name_id_map;
+		std::pmr::unordered_map<RGBufferReadWriteId, RGBufferId> buffer_uav_counter_map;
 
-		std::unordered_map<RGResourceName, RGTextureId> texture_name_id_map;
-		std::unordered_map<RGResourceName, RGBufferId>  buffer_name_id_map;
-		std::unordered_map<RGBufferReadWriteId, RGBufferId> buffer_uav_counter_map;
+		//indexed by resource id
+		mutable RGVector<RGVector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>> texture_view_desc_map;
+		mutable RGVector<RGVector<std::pair<GfxDescriptor, RGDescriptorType>>> texture_view_map;
 
-		mutable std::unordered_map<RGTextureId, std::vector<std::pair<GfxTextureDescriptorDesc, RGDescriptorType>>> texture_view_desc_map;
-		mutable std::unordered_map<RGTextureId, std::vector<std::pair<GfxDescriptor, RGDescriptorType>>> texture_view_map;
+		mutable RGVector<RGVector<std::pair<GfxBufferDescriptorDesc, RGDescriptorType>>> buffer_view_desc_map;
+		mutable RGVector<RGVector<std::pair<GfxDescriptor, RGDescriptorType>>> buffer_view_map;
 
-		mutable std::unordered_map<RGBufferId, std::vector<std::pair<GfxBufferDescriptorDesc, RGDescriptorType>>> buffer_view_desc_map;
-		mutable std::unordered_map<RGBufferId, std::vector<std::pair<GfxDescriptor, RGDescriptorType>>> buffer_view_map;
+		RGStats stats;
 
 	private:
 
@@ -100,8 +113,10 @@ namespace adria
 		void TopologicalSort();
 		void BuildDependencyLevels();
 		void CullPasses();
+		void OptimizeSchedule();
 		void CalculateResourcesLifetime();
-		void DepthFirstSearch(Uint64 i, std::vector<Bool>& visited, std::vector<Uint64>& sort);
+		void CalculateStats();
+		void DepthFirstSearch(Uint64 i, RGVector<Bool>& visited, RGVector<Uint64>& sort);
 		
 		RGTextureId DeclareTexture(RGResourceName name, RGTextureDesc const& desc);
 		RGBufferId DeclareBuffer(RGResourceName name, RGBufferDesc const& desc);
@@ -0,0 +1,88 @@
+#include "RenderGraphAllocator.h"
+#include "Utilities/AllocatorUtil.h"
+
+namespace adria
+{
+	RenderGraphAllocator::RenderGraphAllocator(Uint64 block_size) : block_size(block_size)
+	{
+		AddBlock(block_size);
+		block_allocations = 0;
+	}
+
+	RenderGraphAllocator::~RenderGraphAllocator()
+	{
+		DestroyObjects();
+	}
+
+	void* RenderGraphAllocator::Allocate(Uint64 size, Uint64 align)
+	{
+		while (true)
+		{
+			Block& block = blocks[current_block];
+			Uint8* const block_start = block.memory.get();
+			Uint64 const aligned_offset = AlignToPowerOfTwo(reinterpret_cast<Uint64>(block_start) + current_offset, align) - reinterpret_cast<Uint64>(block_start);
+			if (aligned_offset + size <= block.size)
+			{
+				used_bytes += aligned_offset + size - current_offset;
+				peak_used_bytes = std::max(peak_used_bytes, used_bytes);
+				current_offset = aligned_offset + size;
+				return block_start + aligned_offset;
+			}
+
+			if (current_block + 1 == blocks.size()) AddBlock(std::max(block_size, size + align));
+			++current_block;
+			current_offset = 0;
+		}
+	}
+
+	Char const* RenderGraphAllocator::CopyString(Char const* string)
+	{
+		Uint64 const length = strlen(string);
+		Char* copy = static_cast<Char*>(Allocate(length + 1, alignof(Char)));
+		memcpy(copy, string, length + 1);
+		return copy;
+	}
+
+	void RenderGraphAllocator::Reset()
+	{
+		DestroyObjects();
+		block_allocations = 0;
+		if (blocks.size() > 1)
+		{
+			Uint64 total_size = 0;
+			for (Block const& block : blocks) total_size += block.size;
+			blocks.clear();
+			block_size = total_size;
+			AddBlock(total_size);
+		}
+		current_block = 0;
+		current_offset = 0;
+		used_bytes = 0;
+	}
+
+	RenderGraphAllocatorStats RenderGraphAllocator::GetStats() const
+	{
+		RenderGraphAllocatorStats stats{};
+		stats.used_bytes = used_bytes;
+		stats.peak_used_bytes = peak_used_bytes;
+		for (Block const& block : blocks) stats.capacity += block.size;
+		stats.block_count = (Uint32)blocks.size();
+		stats.block_allocations = block_allocations;
+		return stats;
+	}
+
+	void RenderGraphAllocator::DestroyObjects()
+	{
+		for (ObjectDestructor* destructor = destructors; destructor != nullptr; destructor = destructor->next)
+		{
+			destructor->destroy(destructor->object);
+		}
+		destructors = nullptr;
+	}
+
+	void RenderGraphAllocator::AddBlock(Uint64 size)
+	{
+		blocks.push_back(Block{ .memory = std::make_unique<Uint8[]>(size), .size = size });
+		++block_allocations;
+	}
+}
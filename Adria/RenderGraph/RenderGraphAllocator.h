@@ -0,0 +1,180 @@
+#pragma once
+#include <memory_resource>
+
+namespace adria
+{
+	struct RenderGraphAllocatorStats
+	{
+		Uint64 used_bytes = 0;
+		Uint64 peak_used_bytes = 0;
+		Uint64 capacity = 0;
+		Uint32 block_count = 0;
+		//blocks the arena added since the last reset, 0 once it has grown to the size of a frame
+		Uint32 block_allocations = 0;
+	};
+
+	//linear arena for everything the render graph allocates while it is built and executed.
+	//memory is bump allocated from blocks that are kept across frames and released in one reset,
+	//if a frame needed more than one block they are replaced by a single block big enough for that frame
+	class RenderGraphAllocator final : public std::pmr::memory_resource
+	{
+		static constexpr Uint64 DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+		struct ObjectDestructor
+		{
+			void (*destroy)(void*);
+			void* object;
+			ObjectDestructor* next;
+		};
+
+		struct Block
+		{
+			std::unique_ptr<Uint8[]> memory;
+			Uint64 size;
+		};
+
+	public:
+		explicit RenderGraphAllocator(Uint64 block_size = DEFAULT_BLOCK_SIZE);
+		ADRIA_NONCOPYABLE_NONMOVABLE(RenderGraphAllocator)
+		~RenderGraphAllocator();
+
+		void* Allocate(Uint64 size, Uint64 align = alignof(std::max_align_t));
+
+		//objects that are not trivially destructible are destroyed in reverse order on reset
+		template<typename T, typename... Args>
+		T* New(Args&&... args)
+		{
+			void* memory = Allocate(sizeof(T), alignof(T));
+			T* object = new(memory) T(std::forward<Args>(args)...);
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				ObjectDestructor* destructor = static_cast<ObjectDestructor*>(Allocate(sizeof(ObjectDestructor), alignof(ObjectDestructor)));
+				destructor->destroy = [](void* object) { static_cast<T*>(object)->~T(); };
+				destructor->object = object;
+				destructor->next = destructors;
+				destructors = destructor;
+			}
+			return object;
+		}
+		Char const* CopyString(Char const* string);
+
+		void Reset();
+		RenderGraphAllocatorStats GetStats() const;
+
+	private:
+		std::vector<Block> blocks;
+		Uint64 block_size;
+		Uint64 current_block = 0;
+		Uint64 current_offset = 0;
+		Uint64 used_bytes = 0;
+		Uint64 peak_used_bytes = 0;
+		Uint32 block_allocations = 0;
+		ObjectDestructor* destructors = nullptr;
+
+	private:
+		virtual void* do_allocate(Uint64 size, Uint64 align) override
+		{
+			return Allocate(size, align);
+		}
+		virtual void do_deallocate(void*, Uint64, Uint64) override {}
+		virtual Bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+		void DestroyObjects();
+		void AddBlock(Uint64 size);
+	};
+	using RGAllocator = RenderGraphAllocator;
+	using RGAllocatorStats = RenderGraphAllocatorStats;
+
+	//resets the allocator when destroyed, declare it before the members that allocate from the allocator
+	class RenderGraphAllocatorScope
+	{
+	public:
+		explicit RenderGraphAllocatorScope(RenderGraphAllocator& allocator) : allocator(allocator) {}
+		ADRIA_NONCOPYABLE_NONMOVABLE(RenderGraphAllocatorScope)
+		~RenderGraphAllocatorScope() { allocator.Reset(); }
+
+	private:
+		RenderGraphAllocator& allocator;
+	};
+	using RGAllocatorScope = RenderGraphAllocatorScope;
+
+	template<typename T>
+	using RGVector = std::pmr::vector<T>;
+
+	//small flat set of resource ids, the access lists of a pass rarely have more than a few entries
+	template<typename T>
+	class RGFlatSet
+	{
+	public:
+		using const_iterator = typename RGVector<T>::const_iterator;
+
+		explicit RGFlatSet(RGAllocator* allocator) : elements(allocator) {}
+
+		void insert(T const& element)
+		{
+			if (!contains(element)) elements.push_back(element);
+		}
+		template<typename It>
+		void insert(It begin, It end)
+		{
+			for (; begin != end; ++begin) insert(*begin);
+		}
+		Bool contains(T const& element) const
+		{
+			return std::find(elements.begin(), elements.end(), element) != elements.end();
+		}
+		const_iterator find(T const& element) const
+		{
+			return std::find(elements.begin(), elements.end(), element);
+		}
+
+		const_iterator begin() const { return elements.begin(); }
+		const_iterator end() const { return elements.end(); }
+		Uint64 size() const { return elements.size(); }
+		Bool empty() const { return elements.empty(); }
+
+	private:
+		RGVector<T> elements;
+	};
+
+	template<typename K, typename V>
+	class RGFlatMap
+	{
+	public:
+		using iterator = typename RGVector<std::pair<K, V>>::iterator;
+		using const_iterator = typename RGVector<std::pair<K, V>>::const_iterator;
+
+		explicit RGFlatMap(RGAllocator* allocator) : elements(allocator) {}
+
+		V& operator[](K const& key)
+		{
+			if (iterator it = find(key); it != elements.end()) return it->second;
+			return elements.emplace_back(key, V{}).second;
+		}
+		Bool contains(K const& key) const
+		{
+			return find(key) != elements.end();
+		}
+		iterator find(K const& key)
+		{
+			return std::find_if(elements.begin(), elements.end(), [&key](auto const& element) { return element.first == key; });
+		}
+		const_iterator find(K const& key) const
+		{
+			return std::find_if(elements.begin(), elements.end(), [&key](auto const& element) { return element.first == key; });
+		}
+
+		iterator begin() { return elements.begin(); }
+		iterator end() { return elements.end(); }
+		const_iterator begin() const { return elements.begin(); }
+		const_iterator end() const { return elements.end(); }
+		Uint64 size() const { return elements.size(); }
+		Bool empty() const { return elements.empty(); }
+
+	private:
+		RGVector<std::pair<K, V>> elements;
+	};
+}
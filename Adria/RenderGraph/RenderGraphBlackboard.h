@@ -1,6 +1,7 @@
 #pragma once
 #include <typeindex>
 #include <memory>
+#include "RenderGraphAllocator.h"
 #include "Utilities/TemplatesUtil.h"
 
 namespace adria
@@ -9,7 +10,7 @@ namespace adria
 	class RenderGraphBlackboard
 	{
 	public:
-		RenderGraphBlackboard() = default;
+		explicit RenderGraphBlackboard(RGAllocator& allocator) : allocator(allocator), board_data(&allocator) {}
 		ADRIA_NONCOPYABLE(RenderGraphBlackboard)
 		~RenderGraphBlackboard() = default;
 
@@ -24,9 +25,9 @@ namespace adria
 		{
 			static_assert(std::is_trivial_v<T> && std::is_standard_layout_v<T>);
 			ADRIA_ASSERT(board_data.find(typeid(T)) == board_data.end() && "Cannot create same type more than once in blackboard!");
-			board_data[typeid(T)] = std::make_unique<Uint8[]>(sizeof(T));
-			T* data_entry = reinterpret_cast<T*>(board_data[typeid(T)].get());
+			T* data_entry = static_cast<T*>(allocator.Allocate(sizeof(T), alignof(T)));
 			*data_entry = T{ std::forward<Args>(args)... };
+			board_data[typeid(T)] = data_entry;
 			return *data_entry;
 		}
 
@@ -35,7 +36,7 @@ namespace adria
 		{
 			if (auto it = board_data.find(typeid(T)); it != board_data.end())
 			{
-				return reinterpret_cast<T const*>(it->second.get());
+				return static_cast<T const*>(it->second);
 			}
 			else return nullptr;
 		}
@@ -54,7 +55,9 @@ namespace adria
 		}
 
 	private:
-		std::unordered_map<std::type_index, std::unique_ptr<Uint8[]>> board_data;
+		RGAllocator& allocator;
+		//entries live in the frame allocator of the render graph, they are trivial so nothing has to be destroyed
+		std::pmr::unordered_map<std::type_index, void*> board_data;
 	};
 
 	using RGBlackboard = RenderGraphBlackboard;
@@ -1,8 +1,9 @@
 #pragma once
-#include <functional>
 #include <optional>
 #include "RenderGraphContext.h"
+#include "RenderGraphAllocator.h"
 #include "Utilities/EnumUtil.h"
+#include "Utilities/InlineFunction.h"
 
 
 namespace adria
@@ -95,8 +96,11 @@ namespace adria
 		inline static Uint32 unique_pass_id = 0;
 
 	public:
-		explicit RenderGraphPassBase(Char const* name, RGPassType type = RGPassType::Graphics, RGPassFlags flags = RGPassFlags::None)
-			: name(name), type(type), flags(flags) {}
+		RenderGraphPassBase(RGAllocator& allocator, Char const* name, RGPassType type = RGPassType::Graphics, RGPassFlags flags = RGPassFlags::None)
+			: name(allocator.CopyString(name)), type(type), flags(flags),
+			  texture_creates(&allocator), texture_reads(&allocator), texture_writes(&allocator), texture_destroys(&allocator), texture_state_map(&allocator),
+			  buffer_creates(&allocator), buffer_reads(&allocator), buffer_writes(&allocator), buffer_destroys(&allocator), buffer_state_map(&allocator),
+			  render_targets_info(&allocator) {}
 		virtual ~RenderGraphPassBase() = default;
 
 	protected:
@@ -109,40 +113,44 @@ namespace adria
 		Bool UseLegacyRenderPasses() const { return HasAnyFlag(flags, RGPassFlags::LegacyRenderPass); }
 
 	private:
-		std::string const name;
+		Char const* const name;
 		Uint64 ref_count = 0ull;
 		RGPassType type;
 		RGPassFlags flags = RGPassFlags::None;
 		Uint64 id;
 
-		std::unordered_set<RGTextureId> texture_creates;
-		std::unordered_set<RGTextureId> texture_reads;
-		std::unordered_set<RGTextureId> texture_writes;
-		std::unordered_set<RGTextureId> texture_destroys;
-		std::unordered_map<RGTextureId, GfxResourceState> texture_state_map;
+		RGFlatSet<RGTextureId> texture_creates;
+		RGFlatSet<RGTextureId> texture_reads;
+		RGFlatSet<RGTextureId> texture_writes;
+		RGFlatSet<RGTextureId> texture_destroys;
+		RGFlatMap<RGTextureId, GfxResourceState> texture_state_map;
 		
-		std::unordered_set<RGBufferId> buffer_creates;
-		std::unordered_set<RGBufferId> buffer_reads;
-		std::unordered_set<RGBufferId> buffer_writes;
-		std::unordered_set<RGBufferId> buffer_destroys;
-		std::unordered_map<RGBufferId, GfxResourceState> buffer_state_map;
+		RGFlatSet<RGBufferId> buffer_creates;
+		RGFlatSet<RGBufferId> buffer_reads;
+		RGFlatSet<RGBufferId> buffer_writes;
+		RGFlatSet<RGBufferId> buffer_destroys;
+		RGFlatMap<RGBufferId, GfxResourceState> buffer_state_map;
 
-		std::vector<RenderTargetInfo> render_targets_info;
+		RGVector<RenderTargetInfo> render_targets_info;
 		std::optional<DepthStencilInfo> depth_stencil = std::nullopt;
 		Uint32 viewport_width = 0, viewport_height = 0;
 	};
 	using RGPassBase = RenderGraphPassBase;
 
+	//pass callbacks are stored inline in the pass which lives in the frame allocator, so adding a pass does not touch the heap.
+	//execute lambdas usually capture by value, including copies of blackboard data, hence the large capacity
+	inline constexpr Uint64 RG_PASS_CALLBACK_CAPACITY = 512;
+
 	template<typename PassData>
 	class RenderGraphPass final : public RenderGraphPassBase
 	{
 	public:
-		using SetupFunc = std::function<void(PassData&, RenderGraphBuilder&)>;
-		using ExecuteFunc = std::function<void(PassData const&, RenderGraphContext&, GfxCommandList*)>;
+		using SetupFunc = InlineFunction<void(PassData&, RenderGraphBuilder&), RG_PASS_CALLBACK_CAPACITY>;
+		using ExecuteFunc = InlineFunction<void(PassData const&, RenderGraphContext&, GfxCommandList*), RG_PASS_CALLBACK_CAPACITY>;
 
 	public:
-		RenderGraphPass(Char const* name, SetupFunc&& setup, ExecuteFunc&& execute, RGPassType type = RGPassType::Graphics, RGPassFlags flags = RGPassFlags::None)
-			: RenderGraphPassBase(name, type, flags), setup(std::move(setup)), execute(std::move(execute))
+		RenderGraphPass(RGAllocator& allocator, Char const* name, SetupFunc&& setup, ExecuteFunc&& execute, RGPassType type = RGPassType::Graphics, RGPassFlags flags = RGPassFlags::None)
+			: RenderGraphPassBase(allocator, name, type, flags), setup(std::move(setup)), execute(std::move(execute))
 		{}
 
 		PassData const& GetPassData() const
@@ -174,12 +182,12 @@ namespace adria
 	class RenderGraphPass<void> final : public RenderGraphPassBase
 	{
 	public:
-		using SetupFunc = std::function<void(RenderGraphBuilder&)>;
-		using ExecuteFunc = std::function<void(RenderGraphContext&, GfxCommandList*)>;
+		using SetupFunc = InlineFunction<void(RenderGraphBuilder&), RG_PASS_CALLBACK_CAPACITY>;
+		using ExecuteFunc = InlineFunction<void(RenderGraphContext&, GfxCommandList*), RG_PASS_CALLBACK_CAPACITY>;
 
 	public:
-		RenderGraphPass(Char const* name, SetupFunc&& setup, ExecuteFunc&& execute, RGPassType type = RGPassType::Graphics, RGPassFlags flags = RGPassFlags::None)
-			: RenderGraphPassBase(name, type, flags), setup(std::move(setup)), execute(std::move(execute))
+		RenderGraphPass(RGAllocator& allocator, Char const* name, SetupFunc&& setup, ExecuteFunc&& execute, RGPassType type = RGPassType::Graphics, RGPassFlags flags = RGPassFlags::None)
+			: RenderGraphPassBase(allocator, name, type, flags), setup(std::move(setup)), execute(std::move(execute))
 		{}
 
 		void GetPassData() const
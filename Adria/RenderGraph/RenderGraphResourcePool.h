@@ -1,9 +1,21 @@
 #pragma once
 #include "Graphics/GfxBuffer.h"
 #include "Graphics/GfxTexture.h"
+#include "RenderGraphAllocator.h"
 
 namespace adria
 {
+	//pool activity since the last Tick
+	struct RenderGraphResourcePoolStats
+	{
+		Uint32 texture_hits = 0;
+		Uint32 texture_misses = 0;
+		Uint32 buffer_hits = 0;
+		Uint32 buffer_misses = 0;
+		Uint32 pooled_texture_count = 0;
+		Uint32 pooled_buffer_count = 0;
+	};
+
 	class RenderGraphResourcePool
 	{
 		struct PooledTexture
@@ -35,6 +47,7 @@ namespace adria
 				else ++i;
 			}
 			++frame_index;
+			stats = {};
 		}
 
 		GfxTexture* AllocateTexture(GfxTextureDesc const& desc)
@@ -45,9 +58,11 @@ namespace adria
 				{
 					pool_texture.last_used_frame = frame_index;
 					active = true;
+					++stats.texture_hits;
 					return pool_texture.texture.get();
 				}
 			}
+			++stats.texture_misses;
 			auto& texture = texture_pool.emplace_back(std::pair{ PooledTexture{ std::make_unique<GfxTexture>(device, desc), frame_index}, true }).first.texture;
 			return texture.get();
 		}
@@ -71,9 +86,11 @@ namespace adria
 				{
 					pool_buffer.last_used_frame = frame_index;
 					active = true;
+					++stats.buffer_hits;
 					return pool_buffer.buffer.get();
 				}
 			}
+			++stats.buffer_misses;
 			auto& buffer = buffer_pool.emplace_back(std::pair{ PooledBuffer{ std::make_unique<GfxBuffer>(device, desc), frame_index}, true }).first.buffer;
 			return buffer.get();
 		}
@@ -90,13 +107,25 @@ namespace adria
 		}
 
 		GfxDevice* GetDevice() const { return device; }
+		RenderGraphResourcePoolStats GetStats() const
+		{
+			RenderGraphResourcePoolStats pool_stats = stats;
+			pool_stats.pooled_texture_count = (Uint32)texture_pool.size();
+			pool_stats.pooled_buffer_count = (Uint32)buffer_pool.size();
+			return pool_stats;
+		}
+		//render graphs are rebuilt every frame, the pool keeps their allocator so its memory is reused
+		RenderGraphAllocator& GetFrameAllocator() { return frame_allocator; }
 
 	private:
 		GfxDevice* device = nullptr;
+		RenderGraphAllocator frame_allocator;
 		Uint64 frame_index = 0;
+		RenderGraphResourcePoolStats stats;
 		std::vector<std::pair<PooledTexture, Bool>> texture_pool;
 		std::vector<std::pair<PooledBuffer, Bool>>  buffer_pool;
 	};
 	using RGResourcePool = RenderGraphResourcePool;
+	using RGResourcePoolStats = RenderGraphResourcePoolStats;
 
 }
\ No newline at end of file
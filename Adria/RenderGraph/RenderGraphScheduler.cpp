@@ -0,0 +1,274 @@
+#include "RenderGraphScheduler.h"
+
+namespace adria
+{
+	RenderGraphScheduler::RenderGraphScheduler(RGAllocator& allocator, Uint64 pass_count, Uint64 resource_count)
+		: allocator(allocator), excluded_passes(pass_count, false, &allocator), successors(pass_count, &allocator), predecessors(pass_count, &allocator),
+		  pass_resources(pass_count, &allocator), resource_accesses(resource_count, &allocator), resource_sizes(resource_count, 0, &allocator),
+		  resource_creators(resource_count, INVALID_INDEX, &allocator), resource_use_counts(resource_count, 0, &allocator), schedule(&allocator)
+	{
+	}
+
+	void RenderGraphScheduler::ExcludePass(Uint64 pass)
+	{
+		excluded_passes[pass] = true;
+	}
+
+	void RenderGraphScheduler::AddDependency(Uint64 from, Uint64 to)
+	{
+		ADRIA_ASSERT(from != to);
+		if (std::find(successors[from].begin(), successors[from].end(), to) != successors[from].end()) return;
+		successors[from].push_back(to);
+		predecessors[to].push_back(from);
+	}
+
+	void RenderGraphScheduler::SetResourceSize(Uint64 resource, Uint64 size)
+	{
+		resource_sizes[resource] = size;
+	}
+
+	void RenderGraphScheduler::SetResourceCreator(Uint64 resource, Uint64 pass)
+	{
+		resource_creators[resource] = pass;
+		RGVector<Uint64>& resources = pass_resources[pass];
+		if (std::find(resources.begin(), resources.end(), resource) == resources.end()) resources.push_back(resource);
+	}
+
+	void RenderGraphScheduler::AddResourceAccess(Uint64 pass, Uint64 resource, GfxResourceState state)
+	{
+		resource_accesses[resource].push_back(ResourceAccess{ .pass = pass, .state = state });
+		RGVector<Uint64>& resources = pass_resources[pass];
+		if (std::find(resources.begin(), resources.end(), resource) == resources.end()) resources.push_back(resource);
+	}
+
+	Bool RenderGraphScheduler::Schedule(RGVector<Uint64>& pass_levels, Uint64 beam_width, Uint64 budget)
+	{
+		ADRIA_ASSERT(pass_levels.size() == successors.size());
+		ADRIA_ASSERT(beam_width > 0);
+		Uint64 const pass_count = successors.size();
+
+		stats = {};
+		schedule.clear();
+		std::fill(resource_use_counts.begin(), resource_use_counts.end(), 0);
+		Uint64 included_pass_count = 0;
+		for (Uint64 pass = 0; pass < pass_count; ++pass)
+		{
+			if (excluded_passes[pass]) continue;
+			++included_pass_count;
+			for (Uint64 resource : pass_resources[pass]) ++resource_use_counts[resource];
+		}
+		EvaluateLevels(pass_levels, stats.peak_bytes_before, stats.barriers_before, stats.levels_before);
+		if (included_pass_count == 0) return false;
+
+		RGVector<SearchState> beam(&allocator), next_beam(&allocator);
+		beam.reserve(beam_width);
+		next_beam.reserve(beam_width);
+		for (Uint64 i = 0; i < beam_width; ++i)
+		{
+			beam.emplace_back(&allocator);
+			next_beam.emplace_back(&allocator);
+		}
+		InitSearchState(beam[0]);
+		Uint64 beam_size = 1;
+
+		auto CompareCandidates = [](Candidate const& lhs, Candidate const& rhs)
+			{
+				if (lhs.peak_bytes != rhs.peak_bytes) return lhs.peak_bytes < rhs.peak_bytes;
+				if (lhs.live_bytes != rhs.live_bytes) return lhs.live_bytes < rhs.live_bytes;
+				if (lhs.level_count != rhs.level_count) return lhs.level_count < rhs.level_count;
+				return lhs.pass < rhs.pass;
+			};
+
+		RGVector<Candidate> candidates(&allocator);
+		candidates.reserve(beam_width * pass_count);
+		for (Uint64 step = 0; step < included_pass_count; ++step)
+		{
+			candidates.clear();
+			for (Uint64 state_index = 0; state_index < beam_size; ++state_index)
+			{
+				SearchState const& state = beam[state_index];
+				for (Uint64 pass = 0; pass < pass_count; ++pass)
+				{
+					if (excluded_passes[pass] || state.pass_levels[pass] != INVALID_INDEX || state.remaining_predecessors[pass] != 0) continue;
+					if (++stats.evaluated_candidates > budget)
+					{
+						stats.budget_exceeded = true;
+						return false;
+					}
+					candidates.push_back(EvaluateCandidate(state, state_index, pass));
+				}
+			}
+			ADRIA_ASSERT_MSG(!candidates.empty(), "Render graph dependencies contain a cycle!");
+
+			Uint64 const next_beam_size = std::min<Uint64>(beam_width, candidates.size());
+			std::partial_sort(candidates.begin(), candidates.begin() + next_beam_size, candidates.end(), CompareCandidates);
+			for (Uint64 i = 0; i < next_beam_size; ++i)
+			{
+				next_beam[i] = beam[candidates[i].state];
+				ApplyCandidate(next_beam[i], candidates[i].pass);
+			}
+			beam.swap(next_beam);
+			beam_size = next_beam_size;
+		}
+
+		SearchState const& best = beam[0];
+		RGVector<Uint64> scheduled_pass_levels(pass_levels, &allocator);
+		for (Uint64 pass = 0; pass < pass_count; ++pass)
+		{
+			//excluded passes are not executed, they only have to stay inside the level range
+			scheduled_pass_levels[pass] = excluded_passes[pass] ? std::min(pass_levels[pass], best.level_count - 1) : best.pass_levels[pass];
+		}
+		EvaluateLevels(scheduled_pass_levels, stats.peak_bytes_after, stats.barriers_after, stats.levels_after);
+
+		//a lower peak does not pay for more barriers
+		Bool const is_better = stats.barriers_after <= stats.barriers_before &&
+			std::tie(stats.peak_bytes_after, stats.barriers_after, stats.levels_after) < std::tie(stats.peak_bytes_before, stats.barriers_before, stats.levels_before);
+		if (!is_better) return false;
+
+		pass_levels = scheduled_pass_levels;
+		schedule = best.order;
+		stats.applied = true;
+		return true;
+	}
+
+	void RenderGraphScheduler::InitSearchState(SearchState& state) const
+	{
+		Uint64 const pass_count = successors.size();
+		state.remaining_predecessors.assign(pass_count, 0);
+		for (Uint64 pass = 0; pass < pass_count; ++pass)
+		{
+			if (excluded_passes[pass]) continue;
+			for (Uint64 predecessor : predecessors[pass])
+			{
+				if (!excluded_passes[predecessor]) ++state.remaining_predecessors[pass];
+			}
+		}
+		state.remaining_uses.assign(resource_use_counts.begin(), resource_use_counts.end());
+		state.pass_levels.assign(pass_count, INVALID_INDEX);
+		state.order.clear();
+		state.live_bytes = 0;
+		state.peak_bytes = 0;
+		state.level_count = 0;
+	}
+
+	Uint64 RenderGraphScheduler::GetPassLevel(SearchState const& state, Uint64 pass) const
+	{
+		//a pass joins the last level unless it depends on a pass in that level
+		if (state.level_count == 0) return 0;
+		Uint64 const last_level = state.level_count - 1;
+		for (Uint64 predecessor : predecessors[pass])
+		{
+			if (state.pass_levels[predecessor] == last_level) return last_level + 1;
+		}
+		return last_level;
+	}
+
+	RenderGraphScheduler::Candidate RenderGraphScheduler::EvaluateCandidate(SearchState const& state, Uint64 state_index, Uint64 pass) const
+	{
+		Uint64 live_bytes = state.live_bytes;
+		for (Uint64 resource : pass_resources[pass])
+		{
+			if (state.remaining_uses[resource] == resource_use_counts[resource]) live_bytes += resource_sizes[resource];
+		}
+		Uint64 const peak_bytes = std::max(state.peak_bytes, live_bytes);
+		for (Uint64 resource : pass_resources[pass])
+		{
+			if (state.remaining_uses[resource] == 1) live_bytes -= resource_sizes[resource];
+		}
+		Uint64 const level_count = std::max(state.level_count, GetPassLevel(state, pass) + 1);
+		return Candidate{ .state = state_index, .pass = pass, .peak_bytes = peak_bytes, .live_bytes = live_bytes, .level_count = level_count };
+	}
+
+	void RenderGraphScheduler::ApplyCandidate(SearchState& state, Uint64 pass) const
+	{
+		Uint64 const level = GetPassLevel(state, pass);
+		state.pass_levels[pass] = level;
+		state.level_count = std::max(state.level_count, level + 1);
+
+		for (Uint64 resource : pass_resources[pass])
+		{
+			if (state.remaining_uses[resource] == resource_use_counts[resource]) state.live_bytes += resource_sizes[resource];
+		}
+		state.peak_bytes = std::max(state.peak_bytes, state.live_bytes);
+		for (Uint64 resource : pass_resources[pass])
+		{
+			if (--state.remaining_uses[resource] == 0) state.live_bytes -= resource_sizes[resource];
+		}
+		for (Uint64 successor : successors[pass])
+		{
+			if (!excluded_passes[successor]) --state.remaining_predecessors[successor];
+		}
+		state.order.push_back(pass);
+	}
+
+	void RenderGraphScheduler::EvaluateLevels(RGVector<Uint64> const& pass_levels, Uint64& peak_bytes, Uint32& barriers, Uint32& level_count) const
+	{
+		Uint64 const pass_count = successors.size();
+		Uint64 const resource_count = resource_sizes.size();
+
+		Uint64 levels = 0;
+		for (Uint64 pass = 0; pass < pass_count; ++pass)
+		{
+			if (!excluded_passes[pass]) levels = std::max(levels, pass_levels[pass] + 1);
+		}
+
+		//transient resources are created at the level of their creator and released after the last level that accesses them
+		RGVector<Sint64> level_bytes_delta(levels + 1, 0, &allocator);
+		for (Uint64 resource = 0; resource < resource_count; ++resource)
+		{
+			if (resource_sizes[resource] == 0) continue;
+			Uint64 first_level = INVALID_INDEX, last_level = 0;
+			for (ResourceAccess const& access : resource_accesses[resource])
+			{
+				if (excluded_passes[access.pass]) continue;
+				first_level = std::min(first_level, pass_levels[access.pass]);
+				last_level = std::max(last_level, pass_levels[access.pass]);
+			}
+			Uint64 const creator = resource_creators[resource];
+			if (creator != INVALID_INDEX && !excluded_passes[creator])
+			{
+				first_level = std::min(first_level, pass_levels[creator]);
+				last_level = std::max(last_level, pass_levels[creator]);
+			}
+			if (first_level == INVALID_INDEX) continue;
+			level_bytes_delta[first_level] += (Sint64)resource_sizes[resource];
+			level_bytes_delta[last_level + 1] -= (Sint64)resource_sizes[resource];
+		}
+		peak_bytes = 0;
+		Sint64 live_bytes = 0;
+		for (Uint64 level = 0; level < levels; ++level)
+		{
+			live_bytes += level_bytes_delta[level];
+			peak_bytes = std::max(peak_bytes, (Uint64)live_bytes);
+		}
+
+		//the state of a resource in a level is the combination of the states of all its accesses in that level,
+		//a barrier is needed every time it differs from the state in the previous level that accessed the resource
+		barriers = 0;
+		RGVector<GfxResourceState> level_states(levels, GfxResourceState::Common, &allocator);
+		RGVector<Bool> level_accessed(levels, false, &allocator);
+		for (Uint64 resource = 0; resource < resource_count; ++resource)
+		{
+			for (ResourceAccess const& access : resource_accesses[resource])
+			{
+				if (excluded_passes[access.pass]) continue;
+				Uint64 const level = pass_levels[access.pass];
+				if (!level_accessed[level]) level_states[level] = access.state;
+				else level_states[level] |= access.state;
+				level_accessed[level] = true;
+			}
+
+			Bool has_previous_state = false;
+			GfxResourceState previous_state = GfxResourceState::Common;
+			for (Uint64 level = 0; level < levels; ++level)
+			{
+				if (!level_accessed[level]) continue;
+				if (has_previous_state && previous_state != level_states[level]) ++barriers;
+				previous_state = level_states[level];
+				has_previous_state = true;
+				level_accessed[level] = false;
+			}
+		}
+		level_count = (Uint32)levels;
+	}
+}
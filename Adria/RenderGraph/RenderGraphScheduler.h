@@ -0,0 +1,93 @@
+#pragma once
+#include "RenderGraphAllocator.h"
+#include "Graphics/GfxResourceCommon.h"
+
+namespace adria
+{
+	struct RenderGraphScheduleStats
+	{
+		Uint64 peak_bytes_before = 0;
+		Uint64 peak_bytes_after = 0;
+		Uint32 barriers_before = 0;
+		Uint32 barriers_after = 0;
+		Uint32 levels_before = 0;
+		Uint32 levels_after = 0;
+		Uint64 evaluated_candidates = 0;
+		Bool budget_exceeded = false;
+		Bool applied = false;
+	};
+
+	//reorders independent passes to minimize the peak size of live transient resources and the number of barriers.
+	//it works only on the pass dependencies, resource accesses and resource sizes it is given, no device is needed.
+	//the search is a beam search over the ready passes, if it runs out of budget the current order is kept
+	class RenderGraphScheduler
+	{
+		static constexpr Uint64 INVALID_INDEX = Uint64(-1);
+
+		struct ResourceAccess
+		{
+			Uint64 pass;
+			GfxResourceState state;
+		};
+
+		struct SearchState
+		{
+			explicit SearchState(RGAllocator* allocator) : remaining_predecessors(allocator), remaining_uses(allocator), pass_levels(allocator), order(allocator) {}
+
+			RGVector<Uint32> remaining_predecessors;
+			RGVector<Uint32> remaining_uses;
+			RGVector<Uint64> pass_levels;
+			RGVector<Uint64> order;
+			Uint64 live_bytes = 0;
+			Uint64 peak_bytes = 0;
+			Uint64 level_count = 0;
+		};
+
+		struct Candidate
+		{
+			Uint64 state;
+			Uint64 pass;
+			Uint64 peak_bytes;
+			Uint64 live_bytes;
+			Uint64 level_count;
+		};
+
+	public:
+		RenderGraphScheduler(RGAllocator& allocator, Uint64 pass_count, Uint64 resource_count);
+
+		void ExcludePass(Uint64 pass);
+		void AddDependency(Uint64 from, Uint64 to);
+		void SetResourceSize(Uint64 resource, Uint64 size);
+		void SetResourceCreator(Uint64 resource, Uint64 pass);
+		void AddResourceAccess(Uint64 pass, Uint64 resource, GfxResourceState state);
+
+		//pass_levels holds the current dependency level of every pass and is overwritten only if the new schedule is better.
+		//returns true if it was overwritten, GetSchedule then returns the order of the included passes
+		Bool Schedule(RGVector<Uint64>& pass_levels, Uint64 beam_width, Uint64 budget);
+
+		RGVector<Uint64> const& GetSchedule() const { return schedule; }
+		RenderGraphScheduleStats const& GetStats() const { return stats; }
+
+	private:
+		RGAllocator& allocator;
+		RGVector<Bool> excluded_passes;
+		RGVector<RGVector<Uint64>> successors;
+		RGVector<RGVector<Uint64>> predecessors;
+		RGVector<RGVector<Uint64>> pass_resources;
+		RGVector<RGVector<ResourceAccess>> resource_accesses;
+		RGVector<Uint64> resource_sizes;
+		RGVector<Uint64> resource_creators;
+		RGVector<Uint32> resource_use_counts;
+		RGVector<Uint64> schedule;
+		RenderGraphScheduleStats stats;
+
+	private:
+		void InitSearchState(SearchState& state) const;
+		Uint64 GetPassLevel(SearchState const& state, Uint64 pass) const;
+		Candidate EvaluateCandidate(SearchState const& state, Uint64 state_index, Uint64 pass) const;
+		void ApplyCandidate(SearchState& state, Uint64 pass) const;
+		void EvaluateLevels(RGVector<Uint64> const& pass_levels, Uint64& peak_bytes, Uint32& barriers, Uint32& level_count) const;
+	};
+	using RGScheduler = RenderGraphScheduler;
+	using RGScheduleStats = RenderGraphScheduleStats;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "RenderGraphPass.h"
+#include "RenderGraphResourcePool.h"
+#include "RenderGraphScheduler.h"
+
+namespace adria
+{
+	struct RenderGraphPassStats
+	{
+		explicit RenderGraphPassStats(RGAllocator* allocator) : textures_read(allocator), textures_written(allocator), buffers_read(allocator), buffers_written(allocator) {}
+
+		Char const* name = "";
+		RGPassType type = RGPassType::Graphics;
+		Bool culled = false;
+		Uint32 dependency_level = 0;
+		//barriers issued before the dependency level of the pass for resources it accesses and after it for resources it releases
+		Uint32 barriers = 0;
+		RGVector<Uint64> textures_read;
+		RGVector<Uint64> textures_written;
+		RGVector<Uint64> buffers_read;
+		RGVector<Uint64> buffers_written;
+	};
+
+	struct RenderGraphResourceStats
+	{
+		Char const* name = "";
+		Uint64 id = 0;
+		Bool imported = false;
+		Uint64 size = 0;
+	};
+
+	//filled in Build, pool activity is added in Execute when the resources are actually allocated
+	struct RenderGraphStats
+	{
+		explicit RenderGraphStats(RGAllocator* allocator) : passes(allocator), textures(allocator), buffers(allocator) {}
+
+		RGVector<RenderGraphPassStats> passes;
+		RGVector<RenderGraphResourceStats> textures;
+		RGVector<RenderGraphResourceStats> buffers;
+		Uint32 culled_pass_count = 0;
+		Uint32 dependency_level_count = 0;
+		Uint32 barrier_count = 0;
+		Uint32 transient_texture_count = 0;
+		Uint32 transient_buffer_count = 0;
+		Uint64 transient_bytes = 0;
+		Uint64 peak_transient_bytes = 0;
+		Float64 build_time_ms = 0.0;
+		RGScheduleStats schedule;
+		RGResourcePoolStats pool;
+	};
+	using RGPassStats = RenderGraphPassStats;
+	using RGStats = RenderGraphStats;
+}
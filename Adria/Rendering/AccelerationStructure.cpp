@@ -3,57 +3,114 @@
 #include "Graphics/GfxBuffer.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxCommandList.h"
+#include "Logging/Logger.h"
+#include "Utilities/HashUtil.h"
 
 namespace adria
 {
+	static constexpr Float64 BytesToMegabytes = 1.0 / (1024.0 * 1024.0);
+
+	Uint64 AccelerationStructure::BLASKeyHash::operator()(BLASKey const& key) const
+	{
+		HashState hash;
+		hash.Combine(key.geometry_buffer);
+		hash.Combine(key.positions_offset);
+		hash.Combine(key.vertices_count);
+		hash.Combine(key.indices_offset);
+		hash.Combine(key.indices_count);
+		hash.Combine(key.opaque);
+		hash.Combine(key.deformable);
+		return hash;
+	}
 
 	AccelerationStructure::AccelerationStructure(GfxDevice* gfx) : gfx(gfx)
 	{
-		build_fence.Create(gfx, "Build Fence");
-		++build_fence_value;
 	}
 
-	void AccelerationStructure::AddInstance(Mesh const& mesh)
+	AccelerationStructure::~AccelerationStructure()
 	{
-		auto dynamic_allocator = gfx->GetDynamicAllocator();
-		blases.resize(mesh.instances.size());
-		Uint32 instance_id = 0;
+		if (tlas_srv.IsValid()) gfx->FreeDescriptorCPU(tlas_srv, GfxDescriptorHeapType::CBV_SRV_UAV);
+	}
 
+	void AccelerationStructure::AddInstance(Mesh const& mesh, RayTracing& ray_tracing)
+	{
+		ray_tracing.first_instance = (Uint32)rt_instances.size();
 		GfxBuffer* geometry_buffer = g_GeometryBufferCache.GetGeometryBuffer(mesh.geometry_buffer_handle);
+		Uint32 const geometry_offset = (Uint32)g_GeometryBufferCache.GetGeometryBufferOffset(mesh.geometry_buffer_handle);
+		//deformable BLASes are refit from the geometry buffer every frame, so their geometry must not be moved by defragmentation
+		if (ray_tracing.deformable) g_GeometryBufferCache.PinGeometryBuffer(mesh.geometry_buffer_handle);
 		for (SubMeshInstance const& instance : mesh.instances)
 		{
 			SubMeshGPU const& submesh = mesh.submeshes[instance.submesh_index];
 			Material const& material = mesh.materials[submesh.material_index];
 
-			GfxRayTracingGeometry& rt_geometry = rt_geometries.emplace_back();
-			rt_geometry.vertex_buffer = geometry_buffer;
-			rt_geometry.vertex_buffer_offset = submesh.positions_offset;
-			rt_geometry.vertex_format = GfxFormat::R32G32B32_FLOAT;
-			rt_geometry.vertex_stride = GetGfxFormatStride(rt_geometry.vertex_format);
-			rt_geometry.vertex_count = submesh.vertices_count;
+			BLASKey blas_key{};
+			blas_key.geometry_buffer = geometry_buffer;
+			blas_key.positions_offset = geometry_offset + submesh.positions_offset;
+			blas_key.vertices_count = submesh.vertices_count;
+			blas_key.indices_offset = geometry_offset + submesh.indices_offset;
+			blas_key.indices_count = submesh.indices_count;
+			blas_key.opaque = material.alpha_mode == MaterialAlphaMode::Opaque;
+			blas_key.deformable = ray_tracing.deformable;
+
+			auto [blas_it, inserted] = blas_map.try_emplace(blas_key, (Uint32)blas_geometries.size());
+			if (inserted)
+			{
+				GfxRayTracingGeometry& rt_geometry = blas_geometries.emplace_back();
+				rt_geometry.vertex_buffer = geometry_buffer;
+				rt_geometry.vertex_buffer_offset = blas_key.positions_offset;
+				rt_geometry.vertex_format = GfxFormat::R32G32B32_FLOAT;
+				rt_geometry.vertex_stride = GetGfxFormatStride(rt_geometry.vertex_format);
+				rt_geometry.vertex_count = submesh.vertices_count;
 
-			rt_geometry.index_buffer = geometry_buffer;
-			rt_geometry.index_buffer_offset = submesh.indices_offset;
-			rt_geometry.index_count = submesh.indices_count;
-			rt_geometry.index_format = GfxFormat::R32_UINT;
-			rt_geometry.opaque = material.alpha_mode == MaterialAlphaMode::Opaque;
+				rt_geometry.index_buffer = geometry_buffer;
+				rt_geometry.index_buffer_offset = blas_key.indices_offset;
+				rt_geometry.index_count = submesh.indices_count;
+				rt_geometry.index_format = GfxFormat::R32_UINT;
+				rt_geometry.opaque = blas_key.opaque;
+				tracker.AddBLAS(blas_key.deformable);
+			}
 
 			GfxRayTracingInstance& rt_instance = rt_instances.emplace_back();
 			rt_instance.flags = GfxRayTracingInstanceFlag_None;
-			rt_instance.instance_id = instance_id++; //#todo temporary
+			rt_instance.instance_id = (Uint32)rt_instances.size() - 1;
 			rt_instance.instance_mask = 0xff;
 			const auto T = XMMatrixTranspose(instance.world_transform);
 			memcpy(rt_instance.transform, &T, sizeof(T));
+			rt_instance_blas_indices.push_back(blas_it->second);
+			tracker.AddInstance(blas_it->second, instance.world_transform, ray_tracing.dynamic);
 		}
 	}
 
 	void AccelerationStructure::Build()
 	{
-		if (blases.empty()) return;
+		if (blas_geometries.empty()) return;
 		BuildBottomLevels();
-		for(auto& rt_instance : rt_instances) rt_instance.blas = blases[rt_instance.instance_id].get();
 		BuildTopLevel();
-		tlas_srv = gfx->CreateBufferSRV(&tlas->GetBuffer());
+		tracker.MarkBuilt();
+		UpdateMemoryStats();
+		stats.blas_memory_before_compaction = stats.blas_memory;
+		ADRIA_LOG(INFO, "Built %llu BLASes for %llu ray tracing instances (%.2f MB BLAS, %.2f MB TLAS), compaction pending",
+				  stats.blas_count, stats.instance_count, stats.blas_memory * BytesToMegabytes, stats.tlas_memory * BytesToMegabytes);
+	}
+
+	void AccelerationStructure::UpdateInstances(Mesh const& mesh, RayTracing const& ray_tracing)
+	{
+		ADRIA_ASSERT(ray_tracing.first_instance + mesh.instances.size() <= rt_instances.size());
+		for (Uint64 i = 0; i < mesh.instances.size(); ++i)
+		{
+			Uint32 const instance_index = ray_tracing.first_instance + (Uint32)i;
+			tracker.SetInstanceTransform(instance_index, mesh.instances[i].world_transform);
+			//there is no notification when vertices change, deformable geometry is refit every frame
+			if (ray_tracing.deformable) tracker.MarkBLASDeformed(rt_instance_blas_indices[instance_index]);
+		}
+	}
+
+	void AccelerationStructure::Update()
+	{
+		if (!tlas) return;
+		if (compaction_state != CompactionState::Idle && IsFrameCompleted(compaction_frame)) CompactBottomLevels();
+		UpdateAccelerationStructures();
 	}
 
 	Sint32 AccelerationStructure::GetTLASIndex() const
@@ -65,36 +122,147 @@ namespace adria
 
 	void AccelerationStructure::BuildBottomLevels()
 	{
-		GfxCommandList* cmd_list = gfx->GetCommandList();
+		GfxBufferDesc compacted_sizes_desc{};
+		compacted_sizes_desc.size = blas_geometries.size() * sizeof(Uint64);
+		compacted_sizes_desc.bind_flags = GfxBindFlag::UnorderedAccess;
+		compacted_sizes_buffer = gfx->CreateBuffer(compacted_sizes_desc);
 
-		std::span<GfxRayTracingGeometry> geometry_span(rt_geometries);
+		//all builds go into the same command list, every BLAS has its own scratch buffer so the builds can overlap.
+		//deformable BLASes are refit every frame so they are built for fast build and are not compacted
+		blases.resize(blas_geometries.size());
+		std::span<GfxRayTracingGeometry> geometry_span(blas_geometries);
 		for (Uint64 i = 0; i < blases.size(); ++i)
 		{
-			blases[i] = gfx->CreateRayTracingBLAS(geometry_span.subspan(i, 1), GfxRayTracingASFlag_PreferFastTrace);
+			if (tracker.IsBLASDeformable((Uint32)i))
+			{
+				blases[i] = gfx->CreateRayTracingBLAS(geometry_span.subspan(i, 1), GfxRayTracingASFlag_PreferFastBuild | GfxRayTracingASFlag_AllowUpdate);
+			}
+			else
+			{
+				blases[i] = gfx->CreateRayTracingBLAS(geometry_span.subspan(i, 1), GfxRayTracingASFlag_PreferFastTrace | GfxRayTracingASFlag_AllowCompaction,
+													  compacted_sizes_buffer->GetGpuAddress() + i * sizeof(Uint64));
+			}
 		}
-		cmd_list->Signal(build_fence, build_fence_value);
-		cmd_list->End();
-		cmd_list->Submit();
+
+		GfxCommandList* cmd_list = gfx->GetCommandList();
+		cmd_list->GlobalBarrier(GfxResourceState::ASWrite, GfxResourceState::ASRead);
+		cmd_list->FlushBarriers();
+
+		compaction_state = CompactionState::WaitingForBuild;
+		compaction_frame = gfx->GetFrameIndex();
 	}
 
 	void AccelerationStructure::BuildTopLevel()
 	{
+		for (Uint64 i = 0; i < rt_instances.size(); ++i) rt_instances[i].blas = blases[rt_instance_blas_indices[i]].get();
+		GfxRayTracingASFlags tlas_flags = GfxRayTracingASFlag_PreferFastTrace;
+		if (tracker.IsTLASUpdatable()) tlas_flags |= GfxRayTracingASFlag_AllowUpdate;
+		tlas = gfx->CreateRayTracingTLAS(rt_instances, tlas_flags);
+
+		GfxCommandList* cmd_list = gfx->GetCommandList();
+		cmd_list->GlobalBarrier(GfxResourceState::ASWrite, GfxResourceState::ASRead | GfxResourceState::AllSRV);
+		cmd_list->FlushBarriers();
+
+		if (tlas_srv.IsValid()) gfx->FreeDescriptorCPU(tlas_srv, GfxDescriptorHeapType::CBV_SRV_UAV);
+		tlas_srv = gfx->CreateBufferSRV(&tlas->GetBuffer());
+	}
+
+	void AccelerationStructure::UpdateAccelerationStructures()
+	{
+		AccelerationStructureUpdate const& update = tracker.ScheduleUpdate();
+		stats.last_tlas_update = update.tlas_update;
+		if (update.tlas_update == ASUpdateType::None) return;
+
 		GfxCommandList* cmd_list = gfx->GetCommandList();
-		cmd_list->Begin();
+		if (update.HasBLASUpdates())
+		{
+			std::span<GfxRayTracingGeometry> geometry_span(blas_geometries);
+			for (Uint32 blas_index : update.blas_refits) blases[blas_index]->Update(geometry_span.subspan(blas_index, 1), true);
+			for (Uint32 blas_index : update.blas_rebuilds) blases[blas_index]->Update(geometry_span.subspan(blas_index, 1), false);
+			cmd_list->GlobalBarrier(GfxResourceState::ASWrite, GfxResourceState::ASRead);
+			cmd_list->FlushBarriers();
+		}
 
-		build_fence.Wait(build_fence_value);
-		++build_fence_value;
+		for (Uint32 instance_index : update.dirty_instances)
+		{
+			const auto T = XMMatrixTranspose(tracker.GetInstanceTransform(instance_index));
+			memcpy(rt_instances[instance_index].transform, &T, sizeof(T));
+		}
+		if (update.tlas_update == ASUpdateType::Rebuild)
+		{
+			for (Uint64 i = 0; i < rt_instances.size(); ++i) rt_instances[i].blas = blases[rt_instance_blas_indices[i]].get();
+		}
 
-		tlas = gfx->CreateRayTracingTLAS(rt_instances, GfxRayTracingASFlag_PreferFastTrace);
+		//the TLAS is updated in place, work of previous frames reading it is done once this command list starts
+		tlas->Update(rt_instances, update.tlas_update == ASUpdateType::Refit);
+		cmd_list->GlobalBarrier(GfxResourceState::ASWrite, GfxResourceState::ASRead | GfxResourceState::AllSRV);
+		cmd_list->FlushBarriers();
+	}
 
-		cmd_list->Signal(build_fence, build_fence_value);
-		cmd_list->End();
-		cmd_list->Submit();
+	Bool AccelerationStructure::IsFrameCompleted(Uint64 frame) const
+	{
+		//GfxDevice::EndFrame waits for the frame that used the same backbuffer, so work recorded in a frame is done GetBackbufferCount() frames later
+		return gfx->GetFrameIndex() >= frame + GfxDevice::GetBackbufferCount();
+	}
 
-		build_fence.Wait(build_fence_value);
-		++build_fence_value;
+	//compaction never waits on the cpu: every step is recorded on the frame command list and the next one starts once that frame has completed
+	void AccelerationStructure::CompactBottomLevels()
+	{
+		GfxCommandList* cmd_list = gfx->GetCommandList();
+		switch (compaction_state)
+		{
+		case CompactionState::WaitingForBuild:
+		{
+			GfxBufferDesc readback_desc{};
+			readback_desc.size = compacted_sizes_buffer->GetSize();
+			readback_desc.resource_usage = GfxResourceUsage::Readback;
+			compacted_sizes_readback_buffer = gfx->CreateBuffer(readback_desc);
+			cmd_list->CopyBuffer(*compacted_sizes_readback_buffer, *compacted_sizes_buffer);
+			compaction_state = CompactionState::WaitingForReadback;
+		}
+		break;
+		case CompactionState::WaitingForReadback:
+		{
+			Uint64 const* compacted_sizes = compacted_sizes_readback_buffer->GetMappedData<Uint64>();
+			for (Uint64 i = 0; i < blases.size(); ++i)
+			{
+				if (tracker.IsBLASDeformable((Uint32)i)) continue;
+				std::unique_ptr<GfxRayTracingBLAS> compacted_blas = gfx->CreateCompactedRayTracingBLAS(*blases[i], compacted_sizes[i]);
+				retired_blases.push_back(std::move(blases[i]));
+				blases[i] = std::move(compacted_blas);
+			}
+			cmd_list->GlobalBarrier(GfxResourceState::ASWrite, GfxResourceState::ASRead);
+			cmd_list->FlushBarriers();
+
+			//the instances point to the old BLASes, the TLAS is rebuilt in place by UpdateAccelerationStructures
+			tracker.RequestTLASRebuild();
+			compacted_sizes_buffer.reset();
+			compacted_sizes_readback_buffer.reset();
+			compaction_state = CompactionState::WaitingForCompaction;
+		}
+		break;
+		case CompactionState::WaitingForCompaction:
+		{
+			retired_blases.clear();
+			UpdateMemoryStats();
+			ADRIA_LOG(INFO, "Compacted %llu BLASes: %.2f MB -> %.2f MB", stats.blas_count,
+					  stats.blas_memory_before_compaction * BytesToMegabytes, stats.blas_memory * BytesToMegabytes);
+			compaction_state = CompactionState::Idle;
+		}
+		break;
+		case CompactionState::Idle:
+		default:
+			break;
+		}
+		compaction_frame = gfx->GetFrameIndex();
+	}
 
-		cmd_list->Begin();
+	void AccelerationStructure::UpdateMemoryStats()
+	{
+		stats.instance_count = rt_instances.size();
+		stats.blas_count = blases.size();
+		stats.blas_memory = 0;
+		for (auto const& blas : blases) stats.blas_memory += blas->GetMemorySize();
+		stats.tlas_memory = tlas ? tlas->GetMemorySize() : 0;
 	}
 }
-
@@ -1,42 +1,99 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include <d3d12.h>
 #include <DirectXMath.h>
-#include "Graphics/GfxFence.h"
 #include "Graphics/GfxDescriptor.h"
 #include "Graphics/GfxRayTracingAS.h"
+#include "AccelerationStructureTracker.h"
 
 namespace adria
 {
 	class GfxDevice;
 	class GfxBuffer;
 	struct Mesh;
+	struct RayTracing;
+
+	struct AccelerationStructureStats
+	{
+		Uint64 instance_count = 0;
+		Uint64 blas_count = 0;
+		Uint64 blas_memory_before_compaction = 0;
+		Uint64 blas_memory = 0;
+		Uint64 tlas_memory = 0;
+		ASUpdateType last_tlas_update = ASUpdateType::None;
+	};
 
 	class AccelerationStructure
 	{
+		//identifies the geometry of a submesh, instances of the same submesh share one BLAS
+		struct BLASKey
+		{
+			GfxBuffer const* geometry_buffer;
+			Uint32 positions_offset;
+			Uint32 vertices_count;
+			Uint32 indices_offset;
+			Uint32 indices_count;
+			Bool opaque;
+			Bool deformable;
+
+			Bool operator==(BLASKey const&) const = default;
+		};
+		struct BLASKeyHash
+		{
+			Uint64 operator()(BLASKey const& key) const;
+		};
+
+		enum class CompactionState : Uint8
+		{
+			Idle,
+			WaitingForBuild,
+			WaitingForReadback,
+			WaitingForCompaction
+		};
 
 	public:
 		explicit AccelerationStructure(GfxDevice* gfx);
+		~AccelerationStructure();
 
-		void AddInstance(Mesh const& mesh);
+		//assigns ray_tracing.first_instance
+		void AddInstance(Mesh const& mesh, RayTracing& ray_tracing);
 		void Build();
+		//tracks transform changes of the mesh instances, deformable meshes get their BLASes refit
+		void UpdateInstances(Mesh const& mesh, RayTracing const& ray_tracing);
+		//records the scheduled BLAS/TLAS updates and advances BLAS compaction, has to be called once per frame after GfxDevice::BeginFrame
+		void Update();
 
 		Sint32 GetTLASIndex() const;
+		AccelerationStructureStats const& GetStats() const { return stats; }
 
 	private:
 		GfxDevice* gfx;
-		std::vector<GfxRayTracingGeometry> rt_geometries;
+		std::vector<GfxRayTracingGeometry> blas_geometries;
+		std::unordered_map<BLASKey, Uint32, BLASKeyHash> blas_map;
 		std::vector<std::unique_ptr<GfxRayTracingBLAS>> blases;
+		AccelerationStructureTracker tracker;
 
 		std::vector<GfxRayTracingInstance> rt_instances;
+		std::vector<Uint32> rt_instance_blas_indices;
 		std::unique_ptr<GfxRayTracingTLAS> tlas;
 		GfxDescriptor tlas_srv;
 
-		GfxFence build_fence;
-		Uint64 build_fence_value = 0;
+		std::unique_ptr<GfxBuffer> compacted_sizes_buffer;
+		std::unique_ptr<GfxBuffer> compacted_sizes_readback_buffer;
+		std::vector<std::unique_ptr<GfxRayTracingBLAS>> retired_blases;
+		CompactionState compaction_state = CompactionState::Idle;
+		Uint64 compaction_frame = 0;
+
+		AccelerationStructureStats stats;
+
 	private:
 		void BuildBottomLevels();
 		void BuildTopLevel();
+		void UpdateAccelerationStructures();
+		Bool IsFrameCompleted(Uint64 frame) const;
+		void CompactBottomLevels();
+		void UpdateMemoryStats();
 	};
-}
\ No newline at end of file
+}
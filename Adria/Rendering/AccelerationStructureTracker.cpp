@@ -0,0 +1,132 @@
+#include "AccelerationStructureTracker.h"
+
+namespace adria
+{
+	AccelerationStructureTracker::AccelerationStructureTracker(AccelerationStructureTrackerSettings const& settings) : settings(settings)
+	{
+	}
+
+	Uint32 AccelerationStructureTracker::AddBLAS(Bool deformable)
+	{
+		blases.push_back(TrackedBLAS{ .refit_count = 0, .deformable = deformable, .dirty = false });
+		if (deformable) ++deformable_blas_count;
+		tlas_rebuild_requested = true;
+		return (Uint32)blases.size() - 1;
+	}
+
+	Uint32 AccelerationStructureTracker::AddInstance(Uint32 blas_index, Matrix const& transform, Bool dynamic)
+	{
+		ADRIA_ASSERT(blas_index < blases.size());
+		instances.push_back(TrackedInstance{ .transform = transform, .blas_index = blas_index, .dynamic = dynamic, .dirty = false });
+		if (dynamic) ++dynamic_instance_count;
+		tlas_rebuild_requested = true;
+		return (Uint32)instances.size() - 1;
+	}
+
+	void AccelerationStructureTracker::Clear()
+	{
+		instances.clear();
+		blases.clear();
+		dirty_instances.clear();
+		dirty_blases.clear();
+		dynamic_instance_count = 0;
+		deformable_blas_count = 0;
+		tlas_refit_count = 0;
+		tlas_rebuild_requested = true;
+	}
+
+	void AccelerationStructureTracker::SetInstanceTransform(Uint32 instance_index, Matrix const& transform)
+	{
+		TrackedInstance& instance = instances[instance_index];
+		if (memcmp(&instance.transform, &transform, sizeof(Matrix)) == 0) return;
+
+		instance.transform = transform;
+		if (!instance.dirty)
+		{
+			instance.dirty = true;
+			dirty_instances.push_back(instance_index);
+		}
+	}
+
+	void AccelerationStructureTracker::MarkBLASDeformed(Uint32 blas_index)
+	{
+		TrackedBLAS& blas = blases[blas_index];
+		if (!blas.dirty)
+		{
+			blas.dirty = true;
+			dirty_blases.push_back(blas_index);
+		}
+	}
+
+	void AccelerationStructureTracker::RequestTLASRebuild()
+	{
+		tlas_rebuild_requested = true;
+	}
+
+	void AccelerationStructureTracker::MarkBuilt()
+	{
+		for (Uint32 instance_index : dirty_instances) instances[instance_index].dirty = false;
+		for (Uint32 blas_index : dirty_blases)
+		{
+			blases[blas_index].dirty = false;
+			blases[blas_index].refit_count = 0;
+		}
+		dirty_instances.clear();
+		dirty_blases.clear();
+		tlas_refit_count = 0;
+		tlas_rebuild_requested = false;
+	}
+
+	AccelerationStructureUpdate const& AccelerationStructureTracker::ScheduleUpdate()
+	{
+		update.tlas_update = ASUpdateType::None;
+		update.dirty_instances.swap(dirty_instances);
+		update.blas_refits.clear();
+		update.blas_rebuilds.clear();
+		dirty_instances.clear();
+
+		for (Uint32 blas_index : dirty_blases)
+		{
+			TrackedBLAS& blas = blases[blas_index];
+			blas.dirty = false;
+			//static BLASes are not built with update support, they can only be rebuilt
+			if (blas.deformable && blas.refit_count < settings.max_blas_refits)
+			{
+				++blas.refit_count;
+				update.blas_refits.push_back(blas_index);
+			}
+			else
+			{
+				blas.refit_count = 0;
+				update.blas_rebuilds.push_back(blas_index);
+			}
+		}
+		dirty_blases.clear();
+
+		Bool static_instance_moved = false;
+		for (Uint32 instance_index : update.dirty_instances)
+		{
+			TrackedInstance& instance = instances[instance_index];
+			instance.dirty = false;
+			static_instance_moved |= !instance.dynamic;
+		}
+
+		//instance bounds depend on both the transforms and the BLAS contents
+		if (tlas_rebuild_requested || !update.dirty_instances.empty() || update.HasBLASUpdates())
+		{
+			Bool const can_refit = !tlas_rebuild_requested && !static_instance_moved && IsTLASUpdatable() && tlas_refit_count < settings.max_tlas_refits;
+			if (can_refit)
+			{
+				++tlas_refit_count;
+				update.tlas_update = ASUpdateType::Refit;
+			}
+			else
+			{
+				tlas_refit_count = 0;
+				update.tlas_update = ASUpdateType::Rebuild;
+			}
+		}
+		tlas_rebuild_requested = false;
+		return update;
+	}
+}
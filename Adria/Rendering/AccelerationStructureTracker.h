@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+#include "Math/MathTypes.h"
+
+namespace adria
+{
+	enum class ASUpdateType : Uint8
+	{
+		None,
+		Refit,
+		Rebuild
+	};
+
+	struct AccelerationStructureUpdate
+	{
+		ASUpdateType tlas_update = ASUpdateType::None;
+		std::vector<Uint32> dirty_instances;
+		std::vector<Uint32> blas_refits;
+		std::vector<Uint32> blas_rebuilds;
+
+		Bool HasBLASUpdates() const { return !blas_refits.empty() || !blas_rebuilds.empty(); }
+	};
+
+	struct AccelerationStructureTrackerSettings
+	{
+		//refits keep the topology of the original build, quality degrades as things move so a full rebuild is forced periodically
+		Uint32 max_tlas_refits = 64;
+		Uint32 max_blas_refits = 32;
+	};
+
+	//cpu side change tracking and build scheduling for AccelerationStructure, knows nothing about the gpu objects.
+	//static instances and BLASes are built for fast trace, dynamic instances and deformable BLASes for fast build and update
+	class AccelerationStructureTracker
+	{
+	public:
+		explicit AccelerationStructureTracker(AccelerationStructureTrackerSettings const& settings = {});
+
+		Uint32 AddBLAS(Bool deformable);
+		Uint32 AddInstance(Uint32 blas_index, Matrix const& transform, Bool dynamic);
+		void Clear();
+
+		//marks the instance dirty if the transform differs from the last one
+		void SetInstanceTransform(Uint32 instance_index, Matrix const& transform);
+		void MarkBLASDeformed(Uint32 blas_index);
+		//BLAS addresses changed (e.g. after compaction), the TLAS has to be rebuilt
+		void RequestTLASRebuild();
+		//everything added so far was built, drops the pending changes
+		void MarkBuilt();
+
+		//consumes the pending changes, the returned update is valid until the next call
+		AccelerationStructureUpdate const& ScheduleUpdate();
+
+		Bool IsBLASDeformable(Uint32 blas_index) const { return blases[blas_index].deformable; }
+		Bool IsInstanceDynamic(Uint32 instance_index) const { return instances[instance_index].dynamic; }
+		Bool IsTLASUpdatable() const { return dynamic_instance_count > 0 || deformable_blas_count > 0; }
+		Matrix const& GetInstanceTransform(Uint32 instance_index) const { return instances[instance_index].transform; }
+		Uint64 GetInstanceCount() const { return instances.size(); }
+		Uint64 GetBLASCount() const { return blases.size(); }
+
+	private:
+		struct TrackedInstance
+		{
+			Matrix transform;
+			Uint32 blas_index;
+			Bool dynamic;
+			Bool dirty;
+		};
+		struct TrackedBLAS
+		{
+			Uint32 refit_count;
+			Bool deformable;
+			Bool dirty;
+		};
+
+		AccelerationStructureTrackerSettings settings;
+		std::vector<TrackedInstance> instances;
+		std::vector<TrackedBLAS> blases;
+		std::vector<Uint32> dirty_instances;
+		std::vector<Uint32> dirty_blases;
+		Uint64 dynamic_instance_count = 0;
+		Uint64 deformable_blas_count = 0;
+		Uint32 tlas_refit_count = 0;
+		Bool tlas_rebuild_requested = true;
+		AccelerationStructureUpdate update;
+	};
+}
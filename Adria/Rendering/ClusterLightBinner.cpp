@@ -0,0 +1,259 @@
+#include <emmintrin.h>
+#include <atomic>
+#include <bit>
+#include "ClusterLightBinner.h"
+#include "Components.h"
+#include "Utilities/ThreadPool.h"
+
+namespace adria
+{
+	namespace
+	{
+		//same as GetViewPosition in CommonResources.hlsli
+		Vector3 GetViewPosition(Vector2 const& uv, Float depth, Matrix const& inverse_projection)
+		{
+			Vector4 clip_space_location(uv.x * 2.0f - 1.0f, -(uv.y * 2.0f - 1.0f), depth, 1.0f);
+			Vector4 homogenous_location = Vector4::Transform(clip_space_location, inverse_projection);
+			return Vector3(homogenous_location) / homogenous_location.w;
+		}
+
+		Vector3 IntersectionZPlane(Vector3 const& b, Float z_distance)
+		{
+			return b * (z_distance / b.z);
+		}
+
+		inline __m128 Dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+		{
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+		}
+	}
+
+	ClusterLightBinner::ClusterLightBinner(Uint32 size_x, Uint32 size_y, Uint32 size_z, Uint32 max_cluster_lights)
+		: size_x(size_x), size_y(size_y), size_z(size_z), max_cluster_lights(max_cluster_lights)
+	{
+		Uint32 const cluster_count = size_x * size_y * size_z;
+		clusters.resize(cluster_count);
+		cluster_spheres.resize(cluster_count);
+		cluster_light_counts.resize(cluster_count);
+		cluster_light_indices.resize(cluster_count * max_cluster_lights);
+		light_grid.resize(cluster_count);
+	}
+
+	void ClusterLightBinner::BuildClusters(Matrix const& projection, Float camera_near, Float camera_far)
+	{
+		if (clusters_valid && projection == cluster_projection && camera_near == cluster_near && camera_far == cluster_far) return;
+
+		cluster_projection = projection;
+		cluster_near = camera_near;
+		cluster_far = camera_far;
+		clusters_valid = true;
+		clusters_changed = true;
+		++stats.cluster_rebuilds;
+
+		Matrix const inverse_projection = projection.Invert();
+		Vector2 const tile_size(1.0f / size_x, 1.0f / size_y);
+		for (Uint32 z = 0; z < size_z; ++z)
+		{
+			Float const cluster_near_plane = camera_far * std::pow(camera_near / camera_far, z / Float(size_z));
+			Float const cluster_far_plane = camera_far * std::pow(camera_near / camera_far, (z + 1) / Float(size_z));
+			for (Uint32 y = 0; y < size_y; ++y)
+			{
+				for (Uint32 x = 0; x < size_x; ++x)
+				{
+					Vector3 const max_point = GetViewPosition(Vector2(Float(x + 1), Float(y + 1)) * tile_size, 0.0f, inverse_projection);
+					Vector3 const min_point = GetViewPosition(Vector2(Float(x), Float(y)) * tile_size, 0.0f, inverse_projection);
+
+					Vector3 const min_point_near = IntersectionZPlane(min_point, cluster_near_plane);
+					Vector3 const min_point_far = IntersectionZPlane(min_point, cluster_far_plane);
+					Vector3 const max_point_near = IntersectionZPlane(max_point, cluster_near_plane);
+					Vector3 const max_point_far = IntersectionZPlane(max_point, cluster_far_plane);
+
+					Vector3 const min_point_aabb = Vector3::Min(Vector3::Min(min_point_near, min_point_far), Vector3::Min(max_point_near, max_point_far));
+					Vector3 const max_point_aabb = Vector3::Max(Vector3::Max(min_point_near, min_point_far), Vector3::Max(max_point_near, max_point_far));
+
+					Uint32 const cluster_index = x + y * size_x + z * size_x * size_y;
+					clusters[cluster_index].min_point = Vector4(min_point_aabb.x, min_point_aabb.y, min_point_aabb.z, 0.0f);
+					clusters[cluster_index].max_point = Vector4(max_point_aabb.x, max_point_aabb.y, max_point_aabb.z, 0.0f);
+
+					Vector3 const center = (min_point_aabb + max_point_aabb) * 0.5f;
+					cluster_spheres[cluster_index] = Vector4(center.x, center.y, center.z, Vector3::Distance(min_point_aabb, max_point_aabb) * 0.5f);
+				}
+			}
+		}
+	}
+
+	Bool ClusterLightBinner::BinLights(std::span<LightGPU const> lights, Bool cone_culling, Bool multithreaded)
+	{
+		Bool const lights_changed = lights.size() != binned_lights.size() || cone_culling != binned_cone_culling ||
+			(!lights.empty() && memcmp(lights.data(), binned_lights.data(), lights.size_bytes()) != 0);
+		if (!clusters_changed && !lights_changed) return false;
+
+		clusters_changed = false;
+		binned_lights.assign(lights.begin(), lights.end());
+		binned_cone_culling = cone_culling;
+		++stats.light_rebins;
+
+		SetupLights(lights, cone_culling);
+		if (multithreaded && size_z > 1)
+		{
+			std::atomic<Uint32> next_slice = 0;
+			auto BinSlices = [this, &next_slice, cone_culling]()
+				{
+					for (Uint32 slice = next_slice++; slice < size_z; slice = next_slice++) BinSlice(slice, cone_culling);
+				};
+
+			Uint32 const worker_count = g_ThreadPool.GetHelperCount(size_z);
+			std::vector<std::future<void>> workers;
+			workers.reserve(worker_count);
+			for (Uint32 i = 0; i < worker_count; ++i) workers.push_back(g_ThreadPool.Submit(BinSlices));
+			BinSlices();
+			for (std::future<void>& worker : workers) worker.wait();
+		}
+		else
+		{
+			for (Uint32 slice = 0; slice < size_z; ++slice) BinSlice(slice, cone_culling);
+		}
+
+		//compact the fixed size per cluster lists, the gpu path does the same with an atomic counter in arbitrary order
+		light_list.clear();
+		stats.max_cluster_light_count = 0;
+		stats.overflowed_clusters = 0;
+		for (Uint32 cluster_index = 0; cluster_index < (Uint32)clusters.size(); ++cluster_index)
+		{
+			Uint32 const light_count = cluster_light_counts[cluster_index];
+			light_grid[cluster_index].offset = (Uint32)light_list.size();
+			light_grid[cluster_index].light_count = std::min(light_count, max_cluster_lights);
+			Uint32 const* cluster_lights = cluster_light_indices.data() + cluster_index * max_cluster_lights;
+			light_list.insert(light_list.end(), cluster_lights, cluster_lights + light_grid[cluster_index].light_count);
+
+			stats.max_cluster_light_count = std::max(stats.max_cluster_light_count, light_count);
+			if (light_count > max_cluster_lights) ++stats.overflowed_clusters;
+		}
+		stats.binned_lights = (Uint32)light_indices.size();
+		stats.light_index_count = (Uint32)light_list.size();
+		return true;
+	}
+
+	void ClusterLightBinner::SetupLights(std::span<LightGPU const> lights, Bool cone_culling)
+	{
+		light_indices.clear();
+		for (Uint32 i = 0; i < (Uint32)lights.size(); ++i)
+		{
+			if (lights[i].active) light_indices.push_back(i);
+		}
+
+		Uint64 const padded_count = (light_indices.size() + 3) & ~3ull;
+		auto ResizeArray = [padded_count]<typename T>(std::vector<T>& array, T padding)
+			{
+				array.clear();
+				array.resize(padded_count, padding);
+			};
+		//padding lanes have a negative squared range and never pass the sphere test
+		ResizeArray(light_position_x, 0.0f);
+		ResizeArray(light_position_y, 0.0f);
+		ResizeArray(light_position_z, 0.0f);
+		ResizeArray(light_range, 0.0f);
+		ResizeArray(light_range_sq, -1.0f);
+		ResizeArray(light_direction_x, 0.0f);
+		ResizeArray(light_direction_y, 0.0f);
+		ResizeArray(light_direction_z, 0.0f);
+		ResizeArray(light_cone_cos, 0.0f);
+		ResizeArray(light_cone_sin, 0.0f);
+		ResizeArray(light_is_spot, 0u);
+
+		for (Uint64 i = 0; i < light_indices.size(); ++i)
+		{
+			LightGPU const& light = lights[light_indices[i]];
+			LightType const type = static_cast<LightType>(light.type);
+			if (type == LightType::Directional)
+			{
+				light_range_sq[i] = FLT_MAX;
+				continue;
+			}
+			light_position_x[i] = light.position.x;
+			light_position_y[i] = light.position.y;
+			light_position_z[i] = light.position.z;
+			light_range[i] = light.range;
+			light_range_sq[i] = light.range * light.range;
+
+			if (cone_culling && type == LightType::Spot)
+			{
+				Vector3 direction(light.direction);
+				direction.Normalize();
+				light_direction_x[i] = direction.x;
+				light_direction_y[i] = direction.y;
+				light_direction_z[i] = direction.z;
+				light_cone_cos[i] = std::clamp(light.outer_cosine, -1.0f, 1.0f);
+				light_cone_sin[i] = std::sqrt(1.0f - light_cone_cos[i] * light_cone_cos[i]);
+				light_is_spot[i] = 0xffffffff;
+			}
+		}
+	}
+
+	void ClusterLightBinner::BinSlice(Uint32 slice, Bool cone_culling)
+	{
+		Uint32 const slice_cluster_count = size_x * size_y;
+		Uint32 const padded_light_count = (Uint32)light_range_sq.size();
+		for (Uint32 cluster_index = slice * slice_cluster_count; cluster_index < (slice + 1) * slice_cluster_count; ++cluster_index)
+		{
+			ClusterAABB const& cluster = clusters[cluster_index];
+			__m128 const min_x = _mm_set1_ps(cluster.min_point.x);
+			__m128 const min_y = _mm_set1_ps(cluster.min_point.y);
+			__m128 const min_z = _mm_set1_ps(cluster.min_point.z);
+			__m128 const max_x = _mm_set1_ps(cluster.max_point.x);
+			__m128 const max_y = _mm_set1_ps(cluster.max_point.y);
+			__m128 const max_z = _mm_set1_ps(cluster.max_point.z);
+
+			Vector4 const& sphere = cluster_spheres[cluster_index];
+			__m128 const sphere_x = _mm_set1_ps(sphere.x);
+			__m128 const sphere_y = _mm_set1_ps(sphere.y);
+			__m128 const sphere_z = _mm_set1_ps(sphere.z);
+			__m128 const sphere_radius = _mm_set1_ps(sphere.w);
+			__m128 const negative_sphere_radius = _mm_set1_ps(-sphere.w);
+
+			Uint32 light_count = 0;
+			Uint32* cluster_lights = cluster_light_indices.data() + cluster_index * max_cluster_lights;
+			for (Uint32 i = 0; i < padded_light_count; i += 4)
+			{
+				__m128 const position_x = _mm_loadu_ps(&light_position_x[i]);
+				__m128 const position_y = _mm_loadu_ps(&light_position_y[i]);
+				__m128 const position_z = _mm_loadu_ps(&light_position_z[i]);
+
+				//squared distance from the light to the closest point of the cluster box
+				__m128 const dx = _mm_sub_ps(_mm_max_ps(min_x, _mm_min_ps(position_x, max_x)), position_x);
+				__m128 const dy = _mm_sub_ps(_mm_max_ps(min_y, _mm_min_ps(position_y, max_y)), position_y);
+				__m128 const dz = _mm_sub_ps(_mm_max_ps(min_z, _mm_min_ps(position_z, max_z)), position_z);
+				__m128 visible = _mm_cmple_ps(Dot3(dx, dy, dz, dx, dy, dz), _mm_loadu_ps(&light_range_sq[i]));
+
+				if (cone_culling)
+				{
+					//cone against the bounding sphere of the cluster
+					__m128 const spot_mask = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&light_is_spot[i])));
+					__m128 const vx = _mm_sub_ps(sphere_x, position_x);
+					__m128 const vy = _mm_sub_ps(sphere_y, position_y);
+					__m128 const vz = _mm_sub_ps(sphere_z, position_z);
+					__m128 const v_length_sq = Dot3(vx, vy, vz, vx, vy, vz);
+					__m128 const v_along_axis = Dot3(vx, vy, vz, _mm_loadu_ps(&light_direction_x[i]), _mm_loadu_ps(&light_direction_y[i]), _mm_loadu_ps(&light_direction_z[i]));
+					__m128 const v_across_axis = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(v_length_sq, _mm_mul_ps(v_along_axis, v_along_axis)), _mm_setzero_ps()));
+					__m128 const closest_distance = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(&light_cone_cos[i]), v_across_axis), _mm_mul_ps(v_along_axis, _mm_loadu_ps(&light_cone_sin[i])));
+
+					__m128 const angle_culled = _mm_cmpgt_ps(closest_distance, sphere_radius);
+					__m128 const front_culled = _mm_cmpgt_ps(v_along_axis, _mm_add_ps(sphere_radius, _mm_loadu_ps(&light_range[i])));
+					__m128 const back_culled = _mm_cmplt_ps(v_along_axis, negative_sphere_radius);
+					__m128 const culled = _mm_and_ps(spot_mask, _mm_or_ps(angle_culled, _mm_or_ps(front_culled, back_culled)));
+					visible = _mm_andnot_ps(culled, visible);
+				}
+
+				Uint32 mask = (Uint32)_mm_movemask_ps(visible);
+				while (mask)
+				{
+					Uint32 const lane = std::countr_zero(mask);
+					mask &= mask - 1;
+					if (light_count < max_cluster_lights) cluster_lights[light_count] = light_indices[i + lane];
+					++light_count;
+				}
+			}
+			cluster_light_counts[cluster_index] = light_count;
+		}
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <vector>
+#include <span>
+#include "ShaderStructs.h"
+
+namespace adria
+{
+	struct ClusterAABB
+	{
+		Vector4 min_point;
+		Vector4 max_point;
+	};
+
+	struct ClusterLightGrid
+	{
+		Uint32 offset;
+		Uint32 light_count;
+	};
+
+	struct ClusterLightBinnerStats
+	{
+		Uint32 binned_lights = 0;
+		Uint32 light_index_count = 0;
+		Uint32 max_cluster_light_count = 0;
+		Uint32 overflowed_clusters = 0;
+		Uint32 cluster_rebuilds = 0;
+		Uint32 light_rebins = 0;
+	};
+
+	//cpu version of the ClusterBuilding and ClusterCulling shaders. it produces the same light grid and light index list,
+	//lights of a cluster are stored in ascending order and lists are truncated at max_cluster_lights like on the gpu.
+	//lights are tested four at a time with SSE against the cluster bounds, depth slices are binned in parallel on the thread pool.
+	//clusters are only rebuilt when the projection changes and lights are only rebinned when the clusters or the lights change
+	class ClusterLightBinner
+	{
+	public:
+		ClusterLightBinner(Uint32 size_x, Uint32 size_y, Uint32 size_z, Uint32 max_cluster_lights);
+
+		//near and far are the camera planes as stored in the frame constants, the cluster slices are distributed logarithmically between them
+		void BuildClusters(Matrix const& projection, Float camera_near, Float camera_far);
+		//lights are in view space, cone culling additionally rejects clusters outside of spot light cones which the gpu path does not do.
+		//returns true if the light grid changed
+		Bool BinLights(std::span<LightGPU const> lights, Bool cone_culling, Bool multithreaded = true);
+
+		Uint32 GetClusterCount() const { return (Uint32)clusters.size(); }
+		std::span<ClusterAABB const> GetClusters() const { return clusters; }
+		std::span<ClusterLightGrid const> GetLightGrid() const { return light_grid; }
+		std::span<Uint32 const> GetLightList() const { return light_list; }
+		ClusterLightBinnerStats const& GetStats() const { return stats; }
+
+	private:
+		Uint32 const size_x;
+		Uint32 const size_y;
+		Uint32 const size_z;
+		Uint32 const max_cluster_lights;
+
+		std::vector<ClusterAABB> clusters;
+		std::vector<Vector4> cluster_spheres;
+		Matrix cluster_projection;
+		Float cluster_near = 0.0f;
+		Float cluster_far = 0.0f;
+		Bool clusters_valid = false;
+		Bool clusters_changed = false;
+
+		std::vector<LightGPU> binned_lights;
+		Bool binned_cone_culling = false;
+
+		//active lights in structure of arrays layout, padded to a multiple of four
+		std::vector<Float> light_position_x;
+		std::vector<Float> light_position_y;
+		std::vector<Float> light_position_z;
+		std::vector<Float> light_range;
+		std::vector<Float> light_range_sq;
+		std::vector<Float> light_direction_x;
+		std::vector<Float> light_direction_y;
+		std::vector<Float> light_direction_z;
+		std::vector<Float> light_cone_cos;
+		std::vector<Float> light_cone_sin;
+		std::vector<Uint32> light_is_spot;
+		std::vector<Uint32> light_indices;
+
+		std::vector<Uint32> cluster_light_counts;
+		std::vector<Uint32> cluster_light_indices;
+
+		std::vector<ClusterLightGrid> light_grid;
+		std::vector<Uint32> light_list;
+		ClusterLightBinnerStats stats;
+
+	private:
+		void SetupLights(std::span<LightGPU const> lights, Bool cone_culling);
+		void BinSlice(Uint32 slice, Bool cone_culling);
+	};
+}
@@ -6,37 +6,40 @@
 #include "Graphics/GfxCommon.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxPipelineState.h"
+#include "Graphics/GfxLinearDynamicAllocator.h"
+#include "Graphics/GfxReadbackManager.h"
 #include "RenderGraph/RenderGraph.h"
 #include "Logging/Logger.h"
+#include "Editor/GUICommand.h"
+#include "Core/ConsoleManager.h"
 #include "entt/entity/registry.hpp"
 
 using namespace DirectX;
 
 namespace adria
 {
-	struct ClusterAABB
+	enum ClusterLightAssignment : Uint8
 	{
-		Vector4 min_point;
-		Vector4 max_point;
+		ClusterLightAssignment_GPU,
+		ClusterLightAssignment_CPU,
+		ClusterLightAssignment_GPUValidated
 	};
 
-	struct LightGrid
-	{
-		Uint32 offset;
-		Uint32 light_count;
-	};
+	static TAutoConsoleVariable<int>  LightAssignment("r.ClusteredLighting.LightAssignment", ClusterLightAssignment_GPU, "0 - lights are assigned to clusters on the gpu, 1 - on the cpu and the light lists are uploaded, 2 - on the gpu and compared against the cpu binner");
+	static TAutoConsoleVariable<Bool> ConeCulling("r.ClusteredLighting.ConeCulling", true, "Cull clusters outside of spot light cones when lights are assigned on the cpu");
 
 	ClusteredDeferredLightingPass::ClusteredDeferredLightingPass(entt::registry& reg, GfxDevice* gfx, Uint32 w, Uint32 h) 
 		: reg(reg), gfx(gfx), width(w), height(h),
 		clusters(gfx, StructuredBufferDesc<ClusterAABB>(CLUSTER_COUNT)),
 		light_counter(gfx, StructuredBufferDesc<Uint32>(1)),
 		light_list(gfx, StructuredBufferDesc<Uint32>(CLUSTER_COUNT * CLUSTER_MAX_LIGHTS)),
-		light_grid(gfx, StructuredBufferDesc<LightGrid>(CLUSTER_COUNT))
+		light_grid(gfx, StructuredBufferDesc<ClusterLightGrid>(CLUSTER_COUNT)),
+		light_binner(CLUSTER_SIZE_X, CLUSTER_SIZE_Y, CLUSTER_SIZE_Z, CLUSTER_MAX_LIGHTS)
 	{
 		CreatePSOs();
 	}
 
-	void ClusteredDeferredLightingPass::AddPass(RenderGraph& rendergraph, Bool recreate_clusters)
+	void ClusteredDeferredLightingPass::AddPass(RenderGraph& rendergraph, std::span<LightGPU const> lights, Bool recreate_clusters)
 	{
 		FrameBlackboardData const& frame_data = rendergraph.GetBlackboard().Get<FrameBlackboardData>();
 
@@ -45,77 +48,102 @@ namespace adria
 		rendergraph.ImportBuffer(RG_NAME(LightGrid), &light_grid);
 		rendergraph.ImportBuffer(RG_NAME(LightList), &light_list);
 
-		struct ClusterBuildingPassData
+		ClusterLightAssignment const light_assignment = (ClusterLightAssignment)std::clamp(LightAssignment.Get(), 0, 2);
+		if (light_assignment != ClusterLightAssignment_GPU)
 		{
-			RGBufferReadWriteId clusters;
-		};
+			light_binner.BuildClusters(frame_data.camera_proj, frame_data.camera_near, frame_data.camera_far);
+		}
 
-		if (recreate_clusters)
+		if (light_assignment == ClusterLightAssignment_CPU)
 		{
-			rendergraph.AddPass<ClusterBuildingPassData>("Cluster Building Pass",
-				[=](ClusterBuildingPassData& data, RenderGraphBuilder& builder)
-				{
-					data.clusters = builder.WriteBuffer(RG_NAME(ClustersBuffer));
-				},
-				[=](ClusterBuildingPassData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
-				{
-					GfxDevice* gfx = cmd_list->GetDevice();
-					GfxDescriptor dst_descriptor = gfx->AllocateDescriptorsGPU();
-					gfx->CopyDescriptors(1, dst_descriptor, context.GetReadWriteBuffer(data.clusters));
-
-					cmd_list->SetPipelineState(clustered_building_pso.get());
-					cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
-					cmd_list->SetRootConstant(1, dst_descriptor.GetIndex(), 0);
-					cmd_list->Dispatch(CLUSTER_SIZE_X, CLUSTER_SIZE_Y, CLUSTER_SIZE_Z);
-				}, RGPassType::Compute, RGPassFlags::None);
+			//the light lists stay in the imported buffers, they are only uploaded again when the binning changed
+			Bool const light_lists_changed = light_binner.BinLights(lights, ConeCulling.Get());
+			if (light_lists_changed || !cpu_light_lists_uploaded) AddLightListUploadPass(rendergraph);
+			cpu_light_lists_uploaded = true;
 		}
-
-		struct ClusterCullingPassData
+		else
 		{
-			RGBufferReadOnlyId  clusters;
-			RGBufferReadWriteId light_counter;
-			RGBufferReadWriteId light_grid;
-			RGBufferReadWriteId light_list;
-		};
-		rendergraph.AddPass<ClusterCullingPassData>("Cluster Culling Pass",
-			[=](ClusterCullingPassData& data, RenderGraphBuilder& builder)
+			cpu_light_lists_uploaded = false;
+
+			struct ClusterBuildingPassData
 			{
-				data.clusters = builder.ReadBuffer(RG_NAME(ClustersBuffer), ReadAccess_NonPixelShader);
-				data.light_counter = builder.WriteBuffer(RG_NAME(LightCounter));
-				data.light_grid = builder.WriteBuffer(RG_NAME(LightGrid));
-				data.light_list = builder.WriteBuffer(RG_NAME(LightList));
-			},
-			[=](ClusterCullingPassData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
+				RGBufferReadWriteId clusters;
+			};
+
+			if (recreate_clusters)
 			{
-				GfxDevice* gfx = cmd_list->GetDevice();
+				rendergraph.AddPass<ClusterBuildingPassData>("Cluster Building Pass",
+					[=](ClusterBuildingPassData& data, RenderGraphBuilder& builder)
+					{
+						data.clusters = builder.WriteBuffer(RG_NAME(ClustersBuffer));
+					},
+					[=](ClusterBuildingPassData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
+					{
+						GfxDevice* gfx = cmd_list->GetDevice();
+						GfxDescriptor dst_descriptor = gfx->AllocateDescriptorsGPU();
+						gfx->CopyDescriptors(1, dst_descriptor, context.GetReadWriteBuffer(data.clusters));
 
-				GfxDescriptor src_handles[] = { context.GetReadOnlyBuffer(data.clusters),
-												context.GetReadWriteBuffer(data.light_counter),
-												context.GetReadWriteBuffer(data.light_list),
-												context.GetReadWriteBuffer(data.light_grid) };
-	
-				GfxDescriptor dst_handle = gfx->AllocateDescriptorsGPU(ARRAYSIZE(src_handles));
-				gfx->CopyDescriptors(dst_handle, src_handles);
+						cmd_list->SetPipelineState(clustered_building_pso.get());
+						cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
+						cmd_list->SetRootConstant(1, dst_descriptor.GetIndex(), 0);
+						cmd_list->Dispatch(CLUSTER_SIZE_X, CLUSTER_SIZE_Y, CLUSTER_SIZE_Z);
+					}, RGPassType::Compute, RGPassFlags::None);
+			}
 
-				Uint32 i = dst_handle.GetIndex();
-				struct ClusterCullingConstants
+			struct ClusterCullingPassData
+			{
+				RGBufferReadOnlyId  clusters;
+				RGBufferReadWriteId light_counter;
+				RGBufferReadWriteId light_grid;
+				RGBufferReadWriteId light_list;
+			};
+			rendergraph.AddPass<ClusterCullingPassData>("Cluster Culling Pass",
+				[=](ClusterCullingPassData& data, RenderGraphBuilder& builder)
 				{
-					Uint32 clusters_idx;
-					Uint32 light_index_counter_idx;
-					Uint32 light_index_list_idx;
-					Uint32 light_grid_idx;
-				} constants =
+					data.clusters = builder.ReadBuffer(RG_NAME(ClustersBuffer), ReadAccess_NonPixelShader);
+					data.light_counter = builder.WriteBuffer(RG_NAME(LightCounter));
+					data.light_grid = builder.WriteBuffer(RG_NAME(LightGrid));
+					data.light_list = builder.WriteBuffer(RG_NAME(LightList));
+				},
+				[=](ClusterCullingPassData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
 				{
-					.clusters_idx = i, .light_index_counter_idx = i + 1,
-					.light_index_list_idx = i + 2, .light_grid_idx = i + 3
-				};
+					GfxDevice* gfx = cmd_list->GetDevice();
 
-				cmd_list->SetPipelineState(clustered_culling_pso.get());
-				cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
-				cmd_list->SetRootConstants(1, constants);
-				cmd_list->Dispatch(CLUSTER_SIZE_X / 16, CLUSTER_SIZE_Y / 16, CLUSTER_SIZE_Z / 1);
+					GfxDescriptor src_handles[] = { context.GetReadOnlyBuffer(data.clusters),
+													context.GetReadWriteBuffer(data.light_counter),
+													context.GetReadWriteBuffer(data.light_list),
+													context.GetReadWriteBuffer(data.light_grid) };
+	
+					GfxDescriptor dst_handle = gfx->AllocateDescriptorsGPU(ARRAYSIZE(src_handles));
+					gfx->CopyDescriptors(dst_handle, src_handles);
 
-			}, RGPassType::Compute, RGPassFlags::None);
+					Uint32 i = dst_handle.GetIndex();
+					struct ClusterCullingConstants
+					{
+						Uint32 clusters_idx;
+						Uint32 light_index_counter_idx;
+						Uint32 light_index_list_idx;
+						Uint32 light_grid_idx;
+					} constants =
+					{
+						.clusters_idx = i, .light_index_counter_idx = i + 1,
+						.light_index_list_idx = i + 2, .light_grid_idx = i + 3
+					};
+
+					cmd_list->SetPipelineState(clustered_culling_pso.get());
+					cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
+					cmd_list->SetRootConstants(1, constants);
+					cmd_list->Dispatch(CLUSTER_SIZE_X / 16, CLUSTER_SIZE_Y / 16, CLUSTER_SIZE_Z / 1);
+
+				}, RGPassType::Compute, RGPassFlags::None);
+
+			if (light_assignment == ClusterLightAssignment_GPUValidated)
+			{
+				//the reference uses sphere tests only, like the culling shader
+				light_binner.BinLights(lights, false);
+				AddValidationReadbackPass(rendergraph);
+			}
+		}
 
 		struct ClusteredDeferredLightingPassData
 		{
@@ -191,6 +219,123 @@ namespace adria
 			}, RGPassType::Compute, RGPassFlags::None);
 	}
 
+	void ClusteredDeferredLightingPass::GUI()
+	{
+		QueueGUI([&]()
+			{
+				if (ImGui::TreeNodeEx("Clustered Deferred", ImGuiTreeNodeFlags_None))
+				{
+					ImGui::Combo("Light Assignment", LightAssignment.GetPtr(), "GPU\0CPU\0GPU validated by CPU\0", 3);
+					if (LightAssignment.Get() == ClusterLightAssignment_CPU) ImGui::Checkbox("Cone Culling", ConeCulling.GetPtr());
+					if (LightAssignment.Get() != ClusterLightAssignment_GPU)
+					{
+						ClusterLightBinnerStats const& stats = light_binner.GetStats();
+						ImGui::Text("Binned lights: %u, light indices: %u", stats.binned_lights, stats.light_index_count);
+						ImGui::Text("Max cluster lights: %u, overflowed clusters: %u", stats.max_cluster_light_count, stats.overflowed_clusters);
+						ImGui::Text("Cluster rebuilds: %u, light rebins: %u", stats.cluster_rebuilds, stats.light_rebins);
+					}
+					if (LightAssignment.Get() == ClusterLightAssignment_GPUValidated)
+					{
+						ImGui::Text("Validated frames: %u, mismatched clusters: %u", validated_frames, mismatched_clusters);
+					}
+					ImGui::TreePop();
+					ImGui::Separator();
+				}
+			}, GUICommandGroup_Renderer
+		);
+	}
+
+	void ClusteredDeferredLightingPass::AddLightListUploadPass(RenderGraph& rendergraph)
+	{
+		struct LightListUploadPassData
+		{
+			RGBufferCopyDstId light_grid;
+			RGBufferCopyDstId light_list;
+		};
+
+		rendergraph.AddPass<LightListUploadPassData>("Cluster Light List Upload Pass",
+			[=](LightListUploadPassData& data, RenderGraphBuilder& builder)
+			{
+				data.light_grid = builder.WriteCopyDstBuffer(RG_NAME(LightGrid));
+				data.light_list = builder.WriteCopyDstBuffer(RG_NAME(LightList));
+			},
+			[=](LightListUploadPassData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
+			{
+				GfxDevice* gfx = cmd_list->GetDevice();
+				GfxLinearDynamicAllocator* dynamic_allocator = gfx->GetDynamicAllocator();
+
+				auto UploadBuffer = [&]<typename T>(std::span<T const> data, GfxBuffer& dst_buffer)
+				{
+					if (data.empty()) return;
+					GfxDynamicAllocation allocation = dynamic_allocator->Allocate(data.size_bytes(), 16);
+					allocation.Update(data.data(), data.size_bytes());
+					cmd_list->CopyBuffer(dst_buffer, 0, *allocation.buffer, allocation.offset, data.size_bytes());
+				};
+				UploadBuffer(light_binner.GetLightGrid(), context.GetCopyDstBuffer(data.light_grid));
+				UploadBuffer(light_binner.GetLightList(), context.GetCopyDstBuffer(data.light_list));
+			}, RGPassType::Copy, RGPassFlags::ForceNoCull);
+	}
+
+	void ClusteredDeferredLightingPass::AddValidationReadbackPass(RenderGraph& rendergraph)
+	{
+		//cpu reference of this frame and the gpu light grid, readbacks resolve in request order so the grid arrives before the list
+		struct ValidationFrame
+		{
+			std::vector<ClusterLightGrid> cpu_light_grid;
+			std::vector<Uint32> cpu_light_list;
+			std::vector<ClusterLightGrid> gpu_light_grid;
+		};
+		std::shared_ptr<ValidationFrame> validation_frame = std::make_shared<ValidationFrame>();
+		validation_frame->cpu_light_grid.assign(light_binner.GetLightGrid().begin(), light_binner.GetLightGrid().end());
+		validation_frame->cpu_light_list.assign(light_binner.GetLightList().begin(), light_binner.GetLightList().end());
+
+		struct ValidationReadbackPassData
+		{
+			RGBufferCopySrcId light_grid;
+			RGBufferCopySrcId light_list;
+		};
+
+		rendergraph.AddPass<ValidationReadbackPassData>("Cluster Light Validation Readback Pass",
+			[=](ValidationReadbackPassData& data, RenderGraphBuilder& builder)
+			{
+				data.light_grid = builder.ReadCopySrcBuffer(RG_NAME(LightGrid));
+				data.light_list = builder.ReadCopySrcBuffer(RG_NAME(LightList));
+			},
+			[=](ValidationReadbackPassData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
+			{
+				GfxReadbackManager* readback_manager = gfx->GetReadbackManager();
+				readback_manager->ReadbackBuffer(cmd_list, context.GetCopySrcBuffer(data.light_grid), [validation_frame](void const* data, Uint64 size)
+					{
+						ClusterLightGrid const* gpu_light_grid = static_cast<ClusterLightGrid const*>(data);
+						validation_frame->gpu_light_grid.assign(gpu_light_grid, gpu_light_grid + size / sizeof(ClusterLightGrid));
+					});
+				readback_manager->ReadbackBuffer(cmd_list, context.GetCopySrcBuffer(data.light_list), [this, validation_frame](void const* data, Uint64 size)
+					{
+						Uint32 const* gpu_light_list = static_cast<Uint32 const*>(data);
+						Uint64 const gpu_light_list_count = size / sizeof(Uint32);
+						if (validation_frame->gpu_light_grid.size() != validation_frame->cpu_light_grid.size()) return;
+
+						Uint32 mismatches = 0;
+						for (Uint64 i = 0; i < validation_frame->cpu_light_grid.size(); ++i)
+						{
+							ClusterLightGrid const& cpu_cluster = validation_frame->cpu_light_grid[i];
+							ClusterLightGrid const& gpu_cluster = validation_frame->gpu_light_grid[i];
+							Bool const match = cpu_cluster.light_count == gpu_cluster.light_count &&
+								(Uint64)gpu_cluster.offset + gpu_cluster.light_count <= gpu_light_list_count &&
+								std::equal(gpu_light_list + gpu_cluster.offset, gpu_light_list + gpu_cluster.offset + gpu_cluster.light_count,
+									validation_frame->cpu_light_list.begin() + cpu_cluster.offset);
+							if (!match) ++mismatches;
+						}
+						if (mismatches > 0 && mismatched_clusters == 0)
+						{
+							ADRIA_LOG(WARNING, "Clustered light assignment: %u clusters differ between the gpu and the cpu binner!", mismatches);
+						}
+						mismatched_clusters = mismatches;
+						++validated_frames;
+					});
+			}, RGPassType::Copy, RGPassFlags::ForceNoCull);
+	}
+
 	void ClusteredDeferredLightingPass::CreatePSOs()
 	{
 		GfxComputePipelineStateDesc compute_pso_desc{};
@@ -1,4 +1,5 @@
 #pragma once
+#include "ClusterLightBinner.h"
 #include "Graphics/GfxBuffer.h"
 #include "RenderGraph/RenderGraphResourceId.h"
 #include "entt/entity/entity.hpp"
@@ -9,6 +10,8 @@ namespace adria
 	class GfxDevice;
 	class GfxComputePipelineState;
 
+	//light assignment to clusters runs either on the gpu, or on the cpu with ClusterLightBinner and the light lists are uploaded.
+	//the cpu path only rebins when the projection or the lights change and skips the upload when nothing changed
 	class ClusteredDeferredLightingPass
 	{
 		static constexpr Uint32 CLUSTER_SIZE_X = 16;
@@ -20,7 +23,8 @@ namespace adria
 	public:
 		ClusteredDeferredLightingPass(entt::registry& reg, GfxDevice* gfx, Uint32 w, Uint32 h);
 
-		void AddPass(RenderGraph& rendergraph, Bool recreate_clusters);
+		void AddPass(RenderGraph& rendergraph, std::span<LightGPU const> lights, Bool recreate_clusters);
+		void GUI();
 
 		void OnResize(Uint32 w, Uint32 h)
 		{
@@ -40,8 +44,15 @@ namespace adria
 		std::unique_ptr<GfxComputePipelineState> clustered_building_pso;
 		std::unique_ptr<GfxComputePipelineState> clustered_culling_pso;
 
+		ClusterLightBinner light_binner;
+		Bool cpu_light_lists_uploaded = false;
+		Uint32 validated_frames = 0;
+		Uint32 mismatched_clusters = 0;
+
 	private:
 		void CreatePSOs();
+		void AddLightListUploadPass(RenderGraph& rendergraph);
+		void AddValidationReadbackPass(RenderGraph& rendergraph);
 	};
 
 }
\ No newline at end of file
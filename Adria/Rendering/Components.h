@@ -94,6 +94,8 @@ namespace adria
 		Sint32 shadow_matrix_index = -1;
 		Sint32 shadow_mask_index = -1;
 		Uint32 light_index = 0;
+		//scales the screen coverage that point and spot shadow tiles are sized by
+		Float shadow_importance = 1.0f;
 
 		Float volumetric_strength = 0.004f;
 		Bool volumetric = false;
@@ -126,10 +128,31 @@ namespace adria
 		std::string name = "name tag";
 	};
 
-	struct COMPONENT RayTracing {};
+	struct COMPONENT RayTracing
+	{
+		Bool dynamic = false;		//instance transforms change, the TLAS is built with update support
+		Bool deformable = false;	//vertex positions change, the BLASes are built for fast build and refit every frame
+		Uint32 first_instance = 0;	//set by AccelerationStructure
+	};
 	struct COMPONENT Ocean {};
 	struct COMPONENT Deferred {};
 
+	//simplified cpu copy of an opaque submesh used by the software occlusion culler
+	struct OccluderMesh
+	{
+		std::vector<Vector3> positions;
+		std::vector<Uint32> indices;
+	};
+
+	//layout of the vertex streams, see MESH_QUANTIZED_* in Scene.hlsli
+	enum MeshVertexFlagBit : Uint32
+	{
+		MeshVertexFlag_None = 0x0,
+		MeshVertexFlag_QuantizedPositions = 0x1,	//uint2, 16 bit unorm in the bounding box
+		MeshVertexFlag_QuantizedNormals = 0x2,		//uint, octahedral normal and tangent with the bitangent sign
+		MeshVertexFlag_QuantizedUVs = 0x4,			//uint, half2
+	};
+
 	struct SubMeshGPU
 	{
 		Uint64 buffer_address;
@@ -143,6 +166,8 @@ namespace adria
 		Uint32 normals_offset;
 		Uint32 tangents_offset;
 
+		Uint32 vertex_flags = MeshVertexFlag_None;
+
 		Uint32 meshlet_offset;
 		Uint32 meshlet_vertices_offset;
 		Uint32 meshlet_triangles_offset;
@@ -151,6 +176,7 @@ namespace adria
 		Uint32 material_index;
 		DirectX::BoundingBox bounding_box;
 		GfxPrimitiveTopology topology;
+		std::shared_ptr<OccluderMesh> occluder;
 	};
 	struct SubMeshInstance
 	{
@@ -170,6 +196,7 @@ namespace adria
 	{
 		Uint32   instance_id;
 		SubMeshGPU*  submesh;
+		Material const* material;
 		MaterialAlphaMode alpha_mode;
 		Matrix world_transform;
 		BoundingBox bounding_box;
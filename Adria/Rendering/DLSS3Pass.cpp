@@ -23,7 +23,7 @@ namespace adria
 	}
 
 	DLSS3Pass::DLSS3Pass(GfxDevice* gfx, Uint32 w, Uint32 h) 
-		: gfx(gfx), display_width(), display_height(), render_width(), render_height()
+		: gfx(gfx), display_width(), display_height(), render_width(), render_height(), max_render_width(), max_render_height(), min_render_width(), min_render_height()
 	{
 		sprintf(name_version, "DLSS 3.5");
 		is_supported = InitializeNVSDK_NGX();
@@ -268,8 +268,17 @@ namespace adria
 		NGX_DLSS_GET_OPTIMAL_SETTINGS(ngx_parameters, display_width, display_height, perf_quality, 
 									  &optimal_width, &optimal_height, &max_width, &max_height, &min_width, &min_height, &sharpness);
 		ADRIA_ASSERT(optimal_width != 0 && optimal_height != 0);
-		render_width = optimal_width;
-		render_height = optimal_height;
+		max_render_width = optimal_width;
+		max_render_height = optimal_height;
+		min_render_width = min_width;
+		min_render_height = min_height;
+		OnDynamicResolutionScaleChanged();
+	}
+
+	void DLSS3Pass::OnDynamicResolutionScaleChanged()
+	{
+		render_width = ApplyDynamicResolutionScale(max_render_width, min_render_width);
+		render_height = ApplyDynamicResolutionScale(max_render_height, min_render_height);
 		BroadcastRenderResolutionChanged(render_width, render_height);
 	}
 
@@ -281,8 +290,8 @@ namespace adria
 		if (needs_create)
 		{
 			NVSDK_NGX_DLSS_Create_Params dlss_create_params{};
-			dlss_create_params.Feature.InWidth = render_width;
-			dlss_create_params.Feature.InHeight = render_height;
+			dlss_create_params.Feature.InWidth = max_render_width;
+			dlss_create_params.Feature.InHeight = max_render_height;
 			dlss_create_params.Feature.InTargetWidth = display_width;
 			dlss_create_params.Feature.InTargetHeight = display_height;
 			dlss_create_params.Feature.InPerfQualityValue = perf_quality;
@@ -39,6 +39,8 @@ namespace adria
 		GfxDevice* gfx = nullptr;
 		Uint32 display_width, display_height;
 		Uint32 render_width, render_height;
+		Uint32 max_render_width, max_render_height;
+		Uint32 min_render_width, min_render_height;
 
 		NVSDK_NGX_Parameter* ngx_parameters = nullptr;
 		NVSDK_NGX_Handle* dlss_feature = nullptr;
@@ -50,6 +52,7 @@ namespace adria
 	private:
 		Bool InitializeNVSDK_NGX();
 		void RecreateRenderResolution();
+		virtual void OnDynamicResolutionScaleChanged() override;
 
 		void CreateDLSS(GfxCommandList* cmd_list);
 		void ReleaseDLSS();
@@ -0,0 +1,91 @@
+#include "DynamicResolutionController.h"
+
+namespace adria
+{
+	DynamicResolutionController::DynamicResolutionController(DynamicResolutionSettings const& settings)
+	{
+		SetSettings(settings);
+		Reset();
+	}
+
+	void DynamicResolutionController::SetSettings(DynamicResolutionSettings const& _settings)
+	{
+		settings = _settings;
+		settings.min_scale = std::clamp(settings.min_scale, 0.1f, 1.0f);
+		settings.max_scale = std::clamp(settings.max_scale, settings.min_scale, 1.0f);
+		unquantized_scale = std::clamp(unquantized_scale, settings.min_scale, settings.max_scale);
+		Float const new_scale = Quantize(unquantized_scale);
+		if (new_scale != scale)
+		{
+			scale = new_scale;
+			frames_since_change = 0;
+			has_sample = false;
+		}
+	}
+
+	void DynamicResolutionController::Reset()
+	{
+		scale = Quantize(settings.max_scale);
+		unquantized_scale = scale;
+		filtered_frame_time_ms = 0.0f;
+		has_sample = false;
+		prev_error = prev_prev_error = 0.0f;
+		frames_since_change = 0;
+		scale_change_count = 0;
+	}
+
+	Bool DynamicResolutionController::Update(Float gpu_frame_time_ms)
+	{
+		if (gpu_frame_time_ms <= 0.0f) return false;
+		//samples recorded before the last change are still in flight
+		if (frames_since_change < settings.settle_frames)
+		{
+			++frames_since_change;
+			return false;
+		}
+
+		filtered_frame_time_ms = has_sample ? filtered_frame_time_ms + (gpu_frame_time_ms - filtered_frame_time_ms) * settings.smoothing : gpu_frame_time_ms;
+		has_sample = true;
+
+		Float const upper_budget = settings.target_frame_time_ms;
+		Float const lower_budget = settings.target_frame_time_ms * (1.0f - settings.hysteresis);
+		Float error = 0.0f;
+		if (filtered_frame_time_ms > upper_budget)		error = std::sqrt(upper_budget / filtered_frame_time_ms) - 1.0f;
+		else if (filtered_frame_time_ms < lower_budget) error = std::sqrt(lower_budget / filtered_frame_time_ms) - 1.0f;
+
+		if (error == 0.0f)
+		{
+			//inside the band, drop the history so leaving it does not start with a kick
+			prev_error = prev_prev_error = 0.0f;
+			return false;
+		}
+
+		Float const delta = settings.kp * (error - prev_error) + settings.ki * error + settings.kd * (error - 2.0f * prev_error + prev_prev_error);
+		prev_prev_error = prev_error;
+		prev_error = error;
+		unquantized_scale = std::clamp(unquantized_scale * (1.0f + delta), settings.min_scale, settings.max_scale);
+
+		//a new step is only taken once the unquantized scale is well past the midpoint between two steps
+		Float const new_scale = Quantize(unquantized_scale);
+		if (new_scale == scale || std::abs(unquantized_scale - scale) < settings.scale_step * 0.75f) return false;
+		//going up has to land inside the band, otherwise the scale keeps bouncing between two steps that straddle it
+		if (new_scale > scale && filtered_frame_time_ms * (new_scale * new_scale) / (scale * scale) > upper_budget)
+		{
+			unquantized_scale = scale;
+			return false;
+		}
+
+		scale = new_scale;
+		frames_since_change = 0;
+		has_sample = false;
+		prev_error = prev_prev_error = 0.0f;
+		++scale_change_count;
+		return true;
+	}
+
+	Float DynamicResolutionController::Quantize(Float value) const
+	{
+		if (settings.scale_step > 0.0f) value = std::round(value / settings.scale_step) * settings.scale_step;
+		return std::clamp(value, settings.min_scale, settings.max_scale);
+	}
+}
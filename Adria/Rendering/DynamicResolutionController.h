@@ -0,0 +1,58 @@
+#pragma once
+
+namespace adria
+{
+	struct DynamicResolutionSettings
+	{
+		Float target_frame_time_ms = 16.67f;
+		//fraction of the target below it in which the scale is kept, the controller settles inside [target * (1 - hysteresis), target]
+		Float hysteresis = 0.1f;
+		Float min_scale = 0.5f;
+		Float max_scale = 1.0f;
+		//applied scales are multiples of the step so the render graph pool only ever sees a few texture sizes
+		Float scale_step = 0.05f;
+		//weight of a new sample in the exponential average of the frame time
+		Float smoothing = 0.25f;
+		//gains of the velocity form pid, ki moves the scale towards the budget, kp and kd damp the response
+		Float kp = 0.15f;
+		Float ki = 0.35f;
+		Float kd = 0.05f;
+		//samples ignored after a scale change, gpu timings reach the cpu a few frames late
+		Uint32 settle_frames = 6;
+	};
+
+	//keeps the gpu frame time under a budget by scaling the render resolution. pure cpu, the caller feeds it one measured
+	//gpu frame time per frame and applies GetScale when Update returns true. gpu time is assumed to scale with the pixel
+	//count, so the error is expressed as the relative scale change that would hit the budget
+	class DynamicResolutionController
+	{
+	public:
+		explicit DynamicResolutionController(DynamicResolutionSettings const& settings = {});
+
+		void SetSettings(DynamicResolutionSettings const& settings);
+		DynamicResolutionSettings const& GetSettings() const { return settings; }
+
+		void Reset();
+		//returns true if the applied scale changed
+		Bool Update(Float gpu_frame_time_ms);
+
+		Float GetScale() const { return scale; }
+		Float GetUnquantizedScale() const { return unquantized_scale; }
+		Float GetFilteredFrameTime() const { return filtered_frame_time_ms; }
+		Uint32 GetScaleChangeCount() const { return scale_change_count; }
+
+	private:
+		DynamicResolutionSettings settings;
+		Float scale = 1.0f;
+		Float unquantized_scale = 1.0f;
+		Float filtered_frame_time_ms = 0.0f;
+		Bool has_sample = false;
+		Float prev_error = 0.0f;
+		Float prev_prev_error = 0.0f;
+		Uint32 frames_since_change = 0;
+		Uint32 scale_change_count = 0;
+
+	private:
+		Float Quantize(Float value) const;
+	};
+}
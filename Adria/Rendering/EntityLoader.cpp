@@ -1,3 +1,5 @@
+#include <execution>
+#include <numeric>
 #define TINYOBJLOADER_IMPLEMENTATION
 #define TINYOBJLOADER_USE_MAPBOX_EARCUT
 #define CGLTF_IMPLEMENTATION
@@ -7,14 +9,17 @@
 #include "EntityLoader.h"
 #include "Components.h"
 #include "Meshlet.h"
+#include "MeshletLOD.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxLinearDynamicAllocator.h"
 #include "Logging/Logger.h"
 #include "Math/BoundingVolumeUtil.h"
+#include "Math/Packing.h"
 #include "Core/Paths.h"
 #include "Utilities/StringUtil.h"
 #include "Utilities/FilesUtil.h"
 #include "Utilities/Heightmap.h"
+#include "Utilities/VirtualFileSystem.h"
 
 
 using namespace DirectX;
@@ -22,6 +27,58 @@ using namespace DirectX;
 
 namespace adria
 {
+	namespace
+	{
+		constexpr Uint32 MaxOccluderTriangles = 1024;
+		//half precision uvs have an error below 1/1024 up to this magnitude, meshes with larger uvs keep float uvs
+		constexpr Float MaxQuantizedUV = 4.0f;
+
+		//gltf and buffer files are read through the virtual file system, so models in a mounted pak load like loose files
+		cgltf_result ReadGLTFFile(cgltf_memory_options const*, cgltf_file_options const*, Char const* path, cgltf_size* size, void** data)
+		{
+			VFSFile file;
+			if (!g_VirtualFileSystem.ReadFile(path, file)) return cgltf_result_file_not_found;
+			void* file_data = malloc(std::max(file.Size(), (Uint64)1));
+			if (!file_data) return cgltf_result_out_of_memory;
+			if (file.Size() > 0) memcpy(file_data, file.Data(), file.Size());
+			*size = file.Size();
+			*data = file_data;
+			return cgltf_result_success;
+		}
+		void ReleaseGLTFFile(cgltf_memory_options const*, cgltf_file_options const*, void* data)
+		{
+			free(data);
+		}
+
+		//simplified copy of the submesh for the software occlusion culler. the simplifier only collapses edges into existing vertices,
+		//so the occluder stays inside the bounds of the submesh. meshes that cannot be simplified enough are not occluders
+		std::shared_ptr<OccluderMesh> CreateOccluderMesh(std::vector<Vector3> const& positions, std::vector<Uint32> const& indices)
+		{
+			if (indices.empty()) return nullptr;
+
+			std::vector<Uint32> occluder_indices(indices.size());
+			Uint64 occluder_index_count = indices.size();
+			if (indices.size() > MaxOccluderTriangles * 3)
+			{
+				occluder_index_count = meshopt_simplify(occluder_indices.data(), indices.data(), indices.size(), &positions[0].x, positions.size(), sizeof(Vector3),
+					MaxOccluderTriangles * 3, 1e-2f);
+				if (occluder_index_count == 0 || occluder_index_count > MaxOccluderTriangles * 3) return nullptr;
+			}
+			else
+			{
+				std::copy(indices.begin(), indices.end(), occluder_indices.begin());
+			}
+			occluder_indices.resize(occluder_index_count);
+
+			std::shared_ptr<OccluderMesh> occluder = std::make_shared<OccluderMesh>();
+			occluder->positions.resize(positions.size());
+			Uint64 const vertex_count = meshopt_optimizeVertexFetch(occluder->positions.data(), occluder_indices.data(), occluder_indices.size(), positions.data(), positions.size(), sizeof(Vector3));
+			occluder->positions.resize(vertex_count);
+			occluder->indices = std::move(occluder_indices);
+			return occluder;
+		}
+	}
+
 
 	std::vector<entt::entity> EntityLoader::LoadGrid(GridParameters const& params)
 	{
@@ -32,21 +89,24 @@ namespace adria
 		}
 
 		std::vector<entt::entity> chunks;
-		std::vector<TexturedNormalVertex> vertices{};
-		for (Uint64 j = 0; j <= params.tile_count_z; j++)
-		{
-			for (Uint64 i = 0; i <= params.tile_count_x; i++)
+		Uint64 const row_size = params.tile_count_x + 1;
+		std::vector<Uint64> rows(params.tile_count_z + 1);
+		std::iota(rows.begin(), rows.end(), 0);
+
+		std::vector<TexturedNormalVertex> vertices(row_size * rows.size());
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](Uint64 j)
 			{
-				TexturedNormalVertex vertex{};
+				for (Uint64 i = 0; i <= params.tile_count_x; i++)
+				{
+					TexturedNormalVertex& vertex = vertices[j * row_size + i];
 
-				Float height = params.heightmap ? params.heightmap->HeightAt(i, j) : 0.0f;
+					Float height = params.heightmap ? params.heightmap->HeightAt(i, j) : 0.0f;
 
-				vertex.position = Vector3(i * params.tile_size_x, height, j * params.tile_size_z);
-				vertex.uv = Vector2(i * 1.0f * params.texture_scale_x / (params.tile_count_x - 1), j * 1.0f * params.texture_scale_z / (params.tile_count_z - 1));
-				vertex.normal = Vector3(0.0f, 1.0f, 0.0f);
-				vertices.push_back(vertex);
-			}
-		}
+					vertex.position = Vector3(i * params.tile_size_x, height, j * params.tile_size_z);
+					vertex.uv = Vector2(i * 1.0f * params.texture_scale_x / (params.tile_count_x - 1), j * 1.0f * params.texture_scale_z / (params.tile_count_z - 1));
+					vertex.normal = Vector3(0.0f, 1.0f, 0.0f);
+				}
+			});
 
 		if (!params.split_to_chunks)
 		{
@@ -110,52 +170,67 @@ namespace adria
 		}
 		else
 		{
-			std::vector<Uint32> indices{};
+			struct GridChunk
+			{
+				Uint64 tile_x;
+				Uint64 tile_z;
+				BoundingBox bounding_box;
+			};
+			std::vector<GridChunk> grid_chunks;
 			for (Uint64 j = 0; j < params.tile_count_z; j += params.chunk_count_z)
 			{
 				for (Uint64 i = 0; i < params.tile_count_x; i += params.chunk_count_x)
 				{
-					entt::entity chunk = reg.create();
-
-					Uint32 const indices_count = static_cast<Uint32>(params.chunk_count_z * params.chunk_count_x * 3 * 2);
-					Uint32 const indices_offset = static_cast<Uint32>(indices.size());
-
+					grid_chunks.push_back(GridChunk{ .tile_x = i, .tile_z = j });
+				}
+			}
 
-					std::vector<TexturedNormalVertex> chunk_vertices_aabb{};
-					for (Uint64 k = j; k < j + params.chunk_count_z; ++k)
+			//every chunk owns a fixed slice of the index buffer, so chunks are generated independently
+			Uint32 const indices_count = static_cast<Uint32>(params.chunk_count_z * params.chunk_count_x * 3 * 2);
+			std::vector<Uint32> indices(grid_chunks.size() * indices_count);
+			std::for_each(std::execution::par, grid_chunks.begin(), grid_chunks.end(), [&](GridChunk& grid_chunk)
+				{
+					Uint64 const chunk_index = &grid_chunk - grid_chunks.data();
+					Uint32* chunk_indices = indices.data() + chunk_index * indices_count;
+					Vector3 min_corner(FLT_MAX, FLT_MAX, FLT_MAX);
+					Vector3 max_corner(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+					for (Uint64 k = grid_chunk.tile_z; k < grid_chunk.tile_z + params.chunk_count_z; ++k)
 					{
-						for (Uint64 m = i; m < i + params.chunk_count_x; ++m)
+						for (Uint64 m = grid_chunk.tile_x; m < grid_chunk.tile_x + params.chunk_count_x; ++m)
 						{
-
-							Uint32 i1 = static_cast<Uint32>(k * (params.tile_count_x + 1) + m);
+							Uint32 i1 = static_cast<Uint32>(k * row_size + m);
 							Uint32 i2 = static_cast<Uint32>(i1 + 1);
-							Uint32 i3 = static_cast<Uint32>((k + 1) * (params.tile_count_x + 1) + m);
+							Uint32 i3 = static_cast<Uint32>((k + 1) * row_size + m);
 							Uint32 i4 = static_cast<Uint32>(i3 + 1);
 
-							indices.push_back(i1);
-							indices.push_back(i3);
-							indices.push_back(i2);
+							*chunk_indices++ = i1;
+							*chunk_indices++ = i3;
+							*chunk_indices++ = i2;
 
-							indices.push_back(i2);
-							indices.push_back(i3);
-							indices.push_back(i4);
+							*chunk_indices++ = i2;
+							*chunk_indices++ = i3;
+							*chunk_indices++ = i4;
 
-
-							chunk_vertices_aabb.push_back(vertices[i1]);
-							chunk_vertices_aabb.push_back(vertices[i2]);
-							chunk_vertices_aabb.push_back(vertices[i3]);
-							chunk_vertices_aabb.push_back(vertices[i4]);
+							for (Uint32 index : { i1, i2, i3, i4 })
+							{
+								min_corner = Vector3::Min(min_corner, vertices[index].position);
+								max_corner = Vector3::Max(max_corner, vertices[index].position);
+							}
 						}
 					}
+					grid_chunk.bounding_box = BoundingBox((min_corner + max_corner) * 0.5f, (max_corner - min_corner) * 0.5f);
+				});
 
-					SubMesh submesh{};
-					submesh.indices_count = indices_count;
-					submesh.start_index_location = indices_offset;
-					submesh.bounding_box = AABBFromRange(chunk_vertices_aabb.begin(), chunk_vertices_aabb.end());
-					reg.emplace<SubMesh>(chunk, submesh);
-					reg.emplace<Transform>(chunk);
-					chunks.push_back(chunk);
-				}
+			for (Uint64 c = 0; c < grid_chunks.size(); ++c)
+			{
+				entt::entity chunk = reg.create();
+				SubMesh submesh{};
+				submesh.indices_count = indices_count;
+				submesh.start_index_location = static_cast<Uint32>(c * indices_count);
+				submesh.bounding_box = grid_chunks[c].bounding_box;
+				reg.emplace<SubMesh>(chunk, submesh);
+				reg.emplace<Transform>(chunk);
+				chunks.push_back(chunk);
 			}
 			ComputeNormals(params.normal_type, vertices, indices);
 
@@ -487,6 +562,8 @@ namespace adria
 	entt::entity EntityLoader::ImportModel_GLTF(ModelParameters const& params)
 	{
 		cgltf_options options{};
+		options.file.read = ReadGLTFFile;
+		options.file.release = ReleaseGLTFFile;
 		cgltf_data* gltf_data = nullptr;
 		cgltf_result result = cgltf_parse_file(&options, params.model_path.c_str(), &gltf_data);
 		if (result != cgltf_result_success)
@@ -494,12 +571,30 @@ namespace adria
 			ADRIA_LOG(WARNING, "GLTF - Failed to load '%s'", params.model_path.c_str());
 			return entt::null;
 		}
+
+		//the material textures are read in one batch while the buffers load and decoded together before the materials need them
+		std::vector<std::string> texture_paths;
+		for (Uint32 i = 0; i < gltf_data->materials_count; ++i)
+		{
+			cgltf_material const& gltf_material = gltf_data->materials[i];
+			for (cgltf_texture const* texture : { gltf_material.pbr_metallic_roughness.base_color_texture.texture, gltf_material.pbr_metallic_roughness.metallic_roughness_texture.texture,
+												  gltf_material.normal_texture.texture, gltf_material.emissive_texture.texture })
+			{
+				if (!texture || !texture->image || !texture->image->uri) continue;
+				std::string texture_path = params.textures_path + texture->image->uri;
+				if (std::find(texture_paths.begin(), texture_paths.end(), texture_path) == texture_paths.end()) texture_paths.push_back(std::move(texture_path));
+			}
+		}
+		std::future<std::vector<VFSFile>> texture_files = g_VirtualFileSystem.ReadFilesAsync(texture_paths);
+
 		result = cgltf_load_buffers(&options, gltf_data, params.model_path.c_str());
 		if (result != cgltf_result_success)
 		{
 			ADRIA_LOG(WARNING, "GLTF - Failed to load buffers '%s'", params.model_path.c_str());
+			cgltf_free(gltf_data);
 			return entt::null;
 		}
+		g_TextureManager.PreloadTextures(texture_paths, texture_files.get());
 
 		std::string model_name = GetFilename(params.model_path);
 		entt::entity mesh_entity = reg.create();
@@ -600,6 +695,14 @@ namespace adria
 			std::vector<Meshlet>		 meshlets;
 			std::vector<Uint32>			 meshlet_vertices;
 			std::vector<MeshletTriangle> meshlet_triangles;
+
+			std::shared_ptr<OccluderMesh> occluder;
+
+			Uint32 vertex_flags = MeshVertexFlag_None;
+			std::vector<Uint64> quantized_positions;
+			std::vector<Uint32> quantized_normals;
+			std::vector<Uint32> quantized_tangents;
+			std::vector<Uint32> quantized_uvs;
 		};
 		std::vector<MeshData> mesh_datas{};
 		for (Uint32 i = 0; i < gltf_data->meshes_count; ++i)
@@ -672,6 +775,8 @@ namespace adria
 		}
 
 		Uint64 total_buffer_size = 0;
+		Uint32 lod_level_count = 0;
+		Uint64 base_triangle_count = 0, root_triangle_count = 0;
 		for (auto& mesh_data : mesh_datas)
 		{
 			std::vector<Uint32> const& indices = mesh_data.indices;
@@ -698,73 +803,97 @@ namespace adria
 			meshopt_remapVertexBuffer(mesh_data.tangents_stream.data(), mesh_data.tangents_stream.data(), mesh_data.tangents_stream.size(), sizeof(Vector4), &remap[0]);
 			meshopt_remapVertexBuffer(mesh_data.uvs_stream.data(), mesh_data.uvs_stream.data(), mesh_data.uvs_stream.size(), sizeof(Vector2), &remap[0]);
 
-			Uint64 const max_meshlets = meshopt_buildMeshletsBound(mesh_data.indices.size(), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
-			mesh_data.meshlets.resize(max_meshlets);
-			mesh_data.meshlet_vertices.resize(max_meshlets * MESHLET_MAX_VERTICES);
-
-			std::vector<unsigned char> meshlet_triangles(max_meshlets * MESHLET_MAX_TRIANGLES * 3);
-			std::vector<meshopt_Meshlet> meshlets(max_meshlets);
-
-			Uint64 meshlet_count = meshopt_buildMeshlets(meshlets.data(), mesh_data.meshlet_vertices.data(), meshlet_triangles.data(),
-				mesh_data.indices.data(), mesh_data.indices.size(), &mesh_data.positions_stream[0].x, mesh_data.positions_stream.size(), sizeof(Vector3),
-				MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, 0);
+			Material const* material = mesh_data.material_index >= 0 && mesh_data.material_index < (Sint32)mesh.materials.size() ? &mesh.materials[mesh_data.material_index] : nullptr;
+			Bool const is_opaque = material && material->alpha_mode == MaterialAlphaMode::Opaque;
+			//back faces of double sided materials are visible, so their meshlets must not be backface culled
+			Bool const is_double_sided = !material || material->double_sided;
+			if (is_opaque && mesh_data.topology == GfxPrimitiveTopology::TriangleList)
+			{
+				mesh_data.occluder = CreateOccluderMesh(mesh_data.positions_stream, mesh_data.indices);
+			}
 
-			meshopt_Meshlet const& last = meshlets[meshlet_count - 1];
-			meshlet_triangles.resize(last.triangle_offset + ((last.triangle_count * 3 + 3) & ~3));
-			meshlets.resize(meshlet_count);
+			MeshletHierarchyParams hierarchy_params{};
+			hierarchy_params.cone_weight = params.meshlet_cone_weight;
+			hierarchy_params.double_sided = is_double_sided;
+			if (!params.meshlet_lods || mesh_data.topology != GfxPrimitiveTopology::TriangleList) hierarchy_params.max_levels = 1;
+			MeshletHierarchy hierarchy;
+			BuildMeshletHierarchy(hierarchy, mesh_data.positions_stream.data(), vertex_count, mesh_data.indices.data(), mesh_data.indices.size(), hierarchy_params);
+			if (!hierarchy.levels.empty())
+			{
+				lod_level_count = std::max(lod_level_count, (Uint32)hierarchy.levels.size());
+				base_triangle_count += hierarchy.levels[0].triangle_count;
+				for (Meshlet const& meshlet : hierarchy.meshlets)
+				{
+					if (meshlet.parent_lod_bounds.error == FLT_MAX) root_triangle_count += meshlet.triangle_count;
+				}
+			}
+			mesh_data.meshlets = std::move(hierarchy.meshlets);
+			mesh_data.meshlet_vertices = std::move(hierarchy.meshlet_vertices);
+			mesh_data.meshlet_triangles = std::move(hierarchy.meshlet_triangles);
 
-			mesh_data.meshlets.resize(meshlet_count);
-			mesh_data.meshlet_vertices.resize(last.vertex_offset + last.vertex_count);
-			mesh_data.meshlet_triangles.resize(meshlet_triangles.size() / 3);
+			mesh_data.bounding_box = AABBFromPositions(mesh_data.positions_stream);
 
-			Uint32 triangle_offset = 0;
-			for (Uint64 i = 0; i < meshlet_count; ++i)
+			Uint64 const float_vertex_size = sizeof(Vector3) + sizeof(Vector2) + sizeof(Vector3) + sizeof(Vector4);
+			Uint64 vertex_size = float_vertex_size;
+			if (params.quantize_vertices)
 			{
-				meshopt_Meshlet const& m = meshlets[i];
-				meshopt_Bounds meshopt_bounds = meshopt_computeMeshletBounds(&mesh_data.meshlet_vertices[m.vertex_offset], &meshlet_triangles[m.triangle_offset],
-					m.triangle_count, reinterpret_cast<Float const*>(mesh_data.positions_stream.data()), vertex_count, sizeof(Vector3));
-
-				unsigned char* src_triangles = meshlet_triangles.data() + m.triangle_offset;
-				for (Uint32 triangle_idx = 0; triangle_idx < m.triangle_count; ++triangle_idx)
+				//acceleration structures are built and refit from the float positions in the geometry buffer
+				if (!gfx->GetCapabilities().SupportsRayTracing())
 				{
-					MeshletTriangle& tri = mesh_data.meshlet_triangles[triangle_idx + triangle_offset];
-					tri.V0 = *src_triangles++;
-					tri.V1 = *src_triangles++;
-					tri.V2 = *src_triangles++;
+					Vector3 const position_bias = Vector3(mesh_data.bounding_box.Center) - Vector3(mesh_data.bounding_box.Extents);
+					Vector3 const position_scale = Vector3(mesh_data.bounding_box.Extents) * 2.0f;
+					mesh_data.quantized_positions.resize(vertex_count);
+					for (Uint64 v = 0; v < vertex_count; ++v) mesh_data.quantized_positions[v] = QuantizePosition(mesh_data.positions_stream[v], position_bias, position_scale);
+					mesh_data.vertex_flags |= MeshVertexFlag_QuantizedPositions;
+					vertex_size -= sizeof(Vector3) - sizeof(Uint64);
 				}
 
-				Meshlet& meshlet = mesh_data.meshlets[i];
-				std::memcpy(meshlet.center, meshopt_bounds.center, sizeof(Float) * 3);
-
-				meshlet.radius = meshopt_bounds.radius;
-				meshlet.vertex_count = m.vertex_count;
-				meshlet.triangle_count = m.triangle_count;
-				meshlet.vertex_offset = m.vertex_offset;
-				meshlet.triangle_offset = triangle_offset;
-				triangle_offset += m.triangle_count;
+				mesh_data.quantized_normals.resize(vertex_count);
+				mesh_data.quantized_tangents.resize(vertex_count);
+				for (Uint64 v = 0; v < vertex_count; ++v)
+				{
+					mesh_data.quantized_normals[v] = EncodeNormal16x2(mesh_data.normals_stream[v]);
+					mesh_data.quantized_tangents[v] = EncodeTangent15x2(mesh_data.tangents_stream[v]);
+				}
+				mesh_data.vertex_flags |= MeshVertexFlag_QuantizedNormals;
+				vertex_size -= sizeof(Vector3) + sizeof(Vector4) - 2 * sizeof(Uint32);
 
+				Bool const uvs_fit = std::all_of(mesh_data.uvs_stream.begin(), mesh_data.uvs_stream.end(), [](Vector2 const& uv)
+					{
+						return std::abs(uv.x) <= MaxQuantizedUV && std::abs(uv.y) <= MaxQuantizedUV;
+					});
+				if (uvs_fit)
+				{
+					mesh_data.quantized_uvs.resize(vertex_count);
+					for (Uint64 v = 0; v < vertex_count; ++v) mesh_data.quantized_uvs[v] = PackTwoFloatsToUint32(mesh_data.uvs_stream[v].x, mesh_data.uvs_stream[v].y);
+					mesh_data.vertex_flags |= MeshVertexFlag_QuantizedUVs;
+					vertex_size -= sizeof(Vector2) - sizeof(Uint32);
+				}
+				vertex_stream_stats.quantized_vertex_count += vertex_count;
 			}
-			mesh_data.meshlet_triangles.resize(triangle_offset);
+			vertex_stream_stats.vertex_count += vertex_count;
+			vertex_stream_stats.float_size += vertex_count * float_vertex_size;
+			vertex_stream_stats.stored_size += vertex_count * vertex_size;
 
 			total_buffer_size += Align(mesh_data.indices.size() * sizeof(Uint32), 16);
-			total_buffer_size += Align(mesh_data.positions_stream.size() * sizeof(Vector3), 16);
-			total_buffer_size += Align(mesh_data.uvs_stream.size() * sizeof(Vector2), 16);
-			total_buffer_size += Align(mesh_data.normals_stream.size() * sizeof(Vector3), 16);
-			total_buffer_size += Align(mesh_data.tangents_stream.size() * sizeof(Vector4), 16);
+			total_buffer_size += Align(vertex_count * (mesh_data.vertex_flags & MeshVertexFlag_QuantizedPositions ? sizeof(Uint64) : sizeof(Vector3)), 16);
+			total_buffer_size += Align(vertex_count * (mesh_data.vertex_flags & MeshVertexFlag_QuantizedUVs ? sizeof(Uint32) : sizeof(Vector2)), 16);
+			total_buffer_size += Align(vertex_count * (mesh_data.vertex_flags & MeshVertexFlag_QuantizedNormals ? sizeof(Uint32) : sizeof(Vector3)), 16);
+			total_buffer_size += Align(vertex_count * (mesh_data.vertex_flags & MeshVertexFlag_QuantizedNormals ? sizeof(Uint32) : sizeof(Vector4)), 16);
 			total_buffer_size += Align(mesh_data.meshlets.size() * sizeof(Meshlet), 16);
 			total_buffer_size += Align(mesh_data.meshlet_vertices.size() * sizeof(Uint32), 16);
 			total_buffer_size += Align(mesh_data.meshlet_triangles.size() * sizeof(MeshletTriangle), 16);
-
-			mesh_data.bounding_box = AABBFromPositions(mesh_data.positions_stream);
 		}
 
-		GfxDynamicAllocation staging_buffer = gfx->GetDynamicAllocator()->Allocate(total_buffer_size, 16);
+		//streams are uploaded one by one through the bounded staging ring of the upload manager,
+		//so the copies overlap with loading and staging memory does not grow with the model size
+		mesh.geometry_buffer_handle = g_GeometryBufferCache.CreateGeometryBuffer(total_buffer_size);
 
 		Uint32 current_offset = 0;
-		auto CopyData = [&staging_buffer, &current_offset]<typename T>(std::vector<T> const& _data)
+		auto CopyData = [&mesh, &current_offset]<typename T>(std::vector<T> const& _data)
 		{
 			Uint64 current_copy_size = _data.size() * sizeof(T);
-			staging_buffer.Update(_data.data(), current_copy_size, current_offset);
+			g_GeometryBufferCache.UploadGeometryBuffer(mesh.geometry_buffer_handle, current_offset, _data.data(), current_copy_size);
 			current_offset += (Uint32)Align(current_copy_size, 16);
 		};
 
@@ -780,17 +909,22 @@ namespace adria
 			CopyData(mesh_data.indices);
 
 			submesh.vertices_count = (Uint32)mesh_data.positions_stream.size();
+			submesh.vertex_flags = mesh_data.vertex_flags;
 			submesh.positions_offset = current_offset;
-			CopyData(mesh_data.positions_stream);
+			if (mesh_data.vertex_flags & MeshVertexFlag_QuantizedPositions) CopyData(mesh_data.quantized_positions);
+			else CopyData(mesh_data.positions_stream);
 
 			submesh.uvs_offset = current_offset;
-			CopyData(mesh_data.uvs_stream);
+			if (mesh_data.vertex_flags & MeshVertexFlag_QuantizedUVs) CopyData(mesh_data.quantized_uvs);
+			else CopyData(mesh_data.uvs_stream);
 
 			submesh.normals_offset = current_offset;
-			CopyData(mesh_data.normals_stream);
+			if (mesh_data.vertex_flags & MeshVertexFlag_QuantizedNormals) CopyData(mesh_data.quantized_normals);
+			else CopyData(mesh_data.normals_stream);
 
 			submesh.tangents_offset = current_offset;
-			CopyData(mesh_data.tangents_stream);
+			if (mesh_data.vertex_flags & MeshVertexFlag_QuantizedNormals) CopyData(mesh_data.quantized_tangents);
+			else CopyData(mesh_data.tangents_stream);
 
 			submesh.meshlet_offset = current_offset;
 			CopyData(mesh_data.meshlets);
@@ -806,8 +940,8 @@ namespace adria
 			submesh.bounding_box = mesh_data.bounding_box;
 			submesh.topology = mesh_data.topology;
 			submesh.material_index = mesh_data.material_index;
+			submesh.occluder = mesh_data.occluder;
 		}
-		mesh.geometry_buffer_handle = g_GeometryBufferCache.CreateAndInitializeGeometryBuffer(staging_buffer.buffer, total_buffer_size, staging_buffer.offset);
 
 		for (Uint64 i = 0; i < gltf_data->nodes_count; ++i)
 		{
@@ -833,7 +967,8 @@ namespace adria
 
 		if (gfx->GetCapabilities().SupportsRayTracing()) reg.emplace<RayTracing>(mesh_entity);
 
-		ADRIA_LOG(INFO, "GLTF Model %s successfully loaded!", params.model_path.c_str());
+		ADRIA_LOG(INFO, "GLTF Model %s successfully loaded! Meshlet LODs: %u levels, %llu triangles at full resolution, %llu in the coarsest cut",
+			params.model_path.c_str(), lod_level_count, base_triangle_count, root_triangle_count);
 		cgltf_free(gltf_data);
 		return mesh_entity;
 	}
@@ -24,6 +24,9 @@ namespace adria
 		Matrix model_matrix;
 		Bool triangle_ccw = true;
 		Bool force_mask_alpha_usage = false;
+		Float meshlet_cone_weight = 0.25f; //0 - meshlets are built for culling by bounds only, higher values trade that for tighter normal cones
+		Bool quantize_vertices = false;	   //store the vertex streams in the quantized layout, see MeshVertexFlagBit
+		Bool meshlet_lods = true;		   //build the cluster lod hierarchy of the meshlets, see MeshletLOD.h
     };
     struct SkyboxParameters
     {
@@ -68,6 +71,14 @@ namespace adria
 		Vector3 normal;
 	};
 
+	struct VertexStreamStats
+	{
+		Uint64 vertex_count = 0;
+		Uint64 quantized_vertex_count = 0;
+		Uint64 float_size = 0;	//size of the vertex streams in the float layout
+		Uint64 stored_size = 0;
+	};
+
     class GfxDevice;
  
 	class EntityLoader
@@ -84,9 +95,12 @@ namespace adria
 		ADRIA_MAYBE_UNUSED std::vector<entt::entity> LoadOcean(OceanParameters const&);
 		ADRIA_MAYBE_UNUSED entt::entity LoadDecal(DecalParameters const&);
 		ADRIA_MAYBE_UNUSED entt::entity ImportModel_GLTF(ModelParameters const&);
+
+		VertexStreamStats const& GetVertexStreamStats() const { return vertex_stream_stats; }
 	private:
         entt::registry& reg;
         GfxDevice* gfx;
+		VertexStreamStats vertex_stream_stats;
 	};
 }
 
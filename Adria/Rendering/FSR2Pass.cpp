@@ -31,7 +31,7 @@ namespace adria
 			}
 		}
 	}
-	FSR2Pass::FSR2Pass(GfxDevice* _gfx, Uint32 w, Uint32 h) : gfx(_gfx), display_width(w), display_height(h), render_width(), render_height()
+	FSR2Pass::FSR2Pass(GfxDevice* _gfx, Uint32 w, Uint32 h) : gfx(_gfx), display_width(w), display_height(h), render_width(), render_height(), max_render_width(), max_render_height()
 	{
 		sprintf(name_version, "FSR %d.%d.%d", FFX_FSR2_VERSION_MAJOR, FFX_FSR2_VERSION_MINOR, FFX_FSR2_VERSION_PATCH);
 		ffx_interface = CreateFfxInterface(gfx, FFX_FSR2_CONTEXT_COUNT);
@@ -158,8 +158,8 @@ namespace adria
 	void FSR2Pass::CreateContext()
 	{
 		fsr2_context_desc.fpMessage = FSR2Log;
-		fsr2_context_desc.maxRenderSize.width = render_width;
-		fsr2_context_desc.maxRenderSize.height = render_height;
+		fsr2_context_desc.maxRenderSize.width = max_render_width;
+		fsr2_context_desc.maxRenderSize.height = max_render_height;
 		fsr2_context_desc.displaySize.width = display_width;
 		fsr2_context_desc.displaySize.height = display_height;
 		fsr2_context_desc.flags = FFX_FSR2_ENABLE_HIGH_DYNAMIC_RANGE | FFX_FSR2_ENABLE_AUTO_EXPOSURE | FFX_FSR2_ENABLE_DEPTH_INVERTED;
@@ -178,8 +178,15 @@ namespace adria
 	void FSR2Pass::RecreateRenderResolution()
 	{
 		Float upscale_ratio = (fsr2_quality_mode == 0 ? custom_upscale_ratio : ffxFsr2GetUpscaleRatioFromQualityMode(fsr2_quality_mode));
-		render_width = (Uint32)((Float)display_width / upscale_ratio);
-		render_height = (Uint32)((Float)display_height / upscale_ratio);
+		max_render_width = (Uint32)((Float)display_width / upscale_ratio);
+		max_render_height = (Uint32)((Float)display_height / upscale_ratio);
+		OnDynamicResolutionScaleChanged();
+	}
+
+	void FSR2Pass::OnDynamicResolutionScaleChanged()
+	{
+		render_width = ApplyDynamicResolutionScale(max_render_width);
+		render_height = ApplyDynamicResolutionScale(max_render_height);
 		BroadcastRenderResolutionChanged(render_width, render_height);
 	}
 }
\ No newline at end of file
@@ -30,6 +30,7 @@ namespace adria
 		GfxDevice* gfx = nullptr;
 		Uint32 display_width, display_height;
 		Uint32 render_width, render_height;
+		Uint32 max_render_width, max_render_height;
 
 		FfxInterface* ffx_interface;
 		FfxFsr2ContextDescription fsr2_context_desc{};
@@ -44,5 +45,6 @@ namespace adria
 		void CreateContext();
 		void DestroyContext();
 		void RecreateRenderResolution();
+		virtual void OnDynamicResolutionScaleChanged() override;
 	};
 }
\ No newline at end of file
@@ -32,7 +32,7 @@ namespace adria
 		}
 	}
 
-	FSR3Pass::FSR3Pass(GfxDevice* _gfx, Uint32 w, Uint32 h) : gfx(_gfx), display_width(w), display_height(h), render_width(), render_height(), ffx_interface(nullptr)
+	FSR3Pass::FSR3Pass(GfxDevice* _gfx, Uint32 w, Uint32 h) : gfx(_gfx), display_width(w), display_height(h), render_width(), render_height(), max_render_width(), max_render_height(), ffx_interface(nullptr)
 	{
 		if (!gfx->GetCapabilities().SupportsShaderModel(SM_6_6)) return;
 		sprintf(name_version, "FSR %d.%d.%d", FFX_FSR3_VERSION_MAJOR, FFX_FSR3_VERSION_MINOR, FFX_FSR3_VERSION_PATCH);
@@ -161,8 +161,8 @@ namespace adria
 	void FSR3Pass::CreateContext()
 	{
 		fsr3_context_desc.fpMessage = FSR3Log;
-		fsr3_context_desc.maxRenderSize.width = render_width;
-		fsr3_context_desc.maxRenderSize.height = render_height;
+		fsr3_context_desc.maxRenderSize.width = max_render_width;
+		fsr3_context_desc.maxRenderSize.height = max_render_height;
 		fsr3_context_desc.maxUpscaleSize.width = display_width;
 		fsr3_context_desc.maxUpscaleSize.height = display_height;
 		fsr3_context_desc.displaySize.width = display_width;
@@ -182,8 +182,15 @@ namespace adria
 	void FSR3Pass::RecreateRenderResolution()
 	{
 		Float upscale_ratio = (fsr3_quality_mode == 0 ? custom_upscale_ratio : ffxFsr3GetUpscaleRatioFromQualityMode(fsr3_quality_mode));
-		render_width = (Uint32)((Float)display_width / upscale_ratio);
-		render_height = (Uint32)((Float)display_height / upscale_ratio);
+		max_render_width = (Uint32)((Float)display_width / upscale_ratio);
+		max_render_height = (Uint32)((Float)display_height / upscale_ratio);
+		OnDynamicResolutionScaleChanged();
+	}
+
+	void FSR3Pass::OnDynamicResolutionScaleChanged()
+	{
+		render_width = ApplyDynamicResolutionScale(max_render_width);
+		render_height = ApplyDynamicResolutionScale(max_render_height);
 		BroadcastRenderResolutionChanged(render_width, render_height);
 	}
 
@@ -4,6 +4,7 @@
 #include "Graphics/GfxBuffer.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxCommandList.h"
+#include "Graphics/GfxReadbackManager.h"
 #include "Logging/Logger.h"
 #include "RenderGraph/RenderGraph.h"
 #endif
@@ -194,6 +195,52 @@ namespace adria
 		return "";
 	}
 
+	static void PrintDebugMessages(Uint8 const* data, Uint64 size)
+	{
+		static constexpr Uint32 MaxDebugPrintArgs = 4;
+		DebugPrintReader print_reader(data + sizeof(Uint32), (Uint32)size - sizeof(Uint32));
+
+		while (print_reader.HasMoreData(sizeof(DebugPrintHeader)))
+		{
+			DebugPrintHeader const* header = print_reader.Consume<DebugPrintHeader>();
+			if (header->NumBytes == 0 || !print_reader.HasMoreData(header->NumBytes))
+				break;
+
+			std::string fmt = print_reader.ConsumeString(header->StringSize);
+			if (fmt.length() == 0) break;
+
+			if (header->NumArgs > MaxDebugPrintArgs) break;
+
+			std::vector<std::string> arg_strings;
+			arg_strings.reserve(header->NumArgs);
+			for (Uint32 arg_idx = 0; arg_idx < header->NumArgs; ++arg_idx)
+			{
+				ArgCode const arg_code = (ArgCode)*print_reader.Consume<Uint8>();
+				if (arg_code >= NumDebugPrintArgCodes || arg_code < 0) break;
+
+				Uint32 const arg_size = ArgCodeSizes[arg_code];
+				if (!print_reader.HasMoreData(arg_size)) break;
+
+				std::string const arg_string = MakeArgString(print_reader, arg_code);
+				arg_strings.push_back(arg_string);
+			}
+
+			if (header->NumArgs > 0)
+			{
+				for (Uint64 i = 0; i < arg_strings.size(); ++i)
+				{
+					std::string placeholder = "{" + std::to_string(i) + "}";
+					Uint64 pos = fmt.find(placeholder);
+					while (pos != std::string::npos)
+					{
+						fmt.replace(pos, placeholder.length(), arg_strings[i]);
+						pos = fmt.find(placeholder, pos + arg_strings[i].length());
+					}
+				}
+			}
+			ADRIA_LOG(DEBUG, fmt.c_str());
+		}
+	}
 
 	GPUDebugPrinter::GPUDebugPrinter(GfxDevice* gfx) : gfx(gfx)
 	{
@@ -210,9 +257,6 @@ namespace adria
 		uav_descriptor = gfx->CreateBufferUAV(printf_buffer.get());
 
 		gfx->GetCommandList()->BufferBarrier(*printf_buffer, GfxResourceState::Common, GfxResourceState::ComputeUAV);
-
-		for (auto& readback_buffer : readback_buffers)
-			readback_buffer = gfx->CreateBuffer(ReadBackBufferDesc(printf_buffer_desc.size));
 }
 	Sint32 GPUDebugPrinter::GetPrintfBufferIndex()
 	{
@@ -254,57 +298,10 @@ namespace adria
 			},
 			[&](CopyPrintfBufferPassData const& data, RenderGraphContext& ctx, GfxCommandList* cmd_list)
 			{
-				GfxDevice* gfx = cmd_list->GetDevice();
-				Uint64 current_backbuffer_index = gfx->GetBackbufferIndex();
-				GfxBuffer& readback_buffer = *readback_buffers[current_backbuffer_index];
-				cmd_list->CopyBuffer(readback_buffer, *printf_buffer);
-
-				Uint64 old_backbuffer_index = (current_backbuffer_index + 1) % gfx->GetBackbufferCount();
-				GfxBuffer& old_readback_buffer = *readback_buffers[old_backbuffer_index];
-
-				static constexpr Uint32 MaxDebugPrintArgs = 4;
-				DebugPrintReader print_reader(old_readback_buffer.GetMappedData<Uint8>() + sizeof(Uint32), (Uint32)old_readback_buffer.GetSize() - sizeof(Uint32));
-
-				while (print_reader.HasMoreData(sizeof(DebugPrintHeader)))
-				{
-					DebugPrintHeader const* header = print_reader.Consume<DebugPrintHeader>();
-					if (header->NumBytes == 0 || !print_reader.HasMoreData(header->NumBytes))
-						break;
-
-					std::string fmt = print_reader.ConsumeString(header->StringSize);
-					if (fmt.length() == 0) break;
-
-					if (header->NumArgs > MaxDebugPrintArgs) break;
-
-					std::vector<std::string> arg_strings;
-					arg_strings.reserve(header->NumArgs);
-					for (Uint32 arg_idx = 0; arg_idx < header->NumArgs; ++arg_idx)
-					{
-						ArgCode const arg_code = (ArgCode)*print_reader.Consume<Uint8>();
-						if (arg_code >= NumDebugPrintArgCodes || arg_code < 0) break;
-
-						Uint32 const arg_size = ArgCodeSizes[arg_code];
-						if (!print_reader.HasMoreData(arg_size)) break;
-
-						std::string const arg_string = MakeArgString(print_reader, arg_code);
-						arg_strings.push_back(arg_string);
-					}
-
-					if (header->NumArgs > 0)
+				gfx->GetReadbackManager()->ReadbackBuffer(cmd_list, *printf_buffer, [](void const* readback_data, Uint64 size)
 					{
-						for (Uint64 i = 0; i < arg_strings.size(); ++i)
-						{
-							std::string placeholder = "{" + std::to_string(i) + "}";
-							Uint64 pos = fmt.find(placeholder);
-							while (pos != std::string::npos)
-							{
-								fmt.replace(pos, placeholder.length(), arg_strings[i]);
-								pos = fmt.find(placeholder, pos + arg_strings[i].length());
-							}
-						}
-					}
-					ADRIA_LOG(DEBUG, fmt.c_str());
-				}
+						PrintDebugMessages(static_cast<Uint8 const*>(readback_data), size);
+					});
 			}, RGPassType::Copy, RGPassFlags::ForceNoCull);
 	}
 #else
@@ -24,7 +24,6 @@ namespace adria
 	private:
 		GfxDevice* gfx;
 		std::unique_ptr<GfxBuffer> printf_buffer;
-		std::unique_ptr<GfxBuffer> readback_buffers[GFX_BACKBUFFER_COUNT];
 		GfxDescriptor srv_descriptor;
 		GfxDescriptor uav_descriptor;
 		GfxDescriptor gpu_uav_descriptor;
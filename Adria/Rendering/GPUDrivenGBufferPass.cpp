@@ -1,9 +1,11 @@
 #include "GPUDrivenGBufferPass.h"
 #include "ShaderStructs.h"
 #include "Components.h"
+#include "MeshletLOD.h"
 #include "BlackboardData.h"
 #include "ShaderManager.h"
 #include "RenderGraph/RenderGraph.h"
+#include "Graphics/GfxReadbackManager.h"
 #include "Graphics/GfxPipelineStatePermutations.h"
 #include "entt/entity/registry.hpp"
 #include "Logging/Logger.h"
@@ -19,6 +21,7 @@ using namespace DirectX;
 namespace adria
 {
 	static TAutoConsoleVariable<Bool> GpuDrivenRendering("r.GpuDrivenRendering", true, "Enable GPU Driven Rendering if supported");
+	static TAutoConsoleVariable<Float> MeshletLODErrorThreshold("r.MeshletLOD.ErrorThreshold", 1.0f, "Screen space error in pixels up to which simplified meshlets of the cluster lod hierarchy are drawn, 0 draws full resolution meshlets");
 
 	static constexpr Uint32 MAX_NUM_MESHLETS = 1 << 20u;
 	static constexpr Uint32 MAX_NUM_INSTANCES = 1 << 14u;
@@ -34,7 +37,6 @@ namespace adria
 	{
 		GpuDrivenRendering->Set(IsSupported());
 		if (!IsSupported()) return;
-		CreateDebugBuffer();
 		InitializeHZB();
 		CreatePSOs();
 	}
@@ -71,6 +73,7 @@ namespace adria
 					if (GpuDrivenRendering.Get())
 					{
 						ImGui::Checkbox("Occlusion Cull", &occlusion_culling);
+						ImGui::SliderFloat("Meshlet LOD Error Threshold (px)", MeshletLODErrorThreshold.GetPtr(), 0.0f, 8.0f, "%.2f");
 						ImGui::Checkbox("Display Debug Stats", &display_debug_stats);
 						if (display_debug_stats)
 						{
@@ -79,8 +82,7 @@ namespace adria
 
 							ImGui::SeparatorText("GPU Driven Debug Stats");
 							{
-								Uint32 backbuffer_index = gfx->GetBackbufferIndex();
-								DebugStats current_debug_stats = debug_stats[backbuffer_index];
+								DebugStats const& current_debug_stats = debug_stats;
 
 								ImGui::BeginTable("Profiler", 2, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg);
 								ImGui::TableSetupColumn("Description");
@@ -280,6 +282,7 @@ namespace adria
 		rg.ImportTexture(RG_NAME(HZB), HZB.get());
 
 		FrameBlackboardData const& frame_data = rg.GetBlackboard().Get<FrameBlackboardData>();
+		Float const lod_error_scale = MeshletLODErrorScale(XMVectorGetY(frame_data.camera_proj.r[1]), (Float)height, MeshletLODErrorThreshold.Get());
 		struct CullInstancesPassData
 		{
 			RGTextureReadOnlyId hzb;
@@ -445,6 +448,7 @@ namespace adria
 					Uint32 candidate_meshlets_counter_idx;
 					Uint32 visible_meshlets_idx;
 					Uint32 visible_meshlets_counter_idx;
+					Float  lod_error_scale;
 				} constants =
 				{
 					.hzb_idx = i,
@@ -452,6 +456,7 @@ namespace adria
 					.candidate_meshlets_counter_idx = i + 2,
 					.visible_meshlets_idx = i + 3,
 					.visible_meshlets_counter_idx = i + 4,
+					.lod_error_scale = lod_error_scale,
 				};
 
 				GfxPipelineState* pso = occlusion_culling ? cull_meshlets_psos->Get<0>() : cull_meshlets_psos->Get<1>();
@@ -580,6 +585,7 @@ namespace adria
 		if (!occlusion_culling) return;
 
 		FrameBlackboardData const& frame_data = rg.GetBlackboard().Get<FrameBlackboardData>();
+		Float const lod_error_scale = MeshletLODErrorScale(XMVectorGetY(frame_data.camera_proj.r[1]), (Float)height, MeshletLODErrorThreshold.Get());
 		struct BuildInstanceCullArgsPassData
 		{
 			RGBufferReadOnlyId  occluded_instances_counter;
@@ -761,6 +767,7 @@ namespace adria
 					Uint32 candidate_meshlets_counter_idx;
 					Uint32 visible_meshlets_idx;
 					Uint32 visible_meshlets_counter_idx;
+					Float  lod_error_scale;
 				} constants =
 				{
 					.hzb_idx = i,
@@ -768,6 +775,7 @@ namespace adria
 					.candidate_meshlets_counter_idx = i + 2,
 					.visible_meshlets_idx = i + 3,
 					.visible_meshlets_counter_idx = i + 4,
+					.lod_error_scale = lod_error_scale,
 				};
 				cmd_list->SetPipelineState(cull_meshlets_psos->Get<2>());
 				cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
@@ -1011,45 +1019,43 @@ namespace adria
 			RGBufferCopySrcId  candidate_meshlets_counter;
 			RGBufferCopySrcId  visible_meshlets_counter;
 			RGBufferCopySrcId  occluded_instances_counter;
-			RGBufferCopyDstId  debug_buffer;
 		};
 
-		rg.ImportBuffer(RG_NAME(GPUDrivenDebugBuffer), debug_buffer.get());
-
 		rg.AddPass<GPUDrivenDebugPassData>("GPU Driven Debug Pass",
 			[=](GPUDrivenDebugPassData& data, RenderGraphBuilder& builder)
 			{
-				data.debug_buffer = builder.WriteCopyDstBuffer(RG_NAME(GPUDrivenDebugBuffer));
 				data.candidate_meshlets_counter = builder.ReadCopySrcBuffer(RG_NAME(CandidateMeshletsCounter));
 				data.visible_meshlets_counter = builder.ReadCopySrcBuffer(RG_NAME(VisibleMeshletsCounter));
 				data.occluded_instances_counter = builder.ReadCopySrcBuffer(RG_NAME(OccludedInstancesCounter));
 			},
 			[&](GPUDrivenDebugPassData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
 			{
-				GfxBuffer const& src_buffer1 = context.GetCopySrcBuffer(data.occluded_instances_counter);
-				GfxBuffer const& src_buffer2 = context.GetCopySrcBuffer(data.visible_meshlets_counter);
-				GfxBuffer const& src_buffer3 = context.GetCopySrcBuffer(data.candidate_meshlets_counter);
-				GfxBuffer& debug_buffer = context.GetCopyDstBuffer(data.debug_buffer);
-
-				Uint32 backbuffer_index = gfx->GetBackbufferIndex();
-				Uint32 buffer_offset = 6 * sizeof(Uint32) * backbuffer_index;
-				cmd_list->CopyBuffer(debug_buffer, buffer_offset, src_buffer1, 0, sizeof(Uint32));
-				cmd_list->CopyBuffer(debug_buffer, buffer_offset + sizeof(Uint32), src_buffer2, 0, 2 * sizeof(Uint32));
-				cmd_list->CopyBuffer(debug_buffer, buffer_offset + 3 * sizeof(Uint32), src_buffer3, 0, 3 * sizeof(Uint32));
-
-				ADRIA_ASSERT(debug_buffer.IsMapped());
-				Uint32* buffer_data = debug_buffer.GetMappedData<Uint32>();
-				buffer_data += 6 * backbuffer_index;
-				Uint32 num_instances = (Uint32)reg.view<Batch>().size();
-				debug_stats[backbuffer_index].occluded_instances = buffer_data[0];
-				debug_stats[backbuffer_index].num_instances = num_instances;
-				debug_stats[backbuffer_index].visible_instances = num_instances - buffer_data[0];
-				debug_stats[backbuffer_index].processed_meshlets = buffer_data[3];
-				debug_stats[backbuffer_index].phase1_candidate_meshlets = buffer_data[4];
-				debug_stats[backbuffer_index].phase2_candidate_meshlets = buffer_data[5];
-				debug_stats[backbuffer_index].phase1_visible_meshlets = buffer_data[1];
-				debug_stats[backbuffer_index].phase2_visible_meshlets = buffer_data[2];
+				GfxBuffer const& occluded_instances_counter = context.GetCopySrcBuffer(data.occluded_instances_counter);
+				GfxBuffer const& visible_meshlets_counter = context.GetCopySrcBuffer(data.visible_meshlets_counter);
+				GfxBuffer const& candidate_meshlets_counter = context.GetCopySrcBuffer(data.candidate_meshlets_counter);
 
+				GfxReadbackManager* readback_manager = gfx->GetReadbackManager();
+				Uint32 const num_instances = (Uint32)reg.view<Batch>().size();
+				readback_manager->ReadbackBuffer(cmd_list, occluded_instances_counter, 0, sizeof(Uint32), [this, num_instances](void const* readback_data, Uint64)
+					{
+						Uint32 const* counters = static_cast<Uint32 const*>(readback_data);
+						debug_stats.num_instances = num_instances;
+						debug_stats.occluded_instances = counters[0];
+						debug_stats.visible_instances = num_instances - counters[0];
+					});
+				readback_manager->ReadbackBuffer(cmd_list, visible_meshlets_counter, 0, 2 * sizeof(Uint32), [this](void const* readback_data, Uint64)
+					{
+						Uint32 const* counters = static_cast<Uint32 const*>(readback_data);
+						debug_stats.phase1_visible_meshlets = counters[0];
+						debug_stats.phase2_visible_meshlets = counters[1];
+					});
+				readback_manager->ReadbackBuffer(cmd_list, candidate_meshlets_counter, 0, 3 * sizeof(Uint32), [this](void const* readback_data, Uint64)
+					{
+						Uint32 const* counters = static_cast<Uint32 const*>(readback_data);
+						debug_stats.processed_meshlets = counters[0];
+						debug_stats.phase1_candidate_meshlets = counters[1];
+						debug_stats.phase2_candidate_meshlets = counters[2];
+					});
 			}, RGPassType::Copy, RGPassFlags::ForceNoCull);
 
 	}
@@ -1065,12 +1071,4 @@ namespace adria
 		hzb_height = 1 << (mips_y - 1);
 	}
 
-	void GPUDrivenGBufferPass::CreateDebugBuffer()
-	{
-		GfxBufferDesc debug_buffer_desc{};
-		debug_buffer_desc.size = 6 * sizeof(Uint32) * GFX_BACKBUFFER_COUNT;
-		debug_buffer_desc.resource_usage = GfxResourceUsage::Readback;
-		debug_buffer = gfx->CreateBuffer(debug_buffer_desc);
-	}
-
 }
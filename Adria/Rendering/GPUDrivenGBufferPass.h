@@ -61,9 +61,8 @@ namespace adria
 
 		Bool occlusion_culling = true;
 
-		std::unique_ptr<GfxBuffer> debug_buffer;
 		Bool display_debug_stats = false;
-		DebugStats debug_stats[GFX_BACKBUFFER_COUNT] = {};
+		DebugStats debug_stats = {};
 
 		Bool rain_active = false;
 		std::unique_ptr<GfxMeshShaderPipelineStatePermutations> draw_psos;
@@ -88,7 +87,6 @@ namespace adria
 		void AddDebugPass(RenderGraph& rg);
 
 		void CalculateHZBParameters();
-		void CreateDebugBuffer();
 	};
 
 }
\ No newline at end of file
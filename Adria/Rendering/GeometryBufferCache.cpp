@@ -2,9 +2,14 @@
 #include "Graphics/GfxBuffer.h"
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxCommandList.h"
+#include "Utilities/AllocatorUtil.h"
+#include "Core/ConsoleManager.h"
 
 namespace adria
 {
+	static TAutoConsoleVariable<int>   GeometryDefragmentationBudget("r.GeometryBuffer.DefragmentationBudget", 4, "Megabytes of geometry that can be moved per frame to defragment the geometry buffer pages, 0 disables defragmentation");
+	static TAutoConsoleVariable<Float> GeometryDefragmentationThreshold("r.GeometryBuffer.DefragmentationThreshold", 0.25f, "Fragmentation of a geometry buffer page (1 - largest free region / free size) above which the page is defragmented");
+
 	void GeometryBufferCache::Initialize(GfxDevice* _gfx)
 	{
 		gfx = _gfx;
@@ -12,61 +17,243 @@ namespace adria
 
 	void GeometryBufferCache::Destroy()
 	{
-		buffer_map.clear();
+		allocation_map.clear();
+		pending_frees.clear();
+		for (GeometryBufferPage& page : pages)
+		{
+			if (page.srv.IsValid()) gfx->FreeDescriptorCPU(page.srv, GfxDescriptorHeapType::CBV_SRV_UAV);
+		}
+		pages.clear();
+		defragmentation_buffer.reset();
 		gfx = nullptr;
 	}
 
-	ArcGeometryBufferHandle GeometryBufferCache::CreateAndInitializeGeometryBuffer(GfxBuffer* staging_buffer, Uint64 total_buffer_size, Uint64 src_offset)
+	ArcGeometryBufferHandle GeometryBufferCache::CreateGeometryBuffer(Uint64 total_buffer_size)
 	{
-		GfxBufferDesc desc{};
-		desc.size = total_buffer_size;
-		desc.bind_flags = GfxBindFlag::ShaderResource;
-		desc.misc_flags = GfxBufferMiscFlag::BufferRaw;
-		desc.resource_usage = GfxResourceUsage::Default;
+		Uint32 const size_in_units = (Uint32)std::max<Uint64>(DivideAndRoundUp(total_buffer_size, Alignment), 1);
+
+		Uint32 page_index = 0;
+		OffsetAllocation allocation{};
+		for (; page_index < pages.size(); ++page_index)
+		{
+			allocation = pages[page_index].allocator->Allocate(size_in_units);
+			if (allocation.IsValid()) break;
+		}
+		if (!allocation.IsValid())
+		{
+			page_index = AddPage(std::max(PageSize, (Uint64)size_in_units * Alignment));
+			allocation = pages[page_index].allocator->Allocate(size_in_units);
+			ADRIA_ASSERT(allocation.IsValid());
+		}
 
 		++current_handle;
-		buffer_map[current_handle] = gfx->CreateBuffer(desc);
-		if(staging_buffer) gfx->GetCommandList()->CopyBuffer(*buffer_map[current_handle], 0, *staging_buffer, src_offset, total_buffer_size);
-		buffer_srv_map[current_handle] = gfx->CreateBufferSRV(buffer_map[current_handle].get());
+		allocation_map[current_handle] = GeometryBufferAllocation{ .page = page_index, .allocation = allocation, .size = total_buffer_size };
 		return current_handle;
 	}
 
+	GfxUploadTicket GeometryBufferCache::UploadGeometryBuffer(GeometryBufferHandle& handle, Uint64 offset, void const* data, Uint64 size)
+	{
+		auto it = allocation_map.find(handle);
+		if (it == allocation_map.end()) return 0;
+
+		GeometryBufferAllocation const& allocation = it->second;
+		ADRIA_ASSERT(offset + size <= allocation.size);
+		GeometryBufferPage& page = pages[allocation.page];
+		Uint64 const page_offset = (Uint64)allocation.allocation.offset * Alignment + offset;
+		page.upload_ticket = gfx->GetUploadManager()->UploadBuffer(*page.buffer, page_offset, data, size);
+		return page.upload_ticket;
+	}
+
 	void GeometryBufferCache::DestroyGeometryBuffer(GeometryBufferHandle& handle)
 	{
-		if (buffer_map.empty()) return;
-		if (auto it = buffer_map.find(handle); it != buffer_map.end())
+		if (allocation_map.empty()) return;
+		if (auto it = allocation_map.find(handle); it != allocation_map.end())
+		{
+			pending_frees.push_back(PendingFree{ .page = it->second.page, .allocation = it->second.allocation, .frame = frame });
+			allocation_map.erase(it);
+		}
+	}
+
+	void GeometryBufferCache::PinGeometryBuffer(GeometryBufferHandle& handle)
+	{
+		if (auto it = allocation_map.find(handle); it != allocation_map.end())
+		{
+			it->second.pinned = true;
+		}
+	}
+
+	void GeometryBufferCache::Update(GfxCommandList* cmd_list)
+	{
+		++frame;
+
+		//the copies and reads of the previous GFX_BACKBUFFER_COUNT frames may still be in flight
+		std::erase_if(pending_frees, [this](PendingFree const& pending_free)
+			{
+				if (frame - pending_free.frame <= GFX_BACKBUFFER_COUNT) return false;
+				pages[pending_free.page].allocator->Free(pending_free.allocation);
+				return true;
+			});
+
+		Uint64 const max_moved_size = (Uint64)std::max(GeometryDefragmentationBudget.Get(), 0) * 1024 * 1024;
+		if (max_moved_size == 0) return;
+
+		//one page per frame, the most fragmented one. pages with uploads in flight on the copy queue are skipped
+		Uint32 defragmented_page = Uint32(-1);
+		Float max_fragmentation = GeometryDefragmentationThreshold.Get();
+		for (Uint32 page_index = 0; page_index < pages.size(); ++page_index)
 		{
-			it->second = nullptr;
-			buffer_map.erase(it->first);
+			if (!gfx->GetUploadManager()->IsCompleted(pages[page_index].upload_ticket)) continue;
+			OffsetAllocatorStats const page_stats = pages[page_index].allocator->GetStats();
+			if (page_stats.fragmentation > max_fragmentation)
+			{
+				max_fragmentation = page_stats.fragmentation;
+				defragmented_page = page_index;
+			}
 		}
+		if (defragmented_page != Uint32(-1)) Defragment(cmd_list, defragmented_page, max_moved_size);
 	}
 
 	GfxBuffer* GeometryBufferCache::GetGeometryBuffer(GeometryBufferHandle& handle) const
 	{
 		if (!handle.IsValid()) return nullptr;
 
-		if (auto it = buffer_map.find(handle); it != buffer_map.end())
+		if (auto it = allocation_map.find(handle); it != allocation_map.end())
 		{
-			return it->second.get();
+			return pages[it->second.page].buffer.get();
 		}
 		else return nullptr;
 	}
 
+	Uint64 GeometryBufferCache::GetGeometryBufferOffset(GeometryBufferHandle& handle) const
+	{
+		if (!handle.IsValid()) return 0;
+
+		if (auto it = allocation_map.find(handle); it != allocation_map.end())
+		{
+			return (Uint64)it->second.allocation.offset * Alignment;
+		}
+		else return 0;
+	}
+
+	Uint32 GeometryBufferCache::GetGeometryBufferPage(GeometryBufferHandle& handle) const
+	{
+		if (!handle.IsValid()) return 0;
+
+		if (auto it = allocation_map.find(handle); it != allocation_map.end())
+		{
+			return it->second.page;
+		}
+		else return 0;
+	}
+
 	GfxDescriptor GeometryBufferCache::GetGeometryBufferSRV(GeometryBufferHandle& handle) const
 	{
 		if (!handle.IsValid()) return GfxDescriptor{};
 
-		if (auto it = buffer_srv_map.find(handle); it != buffer_srv_map.end())
+		if (auto it = allocation_map.find(handle); it != allocation_map.end())
 		{
-			return it->second;
+			return pages[it->second.page].srv;
 		}
 		else return GfxDescriptor{};
 	}
 
+	GeometryBufferCacheStats GeometryBufferCache::GetStats() const
+	{
+		GeometryBufferCacheStats stats{};
+		stats.page_count = (Uint32)pages.size();
+		stats.allocation_count = (Uint32)allocation_map.size();
+		stats.defragmented_size = defragmented_size;
+		for (GeometryBufferPage const& page : pages)
+		{
+			OffsetAllocatorStats const page_stats = page.allocator->GetStats();
+			stats.total_size += (Uint64)page_stats.total_size * Alignment;
+			stats.allocated_size += (Uint64)(page_stats.total_size - page_stats.free_size) * Alignment;
+			stats.max_fragmentation = std::max(stats.max_fragmentation, page_stats.fragmentation);
+		}
+		return stats;
+	}
+
+	Uint32 GeometryBufferCache::AddPage(Uint64 size)
+	{
+		GfxBufferDesc desc{};
+		desc.size = AlignToPowerOfTwo(size, Alignment);
+		desc.bind_flags = GfxBindFlag::ShaderResource;
+		desc.misc_flags = GfxBufferMiscFlag::BufferRaw;
+		desc.resource_usage = GfxResourceUsage::Default;
+
+		GeometryBufferPage& page = pages.emplace_back();
+		page.buffer = gfx->CreateBuffer(desc);
+		page.srv = gfx->CreateBufferSRV(page.buffer.get());
+		page.allocator = std::make_unique<OffsetAllocator>((Uint32)(desc.size / Alignment), 64 * 1024);
+		return (Uint32)pages.size() - 1;
+	}
+
+	void GeometryBufferCache::Defragment(GfxCommandList* cmd_list, Uint32 page_index, Uint64 max_moved_size)
+	{
+		GeometryBufferPage& page = pages[page_index];
+		std::vector<OffsetAllocatorMove> moves = page.allocator->CreateDefragmentationPlan((Uint32)std::min<Uint64>(max_moved_size / Alignment, UINT32_MAX));
+
+		std::unordered_map<Uint32, GeometryBufferAllocation*> node_allocations;
+		for (auto& [handle, allocation] : allocation_map)
+		{
+			if (allocation.page == page_index) node_allocations[allocation.allocation.node] = &allocation;
+		}
+		//allocations waiting for their delayed free are not in the map and pinned ones must stay where they are
+		std::erase_if(moves, [&](OffsetAllocatorMove const& move)
+			{
+				auto it = node_allocations.find(move.from.node);
+				if (it != node_allocations.end() && !it->second->pinned) return false;
+				page.allocator->Free(move.to);
+				return true;
+			});
+		if (moves.empty()) return;
+
+		Uint64 scratch_size = 0;
+		for (OffsetAllocatorMove const& move : moves) scratch_size += (Uint64)move.size * Alignment;
+		if (!defragmentation_buffer || defragmentation_buffer->GetSize() < scratch_size)
+		{
+			GfxBufferDesc scratch_desc{};
+			scratch_desc.size = std::max(scratch_size, max_moved_size);
+			scratch_desc.resource_usage = GfxResourceUsage::Default;
+			defragmentation_buffer = gfx->CreateBuffer(scratch_desc);
+		}
+
+		//a buffer cannot be the source and the destination of a copy at the same time, so the moves go through a scratch buffer
+		cmd_list->BufferBarrier(*page.buffer, GfxResourceState::Common, GfxResourceState::CopySrc);
+		cmd_list->BufferBarrier(*defragmentation_buffer, GfxResourceState::Common, GfxResourceState::CopyDst);
+		cmd_list->FlushBarriers();
+		Uint64 scratch_offset = 0;
+		for (OffsetAllocatorMove const& move : moves)
+		{
+			Uint64 const move_size = (Uint64)move.size * Alignment;
+			cmd_list->CopyBuffer(*defragmentation_buffer, scratch_offset, *page.buffer, (Uint64)move.from.offset * Alignment, move_size);
+			scratch_offset += move_size;
+		}
+
+		cmd_list->BufferBarrier(*page.buffer, GfxResourceState::CopySrc, GfxResourceState::CopyDst);
+		cmd_list->BufferBarrier(*defragmentation_buffer, GfxResourceState::CopyDst, GfxResourceState::CopySrc);
+		cmd_list->FlushBarriers();
+		scratch_offset = 0;
+		for (OffsetAllocatorMove const& move : moves)
+		{
+			Uint64 const move_size = (Uint64)move.size * Alignment;
+			cmd_list->CopyBuffer(*page.buffer, (Uint64)move.to.offset * Alignment, *defragmentation_buffer, scratch_offset, move_size);
+			scratch_offset += move_size;
+
+			GeometryBufferAllocation* allocation = node_allocations[move.from.node];
+			allocation->allocation = move.to;
+			pending_frees.push_back(PendingFree{ .page = page_index, .allocation = move.from, .frame = frame });
+			defragmented_size += move_size;
+		}
+
+		cmd_list->BufferBarrier(*page.buffer, GfxResourceState::CopyDst, GfxResourceState::Common);
+		cmd_list->BufferBarrier(*defragmentation_buffer, GfxResourceState::CopySrc, GfxResourceState::Common);
+		cmd_list->FlushBarriers();
+	}
+
 	GeometryBufferHandle::~GeometryBufferHandle()
 	{
 		if (IsValid()) g_GeometryBufferCache.DestroyGeometryBuffer(*this);
 	}
 
 }
-
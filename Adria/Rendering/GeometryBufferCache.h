@@ -1,12 +1,15 @@
 #pragma once
 #include <memory>
 #include "Graphics/GfxDescriptor.h"
+#include "Graphics/GfxUploadManager.h"
+#include "Utilities/OffsetAllocator.h"
 #include "Utilities/Singleton.h"
 
 namespace adria
 {
 	class GfxDevice;
 	class GfxBuffer;
+	class GfxCommandList;
 
 	inline constexpr Uint64 INVALID_GEOMETRY_BUFFER_HANDLE = -1;
 
@@ -44,25 +47,88 @@ namespace adria
 	};
 
 
+	struct GeometryBufferCacheStats
+	{
+		Uint32 page_count = 0;
+		Uint64 total_size = 0;
+		Uint64 allocated_size = 0;
+		Uint32 allocation_count = 0;
+		Float  max_fragmentation = 0.0f;
+		Uint64 defragmented_size = 0;
+	};
+
+	//all geometry lives in a few large pages, every handle is a sub-allocation of one of them.
+	//pages never move or grow, so the gfx buffer of a handle is stable and every mesh of a page is reachable through one SRV.
+	//frees are delayed until the gpu is done with the frames that could still read the data,
+	//and fragmented pages are compacted a few megabytes per frame with gpu copies once their uploads are finished
 	class GeometryBufferCache : public Singleton<GeometryBufferCache>
 	{
 		friend class Singleton<GeometryBufferCache>;
 
+		static constexpr Uint64 PageSize = 256 * 1024 * 1024;
+		//offsets inside a page are multiples of the alignment, the page allocators work in these units
+		static constexpr Uint64 Alignment = 16;
+
+		struct GeometryBufferPage
+		{
+			std::unique_ptr<GfxBuffer> buffer;
+			GfxDescriptor srv;
+			std::unique_ptr<OffsetAllocator> allocator;
+			GfxUploadTicket upload_ticket = 0;
+		};
+
+		struct GeometryBufferAllocation
+		{
+			Uint32 page;
+			OffsetAllocation allocation;
+			Uint64 size;
+			Bool pinned = false;
+		};
+
+		struct PendingFree
+		{
+			Uint32 page;
+			OffsetAllocation allocation;
+			Uint64 frame;
+		};
+
 	public:
 
 		void Initialize(GfxDevice* _gfx);
 		void Destroy();
 
-		ADRIA_NODISCARD ArcGeometryBufferHandle CreateAndInitializeGeometryBuffer(GfxBuffer* staging_buffer, Uint64 total_buffer_size, Uint64 src_offset);
+		ADRIA_NODISCARD ArcGeometryBufferHandle CreateGeometryBuffer(Uint64 total_buffer_size);
+		//uploads through the copy queue, offset is relative to the start of the handle's allocation
+		GfxUploadTicket UploadGeometryBuffer(GeometryBufferHandle& handle, Uint64 offset, void const* data, Uint64 size);
 		ADRIA_NODISCARD GfxBuffer* GetGeometryBuffer(GeometryBufferHandle& handle) const;
+		ADRIA_NODISCARD Uint64 GetGeometryBufferOffset(GeometryBufferHandle& handle) const;
+		ADRIA_NODISCARD Uint32 GetGeometryBufferPage(GeometryBufferHandle& handle) const;
 		ADRIA_NODISCARD GfxDescriptor GetGeometryBufferSRV(GeometryBufferHandle& handle) const;
 		void DestroyGeometryBuffer(GeometryBufferHandle& handle);
+		//pinned geometry is never moved by defragmentation, for users that keep the offsets around (e.g. refitted BLASes)
+		void PinGeometryBuffer(GeometryBufferHandle& handle);
+
+		//once per frame, with the graphics command list open: releases delayed frees and runs incremental defragmentation.
+		//new offsets are visible right away, the old ranges stay intact until the frames that use them are done
+		void Update(GfxCommandList* cmd_list);
+
+		Uint32 GetPageCount() const { return (Uint32)pages.size(); }
+		GfxDescriptor GetPageSRV(Uint32 page) const { return pages[page].srv; }
+		GeometryBufferCacheStats GetStats() const;
 
 	private:
 		GfxDevice* gfx;
 		Uint64 current_handle = INVALID_GEOMETRY_BUFFER_HANDLE;
-		std::unordered_map<Uint64, std::unique_ptr<GfxBuffer>> buffer_map;
-		std::unordered_map<Uint64, GfxDescriptor> buffer_srv_map;
+		std::vector<GeometryBufferPage> pages;
+		std::unordered_map<Uint64, GeometryBufferAllocation> allocation_map;
+		std::vector<PendingFree> pending_frees;
+		std::unique_ptr<GfxBuffer> defragmentation_buffer;
+		Uint64 frame = 0;
+		Uint64 defragmented_size = 0;
+
+	private:
+		Uint32 AddPage(Uint64 size);
+		void Defragment(GfxCommandList* cmd_list, Uint32 page, Uint64 max_moved_size);
 	};
 	#define g_GeometryBufferCache GeometryBufferCache::Get()
 }
\ No newline at end of file
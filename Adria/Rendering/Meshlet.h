@@ -13,15 +13,45 @@ namespace adria
 		Uint32	  : 2;
 	};
 
+	//bounding sphere and simplification error of a meshlet group in the cluster lod hierarchy, see MeshletLOD.h
+	struct MeshletLODBounds
+	{
+		Float center[3];
+		Float radius;
+		Float error;
+	};
+
 	struct Meshlet
 	{
 		Float center[3];
 		Float radius;
 
+		//normal cone for backface culling, axis and cutoff are packed as 8 bit snorm (x, y, z, cutoff from the low byte).
+		//a cutoff of 1 disables backface culling of the meshlet
+		Float cone_apex[3];
+		Uint32 cone_axis_cutoff;
+
 		Uint32 vertex_count;
 		Uint32 triangle_count;
 
 		Uint32 vertex_offset;
 		Uint32 triangle_offset;
+
+		//bounds of the group the meshlet was simplified from and of the group it is simplified into. the meshlet is drawn when
+		//the projected error of lod_bounds is within the threshold and the one of parent_lod_bounds is not
+		MeshletLODBounds lod_bounds;
+		MeshletLODBounds parent_lod_bounds;
 	};
+
+	inline Uint32 PackMeshletCone(Sint8 const cone_axis[3], Sint8 cone_cutoff)
+	{
+		return (Uint32)(Uint8)cone_axis[0] | ((Uint32)(Uint8)cone_axis[1] << 8) | ((Uint32)(Uint8)cone_axis[2] << 16) | ((Uint32)(Uint8)cone_cutoff << 24);
+	}
+	inline void UnpackMeshletCone(Uint32 cone_axis_cutoff, Float cone_axis[3], Float& cone_cutoff)
+	{
+		cone_axis[0] = (Sint8)(cone_axis_cutoff & 0xff) / 127.0f;
+		cone_axis[1] = (Sint8)((cone_axis_cutoff >> 8) & 0xff) / 127.0f;
+		cone_axis[2] = (Sint8)((cone_axis_cutoff >> 16) & 0xff) / 127.0f;
+		cone_cutoff = (Sint8)(cone_axis_cutoff >> 24) / 127.0f;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "MeshletCuller.h"
+
+namespace adria
+{
+	namespace
+	{
+		//float4 helpers that keep the operation order of the shaders, mul(float4, float4x4) is a row vector times the matrix
+		struct Float4
+		{
+			Float x, y, z, w;
+		};
+
+		Float4 Mul(Float4 const& v, Matrix const& m)
+		{
+			return Float4{
+				v.x * m._11 + v.y * m._21 + v.z * m._31 + v.w * m._41,
+				v.x * m._12 + v.y * m._22 + v.z * m._32 + v.w * m._42,
+				v.x * m._13 + v.y * m._23 + v.z * m._33 + v.w * m._43,
+				v.x * m._14 + v.y * m._24 + v.z * m._34 + v.w * m._44 };
+		}
+		Float4 Add(Float4 const& a, Float4 const& b)
+		{
+			return Float4{ a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
+		}
+		Float4 Min(Float4 const& a, Float4 const& b)
+		{
+			return Float4{ std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z), std::min(a.w, b.w) };
+		}
+		Vector3 Normalize(Vector3 const& v)
+		{
+			Float const inv_length = 1.0f / std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+			return Vector3(v.x * inv_length, v.y * inv_length, v.z * inv_length);
+		}
+		Float Saturate(Float v)
+		{
+			return std::clamp(v, 0.0f, 1.0f);
+		}
+	}
+
+	MeshletFrustumCullData MeshletFrustumCull(Vector3 const& aabb_center, Vector3 const& aabb_extents, Matrix const& world_to_clip)
+	{
+		MeshletFrustumCullData data{};
+		data.is_visible = true;
+
+		Float4 const axis[3] =
+		{
+			Mul(Float4{ aabb_extents.x * 2, 0, 0, 0 }, world_to_clip),
+			Mul(Float4{ 0, aabb_extents.y * 2, 0, 0 }, world_to_clip),
+			Mul(Float4{ 0, 0, aabb_extents.z * 2, 0 }, world_to_clip)
+		};
+
+		Float4 corners[8];
+		corners[0] = Mul(Float4{ aabb_center.x - aabb_extents.x, aabb_center.y - aabb_extents.y, aabb_center.z - aabb_extents.z, 1 }, world_to_clip);
+		corners[1] = Add(corners[0], axis[0]);
+		corners[2] = Add(corners[0], axis[1]);
+		corners[3] = Add(corners[2], axis[0]);
+		corners[4] = Add(corners[0], axis[2]);
+		corners[5] = Add(corners[1], axis[2]);
+		corners[6] = Add(corners[2], axis[2]);
+		corners[7] = Add(corners[3], axis[2]);
+
+		Float min_w = FLT_MAX, max_w = -FLT_MAX;
+		Float4 plane_mins{ 1, 1, 1, 1 };
+		data.rect_min = Vector3(1, 1, 1);
+		data.rect_max = Vector3(-1, -1, -1);
+		for (Float4 const& corner : corners)
+		{
+			min_w = std::min(min_w, corner.w);
+			max_w = std::max(max_w, corner.w);
+			plane_mins = Min(plane_mins, Float4{ corner.x - corner.w, corner.y - corner.w, -corner.x - corner.w, -corner.y - corner.w });
+
+			Vector3 const screen_position(corner.x / corner.w, corner.y / corner.w, corner.z / corner.w);
+			data.rect_min = Vector3(std::min(data.rect_min.x, screen_position.x), std::min(data.rect_min.y, screen_position.y), std::min(data.rect_min.z, screen_position.z));
+			data.rect_max = Vector3(std::max(data.rect_max.x, screen_position.x), std::max(data.rect_max.y, screen_position.y), std::max(data.rect_max.z, screen_position.z));
+		}
+
+		data.is_visible = data.is_visible && (data.rect_max.z > 0);
+		if (min_w <= 0 && max_w > 0)
+		{
+			data.rect_min = Vector3(-1, -1, -1);
+			data.rect_max = Vector3(1, 1, 1);
+			data.is_visible = true;
+		}
+		else
+		{
+			data.is_visible = data.is_visible && max_w > 0.0f;
+		}
+		data.is_visible = data.is_visible && !(plane_mins.x > 0.0f || plane_mins.y > 0.0f || plane_mins.z > 0.0f || plane_mins.w > 0.0f);
+		return data;
+	}
+
+	MeshletFrustumCullData MeshletFrustumCull(Vector3 const& aabb_center, Vector3 const& aabb_extents, Matrix const& local_to_world, Matrix const& world_to_clip)
+	{
+		Float4 const world_extents = Mul(Float4{ aabb_extents.x, aabb_extents.y, aabb_extents.z, 0 }, local_to_world);
+		Float4 const world_center = Mul(Float4{ aabb_center.x, aabb_center.y, aabb_center.z, 1 }, local_to_world);
+		return MeshletFrustumCull(Vector3(world_center.x, world_center.y, world_center.z), Vector3(world_extents.x, world_extents.y, world_extents.z), world_to_clip);
+	}
+
+	Bool MeshletHZBCull(MeshletFrustumCullData const& cull_data, MeshletHZB const& hzb)
+	{
+		ADRIA_ASSERT(hzb.GetMipCount() > 0);
+		Float const hzb_width = (Float)hzb.width;
+		Float const hzb_height = (Float)hzb.height;
+		Sint32 const hzb_mip_count = (Sint32)hzb.GetMipCount();
+
+		Float const min_x = cull_data.rect_min.x, min_y = cull_data.rect_min.y;
+		Float const max_x = cull_data.rect_max.x, max_y = cull_data.rect_max.y;
+
+		//rect.xy is the top left and rect.zw the bottom right corner in uv space
+		Float const rect[4] = { Saturate(min_x * 0.5f + 0.5f), Saturate(max_y * -0.5f + 0.5f), Saturate(max_x * 0.5f + 0.5f), Saturate(min_y * -0.5f + 0.5f) };
+		Sint32 rect_pixels[4] = { (Sint32)(rect[0] * hzb_width + 0.5f), (Sint32)(rect[1] * hzb_height + 0.5f), (Sint32)(rect[2] * hzb_width - 0.5f), (Sint32)(rect[3] * hzb_height - 0.5f) };
+		rect_pixels[2] = std::max(rect_pixels[0], rect_pixels[2]);
+		rect_pixels[3] = std::max(rect_pixels[1], rect_pixels[3]);
+
+		Sint32 const size_x = (Sint32)((max_x - min_x) * hzb_width);
+		Sint32 const size_y = (Sint32)((max_y - min_y) * hzb_height);
+		Sint32 const max_size = std::max(size_x, size_y);
+		//the shader converts ceil(log2(0)) to an int and clamps it, which ends up at mip 0
+		Sint32 mip = max_size > 0 ? (Sint32)std::ceil(std::log2((Float)max_size)) : 0;
+		mip = std::clamp(mip, 0, hzb_mip_count);
+
+		Float const lower_level = (Float)std::max(mip - 1, 0);
+		Float const scale = std::exp2(-lower_level);
+		Float const dims_x = std::ceil(max_x * scale) - std::floor(min_x * scale);
+		Float const dims_y = std::ceil(max_y * scale) - std::floor(min_y * scale);
+		if (dims_x <= 2 && dims_y <= 2) mip = (Sint32)lower_level;
+
+		for (Sint32& rect_pixel : rect_pixels) rect_pixel >>= mip;
+
+		//point clamp sampling at the texel centers of mip, levels past the last one are clamped by the sampler
+		Uint32 const sample_mip = (Uint32)std::min(mip, hzb_mip_count - 1);
+		Sint32 const mip_width = (Sint32)std::max(hzb.width >> sample_mip, 1u);
+		Sint32 const mip_height = (Sint32)std::max(hzb.height >> sample_mip, 1u);
+		Float const texel_size_x = 1.0f / hzb_width * (Float)(1u << mip);
+		Float const texel_size_y = 1.0f / hzb_height * (Float)(1u << mip);
+		auto SampleHZB = [&](Sint32 x, Sint32 y)
+			{
+				Sint32 const texel_x = std::clamp((Sint32)std::floor((x + 0.5f) * texel_size_x * mip_width), 0, mip_width - 1);
+				Sint32 const texel_y = std::clamp((Sint32)std::floor((y + 0.5f) * texel_size_y * mip_height), 0, mip_height - 1);
+				return hzb.mips[sample_mip][texel_y * mip_width + texel_x];
+			};
+
+		Float const depth = std::max(std::max(SampleHZB(rect_pixels[0], rect_pixels[1]), SampleHZB(rect_pixels[2], rect_pixels[1])),
+									 std::max(SampleHZB(rect_pixels[0], rect_pixels[3]), SampleHZB(rect_pixels[2], rect_pixels[3])));
+		Float const min_depth = cull_data.rect_min.z;
+
+		Bool const is_occluded = depth < min_depth;
+		return cull_data.is_visible && !is_occluded;
+	}
+
+	Bool MeshletConeCull(Meshlet const& meshlet, Matrix const& local_to_world, Vector3 const& camera_position)
+	{
+		Float cone_axis[3];
+		Float cone_cutoff;
+		UnpackMeshletCone(meshlet.cone_axis_cutoff, cone_axis, cone_cutoff);
+		if (cone_cutoff >= 1.0f) return false;
+
+		Float4 const apex = Mul(Float4{ meshlet.cone_apex[0], meshlet.cone_apex[1], meshlet.cone_apex[2], 1 }, local_to_world);
+		//normals transform with the cofactor matrix, the inverse transpose scaled by the determinant. it keeps non uniformly
+		//scaled normals perpendicular to their triangles and flips them with the winding of mirrored instances
+		Vector3 const row0(local_to_world._11, local_to_world._12, local_to_world._13);
+		Vector3 const row1(local_to_world._21, local_to_world._22, local_to_world._23);
+		Vector3 const row2(local_to_world._31, local_to_world._32, local_to_world._33);
+		Vector3 const cofactor0 = row1.Cross(row2), cofactor1 = row2.Cross(row0), cofactor2 = row0.Cross(row1);
+		Vector3 const world_axis = Normalize(Vector3(
+			cone_axis[0] * cofactor0.x + cone_axis[1] * cofactor1.x + cone_axis[2] * cofactor2.x,
+			cone_axis[0] * cofactor0.y + cone_axis[1] * cofactor1.y + cone_axis[2] * cofactor2.y,
+			cone_axis[0] * cofactor0.z + cone_axis[1] * cofactor1.z + cone_axis[2] * cofactor2.z));
+		Vector3 const view_direction = Normalize(Vector3(apex.x - camera_position.x, apex.y - camera_position.y, apex.z - camera_position.z));
+		return view_direction.x * world_axis.x + view_direction.y * world_axis.y + view_direction.z * world_axis.z >= cone_cutoff;
+	}
+
+	MeshletCullResult CullMeshlet(Meshlet const& meshlet, Matrix const& local_to_world, MeshletCullView const& view)
+	{
+		if (!IsMeshletInLODCut(meshlet, local_to_world, view.camera_position, view.lod_error_scale)) return MeshletCullResult::LODCulled;
+		Vector3 const center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+		MeshletFrustumCullData const cull_data = MeshletFrustumCull(center, Vector3(meshlet.radius, meshlet.radius, meshlet.radius), local_to_world, view.view_projection);
+		if (!cull_data.is_visible) return MeshletCullResult::FrustumCulled;
+		if (view.cone_culling && MeshletConeCull(meshlet, local_to_world, view.camera_position)) return MeshletCullResult::BackfaceCulled;
+		if (view.hzb && !MeshletHZBCull(cull_data, *view.hzb)) return MeshletCullResult::OcclusionCulled;
+		return MeshletCullResult::Visible;
+	}
+
+	MeshletCullStats CullMeshlets(std::span<Meshlet const> meshlets, Matrix const& local_to_world, MeshletCullView const& view, std::vector<Uint32>* visible_meshlets)
+	{
+		MeshletCullStats stats{};
+		for (Uint32 i = 0; i < (Uint32)meshlets.size(); ++i)
+		{
+			++stats.tested;
+			switch (CullMeshlet(meshlets[i], local_to_world, view))
+			{
+			case MeshletCullResult::LODCulled:		 ++stats.lod_culled; break;
+			case MeshletCullResult::FrustumCulled:	 ++stats.frustum_culled; break;
+			case MeshletCullResult::BackfaceCulled:	 ++stats.backface_culled; break;
+			case MeshletCullResult::OcclusionCulled: ++stats.occlusion_culled; break;
+			case MeshletCullResult::Visible:
+				++stats.visible;
+				if (visible_meshlets) visible_meshlets->push_back(i);
+				break;
+			}
+		}
+		return stats;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include <span>
+#include "Meshlet.h"
+#include "MeshletLOD.h"
+
+namespace adria
+{
+	//cpu copy of the hierarchical depth buffer of the gpu driven renderer, mip m is max(width >> m, 1) x max(height >> m, 1)
+	struct MeshletHZB
+	{
+		Uint32 width = 0;
+		Uint32 height = 0;
+		std::vector<std::vector<Float>> mips;
+
+		Uint32 GetMipCount() const { return (Uint32)mips.size(); }
+	};
+
+	struct MeshletFrustumCullData
+	{
+		Bool is_visible;
+		Vector3 rect_min;
+		Vector3 rect_max;
+	};
+
+	enum class MeshletCullResult : Uint8
+	{
+		Visible,
+		LODCulled,
+		FrustumCulled,
+		BackfaceCulled,
+		OcclusionCulled
+	};
+
+	struct MeshletCullView
+	{
+		Matrix view_projection;
+		Vector3 camera_position;
+		MeshletHZB const* hzb = nullptr;
+		Bool cone_culling = true;
+		Float lod_error_scale = FLT_MAX;	//see MeshletLODErrorScale, the default selects full resolution meshlets
+	};
+
+	struct MeshletCullStats
+	{
+		Uint32 tested = 0;
+		Uint32 lod_culled = 0;
+		Uint32 frustum_culled = 0;
+		Uint32 backface_culled = 0;
+		Uint32 occlusion_culled = 0;
+		Uint32 visible = 0;
+	};
+
+	//cpu reference of the meshlet culling in GpuDrivenRendering.hlsli and CullMeshlets.hlsl. every function mirrors its shader
+	//counterpart operation by operation, including the way the hzb mip is picked, so cull rates and thresholds can be checked
+	//against data captured from the gpu path without a gpu. occlusion is tested like the second phase, against the current view.
+	//the lod cut is tested first, meshlets need the lod bounds of BuildMeshletHierarchy
+	MeshletFrustumCullData MeshletFrustumCull(Vector3 const& aabb_center, Vector3 const& aabb_extents, Matrix const& world_to_clip);
+	MeshletFrustumCullData MeshletFrustumCull(Vector3 const& aabb_center, Vector3 const& aabb_extents, Matrix const& local_to_world, Matrix const& world_to_clip);
+	//true if the meshlet is not occluded, mirrors HZBCull
+	Bool MeshletHZBCull(MeshletFrustumCullData const& cull_data, MeshletHZB const& hzb);
+	//true if all triangles face away from the camera, mirrors ConeCull. strong non uniform scale widens the normal cone beyond its cutoff
+	Bool MeshletConeCull(Meshlet const& meshlet, Matrix const& local_to_world, Vector3 const& camera_position);
+
+	MeshletCullResult CullMeshlet(Meshlet const& meshlet, Matrix const& local_to_world, MeshletCullView const& view);
+	//appends the indices of the visible meshlets if visible_meshlets is not null
+	MeshletCullStats CullMeshlets(std::span<Meshlet const> meshlets, Matrix const& local_to_world, MeshletCullView const& view, std::vector<Uint32>* visible_meshlets = nullptr);
+}
@@ -0,0 +1,326 @@
+#include <unordered_map>
+#include "meshoptimizer.h"
+#include "MeshletLOD.h"
+
+namespace adria
+{
+	namespace
+	{
+		//distance below which the projected error of a sphere stops growing, also keeps the division finite inside the sphere
+		constexpr Float MinLODDistance = 1e-4f;
+
+		//a group that keeps more than this fraction of its triangles is not worth another level, its meshlets become roots
+		constexpr Float MinSimplificationRatio = 0.85f;
+
+		void MergeSphere(MeshletLODBounds& bounds, Float const center[3], Float radius)
+		{
+			Vector3 const offset(center[0] - bounds.center[0], center[1] - bounds.center[1], center[2] - bounds.center[2]);
+			Float const distance = offset.Length();
+			if (distance + radius <= bounds.radius) return;
+			if (distance + bounds.radius <= radius)
+			{
+				std::copy_n(center, 3, bounds.center);
+				bounds.radius = radius;
+				return;
+			}
+			Float const merged_radius = (distance + bounds.radius + radius) * 0.5f;
+			Float const t = (merged_radius - bounds.radius) / distance;
+			bounds.center[0] += offset.x * t;
+			bounds.center[1] += offset.y * t;
+			bounds.center[2] += offset.z * t;
+			bounds.radius = merged_radius;
+		}
+
+		Bool SphereContains(MeshletLODBounds const& outer, MeshletLODBounds const& inner)
+		{
+			Vector3 const offset(inner.center[0] - outer.center[0], inner.center[1] - outer.center[1], inner.center[2] - outer.center[2]);
+			Float const tolerance = 1e-4f * std::max(outer.radius, 1.0f);
+			return offset.Length() + inner.radius <= outer.radius + tolerance;
+		}
+
+		Bool operator==(MeshletLODBounds const& a, MeshletLODBounds const& b)
+		{
+			return a.center[0] == b.center[0] && a.center[1] == b.center[1] && a.center[2] == b.center[2] && a.radius == b.radius && a.error == b.error;
+		}
+
+		//builds meshlets of indexed triangles and appends them to the hierarchy. vertex_ids maps the vertices of the triangles
+		//to the vertices of the mesh, null if they index the mesh directly
+		Uint32 AppendMeshlets(MeshletHierarchy& hierarchy, Vector3 const* positions, Uint64 vertex_count, Uint32 const* vertex_ids,
+			Uint32 const* indices, Uint64 index_count, MeshletHierarchyParams const& params, MeshletLODBounds const& lod_bounds)
+		{
+			Uint64 const max_meshlets = meshopt_buildMeshletsBound(index_count, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+			std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+			std::vector<Uint32> meshlet_vertices(max_meshlets * MESHLET_MAX_VERTICES);
+			std::vector<unsigned char> meshlet_triangles(max_meshlets * MESHLET_MAX_TRIANGLES * 3);
+			Uint64 const meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(), indices, index_count,
+				&positions[0].x, vertex_count, sizeof(Vector3), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, params.cone_weight);
+
+			for (Uint64 i = 0; i < meshlet_count; ++i)
+			{
+				meshopt_Meshlet const& m = meshlets[i];
+				meshopt_Bounds const meshopt_bounds = meshopt_computeMeshletBounds(&meshlet_vertices[m.vertex_offset], &meshlet_triangles[m.triangle_offset],
+					m.triangle_count, &positions[0].x, vertex_count, sizeof(Vector3));
+
+				Meshlet& meshlet = hierarchy.meshlets.emplace_back();
+				std::memcpy(meshlet.center, meshopt_bounds.center, sizeof(Float) * 3);
+				meshlet.radius = meshopt_bounds.radius;
+				std::memcpy(meshlet.cone_apex, meshopt_bounds.cone_apex, sizeof(Float) * 3);
+				//back faces of double sided materials are visible, so their meshlets must not be backface culled
+				meshlet.cone_axis_cutoff = PackMeshletCone(meshopt_bounds.cone_axis_s8, params.double_sided ? Sint8(127) : meshopt_bounds.cone_cutoff_s8);
+				meshlet.vertex_count = m.vertex_count;
+				meshlet.triangle_count = m.triangle_count;
+				meshlet.vertex_offset = (Uint32)hierarchy.meshlet_vertices.size();
+				meshlet.triangle_offset = (Uint32)hierarchy.meshlet_triangles.size();
+				meshlet.lod_bounds = lod_bounds;
+				meshlet.parent_lod_bounds = MeshletLODBounds{ .error = -1.0f };	//set when the meshlet is simplified into a group
+
+				for (Uint32 v = 0; v < m.vertex_count; ++v)
+				{
+					Uint32 const vertex = meshlet_vertices[m.vertex_offset + v];
+					hierarchy.meshlet_vertices.push_back(vertex_ids ? vertex_ids[vertex] : vertex);
+				}
+				unsigned char const* src_triangles = &meshlet_triangles[m.triangle_offset];
+				for (Uint32 t = 0; t < m.triangle_count; ++t)
+				{
+					MeshletTriangle& tri = hierarchy.meshlet_triangles.emplace_back();
+					tri.V0 = *src_triangles++;
+					tri.V1 = *src_triangles++;
+					tri.V2 = *src_triangles++;
+				}
+			}
+			return (Uint32)meshlet_count;
+		}
+
+		//greedy grouping of meshlets that share the most vertices, adjacency is computed on the welded vertices
+		std::vector<std::vector<Uint32>> GroupMeshlets(MeshletHierarchy const& hierarchy, Uint32 meshlet_offset, Uint32 meshlet_count,
+			std::vector<Uint32> const& weld, Uint32 group_size)
+		{
+			std::unordered_map<Uint32, std::vector<Uint32>> vertex_meshlets;
+			for (Uint32 i = 0; i < meshlet_count; ++i)
+			{
+				Meshlet const& meshlet = hierarchy.meshlets[meshlet_offset + i];
+				for (Uint32 v = 0; v < meshlet.vertex_count; ++v)
+				{
+					std::vector<Uint32>& meshlets = vertex_meshlets[weld[hierarchy.meshlet_vertices[meshlet.vertex_offset + v]]];
+					if (meshlets.empty() || meshlets.back() != i) meshlets.push_back(i);
+				}
+			}
+
+			std::vector<std::vector<std::pair<Uint32, Uint32>>> adjacency(meshlet_count);
+			{
+				std::unordered_map<Uint32, Uint32> shared_vertices;
+				for (Uint32 i = 0; i < meshlet_count; ++i)
+				{
+					shared_vertices.clear();
+					Meshlet const& meshlet = hierarchy.meshlets[meshlet_offset + i];
+					for (Uint32 v = 0; v < meshlet.vertex_count; ++v)
+					{
+						for (Uint32 neighbour : vertex_meshlets[weld[hierarchy.meshlet_vertices[meshlet.vertex_offset + v]]])
+						{
+							if (neighbour != i) ++shared_vertices[neighbour];
+						}
+					}
+					adjacency[i].assign(shared_vertices.begin(), shared_vertices.end());
+				}
+			}
+
+			std::vector<std::vector<Uint32>> groups;
+			std::vector<Bool> grouped(meshlet_count, false);
+			std::unordered_map<Uint32, Uint32> candidates;
+			for (Uint32 seed = 0; seed < meshlet_count; ++seed)
+			{
+				if (grouped[seed]) continue;
+
+				std::vector<Uint32>& group = groups.emplace_back();
+				candidates.clear();
+				Uint32 next = seed;
+				while (true)
+				{
+					grouped[next] = true;
+					group.push_back(next);
+					candidates.erase(next);
+					if (group.size() >= group_size) break;
+
+					for (auto const& [neighbour, weight] : adjacency[next])
+					{
+						if (!grouped[neighbour]) candidates[neighbour] += weight;
+					}
+					if (candidates.empty()) break;
+
+					next = candidates.begin()->first;
+					Uint32 best_weight = 0;
+					for (auto const& [candidate, weight] : candidates)
+					{
+						if (weight > best_weight || (weight == best_weight && candidate < next))
+						{
+							next = candidate;
+							best_weight = weight;
+						}
+					}
+				}
+			}
+			return groups;
+		}
+	}
+
+	void BuildMeshletHierarchy(MeshletHierarchy& hierarchy, Vector3 const* positions, Uint64 vertex_count,
+		Uint32 const* indices, Uint64 index_count, MeshletHierarchyParams const& params)
+	{
+		hierarchy = MeshletHierarchy{};
+		if (index_count == 0) return;
+
+		//meshlets on both sides of a uv or normal seam share no vertex, so adjacency for grouping is computed on vertices welded
+		//by position. simplification keeps the original vertices, meshopt_simplify matches seam vertices by position itself and
+		//collapses them together so the seam stays closed without losing its attributes
+		std::vector<Uint32> weld(vertex_count);
+		{
+			std::vector<Uint32> remap(vertex_count);
+			Uint64 const unique_count = meshopt_generateVertexRemap(remap.data(), nullptr, vertex_count, &positions[0].x, vertex_count, sizeof(Vector3));
+			std::vector<Uint32> first_vertex(unique_count, Uint32(-1));
+			for (Uint32 v = 0; v < vertex_count; ++v)
+			{
+				if (first_vertex[remap[v]] == Uint32(-1)) first_vertex[remap[v]] = v;
+				weld[v] = first_vertex[remap[v]];
+			}
+		}
+
+		MeshletHierarchyLevel& base_level = hierarchy.levels.emplace_back();
+		base_level.meshlet_count = AppendMeshlets(hierarchy, positions, vertex_count, nullptr, indices, index_count, params, MeshletLODBounds{});
+		for (Meshlet& meshlet : hierarchy.meshlets)
+		{
+			std::memcpy(meshlet.lod_bounds.center, meshlet.center, sizeof(Float) * 3);
+			meshlet.lod_bounds.radius = meshlet.radius;
+			meshlet.lod_bounds.error = 0.0f;
+		}
+
+		std::vector<Uint32> local_vertex(vertex_count, Uint32(-1));
+		std::vector<Uint32> local_to_mesh;
+		std::vector<Vector3> local_positions;
+		std::vector<Uint32> group_indices;
+		std::vector<Uint32> simplified_indices;
+		for (Uint32 level = 0; level + 1 < params.max_levels; ++level)
+		{
+			Uint32 const meshlet_offset = hierarchy.levels[level].meshlet_offset;
+			Uint32 const meshlet_count = hierarchy.levels[level].meshlet_count;
+			if (meshlet_count <= 1) break;
+
+			MeshletHierarchyLevel next_level{};
+			next_level.meshlet_offset = (Uint32)hierarchy.meshlets.size();
+			for (std::vector<Uint32> const& group : GroupMeshlets(hierarchy, meshlet_offset, meshlet_count, weld, params.group_size))
+			{
+				local_to_mesh.clear();
+				local_positions.clear();
+				group_indices.clear();
+				for (Uint32 group_meshlet : group)
+				{
+					Meshlet const& meshlet = hierarchy.meshlets[meshlet_offset + group_meshlet];
+					for (Uint32 t = 0; t < meshlet.triangle_count; ++t)
+					{
+						MeshletTriangle const& tri = hierarchy.meshlet_triangles[meshlet.triangle_offset + t];
+						for (Uint32 corner : { (Uint32)tri.V0, (Uint32)tri.V1, (Uint32)tri.V2 })
+						{
+							Uint32 const vertex = hierarchy.meshlet_vertices[meshlet.vertex_offset + corner];
+							if (local_vertex[vertex] == Uint32(-1))
+							{
+								local_vertex[vertex] = (Uint32)local_to_mesh.size();
+								local_to_mesh.push_back(vertex);
+								local_positions.push_back(positions[vertex]);
+							}
+							group_indices.push_back(local_vertex[vertex]);
+						}
+					}
+				}
+				for (Uint32 vertex : local_to_mesh) local_vertex[vertex] = Uint32(-1);
+
+				//the group border is the border of its triangles, locking it keeps the group watertight with its neighbours on every level
+				simplified_indices.resize(group_indices.size());
+				Float relative_error = 0.0f;
+				Uint64 const target_index_count = group_indices.size() / 6 * 3;
+				Uint64 const simplified_index_count = meshopt_simplify(simplified_indices.data(), group_indices.data(), group_indices.size(),
+					&local_positions[0].x, local_positions.size(), sizeof(Vector3), target_index_count, FLT_MAX, meshopt_SimplifyLockBorder, &relative_error);
+				if (simplified_index_count == 0 || simplified_index_count > group_indices.size() * MinSimplificationRatio) continue;
+
+				MeshletHierarchyGroup& hierarchy_group = hierarchy.groups.emplace_back();
+				MeshletLODBounds& bounds = hierarchy_group.bounds;
+				bounds = hierarchy.meshlets[meshlet_offset + group[0]].lod_bounds;
+				bounds.error = relative_error * meshopt_simplifyScale(&local_positions[0].x, local_positions.size(), sizeof(Vector3));
+				for (Uint32 group_meshlet : group)
+				{
+					MeshletLODBounds const& child_bounds = hierarchy.meshlets[meshlet_offset + group_meshlet].lod_bounds;
+					MergeSphere(bounds, child_bounds.center, child_bounds.radius);
+					bounds.error = std::max(bounds.error, child_bounds.error);
+					hierarchy_group.children.push_back(meshlet_offset + group_meshlet);
+				}
+				for (Uint32 child : hierarchy_group.children) hierarchy.meshlets[child].parent_lod_bounds = bounds;
+
+				hierarchy_group.first_meshlet = (Uint32)hierarchy.meshlets.size();
+				hierarchy_group.meshlet_count = AppendMeshlets(hierarchy, local_positions.data(), local_positions.size(), local_to_mesh.data(),
+					simplified_indices.data(), simplified_index_count, params, bounds);
+				next_level.meshlet_count += hierarchy_group.meshlet_count;
+				next_level.max_error = std::max(next_level.max_error, bounds.error);
+			}
+			if (next_level.meshlet_count == 0) break;
+			hierarchy.levels.push_back(next_level);
+		}
+
+		//meshlets that were not simplified into a group are drawn until their own error is too large
+		for (Meshlet& meshlet : hierarchy.meshlets)
+		{
+			if (meshlet.parent_lod_bounds.error >= 0.0f) continue;
+			meshlet.parent_lod_bounds = meshlet.lod_bounds;
+			meshlet.parent_lod_bounds.error = FLT_MAX;
+		}
+		for (MeshletHierarchyLevel& level : hierarchy.levels)
+		{
+			for (Uint32 i = 0; i < level.meshlet_count; ++i) level.triangle_count += hierarchy.meshlets[level.meshlet_offset + i].triangle_count;
+		}
+	}
+
+	MeshletHierarchyValidation ValidateMeshletHierarchy(MeshletHierarchy const& hierarchy)
+	{
+		MeshletHierarchyValidation validation{};
+		for (MeshletHierarchyGroup const& group : hierarchy.groups)
+		{
+			for (Uint32 child : group.children)
+			{
+				Meshlet const& meshlet = hierarchy.meshlets[child];
+				if (meshlet.lod_bounds.error > group.bounds.error) ++validation.error_violations;
+				if (!SphereContains(group.bounds, meshlet.lod_bounds)) ++validation.bounds_violations;
+				if (!(meshlet.parent_lod_bounds == group.bounds)) ++validation.link_violations;
+			}
+			for (Uint32 i = 0; i < group.meshlet_count; ++i)
+			{
+				if (!(hierarchy.meshlets[group.first_meshlet + i].lod_bounds == group.bounds)) ++validation.link_violations;
+			}
+		}
+		for (Meshlet const& meshlet : hierarchy.meshlets)
+		{
+			if (meshlet.parent_lod_bounds.error < meshlet.lod_bounds.error) ++validation.error_violations;
+		}
+		return validation;
+	}
+
+	Float MeshletLODErrorScale(Float projection_22, Float viewport_height, Float threshold_pixels)
+	{
+		//a threshold of zero only allows simplification that does not change the surface
+		if (threshold_pixels <= 0.0f) return FLT_MAX;
+		return 0.5f * viewport_height * projection_22 / threshold_pixels;
+	}
+
+	Float MeshletLODProjectedError(MeshletLODBounds const& bounds, Matrix const& local_to_world, Vector3 const& camera_position, Float error_scale)
+	{
+		Vector3 const center = Vector3::Transform(Vector3(bounds.center[0], bounds.center[1], bounds.center[2]), local_to_world);
+		Float const scale_x = local_to_world._11 * local_to_world._11 + local_to_world._12 * local_to_world._12 + local_to_world._13 * local_to_world._13;
+		Float const scale_y = local_to_world._21 * local_to_world._21 + local_to_world._22 * local_to_world._22 + local_to_world._23 * local_to_world._23;
+		Float const scale_z = local_to_world._31 * local_to_world._31 + local_to_world._32 * local_to_world._32 + local_to_world._33 * local_to_world._33;
+		Float const scale = std::sqrt(std::max(std::max(scale_x, scale_y), scale_z));
+		Float const distance = std::max(Vector3::Distance(center, camera_position) - bounds.radius * scale, MinLODDistance);
+		return bounds.error * scale * error_scale / distance;
+	}
+
+	Bool IsMeshletInLODCut(Meshlet const& meshlet, Matrix const& local_to_world, Vector3 const& camera_position, Float error_scale)
+	{
+		return MeshletLODProjectedError(meshlet.lod_bounds, local_to_world, camera_position, error_scale) <= 1.0f &&
+			   MeshletLODProjectedError(meshlet.parent_lod_bounds, local_to_world, camera_position, error_scale) > 1.0f;
+	}
+}
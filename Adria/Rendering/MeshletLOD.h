@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <span>
+#include "Meshlet.h"
+
+namespace adria
+{
+	struct MeshletHierarchyParams
+	{
+		Float cone_weight = 0.25f;
+		Bool double_sided = false;	//disables backface culling of all meshlets
+		Uint32 group_size = 4;		//meshlets merged and simplified together
+		Uint32 max_levels = 16;
+	};
+
+	struct MeshletHierarchyLevel
+	{
+		Uint32 meshlet_offset = 0;
+		Uint32 meshlet_count = 0;
+		Uint64 triangle_count = 0;
+		Float max_error = 0.0f;
+	};
+
+	//meshlets of one group are simplified together into the meshlets of the next level
+	struct MeshletHierarchyGroup
+	{
+		std::vector<Uint32> children;
+		Uint32 first_meshlet = 0;
+		Uint32 meshlet_count = 0;
+		MeshletLODBounds bounds;
+	};
+
+	//cluster lod dag of a mesh, level 0 holds the full resolution meshlets and every level is contiguous in meshlets.
+	//meshlet vertices index the vertex streams of the mesh, so all levels share one vertex buffer
+	struct MeshletHierarchy
+	{
+		std::vector<Meshlet> meshlets;
+		std::vector<Uint32> meshlet_vertices;
+		std::vector<MeshletTriangle> meshlet_triangles;
+		std::vector<MeshletHierarchyLevel> levels;
+		std::vector<MeshletHierarchyGroup> groups;
+	};
+
+	//groups neighbouring meshlets, simplifies every group to half of its triangles with the group border locked so neighbouring
+	//groups still match, and splits the result into the meshlets of the next level, until the mesh cannot be simplified further.
+	//errors are in object space and never decrease from a group to the group it is simplified into
+	void BuildMeshletHierarchy(MeshletHierarchy& hierarchy, Vector3 const* positions, Uint64 vertex_count,
+		Uint32 const* indices, Uint64 index_count, MeshletHierarchyParams const& params);
+
+	struct MeshletHierarchyValidation
+	{
+		Uint32 error_violations = 0;	//group error lower than the error of one of its children
+		Uint32 bounds_violations = 0;	//group sphere not containing the sphere of one of its children
+		Uint32 link_violations = 0;		//meshlet bounds not matching the bounds of the group that produced or consumed it
+		Bool IsValid() const { return error_violations == 0 && bounds_violations == 0 && link_violations == 0; }
+	};
+	//checks the invariants that make the projected error monotonic from a meshlet to its parents, which keeps every cut crack free
+	MeshletHierarchyValidation ValidateMeshletHierarchy(MeshletHierarchy const& hierarchy);
+
+	//error_scale converts object space error over distance to units of the threshold, see MeshletLODErrorScale.
+	//mirrors the functions of the same name in GpuDrivenRendering.hlsli
+	Float MeshletLODErrorScale(Float projection_22, Float viewport_height, Float threshold_pixels);
+	Float MeshletLODProjectedError(MeshletLODBounds const& bounds, Matrix const& local_to_world, Vector3 const& camera_position, Float error_scale);
+	Bool IsMeshletInLODCut(Meshlet const& meshlet, Matrix const& local_to_world, Vector3 const& camera_position, Float error_scale);
+}
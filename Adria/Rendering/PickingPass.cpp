@@ -3,6 +3,7 @@
 #include "ShaderManager.h" 
 #include "Graphics/GfxDevice.h"
 #include "Graphics/GfxBuffer.h"
+#include "Graphics/GfxReadbackManager.h"
 #include "Graphics/GfxPipelineState.h"
 #include "RenderGraph/RenderGraph.h"
 #include "Logging/Logger.h"
@@ -14,7 +15,6 @@ namespace adria
 		width(width), height(height)
 	{
 		CreatePSO();
-		CreatePickingBuffers();
 	}
 
 	void PickingPass::OnResize(Uint32 w, Uint32 h)
@@ -88,21 +88,17 @@ namespace adria
 			{
 				data.src = builder.ReadCopySrcBuffer(RG_NAME(PickBuffer));
 			},
-			[=, backbuffer_index = gfx->GetBackbufferIndex()](PickingPassCopyData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
+			[=](PickingPassCopyData const& data, RenderGraphContext& context, GfxCommandList* cmd_list)
 			{
 				GfxBuffer const& buffer = context.GetCopySrcBuffer(data.src);
-				cmd_list->CopyBuffer(*read_picking_buffers[backbuffer_index], buffer);
+				gfx->GetReadbackManager()->ReadbackBuffer(cmd_list, buffer, [this](void const* readback_data, Uint64 size)
+					{
+						ADRIA_ASSERT(size == sizeof(PickingData));
+						memcpy(&picking_data, readback_data, sizeof(PickingData));
+					});
 			}, RGPassType::Copy, RGPassFlags::ForceNoCull);
 	}
 
-	PickingData PickingPass::GetPickingData() const
-	{
-		UINT backbuffer_index = gfx->GetBackbufferIndex();
-		PickingData const* data = read_picking_buffers[backbuffer_index]->GetMappedData<PickingData>();
-		PickingData picking_data = *data;
-		return picking_data;
-	}
-
 	void PickingPass::CreatePSO()
 	{
 		GfxComputePipelineStateDesc compute_pso_desc{};
@@ -110,13 +106,5 @@ namespace adria
 		picking_pso = gfx->CreateComputePipelineState(compute_pso_desc);
 	}
 
-	void PickingPass::CreatePickingBuffers()
-	{
-		for (Uint64 i = 0; i < gfx->GetBackbufferCount(); ++i)
-		{
-			read_picking_buffers.emplace_back(gfx->CreateBuffer(ReadBackBufferDesc(sizeof(PickingData))));
-		}
-	}
-
 }
 
@@ -24,16 +24,16 @@ namespace adria
 
 		void AddPass(RenderGraph& rg);
 
-		PickingData GetPickingData() const;
+		//latest picking data that reached the cpu
+		PickingData GetPickingData() const { return picking_data; }
 
 	private:
 		GfxDevice* gfx;
 		Uint32 width, height;
-		std::vector<std::unique_ptr<GfxBuffer>> read_picking_buffers;
+		PickingData picking_data{};
 		std::unique_ptr<GfxComputePipelineState> picking_pso;
 
 	private:
 		void CreatePSO();
-		void CreatePickingBuffers();
 	};
 }
\ No newline at end of file
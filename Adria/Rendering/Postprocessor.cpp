@@ -93,7 +93,12 @@ namespace adria
 
 	void PostProcessor::AddRenderResolutionChangedCallback(RenderResolutionChangedDelegate delegate)
 	{
-		GetPostEffect<UpscalerPassGroup>()->AddRenderResolutionChangedCallback(delegate);
+		GetPostEffect<UpscalerPassGroup>()->AddRenderResolutionChangedCallback(std::move(delegate));
+	}
+
+	void PostProcessor::SetDynamicResolutionScale(Float scale)
+	{
+		GetPostEffect<UpscalerPassGroup>()->SetDynamicResolutionScale(scale);
 	}
 
 	void PostProcessor::GUI()
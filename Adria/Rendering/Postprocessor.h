@@ -55,6 +55,7 @@ namespace adria
 		void AddPasses(RenderGraph& rg);
 		void AddTonemapPass(RenderGraph& rg, RGResourceName input);
 		void AddRenderResolutionChangedCallback(RenderResolutionChangedDelegate delegate);
+		void SetDynamicResolutionScale(Float scale);
 		void GUI();
 
 		void OnRainEvent(Bool enabled);
@@ -0,0 +1,114 @@
+#include "RenderSnapshot.h"
+
+namespace adria
+{
+	namespace
+	{
+		class SnapshotHasher
+		{
+		public:
+			void Add(void const* data, Uint64 size)
+			{
+				Uint8 const* bytes = static_cast<Uint8 const*>(data);
+				for (Uint64 i = 0; i < size; ++i)
+				{
+					hash ^= bytes[i];
+					hash *= 1099511628211ull;
+				}
+			}
+			template<typename T> requires std::is_trivially_copyable_v<T>
+			void Add(T const& value)
+			{
+				Add(&value, sizeof(T));
+			}
+			Uint64 Get() const { return hash; }
+
+		private:
+			Uint64 hash = 14695981039346656037ull;
+		};
+	}
+
+	void ExtractRenderSnapshot(entt::registry const& reg, RenderSnapshot& snapshot)
+	{
+		snapshot.lights.clear();
+		auto light_view = reg.view<Light>();
+		for (entt::entity light_entity : light_view)
+		{
+			snapshot.lights.push_back(RenderSnapshotLight{ .entity = light_entity, .light = light_view.get<Light>(light_entity) });
+		}
+
+		snapshot.instances.clear();
+		auto mesh_view = reg.view<Mesh>();
+		for (entt::entity mesh_entity : mesh_view)
+		{
+			Mesh const& mesh = mesh_view.get<Mesh>(mesh_entity);
+			for (SubMeshInstance const& instance : mesh.instances)
+			{
+				RenderSnapshotInstance& snapshot_instance = snapshot.instances.emplace_back();
+				snapshot_instance.mesh = mesh_entity;
+				snapshot_instance.submesh_index = instance.submesh_index;
+				snapshot_instance.world_transform = instance.world_transform;
+				snapshot_instance.local_bounding_box = mesh.submeshes[instance.submesh_index].bounding_box;
+			}
+		}
+	}
+
+	void PrepareRenderSnapshot(RenderSnapshot& snapshot)
+	{
+		BoundingFrustum const camera_frustum = snapshot.camera.Frustum();
+		for (RenderSnapshotInstance& instance : snapshot.instances)
+		{
+			instance.local_bounding_box.Transform(instance.bounding_box, instance.world_transform);
+			instance.inverse_world_transform = instance.world_transform.Invert();
+			instance.camera_visible = camera_frustum.Intersects(instance.bounding_box);
+		}
+
+		snapshot.sun_light = -1;
+		for (Uint64 i = 0; i < snapshot.lights.size(); ++i)
+		{
+			Light const& light = snapshot.lights[i].light;
+			if (light.type == LightType::Directional && light.active)
+			{
+				snapshot.sun_light = (Sint32)i;
+				break;
+			}
+		}
+	}
+
+	Uint64 HashRenderSnapshot(RenderSnapshot const& snapshot)
+	{
+		SnapshotHasher hasher{};
+		hasher.Add(snapshot.frame);
+		hasher.Add(snapshot.dt);
+		hasher.Add(snapshot.camera.View());
+		hasher.Add(snapshot.camera.Proj());
+
+		hasher.Add(snapshot.lights.size());
+		for (RenderSnapshotLight const& snapshot_light : snapshot.lights)
+		{
+			Light const& light = snapshot_light.light;
+			hasher.Add(snapshot_light.entity);
+			hasher.Add(light.position);
+			hasher.Add(light.direction);
+			hasher.Add(light.color);
+			hasher.Add(light.range);
+			hasher.Add(light.intensity);
+			hasher.Add(light.type);
+			hasher.Add(light.active);
+			hasher.Add(light.casts_shadows);
+			hasher.Add(light.volumetric);
+		}
+
+		hasher.Add(snapshot.instances.size());
+		for (RenderSnapshotInstance const& instance : snapshot.instances)
+		{
+			hasher.Add(instance.mesh);
+			hasher.Add(instance.submesh_index);
+			hasher.Add(instance.world_transform);
+			hasher.Add(instance.bounding_box);
+			hasher.Add(instance.camera_visible);
+		}
+		hasher.Add(snapshot.sun_light);
+		return hasher.Get();
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Camera.h"
+#include "Components.h"
+#include "entt/entity/registry.hpp"
+
+namespace adria
+{
+	struct RenderSnapshotLight
+	{
+		entt::entity entity;
+		Light light;
+	};
+
+	struct RenderSnapshotInstance
+	{
+		entt::entity mesh;
+		Uint32 submesh_index;
+		Matrix world_transform;
+		BoundingBox local_bounding_box;
+
+		//filled by PrepareRenderSnapshot
+		Matrix inverse_world_transform;
+		BoundingBox bounding_box;
+		Bool camera_visible;
+	};
+
+	//immutable view of one frame, written by the simulation and consumed by the renderer
+	struct RenderSnapshot
+	{
+		Uint64 frame = 0;
+		Float dt = 0.0f;
+		Camera camera;
+		std::vector<RenderSnapshotLight> lights;
+		std::vector<RenderSnapshotInstance> instances;
+		Sint32 sun_light = -1;	//index of the first active directional light
+	};
+
+	//copies the registry owned part of the snapshot: lights and the instance list, capacity is reused between frames
+	void ExtractRenderSnapshot(entt::registry const& reg, RenderSnapshot& snapshot);
+	//world bounds, inverse transforms and frustum visibility of the instances and the sun light. only reads the snapshot
+	//and its camera, so it runs in the simulation stage
+	void PrepareRenderSnapshot(RenderSnapshot& snapshot);
+	Uint64 HashRenderSnapshot(RenderSnapshot const& snapshot);
+}
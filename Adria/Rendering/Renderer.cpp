@@ -2,6 +2,7 @@
 #include "BlackboardData.h"
 #include "Camera.h"
 #include "Components.h"
+#include "RenderSnapshot.h"
 #include "ShaderManager.h"
 #include "SkyModel.h"
 #include "TextureManager.h"
@@ -18,7 +19,6 @@
 #include "RenderGraph/RenderGraph.h"
 #include "Utilities/ThreadPool.h"
 #include "Utilities/Random.h"
-#include "Utilities/ImageWrite.h"
 #include "Math/Constants.h"
 #include "Logging/Logger.h"
 #include "Core/Paths.h"
@@ -32,9 +32,17 @@ namespace adria
 {
 	static TAutoConsoleVariable<int>  LightingPath("r.LightingPath", 0, "0 - Deferred, 1 - Tiled Deferred, 2 - Clustered Deferred, 3 - Path Tracing");
 	static TAutoConsoleVariable<int>  VolumetricPath("r.VolumetricPath", 1, "0 - None, 1 - 2D Raymarching, 2 - Fog Volume");
+	static TAutoConsoleVariable<Bool> OcclusionCulling("r.OcclusionCulling", true, "Enable CPU software occlusion culling of the batches when GPU driven rendering is disabled");
+	static TAutoConsoleVariable<int>  OcclusionCullingTriangleBudget("r.OcclusionCulling.TriangleBudget", 16384, "Maximum number of occluder triangles rasterized per frame by the software occlusion culler");
+	static TAutoConsoleVariable<Bool>  DynamicResolution("r.DynamicResolution", false, "Scale the render resolution of the active upscaler to keep the GPU frame time under the target");
+	static TAutoConsoleVariable<Float> DynamicResolutionTargetFrameTime("r.DynamicResolution.TargetFrameTime", 16.67f, "GPU frame time budget of dynamic resolution in milliseconds");
+	static TAutoConsoleVariable<Float> DynamicResolutionMinScale("r.DynamicResolution.MinScale", 0.5f, "Minimum scale of the upscaler render resolution");
+	static TAutoConsoleVariable<Float> DynamicResolutionMaxScale("r.DynamicResolution.MaxScale", 1.0f, "Maximum scale of the upscaler render resolution");
+	static TAutoConsoleVariable<Bool>  TextureStreaming("r.TextureStreaming", false, "Trim the top mips of the least recently used textures when the textures do not fit into the budget, every change waits for the GPU");
+	static TAutoConsoleVariable<int>   TextureStreamingBudget("r.TextureStreaming.Budget", 0, "Texture memory budget in MB, 0 derives it from the memory budget of the adapter");
 
 	Renderer::Renderer(entt::registry& reg, GfxDevice* gfx, Uint32 width, Uint32 height) : reg(reg), gfx(gfx), resource_pool(gfx),
-		accel_structure(gfx), camera(nullptr), display_width(width), display_height(height), render_width(width), render_height(height),
+		accel_structure(gfx), snapshot(nullptr), camera(nullptr), display_width(width), display_height(height), render_width(width), render_height(height),
 		backbuffer_count(gfx->GetBackbufferCount()), backbuffer_index(gfx->GetBackbufferIndex()), final_texture(nullptr),
 		frame_cbuffer(gfx, backbuffer_count), gpu_driven_renderer(reg, gfx, width, height),
 		gbuffer_pass(reg, gfx, width, height),
@@ -45,7 +53,7 @@ namespace adria
 		clustered_deferred_lighting_pass(reg, gfx, width, height),
 		decals_pass(reg, gfx, width, height), rain_pass(reg, gfx, width, height), ocean_renderer(reg, gfx, width, height),
 		shadow_renderer(reg, gfx, width, height), renderer_output_pass(gfx, width, height),
-		path_tracer(gfx, width, height), ddgi(gfx, reg, width, height), gpu_debug_printer(gfx)
+		path_tracer(gfx, width, height), ddgi(gfx, reg, width, height), gpu_debug_printer(gfx), screen_capture(gfx)
 	{
 		ray_tracing_supported = gfx->GetCapabilities().SupportsRayTracing();
 
@@ -61,7 +69,6 @@ namespace adria
 		rain_pass.GetRainEvent().AddMember(&PostProcessor::OnRainEvent, postprocessor);
 		rain_pass.GetRainEvent().AddMember(&GPUDrivenGBufferPass::OnRainEvent, gpu_driven_renderer);
 		rain_pass.GetRainEvent().AddMember(&GBufferPass::OnRainEvent, gbuffer_pass);
-		screenshot_fence.Create(gfx, "Screenshot Fence");
 
 		{
 			LightingPath->AddOnChanged(ConsoleVariableDelegate::CreateLambda([this](IConsoleVariable* cvar) { lighting_path = static_cast<LightingPathType>(cvar->GetInt()); }));
@@ -88,23 +95,29 @@ namespace adria
 	{
 		viewport_data = vp;
 	}
-	void Renderer::NewFrame(Camera const* _camera)
+	void Renderer::NewFrame(RenderSnapshot const* _snapshot)
 	{
-		ADRIA_ASSERT(_camera);
-		camera = _camera;
+		ADRIA_ASSERT(_snapshot);
+		snapshot = _snapshot;
+		camera = &snapshot->camera;
 		backbuffer_index = gfx->GetBackbufferIndex();
 		g_GfxProfiler.NewFrame();
 		GfxTracyProfiler::NewFrame();
+		screen_capture.Update();
 	}
 	void Renderer::Update(Float dt)
 	{
 		shadow_renderer.SetupShadows(camera);
 		UpdateSceneBuffers();
 		UpdateFrameConstants(dt);
-		CameraFrustumCulling();
+		CameraCulling();
 	}
 	void Renderer::Render()
 	{
+		g_GeometryBufferCache.Update(gfx->GetCommandList());
+		UpdateTextureResidency();
+		if (ray_tracing_supported) UpdateAS();
+
 		RenderGraph render_graph(resource_pool);
 		RGBlackboard& rg_blackboard = render_graph.GetBlackboard();
 		FrameBlackboardData frame_data{};
@@ -134,14 +147,18 @@ namespace adria
 		gpu_debug_printer.AddClearPass(render_graph);
 		if (lighting_path == LightingPathType::PathTracing) Render_PathTracing(render_graph);
 		else Render_Deferred(render_graph);
-		if (take_screenshot) TakeScreenshot(render_graph);
+		AddScreenCapturePasses(render_graph);
 		gpu_debug_printer.AddPrintPass(render_graph);
 
 		if (!g_Editor.IsActive()) CopyToBackbuffer(render_graph);
 		else g_Editor.AddRenderPass(render_graph);
 
 		render_graph.Build();
-		render_graph.Execute();
+		{
+			AdriaGfxProfileScope(gfx->GetCommandList(), "Frame");
+			render_graph.Execute();
+		}
+		UpdateDynamicResolution();
 
 		GUI();
 	}
@@ -203,14 +220,18 @@ namespace adria
 	}
 	void Renderer::OnTakeScreenshot(Char const* filename)
 	{
-		screenshot_name = filename;
+		std::string screenshot_name = filename;
 		if (screenshot_name.empty())
 		{
 			static Uint32 screenshot_index = 0;
 			screenshot_name = "adria_screenshot";
 			screenshot_name += std::to_string(screenshot_index++);
 		}
-		take_screenshot = true;
+		screen_capture.RequestScreenshot(screenshot_name);
+	}
+	void Renderer::FlushScreenCaptures()
+	{
+		screen_capture.Flush();
 	}
 
 	void Renderer::OnLightChanged()
@@ -236,11 +257,21 @@ namespace adria
 		auto ray_tracing_view = reg.view<Mesh, RayTracing>();
 		for (auto entity : ray_tracing_view)
 		{
-			Mesh const& mesh = ray_tracing_view.get<Mesh>(entity);
-			accel_structure.AddInstance(mesh);
+			auto [mesh, ray_tracing] = ray_tracing_view.get<Mesh, RayTracing>(entity);
+			accel_structure.AddInstance(mesh, ray_tracing);
 		}
 		accel_structure.Build();
 	}
+	void Renderer::UpdateAS()
+	{
+		auto ray_tracing_view = reg.view<Mesh, RayTracing>();
+		for (auto entity : ray_tracing_view)
+		{
+			auto [mesh, ray_tracing] = ray_tracing_view.get<Mesh, RayTracing>(entity);
+			accel_structure.UpdateInstances(mesh, ray_tracing);
+		}
+		accel_structure.Update();
+	}
 
 	void Renderer::UpdateSceneBuffers()
 	{
@@ -248,15 +279,20 @@ namespace adria
 		for (auto e : reg.view<Batch>()) reg.destroy(e);
 		reg.clear<Batch>();
 
-		std::vector<LightGPU> hlsl_lights{};
+		hlsl_lights.clear();
 		Uint32 light_index = 0;
 		Matrix light_transform = lighting_path == LightingPathType::PathTracing ? Matrix::Identity : camera->View();
-		for (auto light_entity : reg.view<Light>())
+		for (RenderSnapshotLight const& snapshot_light : snapshot->lights)
 		{
-			Light& light = reg.get<Light>(light_entity);
-			light.light_index = light_index;
+			//light indices and shadow indices are render state and stay in the registry, the rest comes from the snapshot.
+			//the snapshot was extracted a frame ago, skip lights that were removed since
+			Light* light_state = reg.try_get<Light>(snapshot_light.entity);
+			if (!light_state) continue;
+			light_state->light_index = light_index;
 			++light_index;
 
+			Light const& light = snapshot_light.light;
+
 			LightGPU& hlsl_light = hlsl_lights.emplace_back();
 			hlsl_light.color = light.color * light.intensity;
 			hlsl_light.position = Vector4::Transform(light.position, light_transform);
@@ -268,9 +304,9 @@ namespace adria
 			hlsl_light.volumetric = light.volumetric;
 			hlsl_light.volumetric_strength = light.volumetric_strength;
 			hlsl_light.active = light.active;
-			hlsl_light.shadow_matrix_index = light.casts_shadows ? light.shadow_matrix_index : -1;
-			hlsl_light.shadow_texture_index = light.casts_shadows ? light.shadow_texture_index : -1;
-			hlsl_light.shadow_mask_index = light.ray_traced_shadows ? light.shadow_mask_index : -1;
+			hlsl_light.shadow_matrix_index = light.casts_shadows ? light_state->shadow_matrix_index : -1;
+			hlsl_light.shadow_texture_index = light.casts_shadows ? light_state->shadow_texture_index : -1;
+			hlsl_light.shadow_mask_index = light.ray_traced_shadows ? light_state->shadow_mask_index : -1;
 			hlsl_light.use_cascades = light.use_cascades;
 			if (light.volumetric) ++volumetric_lights;
 		}
@@ -280,54 +316,51 @@ namespace adria
 		std::vector<MaterialGPU> materials;
 		Uint32 instanceID = 0;
 
+		//geometry is sub-allocated from a few buffer pages, their SRVs are copied once instead of once per mesh
+		Uint32 const geometry_page_count = g_GeometryBufferCache.GetPageCount();
+		GfxDescriptor geometry_pages_online_srv{};
+		if (geometry_page_count > 0)
+		{
+			geometry_pages_online_srv = gfx->AllocateDescriptorsGPU(geometry_page_count);
+			for (Uint32 i = 0; i < geometry_page_count; ++i)
+			{
+				gfx->CopyDescriptors(1, gfx->GetDescriptorGPU(geometry_pages_online_srv.GetIndex() + i), g_GeometryBufferCache.GetPageSRV(i));
+			}
+		}
+
+		struct MeshOffsets
+		{
+			Uint32 mesh_offset;
+			Uint32 material_offset;
+		};
+		std::unordered_map<entt::entity, MeshOffsets> mesh_offsets;
 		for (auto mesh_entity : reg.view<Mesh>())
 		{
 			Mesh& mesh = reg.get<Mesh>(mesh_entity);
 
 			GfxBuffer* mesh_buffer = g_GeometryBufferCache.GetGeometryBuffer(mesh.geometry_buffer_handle);
-			GfxDescriptor mesh_buffer_srv = g_GeometryBufferCache.GetGeometryBufferSRV(mesh.geometry_buffer_handle);
-			GfxDescriptor mesh_buffer_online_srv = gfx->AllocateDescriptorsGPU();
-			gfx->CopyDescriptors(1, mesh_buffer_online_srv, mesh_buffer_srv);
+			Uint32 const mesh_buffer_offset = (Uint32)g_GeometryBufferCache.GetGeometryBufferOffset(mesh.geometry_buffer_handle);
+			Uint32 const mesh_buffer_idx = geometry_pages_online_srv.GetIndex() + g_GeometryBufferCache.GetGeometryBufferPage(mesh.geometry_buffer_handle);
+			mesh_offsets[mesh_entity] = MeshOffsets{ .mesh_offset = (Uint32)meshes.size(), .material_offset = (Uint32)materials.size() };
 
-			for (auto const& instance : mesh.instances)
-			{
-				SubMeshGPU& submesh = mesh.submeshes[instance.submesh_index];
-				Material& material = mesh.materials[submesh.material_index];
-
-				submesh.buffer_address = mesh_buffer->GetGpuAddress();
-
-				entt::entity batch_entity = reg.create();
-				Batch& batch = reg.emplace<Batch>(batch_entity);
-				batch.instance_id = instanceID;
-				batch.alpha_mode = material.alpha_mode;
-				batch.submesh = &submesh;
-				batch.world_transform = instance.world_transform;
-				submesh.bounding_box.Transform(batch.bounding_box, batch.world_transform);
-
-				InstanceGPU& instance_hlsl = instances.emplace_back();
-				instance_hlsl.instance_id = instanceID;
-				instance_hlsl.material_idx = static_cast<Uint32>(materials.size() + submesh.material_index);
-				instance_hlsl.mesh_index = static_cast<Uint32>(meshes.size() + instance.submesh_index);
-				instance_hlsl.world_matrix = instance.world_transform;
-				instance_hlsl.inverse_world_matrix = XMMatrixInverse(nullptr, instance.world_transform);
-				instance_hlsl.bb_origin = submesh.bounding_box.Center;
-				instance_hlsl.bb_extents = submesh.bounding_box.Extents;
-
-				++instanceID;
-			}
-			for (auto const& submesh : mesh.submeshes)
+			for (auto& submesh : mesh.submeshes)
 			{
+				submesh.buffer_address = mesh_buffer->GetGpuAddress() + mesh_buffer_offset;
+
 				MeshGPU& mesh_hlsl = meshes.emplace_back();
-				mesh_hlsl.buffer_idx = mesh_buffer_online_srv.GetIndex();
-				mesh_hlsl.indices_offset = submesh.indices_offset;
-				mesh_hlsl.positions_offset = submesh.positions_offset;
-				mesh_hlsl.normals_offset = submesh.normals_offset;
-				mesh_hlsl.tangents_offset = submesh.tangents_offset;
-				mesh_hlsl.uvs_offset = submesh.uvs_offset;
-
-				mesh_hlsl.meshlet_offset = submesh.meshlet_offset;
-				mesh_hlsl.meshlet_vertices_offset = submesh.meshlet_vertices_offset;
-				mesh_hlsl.meshlet_triangles_offset = submesh.meshlet_triangles_offset;
+				mesh_hlsl.buffer_idx = mesh_buffer_idx;
+				mesh_hlsl.indices_offset = mesh_buffer_offset + submesh.indices_offset;
+				mesh_hlsl.positions_offset = mesh_buffer_offset + submesh.positions_offset;
+				mesh_hlsl.normals_offset = mesh_buffer_offset + submesh.normals_offset;
+				mesh_hlsl.tangents_offset = mesh_buffer_offset + submesh.tangents_offset;
+				mesh_hlsl.uvs_offset = mesh_buffer_offset + submesh.uvs_offset;
+				mesh_hlsl.vertex_flags = submesh.vertex_flags;
+				mesh_hlsl.position_bias = Vector3(submesh.bounding_box.Center) - Vector3(submesh.bounding_box.Extents);
+				mesh_hlsl.position_scale = Vector3(submesh.bounding_box.Extents) * 2.0f;
+
+				mesh_hlsl.meshlet_offset = mesh_buffer_offset + submesh.meshlet_offset;
+				mesh_hlsl.meshlet_vertices_offset = mesh_buffer_offset + submesh.meshlet_vertices_offset;
+				mesh_hlsl.meshlet_triangles_offset = mesh_buffer_offset + submesh.meshlet_triangles_offset;
 				mesh_hlsl.meshlet_count = submesh.meshlet_count;
 			}
 
@@ -346,6 +379,38 @@ namespace adria
 			}
 		}
 
+		//the instance list of the snapshot in mesh order, bounds, inverse transforms and frustum visibility come from the simulation stage
+		for (RenderSnapshotInstance const& instance : snapshot->instances)
+		{
+			auto mesh_offsets_it = mesh_offsets.find(instance.mesh);
+			if (mesh_offsets_it == mesh_offsets.end()) continue;
+			Mesh& mesh = reg.get<Mesh>(instance.mesh);
+			MeshOffsets const& offsets = mesh_offsets_it->second;
+			SubMeshGPU& submesh = mesh.submeshes[instance.submesh_index];
+			Material const& material = mesh.materials[submesh.material_index];
+
+			entt::entity batch_entity = reg.create();
+			Batch& batch = reg.emplace<Batch>(batch_entity);
+			batch.instance_id = instanceID;
+			batch.alpha_mode = material.alpha_mode;
+			batch.submesh = &submesh;
+			batch.material = &material;
+			batch.world_transform = instance.world_transform;
+			batch.bounding_box = instance.bounding_box;
+			batch.camera_visibility = instance.camera_visible;
+
+			InstanceGPU& instance_hlsl = instances.emplace_back();
+			instance_hlsl.instance_id = instanceID;
+			instance_hlsl.material_idx = offsets.material_offset + submesh.material_index;
+			instance_hlsl.mesh_index = offsets.mesh_offset + instance.submesh_index;
+			instance_hlsl.world_matrix = instance.world_transform;
+			instance_hlsl.inverse_world_matrix = instance.inverse_world_transform;
+			instance_hlsl.bb_origin = submesh.bounding_box.Center;
+			instance_hlsl.bb_extents = submesh.bounding_box.Extents;
+
+			++instanceID;
+		}
+
 		auto CopyBuffer = [&]<typename T>(std::vector<T> const& data, SceneBuffer& scene_buffer)
 		{
 			if (data.empty()) return;
@@ -417,17 +482,12 @@ namespace adria
 			frame_cbuf_data.accel_struct_idx = accel_structure.GetTLASIndex();
 		}
 
-		auto lights = reg.view<Light>();
-		for (auto light : lights)
+		if (snapshot->sun_light >= 0)
 		{
-			auto const& light_data = lights.get<Light>(light);
-			if (light_data.type == LightType::Directional && light_data.active)
-			{
-				frame_cbuf_data.sun_direction = -light_data.direction;
-				frame_cbuf_data.sun_color = light_data.color * light_data.intensity;
-				sun_direction = Vector3(light_data.direction);
-				break;
-			}
+			Light const& light_data = snapshot->lights[snapshot->sun_light].light;
+			frame_cbuf_data.sun_direction = -light_data.direction;
+			frame_cbuf_data.sun_color = light_data.color * light_data.intensity;
+			sun_direction = Vector3(light_data.direction);
 		}
 
 		frame_cbuf_data.ambient_color = Vector4(ambient_color[0], ambient_color[1], ambient_color[2], 1.0f);
@@ -438,16 +498,63 @@ namespace adria
 		frame_cbuf_data.prev_view = camera->View();
 		frame_cbuf_data.prev_projection = camera->Proj();
 	}
-	void Renderer::CameraFrustumCulling()
+	void Renderer::CameraCulling()
+	{
+		//frustum visibility was computed by the simulation stage in PrepareRenderSnapshot
+		auto batch_view = reg.view<Batch>();
+		if (OcclusionCulling.Get() && !gpu_driven_renderer.IsEnabled()) CameraOcclusionCulling();
+
+		for (auto e : batch_view)
+		{
+			Batch const& batch = batch_view.get<Batch>(e);
+			if (!batch.camera_visibility) continue;
+			g_TextureManager.MarkTextureUsed(batch.material->albedo_texture);
+			g_TextureManager.MarkTextureUsed(batch.material->normal_texture);
+			g_TextureManager.MarkTextureUsed(batch.material->metallic_roughness_texture);
+			g_TextureManager.MarkTextureUsed(batch.material->emissive_texture);
+		}
+	}
+	void Renderer::CameraOcclusionCulling()
 	{
-		BoundingFrustum camera_frustum = camera->Frustum();
+		struct OccluderCandidate
+		{
+			Batch const* batch;
+			Float screen_size;
+		};
+		std::vector<OccluderCandidate> occluder_candidates;
+
+		//the occluders that cover most of the screen are rasterized first, until the triangle budget is used up
+		Vector3 const camera_position = camera->Position();
 		auto batch_view = reg.view<Batch>();
-		auto light_view = reg.view<Light>();
+		for (auto e : batch_view)
+		{
+			Batch const& batch = batch_view.get<Batch>(e);
+			if (!batch.camera_visibility || !batch.submesh->occluder) continue;
+
+			Float const radius = Vector3(batch.bounding_box.Extents).Length();
+			Float const distance = std::max(Vector3::Distance(camera_position, batch.bounding_box.Center) - radius, camera->Near());
+			Float const screen_size = radius / distance;
+			if (screen_size > 0.1f) occluder_candidates.push_back(OccluderCandidate{ .batch = &batch, .screen_size = screen_size });
+		}
+		std::sort(occluder_candidates.begin(), occluder_candidates.end(), [](OccluderCandidate const& a, OccluderCandidate const& b) { return a.screen_size > b.screen_size; });
+
+		occlusion_culler.BeginFrame(camera->ViewProj(), camera->Near());
+		Uint32 remaining_triangles = (Uint32)std::max(OcclusionCullingTriangleBudget.Get(), 0);
+		for (OccluderCandidate const& candidate : occluder_candidates)
+		{
+			OccluderMesh const& occluder = *candidate.batch->submesh->occluder;
+			Uint32 const triangle_count = (Uint32)occluder.indices.size() / 3;
+			if (triangle_count > remaining_triangles) continue;
+			occlusion_culler.AddOccluder(occluder.positions.data(), occluder.indices.data(), (Uint32)occluder.indices.size(), candidate.batch->world_transform);
+			remaining_triangles -= triangle_count;
+		}
+		if (occlusion_culler.GetStats().occluder_count == 0) return;
+		occlusion_culler.RasterizeOccluders();
+
 		for (auto e : batch_view)
 		{
 			Batch& batch = batch_view.get<Batch>(e);
-			auto& aabb = batch.bounding_box;
-			batch.camera_visibility = camera_frustum.Intersects(aabb);
+			if (batch.camera_visibility) batch.camera_visibility = occlusion_culler.IsVisible(batch.bounding_box);
 		}
 	}
 
@@ -475,7 +582,7 @@ namespace adria
 			{
 			case LightingPathType::Deferred:			deferred_lighting_pass.AddPass(render_graph); break;
 			case LightingPathType::TiledDeferred:		tiled_deferred_lighting_pass.AddPass(render_graph); break;
-			case LightingPathType::ClusteredDeferred:	clustered_deferred_lighting_pass.AddPass(render_graph, true); break;
+			case LightingPathType::ClusteredDeferred:	clustered_deferred_lighting_pass.AddPass(render_graph, hlsl_lights, true); break;
 			}
 
 			if (volumetric_lights > 0)
@@ -507,13 +614,116 @@ namespace adria
 		postprocessor.AddTonemapPass(render_graph, RG_NAME(PT_Output));
 	}
 
+	void Renderer::UpdateDynamicResolution()
+	{
+		if (!DynamicResolution.Get() || !postprocessor.HasUpscaler())
+		{
+			dynamic_resolution.Reset();
+			postprocessor.SetDynamicResolutionScale(1.0f);
+			return;
+		}
+
+		DynamicResolutionSettings settings = dynamic_resolution.GetSettings();
+		settings.target_frame_time_ms = DynamicResolutionTargetFrameTime.Get();
+		settings.min_scale = DynamicResolutionMinScale.Get();
+		settings.max_scale = DynamicResolutionMaxScale.Get();
+		dynamic_resolution.SetSettings(settings);
+
+		//the profiler reports the latest frame whose timestamps reached the cpu
+		Float gpu_frame_time_ms = 0.0f;
+		for (GfxTimestamp const& timestamp : g_GfxProfiler.GetResults())
+		{
+			if (timestamp.name == "Frame") gpu_frame_time_ms = timestamp.time_in_ms;
+		}
+		dynamic_resolution.Update(gpu_frame_time_ms);
+		postprocessor.SetDynamicResolutionScale(dynamic_resolution.GetScale());
+	}
+
+	void Renderer::UpdateTextureResidency()
+	{
+		TextureResidencySettings settings{};
+		if (!TextureStreaming.Get())
+		{
+			//without a budget the trimmed textures stream back in once they are used
+			settings.budget = UINT64_MAX;
+		}
+		else if (TextureStreamingBudget.Get() > 0)
+		{
+			settings.budget = Uint64(TextureStreamingBudget.Get()) << 20;
+		}
+		else
+		{
+			//what the adapter budget leaves after everything that is not a managed texture
+			GPUMemoryUsage const memory_usage = gfx->GetMemoryUsage();
+			Uint64 const texture_bytes = g_TextureManager.GetResidencyStats().resident_bytes;
+			Uint64 const other_bytes = memory_usage.usage > texture_bytes ? memory_usage.usage - texture_bytes : 0;
+			Uint64 const available_bytes = Uint64(memory_usage.budget * 0.9);
+			settings.budget = available_bytes > other_bytes ? available_bytes - other_bytes : 0;
+		}
+		texture_budget = settings.budget;
+		g_TextureManager.UpdateResidency(settings);
+	}
+
 	void Renderer::GUI()
 	{
 		if (gpu_driven_renderer.IsSupported()) gpu_driven_renderer.GUI();
+		QueueGUI([&]()
+			{
+				if (ImGui::TreeNode("Dynamic Resolution"))
+				{
+					ImGui::Checkbox("Enable", DynamicResolution.GetPtr());
+					ImGui::SliderFloat("Target Frame Time (ms)", DynamicResolutionTargetFrameTime.GetPtr(), 4.0f, 50.0f, "%.2f");
+					ImGui::SliderFloat("Min Scale", DynamicResolutionMinScale.GetPtr(), 0.25f, 1.0f, "%.2f");
+					ImGui::SliderFloat("Max Scale", DynamicResolutionMaxScale.GetPtr(), 0.25f, 1.0f, "%.2f");
+					if (!postprocessor.HasUpscaler())
+					{
+						ImGui::Text("Dynamic resolution needs an upscaler");
+					}
+					else if (DynamicResolution.Get())
+					{
+						ImGui::Text("Scale: %.2f (%.3f)", dynamic_resolution.GetScale(), dynamic_resolution.GetUnquantizedScale());
+						ImGui::Text("Render Resolution: %ux%u", render_width, render_height);
+						ImGui::Text("GPU Frame Time: %.2f ms", dynamic_resolution.GetFilteredFrameTime());
+						ImGui::Text("Scale Changes: %u", dynamic_resolution.GetScaleChangeCount());
+					}
+					ImGui::TreePop();
+				}
+			}, GUICommandGroup_Renderer);
+		QueueGUI([&]()
+			{
+				if (ImGui::TreeNode("Texture Streaming"))
+				{
+					ImGui::Checkbox("Enable", TextureStreaming.GetPtr());
+					ImGui::InputInt("Budget (MB)", TextureStreamingBudget.GetPtr());
+					TextureResidencyStats const& stats = g_TextureManager.GetResidencyStats();
+					if (TextureStreaming.Get()) ImGui::Text("Budget: %.1f MB", texture_budget / (1024.0f * 1024.0f));
+					ImGui::Text("Resident: %.1f / %.1f MB", stats.resident_bytes / (1024.0f * 1024.0f), stats.full_resolution_bytes / (1024.0f * 1024.0f));
+					ImGui::Text("Trimmed Textures: %u (%u mips)", stats.trimmed_textures, stats.dropped_mips);
+					ImGui::TreePop();
+				}
+			}, GUICommandGroup_Renderer);
+		if (!gpu_driven_renderer.IsEnabled())
+		{
+			QueueGUI([&]()
+				{
+					if (ImGui::TreeNode("Software Occlusion Culling"))
+					{
+						ImGui::Checkbox("Enable", OcclusionCulling.GetPtr());
+						if (OcclusionCulling.Get())
+						{
+							SoftwareOcclusionCullerStats const& stats = occlusion_culler.GetStats();
+							ImGui::Text("Occluders: %u (%u triangles)", stats.occluder_count, stats.occluder_triangles);
+							ImGui::Text("Occluded batches: %u / %u", stats.occluded_boxes, stats.tested_boxes);
+						}
+						ImGui::TreePop();
+					}
+				}, GUICommandGroup_Renderer);
+		}
 		if (ddgi.IsSupported()) ddgi.GUI();
 		if (renderer_output == RendererOutput::Final)
 		{
 			if (lighting_path == LightingPathType::TiledDeferred) tiled_deferred_lighting_pass.GUI();
+			if (lighting_path == LightingPathType::ClusteredDeferred) clustered_deferred_lighting_pass.GUI();
 			switch (volumetric_path)
 			{
 			case VolumetricPathType::Raymarching2D: volumetric_lighting_pass.GUI(); break;
@@ -522,6 +732,7 @@ namespace adria
 			ocean_renderer.GUI();
 			sky_pass.GUI();
 			rain_pass.GUI();
+			shadow_renderer.GUI();
 			QueueGUI([&]()
 				{
 					if (ImGui::TreeNode("Sun Settings"))
@@ -611,51 +822,21 @@ namespace adria
 			}, RGPassType::Copy, RGPassFlags::ForceNoCull);
 	}
 
-	void Renderer::TakeScreenshot(RenderGraph& rg)
+	void Renderer::AddScreenCapturePasses(RenderGraph& rg)
 	{
-		ADRIA_ASSERT(take_screenshot);
-
-		std::string absolute_screenshot_path = paths::ScreenshotsDir + screenshot_name + ".png";
-		ADRIA_LOG(INFO, "Taking screenshot: %s.png...", screenshot_name.c_str());
-		if (!screenshot_buffer)
-		{	
-			GfxBufferDesc screenshot_desc{};
-			screenshot_desc.size = gfx->GetLinearBufferSize(final_texture.get()); 
-			screenshot_desc.resource_usage = GfxResourceUsage::Readback;
-			screenshot_buffer = gfx->CreateBuffer(screenshot_desc);
-		}
-		rg.ImportBuffer(RG_NAME(ScreenshotBuffer), screenshot_buffer.get());
+		GfxTextureDesc const& final_desc = final_texture->GetDesc();
+		ScreenCaptureSource ldr_source{ .name = RG_NAME(FinalTexture), .width = final_desc.width, .height = final_desc.height, .format = final_desc.format };
 
-		struct ScreenshotPassData
+		std::optional<ScreenCaptureSource> hdr_source;
+		if (lighting_path == LightingPathType::PathTracing)
 		{
-			RGBufferCopyDstId  dst;
-			RGTextureCopySrcId src;
-		};
-		rg.AddPass<ScreenshotPassData>("Screenshot Pass",
-			[=](ScreenshotPassData& data, RenderGraphBuilder& builder)
-			{
-				data.dst = builder.WriteCopyDstBuffer(RG_NAME(ScreenshotBuffer));
-				data.src = builder.ReadCopySrcTexture(RG_NAME(FinalTexture));
-			},
-			[=](ScreenshotPassData const& data, RenderGraphContext& ctx, GfxCommandList* cmd_list)
-			{
-				GfxTexture const& src_texture = ctx.GetCopySrcTexture(data.src);
-				GfxBuffer& dst_buffer = ctx.GetCopyDstBuffer(data.dst);
-				cmd_list->CopyTextureToBuffer(dst_buffer, 0, src_texture, 0, 0);
-				cmd_list->Signal(screenshot_fence, screenshot_fence_value);
-			}, RGPassType::Copy, RGPassFlags::ForceNoCull);
-
-		g_ThreadPool.Submit([this](std::string_view name) 
-			{
-			screenshot_fence.Wait(screenshot_fence_value);
-			WriteImageToFile(FileType::PNG, name.data(), display_width, display_height,
-							 screenshot_buffer->GetMappedData(), display_width * 4);
-			screenshot_buffer.reset();
-			ADRIA_LOG(INFO, "Screenshot %s.png saved to screenshots folder!", screenshot_name.c_str());
-			screenshot_fence_value++;
-			}, absolute_screenshot_path);
-
-		take_screenshot = false;
+			hdr_source = ScreenCaptureSource{ .name = RG_NAME(PT_Output), .width = display_width, .height = display_height, .format = GfxFormat::R16G16B16A16_FLOAT };
+		}
+		else if (renderer_output == RendererOutput::Final)
+		{
+			hdr_source = ScreenCaptureSource{ .name = RG_NAME(HDR_RenderTarget), .width = render_width, .height = render_height, .format = GfxFormat::R16G16B16A16_FLOAT };
+		}
+		screen_capture.AddCapturePasses(rg, ldr_source, hdr_source);
 	}
 
 }
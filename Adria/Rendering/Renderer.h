@@ -21,6 +21,9 @@
 #include "ShadowRenderer.h"
 #include "PathTracingPass.h"
 #include "RendererOutputPass.h"
+#include "ScreenCapture.h"
+#include "SoftwareOcclusionCuller.h"
+#include "DynamicResolutionController.h"
 #include "Graphics/GfxShaderCompiler.h"
 #include "Graphics/GfxConstantBuffer.h"
 #include "RenderGraph/RenderGraphResourcePool.h"
@@ -28,6 +31,7 @@
 namespace adria
 {
 	class Camera;
+	struct RenderSnapshot;
 	class GfxBuffer;
 	class GfxCommandList;
 	class GfxTexture;
@@ -55,7 +59,7 @@ namespace adria
 		Renderer(entt::registry& reg, GfxDevice* gfx, Uint32 width, Uint32 height);
 		~Renderer();
 
-		void NewFrame(Camera const* camera);
+		void NewFrame(RenderSnapshot const* snapshot);
 		void Update(Float dt);
 		void Render();
 
@@ -64,6 +68,7 @@ namespace adria
 		void OnSceneInitialized();
 		void OnRightMouseClicked(Sint32 x, Sint32 y);
 		void OnTakeScreenshot(Char const*);
+		void FlushScreenCaptures();
 		void OnLightChanged();
 
 		PickingData const& GetPickingData() const { return picking_data; }
@@ -83,6 +88,7 @@ namespace adria
 		GfxDevice* gfx;
 		RGResourcePool resource_pool;
 
+		RenderSnapshot const* snapshot;
 		Camera const* camera;
 		Vector2 camera_jitter;
 
@@ -114,6 +120,7 @@ namespace adria
 			GfxDescriptor				buffer_srv_gpu;
 		};
 		std::array<SceneBuffer, SceneBuffer_Count> scene_buffers;
+		std::vector<LightGPU> hlsl_lights;
 
 		//passes
 		GBufferPass  gbuffer_pass;
@@ -155,12 +162,17 @@ namespace adria
 		Float					 wind_speed = 10.0f;
 		Vector3					 sun_direction;
 
-		//screenshot
-		Bool						take_screenshot = false;
-		std::string					screenshot_name = "";
-		GfxFence					screenshot_fence;
-		Uint64						screenshot_fence_value = 1;
-		std::unique_ptr<GfxBuffer>  screenshot_buffer;
+		//screenshots and frame sequences
+		ScreenCapture			 screen_capture;
+
+		//cpu occlusion culling of the rasterized path
+		SoftwareOcclusionCuller  occlusion_culler;
+
+		//render resolution scale of the upscaler driven by the measured gpu frame time
+		DynamicResolutionController dynamic_resolution;
+
+		//textures of the visible batches keep their top mips when the textures do not fit into the budget
+		Uint64					 texture_budget = 0;
 
 		//volumetric
 		Uint32			         volumetric_lights = 0;
@@ -171,16 +183,20 @@ namespace adria
 	private:
 		void CreateSizeDependentResources();
 		void CreateAS();
+		void UpdateAS();
 
 		void GUI();
 		void UpdateSceneBuffers();
 		void UpdateFrameConstants(Float dt);
-		void CameraFrustumCulling();
+		void CameraCulling();
+		void CameraOcclusionCulling();
+		void UpdateDynamicResolution();
+		void UpdateTextureResidency();
 
 		void Render_Deferred(RenderGraph& rg);
 		void Render_PathTracing(RenderGraph& rg);
 
 		void CopyToBackbuffer(RenderGraph& rg);
-		void TakeScreenshot(RenderGraph& rg);
+		void AddScreenCapturePasses(RenderGraph& rg);
 	};
 }
\ No newline at end of file
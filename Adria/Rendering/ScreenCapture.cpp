@@ -0,0 +1,266 @@
+#include "ScreenCapture.h"
+#include <algorithm>
+#include <filesystem>
+#include "Graphics/GfxDevice.h"
+#include "Graphics/GfxBuffer.h"
+#include "Graphics/GfxTexture.h"
+#include "Graphics/GfxCommandList.h"
+#include "RenderGraph/RenderGraph.h"
+#include "Utilities/ImageEncoders.h"
+#include "Utilities/ThreadPool.h"
+#include "Utilities/AllocatorUtil.h"
+#include "Core/Paths.h"
+#include "Core/ConsoleManager.h"
+#include "Logging/Logger.h"
+
+namespace adria
+{
+	static TAutoConsoleVariable<int>  CaptureFormat("r.Capture.Format", 0, "0 - PNG, 1 - QOI, 2 - PFM (HDR)");
+	static TAutoConsoleVariable<Bool> CaptureSequence("r.Capture.Sequence", false, "0 - Disabled, 1 - Capture every frame to a new folder in the screenshots directory");
+
+	namespace
+	{
+		ScreenCaptureFormat GetCaptureFormat()
+		{
+			return static_cast<ScreenCaptureFormat>(std::clamp(CaptureFormat.Get(), 0, 2));
+		}
+
+		Char const* GetCaptureFileExtension(ScreenCaptureFormat format)
+		{
+			switch (format)
+			{
+			case ScreenCaptureFormat::PNG: return ".png";
+			case ScreenCaptureFormat::QOI: return ".qoi";
+			case ScreenCaptureFormat::PFM: return ".pfm";
+			}
+			return "";
+		}
+
+		std::optional<ImagePixelFormat> GetImagePixelFormat(GfxFormat format)
+		{
+			switch (format)
+			{
+			case GfxFormat::R8G8B8A8_UNORM:
+			case GfxFormat::R8G8B8A8_UNORM_SRGB:
+				return ImagePixelFormat::RGBA8;
+			case GfxFormat::R16G16B16A16_FLOAT:
+				return ImagePixelFormat::RGBA16F;
+			case GfxFormat::R32G32B32A32_FLOAT:
+				return ImagePixelFormat::RGBA32F;
+			}
+			return std::nullopt;
+		}
+
+		void EncodeCapture(ImageView const& image, std::string const& file_path, ScreenCaptureFormat format, Bool log)
+		{
+			std::vector<Uint8> encoded_image;
+			Bool encoded = false;
+			switch (format)
+			{
+			case ScreenCaptureFormat::PNG: encoded = EncodePNG(image, encoded_image); break;
+			case ScreenCaptureFormat::QOI: encoded = EncodeQOI(image, encoded_image); break;
+			case ScreenCaptureFormat::PFM: encoded = EncodePFM(image, encoded_image); break;
+			}
+			if (!encoded)
+			{
+				ADRIA_LOG(WARNING, "Captured texture format is not supported by the capture format, %s is not saved!", file_path.c_str());
+				return;
+			}
+
+			std::ofstream file(file_path, std::ios::binary);
+			if (!file)
+			{
+				ADRIA_LOG(ERROR, "Cannot open %s for writing!", file_path.c_str());
+				return;
+			}
+			file.write(reinterpret_cast<Char const*>(encoded_image.data()), encoded_image.size());
+			if (log) ADRIA_LOG(INFO, "Screenshot saved to %s", file_path.c_str());
+		}
+	}
+
+	ScreenCapture::ScreenCapture(GfxDevice* gfx) : gfx(gfx)
+	{
+		fence.Create(gfx, "Screen Capture Fence");
+	}
+
+	ScreenCapture::~ScreenCapture()
+	{
+		Flush();
+	}
+
+	void ScreenCapture::RequestScreenshot(std::string const& name)
+	{
+		ScreenCaptureFormat const format = GetCaptureFormat();
+		std::error_code error;
+		std::filesystem::create_directories(paths::ScreenshotsDir, error);
+		screenshot_request = CaptureRequest{ .file_path = paths::ScreenshotsDir + name + GetCaptureFileExtension(format), .format = format, .log = true };
+		ADRIA_LOG(INFO, "Taking screenshot: %s...", screenshot_request->file_path.c_str());
+	}
+
+	void ScreenCapture::BeginSequence()
+	{
+		if (sequence_active) return;
+
+		Uint32 sequence_index = 0;
+		do
+		{
+			sequence_directory = paths::ScreenshotsDir + "Sequence" + std::to_string(sequence_index++) + "/";
+		} while (std::filesystem::exists(sequence_directory));
+
+		std::error_code error;
+		std::filesystem::create_directories(sequence_directory, error);
+		if (error)
+		{
+			ADRIA_LOG(ERROR, "Cannot create frame sequence directory %s!", sequence_directory.c_str());
+			CaptureSequence->Set(false);
+			return;
+		}
+
+		sequence_active = true;
+		sequence_format = GetCaptureFormat();
+		sequence_frame = 0;
+		sequence_dropped_frames = 0;
+		CaptureSequence->Set(true);
+		ADRIA_LOG(INFO, "Frame sequence capture started, frames are saved to %s", sequence_directory.c_str());
+	}
+
+	void ScreenCapture::EndSequence()
+	{
+		if (!sequence_active) return;
+
+		sequence_active = false;
+		CaptureSequence->Set(false);
+		ADRIA_LOG(INFO, "Frame sequence capture ended: %u frames captured, %u frames dropped because all readback buffers were busy",
+			sequence_frame - sequence_dropped_frames, sequence_dropped_frames);
+	}
+
+	void ScreenCapture::Update()
+	{
+		if (CaptureSequence.Get() != sequence_active)
+		{
+			if (CaptureSequence.Get()) BeginSequence();
+			else EndSequence();
+		}
+
+		for (CaptureSlot& slot : slots)
+		{
+			if (!slot.copy_pending || !fence.IsCompleted(slot.fence_value)) continue;
+
+			slot.copy_pending = false;
+			slot.encode_task = g_ThreadPool.Submit([image = GetSlotImage(slot), request = slot.request]()
+				{
+					EncodeCapture(image, request.file_path, request.format, request.log);
+				});
+		}
+	}
+
+	void ScreenCapture::AddCapturePasses(RenderGraph& rg, ScreenCaptureSource const& ldr_source, std::optional<ScreenCaptureSource> const& hdr_source)
+	{
+		auto GetSource = [&](ScreenCaptureFormat format) -> ScreenCaptureSource const&
+			{
+				return format == ScreenCaptureFormat::PFM && hdr_source.has_value() ? *hdr_source : ldr_source;
+			};
+
+		if (screenshot_request.has_value())
+		{
+			//if every slot is busy the screenshot is taken in one of the next frames
+			if (CaptureSlot* slot = FindFreeSlot())
+			{
+				ScreenCaptureSource const& source = GetSource(screenshot_request->format);
+				AddCapturePass(rg, *slot, source, std::move(*screenshot_request));
+				screenshot_request.reset();
+			}
+		}
+
+		if (sequence_active)
+		{
+			Char frame_name[32];
+			snprintf(frame_name, sizeof(frame_name), "Frame%06u", sequence_frame++);
+			CaptureRequest request{ .file_path = sequence_directory + frame_name + GetCaptureFileExtension(sequence_format), .format = sequence_format, .log = false };
+			//a sequence never stalls rendering, frames that find no free slot are dropped
+			if (CaptureSlot* slot = FindFreeSlot()) AddCapturePass(rg, *slot, GetSource(sequence_format), std::move(request));
+			else ++sequence_dropped_frames;
+		}
+	}
+
+	void ScreenCapture::Flush()
+	{
+		for (CaptureSlot& slot : slots)
+		{
+			if (slot.copy_pending)
+			{
+				fence.Wait(slot.fence_value);
+				slot.copy_pending = false;
+				EncodeCapture(GetSlotImage(slot), slot.request.file_path, slot.request.format, slot.request.log);
+			}
+			if (slot.encode_task.valid()) slot.encode_task.get();
+		}
+	}
+
+	ScreenCapture::CaptureSlot* ScreenCapture::FindFreeSlot()
+	{
+		for (CaptureSlot& slot : slots)
+		{
+			if (slot.copy_pending) continue;
+			if (slot.encode_task.valid())
+			{
+				if (slot.encode_task.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+				slot.encode_task.get();
+			}
+			return &slot;
+		}
+		return nullptr;
+	}
+
+	void ScreenCapture::AddCapturePass(RenderGraph& rg, CaptureSlot& slot, ScreenCaptureSource const& source, CaptureRequest&& request)
+	{
+		std::optional<ImagePixelFormat> pixel_format = GetImagePixelFormat(source.format);
+		if (!pixel_format.has_value())
+		{
+			ADRIA_LOG(WARNING, "Captured texture format is not supported, %s is not saved!", request.file_path.c_str());
+			return;
+		}
+
+		Uint64 const row_pitch = AlignToPowerOfTwo(GetRowPitch(source.format, source.width), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+		Uint64 const buffer_size = row_pitch * source.height;
+		if (!slot.readback_buffer || slot.readback_buffer->GetSize() < buffer_size)
+		{
+			GfxBufferDesc readback_desc{};
+			readback_desc.size = buffer_size;
+			readback_desc.resource_usage = GfxResourceUsage::Readback;
+			slot.readback_buffer = gfx->CreateBuffer(readback_desc);
+		}
+		slot.request = std::move(request);
+		slot.image = ImageView{ .data = nullptr, .width = source.width, .height = source.height, .row_pitch = row_pitch, .format = *pixel_format };
+		slot.fence_value = ++fence_value;
+		slot.copy_pending = true;
+
+		struct ScreenCapturePassData
+		{
+			RGTextureCopySrcId src;
+		};
+
+		//readback buffers never leave the copy destination state so they are not imported into the render graph
+		GfxBuffer* readback_buffer = slot.readback_buffer.get();
+		Uint64 const capture_fence_value = slot.fence_value;
+		rg.AddPass<ScreenCapturePassData>("Screen Capture Pass",
+			[=](ScreenCapturePassData& data, RenderGraphBuilder& builder)
+			{
+				data.src = builder.ReadCopySrcTexture(source.name);
+			},
+			[=](ScreenCapturePassData const& data, RenderGraphContext& ctx, GfxCommandList* cmd_list)
+			{
+				GfxTexture const& src_texture = ctx.GetCopySrcTexture(data.src);
+				ADRIA_ASSERT(src_texture.GetDesc().width == source.width && src_texture.GetDesc().height == source.height);
+				cmd_list->CopyTextureToBuffer(*readback_buffer, 0, src_texture, 0, 0);
+				cmd_list->Signal(fence, capture_fence_value);
+			}, RGPassType::Copy, RGPassFlags::ForceNoCull);
+	}
+
+	ImageView ScreenCapture::GetSlotImage(CaptureSlot const& slot) const
+	{
+		ImageView image = slot.image;
+		image.data = slot.readback_buffer->GetMappedData();
+		return image;
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <future>
+#include <optional>
+#include "Graphics/GfxFence.h"
+#include "Graphics/GfxFormat.h"
+#include "RenderGraph/RenderGraphResourceName.h"
+#include "Utilities/ImageEncoders.h"
+
+namespace adria
+{
+	class GfxDevice;
+	class GfxBuffer;
+	class RenderGraph;
+
+	enum class ScreenCaptureFormat : Uint8
+	{
+		PNG,
+		QOI,
+		PFM
+	};
+
+	struct ScreenCaptureSource
+	{
+		RGResourceName name;
+		Uint32 width;
+		Uint32 height;
+		GfxFormat format;
+	};
+
+	//screenshots and frame sequences. captured textures are copied into a ring of readback buffers,
+	//the copies are tracked with a fence that is only polled and the encoding is done on the thread pool,
+	//so neither the render thread nor the workers wait for the gpu
+	class ScreenCapture
+	{
+		static constexpr Uint32 RING_SIZE = 4;
+
+		struct CaptureRequest
+		{
+			std::string file_path;
+			ScreenCaptureFormat format;
+			Bool log;
+		};
+
+		struct CaptureSlot
+		{
+			std::unique_ptr<GfxBuffer> readback_buffer;
+			Uint64 fence_value = 0;
+			Bool copy_pending = false;
+			CaptureRequest request;
+			ImageView image;
+			std::future<void> encode_task;
+		};
+
+	public:
+		explicit ScreenCapture(GfxDevice* gfx);
+		ADRIA_NONCOPYABLE_NONMOVABLE(ScreenCapture)
+		~ScreenCapture();
+
+		void RequestScreenshot(std::string const& name);
+		void BeginSequence();
+		void EndSequence();
+		Bool IsSequenceActive() const { return sequence_active; }
+
+		//starts the encoding of finished copies, call once per frame before adding the capture passes
+		void Update();
+		//hdr_source is used for PFM captures, the other formats and PFM without a hdr source use ldr_source
+		void AddCapturePasses(RenderGraph& rg, ScreenCaptureSource const& ldr_source, std::optional<ScreenCaptureSource> const& hdr_source);
+		//waits for all pending copies and encodings, has to be called before the thread pool is destroyed
+		void Flush();
+
+	private:
+		GfxDevice* gfx;
+		GfxFence fence;
+		Uint64 fence_value = 0;
+		CaptureSlot slots[RING_SIZE];
+
+		std::optional<CaptureRequest> screenshot_request;
+		Bool sequence_active = false;
+		ScreenCaptureFormat sequence_format = ScreenCaptureFormat::PNG;
+		std::string sequence_directory;
+		Uint32 sequence_frame = 0;
+		Uint32 sequence_dropped_frames = 0;
+
+	private:
+		CaptureSlot* FindFreeSlot();
+		void AddCapturePass(RenderGraph& rg, CaptureSlot& slot, ScreenCaptureSource const& source, CaptureRequest&& request);
+		ImageView GetSlotImage(CaptureSlot const& slot) const;
+	};
+}
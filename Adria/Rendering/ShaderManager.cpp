@@ -8,6 +8,7 @@
 #include "Logging/Logger.h"
 #include "Utilities/Timer.h"
 #include "Utilities/FileWatcher.h"
+#include "Utilities/StringUtil.h"
 
 namespace fs = std::filesystem;
 
@@ -20,6 +21,10 @@ namespace adria
 		LibraryRecompiledEvent library_recompiled_event;
 		std::unordered_map<GfxShaderKey, GfxShader, GfxShaderKeyHash> shader_map;
 		std::unordered_map<GfxShaderKey, std::vector<fs::path>, GfxShaderKeyHash> dependent_files_map;
+		//reverse include index: normalized file path -> shaders that include it (or are compiled from it)
+		std::unordered_map<std::string, std::unordered_set<GfxShaderKey, GfxShaderKeyHash>> file_dependents_map;
+		//shaders waiting for recompilation, the value tells if the shader cache has to be bypassed
+		std::unordered_map<GfxShaderKey, Bool, GfxShaderKeyHash> pending_shaders;
 
 		constexpr GfxShaderStage GetShaderStage(ShaderID shader)
 		{
@@ -538,10 +543,15 @@ namespace adria
 			return SM_6_7;
 		}
 
-		void CompileShader(GfxShaderKey const& shader, Bool bypass_cache = false)
+		std::string GetDependencyKey(fs::path const& file)
 		{
-			if (!shader.IsValid()) return;
+			std::error_code ec;
+			fs::path canonical_path = fs::weakly_canonical(file, ec);
+			return ToLower(ec ? file.generic_string() : canonical_path.generic_string());
+		}
 
+		GfxShaderDesc GetShaderDesc(GfxShaderKey const& shader)
+		{
 			GfxShaderDesc shader_desc{};
 			shader_desc.entry_point = GetEntryPoint(shader);
 			shader_desc.stage = GetShaderStage(shader);
@@ -553,28 +563,96 @@ namespace adria
 			shader_desc.flags = ShaderCompilerFlag_None;
 #endif
 			shader_desc.defines = shader.GetDefines();
+			return shader_desc;
+		}
+
+		void UpdateDependencies(GfxShaderKey const& shader, std::vector<std::string> const& includes)
+		{
+			std::vector<fs::path>& dependent_files = dependent_files_map[shader];
+			for (fs::path const& file : dependent_files)
+			{
+				auto it = file_dependents_map.find(GetDependencyKey(file));
+				if (it == file_dependents_map.end()) continue;
+				it->second.erase(shader);
+				if (it->second.empty()) file_dependents_map.erase(it);
+			}
+
+			dependent_files.clear();
+			for (auto const& include : includes)
+			{
+				dependent_files.push_back(fs::path(include));
+				file_dependents_map[GetDependencyKey(dependent_files.back())].insert(shader);
+			}
+		}
+
+		void CommitShader(GfxShaderKey const& shader, GfxShaderStage stage, GfxShaderCompileOutput& output)
+		{
+			shader_map[shader] = std::move(output.shader);
+			UpdateDependencies(shader, output.includes);
+			stage == GfxShaderStage::LIB ? library_recompiled_event.Broadcast(shader) : shader_recompiled_event.Broadcast(shader);
+		}
+
+		void CompileShader(GfxShaderKey const& shader, Bool bypass_cache = false)
+		{
+			if (!shader.IsValid()) return;
 
+			GfxShaderDesc shader_desc = GetShaderDesc(shader);
 			GfxShaderCompileOutput output;
 			Bool compile_result = GfxShaderCompiler::CompileShader(shader_desc, output, bypass_cache);
 			ADRIA_ASSERT(compile_result);
 			if (!compile_result) return;
 
-			shader_map[shader] = std::move(output.shader);
-
-			dependent_files_map[shader].clear();
-			for (auto const& include : output.includes) dependent_files_map[shader].push_back(fs::path(include));
-			shader_desc.stage == GfxShaderStage::LIB ? library_recompiled_event.Broadcast(shader) : shader_recompiled_event.Broadcast(shader);
+			CommitShader(shader, shader_desc.stage, output);
 		}
+
+		//only records the affected shaders, they are recompiled together in CheckIfShadersHaveChanged
 		void OnShaderFileChanged(std::string const& filename)
 		{
-			for (auto const& [shader, files] : dependent_files_map)
+			auto it = file_dependents_map.find(GetDependencyKey(fs::path(filename)));
+			if (it == file_dependents_map.end()) return;
+
+			std::string const changed_file = it->first;
+			for (GfxShaderKey const& shader : it->second)
 			{
-				for (Uint64 i = 0; i < files.size(); ++i)
+				//the cache is validated against the main source file only, changes in included files have to bypass it
+				std::vector<fs::path> const& files = dependent_files_map[shader];
+				Bool const is_main_file = !files.empty() && GetDependencyKey(files.back()) == changed_file;
+				pending_shaders[shader] |= !is_main_file;
+			}
+		}
+
+		void RecompilePendingShaders()
+		{
+			if (pending_shaders.empty()) return;
+
+			struct ShaderRecompileJob
+			{
+				GfxShaderKey shader;
+				Bool bypass_cache;
+				GfxShaderDesc shader_desc;
+				GfxShaderCompileOutput output;
+				Bool compile_result = false;
+			};
+			std::vector<ShaderRecompileJob> jobs;
+			jobs.reserve(pending_shaders.size());
+			for (auto const& [shader, bypass_cache] : pending_shaders)
+			{
+				if (shader.IsValid()) jobs.push_back(ShaderRecompileJob{ .shader = shader, .bypass_cache = bypass_cache, .shader_desc = GetShaderDesc(shader) });
+			}
+			pending_shaders.clear();
+
+			Timer<> timer;
+			std::for_each(std::execution::par, jobs.begin(), jobs.end(), [](ShaderRecompileJob& job)
 				{
-					fs::path const& file = files[i];
-					if (fs::equivalent(file, fs::path(filename))) CompileShader(shader, i != 0);
-				}
+					job.compile_result = GfxShaderCompiler::CompileShader(job.shader_desc, job.output, job.bypass_cache);
+				});
+
+			//shader map updates and events stay on the calling thread, listeners recreate pipeline states
+			for (ShaderRecompileJob& job : jobs)
+			{
+				if (job.compile_result) CommitShader(job.shader, job.shader_desc.stage, job.output);
 			}
+			ADRIA_LOG(INFO, "Recompiled %llu shaders in %f s", jobs.size(), timer.ElapsedInSeconds());
 		}
 	}
 
@@ -590,10 +668,17 @@ namespace adria
 		file_watcher = nullptr;
 		shader_map.clear();
 		dependent_files_map.clear();
+		file_dependents_map.clear();
+		pending_shaders.clear();
 	}
 	void ShaderManager::CheckIfShadersHaveChanged()
 	{
 		file_watcher->CheckWatchedFiles();
+		RecompilePendingShaders();
+	}
+	Bool ShaderManager::HasPendingChanges()
+	{
+		return file_watcher && file_watcher->HasPendingChanges();
 	}
 
 	GfxShader const& ShaderManager::GetGfxShader(GfxShaderKey const& shader_key)
@@ -126,6 +126,7 @@ namespace adria
 		static void Initialize();
 		static void Destroy();
 		static void CheckIfShadersHaveChanged();
+		static Bool HasPendingChanges();
 
 		static ShaderRecompiledEvent& GetShaderRecompiledEvent();
 		static LibraryRecompiledEvent& GetLibraryRecompiledEvent();
@@ -63,6 +63,8 @@ namespace adria
 		Sint32  rain_splash_bump_idx;
 		Sint32  rain_blocker_map_idx;
 		Float  rain_total_time;
+
+		Sint32  shadow_atlas_rects_idx;
 	};
 
 	struct LightGPU
@@ -98,6 +100,9 @@ namespace adria
 		Uint32 meshlet_vertices_offset;
 		Uint32 meshlet_triangles_offset;
 		Uint32 meshlet_count;
+		Uint32 vertex_flags;
+		Vector3 position_bias;
+		Vector3 position_scale;
 	};
 
 	struct MaterialGPU
@@ -0,0 +1,101 @@
+#include "ShadowAtlas.h"
+
+namespace adria
+{
+	ShadowAtlas::ShadowAtlas(Uint32 atlas_size, Uint32 min_tile_size) : allocator(atlas_size, min_tile_size)
+	{
+	}
+
+	void ShadowAtlas::BeginFrame()
+	{
+		++frame;
+		used_tile_count = 0;
+		evictions = 0;
+		downgrades = 0;
+		failed_requests = 0;
+	}
+
+	AtlasTile ShadowAtlas::RequestTile(Uint64 light_id, Uint32 view_index, Uint32 tile_size)
+	{
+		ADRIA_ASSERT(view_index < 256);
+		Uint64 const key = TileKey(light_id, view_index);
+		if (auto it = tiles.find(key); it != tiles.end())
+		{
+			CachedTile& cached_tile = it->second;
+			//a downgraded tile is kept until there is space for the requested size again
+			Bool const can_upgrade = cached_tile.tile.size < tile_size && allocator.GetLargestFreeTileSize() >= tile_size;
+			if (cached_tile.requested_size == tile_size && !can_upgrade)
+			{
+				cached_tile.last_used_frame = frame;
+				++used_tile_count;
+				return cached_tile.tile;
+			}
+			allocator.Free(cached_tile.tile);
+			tiles.erase(it);
+		}
+
+		Uint32 size = tile_size;
+		AtlasTile tile = allocator.Allocate(size);
+		while (!tile.IsValid())
+		{
+			if (EvictLeastRecentlyUsed())
+			{
+				++evictions;
+			}
+			else if (size > allocator.GetMinTileSize())
+			{
+				size /= 2;
+				++downgrades;
+			}
+			else
+			{
+				++failed_requests;
+				return AtlasTile{};
+			}
+			tile = allocator.Allocate(size);
+		}
+
+		tiles[key] = CachedTile{ .tile = tile, .requested_size = tile_size, .last_used_frame = frame };
+		++used_tile_count;
+		return tile;
+	}
+
+	Uint32 ShadowAtlas::GetCachedTileSize(Uint64 light_id, Uint32 view_index) const
+	{
+		auto it = tiles.find(TileKey(light_id, view_index));
+		return it != tiles.end() ? it->second.requested_size : 0;
+	}
+
+	void ShadowAtlas::Reset(Uint32 atlas_size)
+	{
+		allocator = AtlasAllocator(atlas_size, allocator.GetMinTileSize());
+		tiles.clear();
+	}
+
+	ShadowAtlasStats ShadowAtlas::GetStats() const
+	{
+		ShadowAtlasStats stats{};
+		stats.allocator = allocator.GetStats();
+		stats.cached_tile_count = (Uint32)tiles.size();
+		stats.used_tile_count = used_tile_count;
+		stats.evictions = evictions;
+		stats.downgrades = downgrades;
+		stats.failed_requests = failed_requests;
+		return stats;
+	}
+
+	Bool ShadowAtlas::EvictLeastRecentlyUsed()
+	{
+		auto lru_it = tiles.end();
+		for (auto it = tiles.begin(); it != tiles.end(); ++it)
+		{
+			if (it->second.last_used_frame == frame) continue;
+			if (lru_it == tiles.end() || it->second.last_used_frame < lru_it->second.last_used_frame) lru_it = it;
+		}
+		if (lru_it == tiles.end()) return false;
+
+		allocator.Free(lru_it->second.tile);
+		tiles.erase(lru_it);
+		return true;
+	}
+}
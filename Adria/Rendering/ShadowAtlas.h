@@ -0,0 +1,56 @@
+#pragma once
+#include <unordered_map>
+#include "Utilities/AtlasAllocator.h"
+
+namespace adria
+{
+	struct ShadowAtlasStats
+	{
+		AtlasAllocatorStats allocator;
+		Uint32 cached_tile_count = 0;
+		Uint32 used_tile_count = 0;
+		Uint32 evictions = 0;
+		Uint32 downgrades = 0;
+		Uint32 failed_requests = 0;
+	};
+
+	//persistent shadow tiles of light views packed into one atlas.
+	//a view keeps its tile across frames while the requested size does not change, tiles of views that were not
+	//requested in the current frame stay cached until the space is needed and are then evicted in LRU order
+	class ShadowAtlas
+	{
+	public:
+		ShadowAtlas(Uint32 atlas_size, Uint32 min_tile_size);
+
+		void BeginFrame();
+		//tile of the view_index-th view of a light, if the atlas is full the tile can be smaller than requested or invalid.
+		//request the most important views first, they get the space before the others get downgraded
+		AtlasTile RequestTile(Uint64 light_id, Uint32 view_index, Uint32 tile_size);
+		//tile size the view had in the previous frames, 0 if it has no tile
+		Uint32 GetCachedTileSize(Uint64 light_id, Uint32 view_index) const;
+		void Reset(Uint32 atlas_size);
+
+		Uint32 GetAtlasSize() const { return allocator.GetAtlasSize(); }
+		ShadowAtlasStats GetStats() const;
+
+	private:
+		struct CachedTile
+		{
+			AtlasTile tile;
+			Uint32 requested_size;
+			Uint64 last_used_frame;
+		};
+
+		AtlasAllocator allocator;
+		std::unordered_map<Uint64, CachedTile> tiles;
+		Uint64 frame = 0;
+		Uint32 used_tile_count = 0;
+		Uint32 evictions = 0;
+		Uint32 downgrades = 0;
+		Uint32 failed_requests = 0;
+
+	private:
+		static Uint64 TileKey(Uint64 light_id, Uint32 view_index) { return (light_id << 8) | view_index; }
+		Bool EvictLeastRecentlyUsed();
+	};
+}
@@ -1,3 +1,4 @@
+#include <bit>
 #include "ShadowRenderer.h"
 #include "Components.h"
 #include "Camera.h"
@@ -11,13 +12,38 @@
 #include "Graphics/GfxReflection.h"
 #include "Graphics/GfxPipelineStatePermutations.h"
 #include "RenderGraph/RenderGraph.h"
+#include "Editor/GUICommand.h"
+#include "Core/ConsoleManager.h"
 
 using namespace DirectX;
 
 namespace adria
 {
+	static TAutoConsoleVariable<int> ShadowAtlasSize("r.Shadows.AtlasSize", 4096, "Size of the shadow atlas that all shadow maps are packed into, rounded to a power of two");
+
 	namespace
 	{
+		Uint32 GetShadowAtlasSize()
+		{
+			return std::bit_ceil((Uint32)std::clamp(ShadowAtlasSize.Get(), 1024, 16384));
+		}
+
+		//tile size of a point or spot light view from the fraction of the screen the light volume covers, weighted by the importance of the light.
+		//a view keeps its cached size until the coverage changes enough, otherwise it would move between tiles every frame
+		Uint32 ShadowTileSize(Light const& light, Camera const& camera, Uint32 max_tile_size, Uint32 cached_tile_size)
+		{
+			if (light.type == LightType::Directional) return max_tile_size;
+
+			Float const distance = Vector3::Distance(Vector3(light.position), camera.Position());
+			Float coverage = 1.0f;
+			if (distance > light.range)
+			{
+				coverage = std::min(light.range / (distance * std::tan(camera.Fov() * 0.5f)), 1.0f);
+			}
+			Float const tile_size = std::clamp(coverage * light.shadow_importance, 0.0f, 1.0f) * max_tile_size;
+			if (cached_tile_size != 0 && tile_size <= cached_tile_size && tile_size > 0.375f * cached_tile_size) return cached_tile_size;
+			return std::bit_ceil(std::clamp((Uint32)tile_size, 1u, max_tile_size));
+		}
 
 		std::pair<Matrix, Matrix> LightViewProjection_Directional(Light const& light, Camera const& camera, Uint32 shadow_size)
 		{
@@ -186,9 +212,10 @@ namespace adria
 	}
 
 	ShadowRenderer::ShadowRenderer(entt::registry& reg, GfxDevice* gfx, Uint32 width, Uint32 height) : reg(reg), gfx(gfx), width(width), height(height),
-		ray_traced_shadows_pass(gfx, width, height) 
+		ray_traced_shadows_pass(gfx, width, height), shadow_atlas(GetShadowAtlasSize(), SHADOW_ATLAS_MIN_TILE_SIZE)
 	{
 		CreatePSOs();
+		CreateShadowAtlas(shadow_atlas.GetAtlasSize());
 	}
 	ShadowRenderer::~ShadowRenderer() {}
 
@@ -196,7 +223,29 @@ namespace adria
 	{
 		frame_cbuffer.lights_matrices_idx = light_matrices_gpu_index;
 		frame_cbuffer.cascade_splits = Vector4(split_distances[0], split_distances[1], split_distances[2], split_distances[3]);
+		frame_cbuffer.shadow_atlas_rects_idx = shadow_atlas_rects_gpu_index;
+	}
+
+	void ShadowRenderer::GUI()
+	{
+		QueueGUI([&]()
+			{
+				if (ImGui::TreeNode("Shadow Atlas"))
+				{
+					ShadowAtlasStats stats = shadow_atlas.GetStats();
+					ImGui::Text("Atlas Size: %u", shadow_atlas.GetAtlasSize());
+					ImGui::Text("Used Tiles: %u", stats.used_tile_count);
+					ImGui::Text("Cached Tiles: %u", stats.cached_tile_count);
+					ImGui::Text("Allocated: %.1f%%", 100.0 * stats.allocator.allocated_area / stats.allocator.total_area);
+					ImGui::Text("Largest Free Tile: %u", stats.allocator.largest_free_tile);
+					ImGui::Text("Fragmentation: %.2f", stats.allocator.fragmentation);
+					ImGui::Text("Evictions: %u, Downgrades: %u, Failed: %u", stats.evictions, stats.downgrades, stats.failed_requests);
+					ImGui::TreePop();
+					ImGui::Separator();
+				}
+			}, GUICommandGroup_Renderer);
 	}
+
 	void ShadowRenderer::SetupShadows(Camera const* camera)
 	{
 		static constexpr Uint32 backbuffer_count = GFX_BACKBUFFER_COUNT;
@@ -224,74 +273,14 @@ namespace adria
 			gfx->CopyDescriptors(1, dst_descriptor, srv);
 			light.shadow_mask_index = (Sint32)dst_descriptor.GetIndex();
 		};
-		auto AddShadowMap  = [&](Uint64 light_id, Uint32 shadow_map_size)
-		{
-			GfxTextureDesc depth_desc{};
-			depth_desc.width = shadow_map_size;
-			depth_desc.height = shadow_map_size;
-			depth_desc.format = GfxFormat::R32_TYPELESS;
-			depth_desc.clear_value = GfxClearValue(1.0f, 0);
-			depth_desc.bind_flags = GfxBindFlag::DepthStencil | GfxBindFlag::ShaderResource;
-			depth_desc.initial_state = GfxResourceState::DSV;
-
-			light_shadow_maps[light_id].emplace_back(gfx->CreateTexture(depth_desc));
-			light_shadow_map_srvs[light_id].push_back(gfx->CreateTextureSRV(light_shadow_maps[light_id].back().get()));
-			light_shadow_map_dsvs[light_id].push_back(gfx->CreateTextureDSV(light_shadow_maps[light_id].back().get()));
-		};
-		auto AddShadowMaps = [&](Light& light, Uint64 light_id)
-		{
-			switch (light.type)
-			{
-			case LightType::Directional:
-			{
-				if (light.use_cascades && light_shadow_maps[light_id].size() != SHADOW_CASCADE_COUNT)
-				{
-					light_shadow_maps[light_id].clear();
-					light_shadow_map_srvs[light_id].clear();
-					light_shadow_map_dsvs[light_id].clear();
-					for (Uint32 i = 0; i < SHADOW_CASCADE_COUNT; ++i) AddShadowMap(light_id, SHADOW_CASCADE_MAP_SIZE);
-				}
-				else if (!light.use_cascades && light_shadow_maps[light_id].size() != 1)
-				{
-					light_shadow_maps[light_id].clear();
-					light_shadow_map_srvs[light_id].clear();
-					light_shadow_map_dsvs[light_id].clear();
-					AddShadowMap(light_id, SHADOW_MAP_SIZE);
-				}
-			}
-			break;
-			case LightType::Point:
-			{
-				if (light_shadow_maps[light_id].size() != 6)
-				{
-					light_shadow_maps[light_id].clear();
-					light_shadow_map_srvs[light_id].clear();
-					light_shadow_map_dsvs[light_id].clear();
-					for (Uint32 i = 0; i < 6; ++i) AddShadowMap(light_id, SHADOW_CUBE_SIZE);
-				}
-			}
-			break;
-			case LightType::Spot:
-			{
-				if (light_shadow_maps[light_id].size() != 1)
-				{
-					light_shadow_maps[light_id].clear();
-					light_shadow_map_srvs[light_id].clear();
-					light_shadow_map_dsvs[light_id].clear();
-					AddShadowMap(light_id, SHADOW_MAP_SIZE);
-				}
-			}
-			break;
-			}
 
-			for (Uint64 j = 0; j < light_shadow_maps[light_id].size(); ++j)
-			{
-				GfxDescriptor srv = light_shadow_map_srvs[light_id][j];
-				GfxDescriptor dst_descriptor = gfx->AllocateDescriptorsGPU();
-				gfx->CopyDescriptors(1, dst_descriptor, srv);
-				if (j == 0) light.shadow_texture_index = (Sint32)dst_descriptor.GetIndex();
-			}
-		};
+		Uint32 const atlas_size = GetShadowAtlasSize();
+		if (atlas_size != shadow_atlas.GetAtlasSize())
+		{
+			gfx->WaitForGPU();
+			shadow_atlas.Reset(atlas_size);
+			CreateShadowAtlas(atlas_size);
+		}
 
 		static Uint64 light_matrices_count = 0;
 		Uint64 current_light_matrices_count = 0;
@@ -315,6 +304,7 @@ namespace adria
 			if (light_matrices_count != 0)
 			{
 				light_matrices_buffer = gfx->CreateBuffer(StructuredBufferDesc<Matrix>(light_matrices_count * backbuffer_count, false, true));
+				shadow_atlas_rects_buffer = gfx->CreateBuffer(StructuredBufferDesc<Vector4>(light_matrices_count * backbuffer_count, false, true));
 				GfxBufferDescriptorDesc srv_desc{};
 				srv_desc.size = light_matrices_count * sizeof(Matrix);
 				for (Uint32 i = 0; i < backbuffer_count; ++i)
@@ -322,11 +312,27 @@ namespace adria
 					srv_desc.offset = i * light_matrices_count * sizeof(Matrix);
 					light_matrices_buffer_srvs[i] = gfx->CreateBufferSRV(light_matrices_buffer.get(), &srv_desc);
 				}
+				srv_desc.size = light_matrices_count * sizeof(Vector4);
+				for (Uint32 i = 0; i < backbuffer_count; ++i)
+				{
+					srv_desc.offset = i * light_matrices_count * sizeof(Vector4);
+					shadow_atlas_rects_buffer_srvs[i] = gfx->CreateBufferSRV(shadow_atlas_rects_buffer.get(), &srv_desc);
+				}
 			}
 		}
 
-		std::vector<Matrix> _light_matrices;
-		_light_matrices.reserve(light_matrices_count);
+		//assign the light matrices and request a tile for each of them, the most important views are packed first
+		struct ShadowTileRequest
+		{
+			Uint64 light_id;
+			Uint32 light_index;
+			Uint32 matrix_index;
+			Uint32 matrix_offset;
+			Uint32 tile_size;
+			Bool   directional;
+		};
+		std::vector<ShadowTileRequest> tile_requests;
+		Uint32 matrix_count = 0;
 		for (auto e : light_view)
 		{
 			auto& light = light_view.get<Light>(e);
@@ -335,152 +341,156 @@ namespace adria
 			if (light.casts_shadows)
 			{
 				if (light.ray_traced_shadows) continue;
-				light.shadow_matrix_index = (Uint32)_light_matrices.size();
-				if (light.type == LightType::Directional)
-				{
-					if (light.use_cascades)
-					{
-						std::array<Matrix, SHADOW_CASCADE_COUNT> proj_matrices = RecalculateProjectionMatrices(*camera, cascades_split_lambda, split_distances);
-						AddShadowMaps(light, entt::to_integral(e));
-						for (Uint32 i = 0; i < SHADOW_CASCADE_COUNT; ++i)
-						{
-							auto const& [V, P] = LightViewProjection_Cascades(light, *camera, proj_matrices[i], SHADOW_CASCADE_MAP_SIZE);
-							_light_matrices.push_back(XMMatrixTranspose(V * P));
-						}
-					}
-					else
-					{
-						AddShadowMaps(light, entt::to_integral(e));
-						auto const& [V, P] = LightViewProjection_Directional(light, *camera, SHADOW_MAP_SIZE);
-						_light_matrices.push_back(XMMatrixTranspose(V * P));
-					}
+				light.shadow_matrix_index = (Sint32)matrix_count;
 
+				Uint64 const light_id = entt::to_integral(e);
+				Uint32 view_count = 1;
+				Uint32 max_tile_size = SHADOW_MAP_SIZE;
+				if (light.type == LightType::Directional && light.use_cascades)
+				{
+					view_count = SHADOW_CASCADE_COUNT;
+					max_tile_size = SHADOW_CASCADE_MAP_SIZE;
 				}
 				else if (light.type == LightType::Point)
 				{
-					AddShadowMaps(light, entt::to_integral(e));
-					for (Uint32 i = 0; i < 6; ++i)
-					{
-						auto const& [V, P] = LightViewProjection_Point(light, i);
-						_light_matrices.push_back(XMMatrixTranspose(V * P));
-					}
+					view_count = 6;
+					max_tile_size = SHADOW_CUBE_SIZE;
 				}
-				else if (light.type == LightType::Spot)
+
+				for (Uint32 i = 0; i < view_count; ++i)
 				{
-					AddShadowMaps(light, entt::to_integral(e));
-					auto const& [V, P] = LightViewProjection_Spot(light);
-					_light_matrices.push_back(XMMatrixTranspose(V * P));
+					Uint32 const cached_tile_size = shadow_atlas.GetCachedTileSize(light_id, i);
+					tile_requests.push_back(ShadowTileRequest
+						{
+							.light_id = light_id,
+							.light_index = light.light_index,
+							.matrix_index = matrix_count,
+							.matrix_offset = i,
+							.tile_size = ShadowTileSize(light, *camera, max_tile_size, cached_tile_size),
+							.directional = light.type == LightType::Directional
+						});
 				}
+				matrix_count += view_count;
 			}
 			else if (light.ray_traced_shadows)
 			{
 				AddShadowMask(light, entt::to_integral(e));
 			}
 		}
-		if (light_matrices_buffer)
+		std::stable_sort(tile_requests.begin(), tile_requests.end(), [](ShadowTileRequest const& a, ShadowTileRequest const& b)
+			{
+				if (a.directional != b.directional) return a.directional;
+				return a.tile_size > b.tile_size;
+			});
+
+		shadow_atlas.BeginFrame();
+		shadow_views.clear();
+		std::vector<Vector4> shadow_atlas_rects(light_matrices_count, Vector4(0.0f, 0.0f, 0.0f, 0.0f));
+		std::vector<Uint32> shadow_tile_sizes(light_matrices_count, 0);
+		Float const inv_atlas_size = 1.0f / shadow_atlas.GetAtlasSize();
+		for (ShadowTileRequest const& request : tile_requests)
+		{
+			AtlasTile tile = shadow_atlas.RequestTile(request.light_id, request.matrix_offset, request.tile_size);
+			if (!tile.IsValid()) continue;
+
+			Uint32 const matrix_index = request.matrix_index + request.matrix_offset;
+			shadow_atlas_rects[matrix_index] = Vector4(tile.size * inv_atlas_size, tile.size * inv_atlas_size, tile.x * inv_atlas_size, tile.y * inv_atlas_size);
+			shadow_tile_sizes[matrix_index] = tile.size;
+			shadow_views.push_back(ShadowView{ .light_index = request.light_index, .matrix_index = request.matrix_index, .matrix_offset = request.matrix_offset, .tile = tile });
+		}
+
+		Sint32 shadow_atlas_gpu_index = -1;
+		if (!shadow_views.empty())
 		{
-			light_matrices_buffer->Update(_light_matrices.data(), light_matrices_count * sizeof(Matrix), light_matrices_count * sizeof(Matrix) * backbuffer_index);
 			GfxDescriptor dst_descriptor = gfx->AllocateDescriptorsGPU();
-			gfx->CopyDescriptors(1, dst_descriptor, light_matrices_buffer_srvs[backbuffer_index]);
-			light_matrices_gpu_index = (Sint32)dst_descriptor.GetIndex();
+			gfx->CopyDescriptors(1, dst_descriptor, shadow_atlas_srv);
+			shadow_atlas_gpu_index = (Sint32)dst_descriptor.GetIndex();
 		}
-		light_matrices = std::move(_light_matrices);
-	}
 
-	void ShadowRenderer::AddShadowMapPasses(RenderGraph& rg)
-	{
-		FrameBlackboardData const& frame_data = rg.GetBlackboard().Get<FrameBlackboardData>();
-		auto light_view = reg.view<Light>();
+		std::vector<Matrix> _light_matrices;
+		_light_matrices.reserve(light_matrices_count);
 		for (auto e : light_view)
 		{
 			auto& light = light_view.get<Light>(e);
-			if (!light.casts_shadows) continue;
-			Sint32 light_index = light.light_index;
-			Sint32 light_matrix_index = light.shadow_matrix_index;
-			Uint64 light_id = entt::to_integral(e);
+			if (!light.casts_shadows || light.ray_traced_shadows) continue;
 
+			light.shadow_texture_index = shadow_atlas_gpu_index;
 			if (light.type == LightType::Directional)
 			{
 				if (light.use_cascades)
 				{
+					std::array<Matrix, SHADOW_CASCADE_COUNT> proj_matrices = RecalculateProjectionMatrices(*camera, cascades_split_lambda, split_distances);
 					for (Uint32 i = 0; i < SHADOW_CASCADE_COUNT; ++i)
 					{
-						rg.ImportTexture(RG_NAME_IDX(ShadowMap, light_matrix_index + i), light_shadow_maps[light_id][i].get());
-						std::string name = "Cascade Shadow Pass" + std::to_string(i);
-						rg.AddPass<void>(name.c_str(),
-							[=](RenderGraphBuilder& builder)
-							{
-								builder.WriteDepthStencil(RG_NAME_IDX(ShadowMap, light_matrix_index + i), RGLoadStoreAccessOp::Clear_Preserve);
-								builder.SetViewport(SHADOW_CASCADE_MAP_SIZE, SHADOW_CASCADE_MAP_SIZE);
-							},
-							[=](RenderGraphContext& context, GfxCommandList* cmd_list)
-							{
-								cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
-								ShadowMapPass_Common(gfx, cmd_list, light_index, light_matrix_index, i);
-							}, RGPassType::Graphics);
-
-						shadow_rendered_event.Broadcast(RG_NAME_IDX(ShadowMap, light_matrix_index + i));
+						Uint32 const tile_size = std::max(shadow_tile_sizes[light.shadow_matrix_index + i], 1u);
+						auto const& [V, P] = LightViewProjection_Cascades(light, *camera, proj_matrices[i], tile_size);
+						_light_matrices.push_back(XMMatrixTranspose(V * P));
 					}
 				}
 				else
 				{
-					rg.ImportTexture(RG_NAME_IDX(ShadowMap, light.shadow_matrix_index), light_shadow_maps[light_id][0].get());
-					std::string name = "Directional Shadow Pass";
-					rg.AddPass<void>(name.c_str(),
-						[=](RenderGraphBuilder& builder)
-						{
-							builder.WriteDepthStencil(RG_NAME_IDX(ShadowMap, light.shadow_matrix_index), RGLoadStoreAccessOp::Clear_Preserve);
-							builder.SetViewport(SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
-						},
-						[=](RenderGraphContext& context, GfxCommandList* cmd_list)
-						{
-							cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
-							ShadowMapPass_Common(gfx, cmd_list, light_index, light_matrix_index, 0);
-						}, RGPassType::Graphics);
-
-					shadow_rendered_event.Broadcast(RG_NAME_IDX(ShadowMap, light.shadow_matrix_index));
+					Uint32 const tile_size = std::max(shadow_tile_sizes[light.shadow_matrix_index], 1u);
+					auto const& [V, P] = LightViewProjection_Directional(light, *camera, tile_size);
+					_light_matrices.push_back(XMMatrixTranspose(V * P));
 				}
+
 			}
 			else if (light.type == LightType::Point)
 			{
 				for (Uint32 i = 0; i < 6; ++i)
 				{
-					rg.ImportTexture(RG_NAME_IDX(ShadowMap, light.shadow_matrix_index + i), light_shadow_maps[light_id][i].get());
-					std::string name = "Point Shadow Pass" + std::to_string(i);
-					rg.AddPass<void>(name.c_str(),
-						[=](RenderGraphBuilder& builder)
-						{
-							builder.WriteDepthStencil(RG_NAME_IDX(ShadowMap, light.shadow_matrix_index + i), RGLoadStoreAccessOp::Clear_Preserve);
-							builder.SetViewport(SHADOW_CUBE_SIZE, SHADOW_CUBE_SIZE);
-						},
-						[=](RenderGraphContext& context, GfxCommandList* cmd_list)
-						{
-							cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
-							ShadowMapPass_Common(gfx, cmd_list, light_index, light_matrix_index, i);
-						}, RGPassType::Graphics);
-
-					shadow_rendered_event.Broadcast(RG_NAME_IDX(ShadowMap, light.shadow_matrix_index + i));
+					auto const& [V, P] = LightViewProjection_Point(light, i);
+					_light_matrices.push_back(XMMatrixTranspose(V * P));
 				}
 			}
 			else if (light.type == LightType::Spot)
 			{
-				rg.ImportTexture(RG_NAME_IDX(ShadowMap, light_matrix_index), light_shadow_maps[light_id][0].get());
-				std::string name = "Spot Shadow Pass";
-				rg.AddPass<void>(name.c_str(),
-					[=](RenderGraphBuilder& builder)
-					{
-						builder.WriteDepthStencil(RG_NAME_IDX(ShadowMap, light_matrix_index), RGLoadStoreAccessOp::Clear_Preserve);
-						builder.SetViewport(SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
-					},
-					[=](RenderGraphContext& context, GfxCommandList* cmd_list)
-					{
-						cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
-						ShadowMapPass_Common(gfx, cmd_list, light_index, light_matrix_index, 0);
-					}, RGPassType::Graphics);
-
-				shadow_rendered_event.Broadcast(RG_NAME_IDX(ShadowMap, light_matrix_index));
+				auto const& [V, P] = LightViewProjection_Spot(light);
+				_light_matrices.push_back(XMMatrixTranspose(V * P));
 			}
 		}
+		if (light_matrices_buffer)
+		{
+			light_matrices_buffer->Update(_light_matrices.data(), light_matrices_count * sizeof(Matrix), light_matrices_count * sizeof(Matrix) * backbuffer_index);
+			GfxDescriptor dst_descriptor = gfx->AllocateDescriptorsGPU();
+			gfx->CopyDescriptors(1, dst_descriptor, light_matrices_buffer_srvs[backbuffer_index]);
+			light_matrices_gpu_index = (Sint32)dst_descriptor.GetIndex();
+
+			shadow_atlas_rects_buffer->Update(shadow_atlas_rects.data(), light_matrices_count * sizeof(Vector4), light_matrices_count * sizeof(Vector4) * backbuffer_index);
+			dst_descriptor = gfx->AllocateDescriptorsGPU();
+			gfx->CopyDescriptors(1, dst_descriptor, shadow_atlas_rects_buffer_srvs[backbuffer_index]);
+			shadow_atlas_rects_gpu_index = (Sint32)dst_descriptor.GetIndex();
+		}
+		light_matrices = std::move(_light_matrices);
+	}
+
+	void ShadowRenderer::AddShadowMapPasses(RenderGraph& rg)
+	{
+		if (shadow_views.empty()) return;
+
+		FrameBlackboardData const& frame_data = rg.GetBlackboard().Get<FrameBlackboardData>();
+		Uint32 const atlas_size = shadow_atlas.GetAtlasSize();
+		rg.ImportTexture(RG_NAME(ShadowAtlas), shadow_atlas_texture.get());
+		//tiles are cleared one by one inside the pass so it can't use a DX12 render pass
+		rg.AddPass<void>("Shadow Atlas Pass",
+			[=](RenderGraphBuilder& builder)
+			{
+				builder.WriteDepthStencil(RG_NAME(ShadowAtlas), RGLoadStoreAccessOp::Preserve_Preserve);
+				builder.SetViewport(atlas_size, atlas_size);
+			},
+			[=](RenderGraphContext& context, GfxCommandList* cmd_list)
+			{
+				cmd_list->SetRootCBV(0, frame_data.frame_cbuffer_address);
+				for (ShadowView const& shadow_view : shadow_views)
+				{
+					AtlasTile const& tile = shadow_view.tile;
+					cmd_list->ClearDepth(shadow_atlas_dsv, tile.x, tile.y, tile.size, tile.size);
+					cmd_list->SetViewport(tile.x, tile.y, tile.size, tile.size);
+					ShadowMapPass_Common(gfx, cmd_list, shadow_view.light_index, shadow_view.matrix_index, shadow_view.matrix_offset);
+				}
+			}, RGPassType::Graphics, RGPassFlags::LegacyRenderPass);
+
+		shadow_rendered_event.Broadcast(RG_NAME(ShadowAtlas));
 	}
 	void ShadowRenderer::AddRayTracingShadowPasses(RenderGraph& rg)
 	{
@@ -521,6 +531,21 @@ namespace adria
 		shadow_psos->Finalize(gfx);
 	}
 
+	void ShadowRenderer::CreateShadowAtlas(Uint32 atlas_size)
+	{
+		GfxTextureDesc depth_desc{};
+		depth_desc.width = atlas_size;
+		depth_desc.height = atlas_size;
+		depth_desc.format = GfxFormat::R32_TYPELESS;
+		depth_desc.clear_value = GfxClearValue(1.0f, 0);
+		depth_desc.bind_flags = GfxBindFlag::DepthStencil | GfxBindFlag::ShaderResource;
+		depth_desc.initial_state = GfxResourceState::DSV;
+
+		shadow_atlas_texture = gfx->CreateTexture(depth_desc);
+		shadow_atlas_srv = gfx->CreateTextureSRV(shadow_atlas_texture.get());
+		shadow_atlas_dsv = gfx->CreateTextureDSV(shadow_atlas_texture.get());
+	}
+
 	void ShadowRenderer::ShadowMapPass_Common(GfxDevice* gfx, GfxCommandList* cmd_list, Uint64 light_index, Uint64 matrix_index, Uint64 matrix_offset)
 	{
 		struct ShadowConstants
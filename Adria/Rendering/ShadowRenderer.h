@@ -1,6 +1,7 @@
 #pragma once
 #include <array>
 #include "RayTracedShadowsPass.h"
+#include "ShadowAtlas.h"
 #include "Graphics/GfxMacros.h"
 #include "Graphics/GfxDescriptor.h"
 #include "Graphics/GfxPipelineStatePermutationsFwd.h"
@@ -21,10 +22,20 @@ namespace adria
 
 	class ShadowRenderer
 	{
+		//maximum tile sizes in the shadow atlas, point and spot light tiles shrink with the screen coverage of the light
 		static constexpr Uint32 SHADOW_MAP_SIZE = 2048;
 		static constexpr Uint32 SHADOW_CUBE_SIZE = 512;
 		static constexpr Uint32 SHADOW_CASCADE_MAP_SIZE = 1024;
 		static constexpr Uint32 SHADOW_CASCADE_COUNT = 4;
+		static constexpr Uint32 SHADOW_ATLAS_MIN_TILE_SIZE = 128;
+
+		struct ShadowView
+		{
+			Uint32 light_index;
+			Uint32 matrix_index;
+			Uint32 matrix_offset;
+			AtlasTile tile;
+		};
 
 	public:
 		ShadowRenderer(entt::registry& reg, GfxDevice* gfx, Uint32 width, Uint32 height);
@@ -45,6 +56,7 @@ namespace adria
 		void AddRayTracingShadowPasses(RenderGraph& rg);
 
 		void FillFrameCBuffer(FrameCBuffer& frame_cbuffer);
+		void GUI();
 
 		ShadowTextureRenderedEvent& GetShadowTextureRenderedEvent() { return shadow_rendered_event; }
 
@@ -58,13 +70,18 @@ namespace adria
 
 		std::unique_ptr<GfxBuffer>  light_matrices_buffer;
 		GfxDescriptor				light_matrices_buffer_srvs[GFX_BACKBUFFER_COUNT];
-		std::unordered_map<Uint64, std::vector<std::unique_ptr<GfxTexture>>> light_shadow_maps;
-		std::unordered_map<Uint64, std::vector<GfxDescriptor>> light_shadow_map_srvs;
-		std::unordered_map<Uint64, std::vector<GfxDescriptor>> light_shadow_map_dsvs;
+		std::unique_ptr<GfxBuffer>  shadow_atlas_rects_buffer;
+		GfxDescriptor				shadow_atlas_rects_buffer_srvs[GFX_BACKBUFFER_COUNT];
+		ShadowAtlas					shadow_atlas;
+		std::unique_ptr<GfxTexture> shadow_atlas_texture;
+		GfxDescriptor				shadow_atlas_srv;
+		GfxDescriptor				shadow_atlas_dsv;
+		std::vector<ShadowView>		shadow_views;
 		std::unordered_map<Uint64, std::unique_ptr<GfxTexture>> light_mask_textures;
 		std::unordered_map<Uint64, GfxDescriptor> light_mask_texture_srvs;
 		std::unordered_map<Uint64, GfxDescriptor> light_mask_texture_uavs;
 		Sint32						   light_matrices_gpu_index = -1;
+		Sint32						   shadow_atlas_rects_gpu_index = -1;
 
 		std::vector<Matrix>								light_matrices;
 		std::array<Float, SHADOW_CASCADE_COUNT>		    split_distances{};
@@ -74,6 +91,7 @@ namespace adria
 
 	private:
 		void CreatePSOs();
+		void CreateShadowAtlas(Uint32 atlas_size);
 		void ShadowMapPass_Common(GfxDevice* gfx, GfxCommandList* cmd_list, Uint64 light_index, Uint64 matrix_index, Uint64 matrix_offset);
 		static std::array<Matrix, SHADOW_CASCADE_COUNT> RecalculateProjectionMatrices(Camera const& camera, Float split_lambda, std::array<Float, SHADOW_CASCADE_COUNT>& split_distances);
 	};
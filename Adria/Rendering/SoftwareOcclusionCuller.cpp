@@ -0,0 +1,298 @@
+#include <emmintrin.h>
+#include <atomic>
+#include "SoftwareOcclusionCuller.h"
+#include "Utilities/ThreadPool.h"
+
+namespace adria
+{
+	namespace
+	{
+		Vector4 TransformPosition(Vector3 const& p, Matrix const& m)
+		{
+			return Vector4(
+				p.x * m._11 + p.y * m._21 + p.z * m._31 + m._41,
+				p.x * m._12 + p.y * m._22 + p.z * m._32 + m._42,
+				p.x * m._13 + p.y * m._23 + p.z * m._33 + m._43,
+				p.x * m._14 + p.y * m._24 + p.z * m._34 + m._44);
+		}
+
+		//binning and the multithreaded rasterization are not worth it for a handful of triangles
+		constexpr Uint32 MinParallelBinnedTriangles = 256;
+	}
+
+	SoftwareOcclusionCuller::SoftwareOcclusionCuller()
+	{
+		for (Uint32 mip = 0; mip < MipCount; ++mip)
+		{
+			depth_mips[mip].resize((Width >> mip) * (Height >> mip), 0.0f);
+		}
+	}
+
+	void SoftwareOcclusionCuller::BeginFrame(Matrix const& _view_projection, Float near_distance)
+	{
+		view_projection = _view_projection;
+		near_plane = near_distance;
+		stats = {};
+		triangles.clear();
+		for (std::vector<Uint32>& tile_bin : tile_bins) tile_bin.clear();
+		std::fill(depth_mips[0].begin(), depth_mips[0].end(), 0.0f);
+	}
+
+	void SoftwareOcclusionCuller::AddOccluder(Vector3 const* positions, Uint32 const* indices, Uint32 index_count, Matrix const& world)
+	{
+		Matrix const world_view_projection = world * view_projection;
+		++stats.occluder_count;
+		for (Uint32 i = 0; i + 2 < index_count; i += 3)
+		{
+			Vector4 clip[3];
+			for (Uint32 k = 0; k < 3; ++k) clip[k] = TransformPosition(positions[indices[i + k]], world_view_projection);
+			++stats.occluder_triangles;
+
+			//the side planes are valid for every w, so the trivial reject can be done before clipping
+			if (clip[0].x > clip[0].w && clip[1].x > clip[1].w && clip[2].x > clip[2].w) continue;
+			if (clip[0].x < -clip[0].w && clip[1].x < -clip[1].w && clip[2].x < -clip[2].w) continue;
+			if (clip[0].y > clip[0].w && clip[1].y > clip[1].w && clip[2].y > clip[2].w) continue;
+			if (clip[0].y < -clip[0].w && clip[1].y < -clip[1].w && clip[2].y < -clip[2].w) continue;
+
+			Uint32 const behind_mask = (clip[0].w < near_plane) | ((clip[1].w < near_plane) << 1) | ((clip[2].w < near_plane) << 2);
+			if (behind_mask == 0x7) continue;
+			if (behind_mask == 0x0)
+			{
+				SetupAndBinTriangle(clip);
+				continue;
+			}
+
+			//large occluders like walls and floors usually cross the near plane, clipping turns them into one or two triangles
+			Vector4 polygon[4];
+			Uint32 polygon_size = 0;
+			for (Uint32 k = 0; k < 3; ++k)
+			{
+				Vector4 const& a = clip[k];
+				Vector4 const& b = clip[(k + 1) % 3];
+				Bool const a_inside = a.w >= near_plane;
+				Bool const b_inside = b.w >= near_plane;
+				if (a_inside) polygon[polygon_size++] = a;
+				if (a_inside != b_inside) polygon[polygon_size++] = Vector4::Lerp(a, b, (near_plane - a.w) / (b.w - a.w));
+			}
+			SetupAndBinTriangle(polygon);
+			if (polygon_size == 4)
+			{
+				Vector4 const second_triangle[3] = { polygon[0], polygon[2], polygon[3] };
+				SetupAndBinTriangle(second_triangle);
+			}
+		}
+	}
+
+	void SoftwareOcclusionCuller::RasterizeOccluders(Bool multithreaded)
+	{
+		if (multithreaded && stats.binned_triangles >= MinParallelBinnedTriangles)
+		{
+			std::atomic<Uint32> next_tile = 0;
+			auto RasterizeTiles = [this, &next_tile]()
+				{
+					for (Uint32 tile_index = next_tile++; tile_index < TileCount; tile_index = next_tile++)
+					{
+						if (!tile_bins[tile_index].empty()) RasterizeTile(tile_index);
+					}
+				};
+
+			Uint32 const worker_count = g_ThreadPool.GetHelperCount(TileCount);
+			std::vector<std::future<void>> workers;
+			workers.reserve(worker_count);
+			for (Uint32 i = 0; i < worker_count; ++i) workers.push_back(g_ThreadPool.Submit(RasterizeTiles));
+			RasterizeTiles();
+			for (std::future<void>& worker : workers) worker.wait();
+		}
+		else
+		{
+			for (Uint32 tile_index = 0; tile_index < TileCount; ++tile_index)
+			{
+				if (!tile_bins[tile_index].empty()) RasterizeTile(tile_index);
+			}
+		}
+		BuildDepthPyramid();
+	}
+
+	Bool SoftwareOcclusionCuller::IsVisible(BoundingBox const& aabb)
+	{
+		++stats.tested_boxes;
+
+		Float min_x = FLT_MAX, min_y = FLT_MAX;
+		Float max_x = -FLT_MAX, max_y = -FLT_MAX;
+		Float max_depth = 0.0f;
+		for (Uint32 corner = 0; corner < 8; ++corner)
+		{
+			Vector3 const position(
+				aabb.Center.x + ((corner & 1) ? aabb.Extents.x : -aabb.Extents.x),
+				aabb.Center.y + ((corner & 2) ? aabb.Extents.y : -aabb.Extents.y),
+				aabb.Center.z + ((corner & 4) ? aabb.Extents.z : -aabb.Extents.z));
+			Vector4 const clip = TransformPosition(position, view_projection);
+			if (clip.w < near_plane) return true;
+
+			Float const inv_w = 1.0f / clip.w;
+			Float const x = (clip.x * inv_w * 0.5f + 0.5f) * Width;
+			Float const y = (0.5f - clip.y * inv_w * 0.5f) * Height;
+			min_x = std::min(min_x, x);
+			min_y = std::min(min_y, y);
+			max_x = std::max(max_x, x);
+			max_y = std::max(max_y, y);
+			max_depth = std::max(max_depth, inv_w);
+		}
+
+		Sint32 const x0 = (Sint32)std::floor(std::clamp(min_x, 0.0f, (Float)Width));
+		Sint32 const y0 = (Sint32)std::floor(std::clamp(min_y, 0.0f, (Float)Height));
+		Sint32 const x1 = (Sint32)std::floor(std::clamp(max_x, -1.0f, (Float)Width - 1));
+		Sint32 const y1 = (Sint32)std::floor(std::clamp(max_y, -1.0f, (Float)Height - 1));
+		if (x0 > x1 || y0 > y1) return true;
+
+		//the coarsest mip that still covers the rectangle with at most 4x4 texels
+		Uint32 mip = 0;
+		while (mip + 1 < MipCount && ((x1 >> mip) - (x0 >> mip) >= 4 || (y1 >> mip) - (y0 >> mip) >= 4)) ++mip;
+
+		Float const* depth = depth_mips[mip].data();
+		Uint32 const mip_width = Width >> mip;
+		for (Sint32 y = y0 >> mip; y <= (y1 >> mip); ++y)
+		{
+			for (Sint32 x = x0 >> mip; x <= (x1 >> mip); ++x)
+			{
+				//the farthest occluder depth of the texel is not in front of the nearest point of the box
+				if (depth[y * mip_width + x] <= max_depth) return true;
+			}
+		}
+		++stats.occluded_boxes;
+		return false;
+	}
+
+	void SoftwareOcclusionCuller::SetupAndBinTriangle(Vector4 const* clip_vertices)
+	{
+		Float x[3], y[3], z[3];
+		for (Uint32 i = 0; i < 3; ++i)
+		{
+			Float const inv_w = 1.0f / clip_vertices[i].w;
+			x[i] = (clip_vertices[i].x * inv_w * 0.5f + 0.5f) * Width;
+			y[i] = (0.5f - clip_vertices[i].y * inv_w * 0.5f) * Height;
+			z[i] = inv_w;
+		}
+
+		Float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (std::abs(area) < 1e-6f) return;
+		if (area < 0.0f)
+		{
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+			std::swap(z[1], z[2]);
+			area = -area;
+		}
+
+		//pixels whose centers can be covered, clamped before the conversion since clipped vertices can be far off screen
+		Sint32 const min_x = (Sint32)std::ceil(std::clamp(std::min({ x[0], x[1], x[2] }) - 0.5f, 0.0f, (Float)Width));
+		Sint32 const min_y = (Sint32)std::ceil(std::clamp(std::min({ y[0], y[1], y[2] }) - 0.5f, 0.0f, (Float)Height));
+		Sint32 const max_x = (Sint32)std::floor(std::clamp(std::max({ x[0], x[1], x[2] }) - 0.5f, -1.0f, (Float)Width - 1));
+		Sint32 const max_y = (Sint32)std::floor(std::clamp(std::max({ y[0], y[1], y[2] }) - 0.5f, -1.0f, (Float)Height - 1));
+		if (min_x > max_x || min_y > max_y) return;
+
+		SetupTriangle& triangle = triangles.emplace_back();
+		for (Uint32 i = 0; i < 3; ++i)
+		{
+			Uint32 const j = (i + 1) % 3;
+			triangle.edge_a[i] = y[i] - y[j];
+			triangle.edge_b[i] = x[j] - x[i];
+			triangle.edge_c[i] = -(triangle.edge_a[i] * x[i] + triangle.edge_b[i] * y[i]);
+		}
+		triangle.depth_a = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+		triangle.depth_b = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+		triangle.depth_c = z[0] - triangle.depth_a * x[0] - triangle.depth_b * y[0];
+		triangle.max_depth = std::max({ z[0], z[1], z[2] });
+		triangle.min_x = min_x;
+		triangle.min_y = min_y;
+		triangle.max_x = max_x;
+		triangle.max_y = max_y;
+
+		Uint32 const triangle_index = (Uint32)triangles.size() - 1;
+		for (Sint32 tile_y = min_y / (Sint32)TileHeight; tile_y <= max_y / (Sint32)TileHeight; ++tile_y)
+		{
+			for (Sint32 tile_x = min_x / (Sint32)TileWidth; tile_x <= max_x / (Sint32)TileWidth; ++tile_x)
+			{
+				tile_bins[tile_y * TileCountX + tile_x].push_back(triangle_index);
+				++stats.binned_triangles;
+			}
+		}
+	}
+
+	void SoftwareOcclusionCuller::RasterizeTile(Uint32 tile_index)
+	{
+		Sint32 const tile_x = (tile_index % TileCountX) * TileWidth;
+		Sint32 const tile_y = (tile_index / TileCountX) * TileHeight;
+		Float* depth = depth_mips[0].data();
+
+		__m128 const pixel_offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		__m128 const zero = _mm_setzero_ps();
+		for (Uint32 triangle_index : tile_bins[tile_index])
+		{
+			SetupTriangle const& triangle = triangles[triangle_index];
+			//tiles start at multiples of 4, so the aligned span never leaves the tile
+			Sint32 const x0 = std::max(triangle.min_x, tile_x) & ~3;
+			Sint32 const x1 = std::min(triangle.max_x, tile_x + (Sint32)TileWidth - 1);
+			Sint32 const y0 = std::max(triangle.min_y, tile_y);
+			Sint32 const y1 = std::min(triangle.max_y, tile_y + (Sint32)TileHeight - 1);
+
+			__m128 const pixel_x = _mm_add_ps(_mm_set1_ps((Float)x0), pixel_offsets);
+			__m128 edge_a[3], edge_step[3];
+			for (Uint32 i = 0; i < 3; ++i)
+			{
+				edge_a[i] = _mm_set1_ps(triangle.edge_a[i]);
+				edge_step[i] = _mm_set1_ps(triangle.edge_a[i] * 4.0f);
+			}
+			__m128 const depth_a = _mm_set1_ps(triangle.depth_a);
+			__m128 const depth_step = _mm_set1_ps(triangle.depth_a * 4.0f);
+			__m128 const max_depth = _mm_set1_ps(triangle.max_depth);
+
+			for (Sint32 y = y0; y <= y1; ++y)
+			{
+				Float const pixel_y = (Float)y + 0.5f;
+				__m128 edge[3];
+				for (Uint32 i = 0; i < 3; ++i)
+				{
+					edge[i] = _mm_add_ps(_mm_mul_ps(edge_a[i], pixel_x), _mm_set1_ps(triangle.edge_b[i] * pixel_y + triangle.edge_c[i]));
+				}
+				__m128 pixel_depth = _mm_add_ps(_mm_mul_ps(depth_a, pixel_x), _mm_set1_ps(triangle.depth_b * pixel_y + triangle.depth_c));
+
+				Float* depth_row = depth + y * Width;
+				for (Sint32 x = x0; x <= x1; x += 4)
+				{
+					__m128 const inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge[0], zero), _mm_cmpge_ps(edge[1], zero)), _mm_cmpge_ps(edge[2], zero));
+					if (_mm_movemask_ps(inside))
+					{
+						//the plane is clamped so that slivers do not extrapolate in front of the triangle, lanes outside it keep the old depth
+						__m128 const triangle_depth = _mm_and_ps(inside, _mm_min_ps(pixel_depth, max_depth));
+						_mm_storeu_ps(depth_row + x, _mm_max_ps(_mm_loadu_ps(depth_row + x), triangle_depth));
+					}
+					for (Uint32 i = 0; i < 3; ++i) edge[i] = _mm_add_ps(edge[i], edge_step[i]);
+					pixel_depth = _mm_add_ps(pixel_depth, depth_step);
+				}
+			}
+		}
+	}
+
+	void SoftwareOcclusionCuller::BuildDepthPyramid()
+	{
+		//every texel keeps the farthest depth of the pixels it covers
+		for (Uint32 mip = 1; mip < MipCount; ++mip)
+		{
+			Float const* src = depth_mips[mip - 1].data();
+			Float* dst = depth_mips[mip].data();
+			Uint32 const src_width = Width >> (mip - 1);
+			Uint32 const dst_width = Width >> mip;
+			Uint32 const dst_height = Height >> mip;
+			for (Uint32 y = 0; y < dst_height; ++y)
+			{
+				Float const* src_row0 = src + (2 * y) * src_width;
+				Float const* src_row1 = src_row0 + src_width;
+				for (Uint32 x = 0; x < dst_width; ++x)
+				{
+					dst[y * dst_width + x] = std::min(std::min(src_row0[2 * x], src_row0[2 * x + 1]), std::min(src_row1[2 * x], src_row1[2 * x + 1]));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+
+namespace adria
+{
+	struct SoftwareOcclusionCullerStats
+	{
+		Uint32 occluder_count = 0;
+		Uint32 occluder_triangles = 0;
+		Uint32 binned_triangles = 0;
+		Uint32 tested_boxes = 0;
+		Uint32 occluded_boxes = 0;
+	};
+
+	//conservative cpu occlusion culling. large occluders are rasterized into a small depth buffer and bounding boxes are tested
+	//against a min pyramid of it. the buffer stores 1/w, which is linear in screen space and does not depend on the depth
+	//convention of the projection. triangles are binned into screen tiles, tiles are rasterized in parallel on the thread pool,
+	//four pixels at a time with SSE
+	class SoftwareOcclusionCuller
+	{
+	public:
+		static constexpr Uint32 Width = 320;
+		static constexpr Uint32 Height = 192;
+		static constexpr Uint32 TileWidth = 64;
+		static constexpr Uint32 TileHeight = 32;
+		static constexpr Uint32 TileCountX = Width / TileWidth;
+		static constexpr Uint32 TileCountY = Height / TileHeight;
+		static constexpr Uint32 TileCount = TileCountX * TileCountY;
+		static constexpr Uint32 MipCount = 7;
+
+	private:
+		struct SetupTriangle
+		{
+			Float edge_a[3];
+			Float edge_b[3];
+			Float edge_c[3];
+			Float depth_a, depth_b, depth_c;
+			Float max_depth;
+			Sint32 min_x, min_y, max_x, max_y;
+		};
+
+	public:
+		SoftwareOcclusionCuller();
+
+		//near_distance is the view space distance of the near plane, occluders are clipped against it
+		void BeginFrame(Matrix const& view_projection, Float near_distance);
+		//positions are in object space and the triangles are indexed, winding does not matter
+		void AddOccluder(Vector3 const* positions, Uint32 const* indices, Uint32 index_count, Matrix const& world);
+		//rasterizes the added occluders and builds the depth pyramid
+		void RasterizeOccluders(Bool multithreaded = true);
+		//false only if the box is completely behind the occluders, boxes crossing the near plane are always visible
+		Bool IsVisible(BoundingBox const& aabb);
+
+		SoftwareOcclusionCullerStats const& GetStats() const { return stats; }
+		Float const* GetDepth(Uint32 mip = 0) const { return depth_mips[mip].data(); }
+
+	private:
+		Matrix view_projection;
+		Float near_plane = 0.1f;
+		std::vector<SetupTriangle> triangles;
+		std::vector<Uint32> tile_bins[TileCount];
+		std::vector<Float> depth_mips[MipCount];
+		SoftwareOcclusionCullerStats stats;
+
+	private:
+		void SetupAndBinTriangle(Vector4 const* clip_vertices);
+		void RasterizeTile(Uint32 tile_index);
+		void BuildDepthPyramid();
+	};
+}
@@ -8,10 +8,14 @@
 #include "Graphics/GfxShaderCompiler.h"
 #include "Logging/Logger.h"
 #include "Utilities/Image.h"
+#include "Utilities/ThreadPool.h"
+#include "Utilities/VirtualFileSystem.h"
 
 
 namespace adria
 {
+	//trimmed textures keep at least this many texels in both dimensions
+	static constexpr Uint32 MIN_TRIMMED_TEXTURE_SIZE = 256;
 
     TextureManager::TextureManager() {}
     TextureManager::~TextureManager() = default;
@@ -24,6 +28,7 @@ namespace adria
 	{
         texture_map.clear();
         loaded_textures.clear();
+        residency_paths.clear();
         gfx = nullptr;
 	}
 
@@ -32,49 +37,71 @@ namespace adria
         std::string texture_name(path);
         if (auto it = loaded_textures.find(texture_name); it == loaded_textures.end())
         {
-            ++handle;
-            loaded_textures.insert({ texture_name, handle });
             Image img(path);
+            return AddTexture(texture_name, img);
+        }
+	    else return it->second;
+    }
+
+	void TextureManager::PreloadTextures(std::span<std::string const> paths, std::span<VFSFile const> files)
+	{
+		ADRIA_ASSERT(paths.size() == files.size());
+		std::vector<Uint64> pending_textures;
+		std::unordered_set<std::string_view> pending_paths;
+		for (Uint64 i = 0; i < paths.size(); ++i)
+		{
+			if (!files[i].IsValid() || loaded_textures.contains(paths[i]) || !pending_paths.insert(paths[i]).second) continue;
+			pending_textures.push_back(i);
+		}
 
-			GfxTextureDesc desc{};
-			desc.type = img.Depth() > 1 ? GfxTextureType_3D : GfxTextureType_2D;
-			desc.misc_flags = GfxTextureMiscFlag::None;
-			desc.width = img.Width();
-			desc.height = img.Height();
-			desc.array_size = img.IsCubemap() ? 6 : 1;
-			desc.depth = img.Depth();
-			desc.bind_flags = GfxBindFlag::ShaderResource;
-			desc.format = img.Format();
-			desc.initial_state = GfxResourceState::AllSRV; 
-			desc.heap_type = GfxResourceUsage::Default;
-			desc.mip_levels = img.MipLevels();
-            desc.misc_flags = img.IsCubemap() ? GfxTextureMiscFlag::TextureCube : GfxTextureMiscFlag::None;
-
-            std::vector<GfxTextureSubData> tex_data;
-			const Image* curr_img = &img;
-			while (curr_img)
+		//images are decoded on the thread pool a few at a time, so not all of them are in memory at once
+		Uint64 const batch_size = std::max(std::thread::hardware_concurrency(), 1u);
+		std::vector<std::future<std::unique_ptr<Image>>> images;
+		for (Uint64 first = 0; first < pending_textures.size(); first += batch_size)
+		{
+			Uint64 const last = std::min(first + batch_size, (Uint64)pending_textures.size());
+			images.clear();
+			for (Uint64 i = first; i < last; ++i)
 			{
-				for (Uint32 i = 0; i < desc.mip_levels; ++i)
-				{
-                    GfxTextureSubData& data = tex_data.emplace_back();
-					data.data = curr_img->MipData(i);
-					data.row_pitch = GetRowPitch(curr_img->Format(), desc.width, i);
-					data.slice_pitch = GetSlicePitch(img.Format(), desc.width, desc.height, i);
-				}
-                curr_img = curr_img->NextImage();
+				Uint64 const index = pending_textures[i];
+				images.push_back(g_ThreadPool.Submit([&paths, &files, index]() { return std::make_unique<Image>(paths[index], files[index].Bytes()); }));
 			}
+			for (Uint64 i = first; i < last; ++i)
+			{
+				AddTexture(paths[pending_textures[i]], *images[i - first].get());
+			}
+		}
+	}
 
-			GfxTextureData init_data{};
-			init_data.sub_data = tex_data.data();
-			init_data.sub_count = (Uint32)tex_data.size();
-            std::unique_ptr<GfxTexture> tex = gfx->CreateTexture(desc, init_data);
+	TextureHandle TextureManager::AddTexture(std::string const& texture_name, Image const& img)
+	{
+		++handle;
+		loaded_textures.insert({ texture_name, handle });
+		texture_map[handle] = CreateTexture(img);
 
-            texture_map[handle] = std::move(tex);
-			CreateViewForTexture(handle);
-			return handle;
-        }
-	    else return it->second;
-    }
+		//only plain 2d textures with a mip chain can be trimmed, the top mips are dropped while the remaining mip is large enough
+		if (img.Depth() == 1 && !img.IsCubemap() && !img.NextImage() && img.MipLevels() > 1)
+		{
+			Uint32 const block_size = GetGfxFormatBlockSize(img.Format());
+			Uint32 max_dropped_mips = 0;
+			while (max_dropped_mips + 1 < img.MipLevels())
+			{
+				Uint32 const width = img.Width() >> (max_dropped_mips + 1);
+				Uint32 const height = img.Height() >> (max_dropped_mips + 1);
+				if (std::min(width, height) < MIN_TRIMMED_TEXTURE_SIZE || width % block_size || height % block_size) break;
+				++max_dropped_mips;
+			}
+			if (max_dropped_mips > 0)
+			{
+				std::vector<Uint64> mip_sizes(img.MipLevels());
+				for (Uint32 i = 0; i < img.MipLevels(); ++i) mip_sizes[i] = GetTextureMipByteSize(img.Format(), img.Width(), img.Height(), 1, i);
+				residency.AddTexture(handle, mip_sizes, max_dropped_mips, residency_frame);
+				residency_paths[handle] = texture_name;
+			}
+		}
+		CreateViewForTexture(handle);
+		return handle;
+	}
 
 	TextureHandle TextureManager::LoadCubemap(std::array<std::string, 6> const& cubemap_textures)
 	{
@@ -114,6 +141,24 @@ namespace adria
 		return texture_srv_map[tex_handle];
 	}
 
+	void TextureManager::MarkTextureUsed(TextureHandle tex_handle)
+	{
+		residency.MarkUsed(tex_handle, residency_frame);
+	}
+
+	void TextureManager::UpdateResidency(TextureResidencySettings const& settings)
+	{
+		residency.Update(residency_frame++, settings, residency_changes);
+		if (residency_changes.empty()) return;
+
+		//the bindless descriptors of the changed textures are rewritten in place while frames in flight may still sample them
+		gfx->WaitForGPU();
+		for (TextureResidencyChange const& change : residency_changes)
+		{
+			if (!ApplyResidencyChange(change)) residency.RevertChange(change);
+		}
+	}
+
 	GfxTexture* TextureManager::GetTexture(TextureHandle handle) const
 	{
 		if (handle == INVALID_TEXTURE_HANDLE) return nullptr;
@@ -144,14 +189,94 @@ namespace adria
         is_scene_initialized = true;
 	}
 
+	std::unique_ptr<GfxTexture> TextureManager::CreateTexture(Image const& img, Uint32 first_mip)
+	{
+		ADRIA_ASSERT(first_mip < img.MipLevels());
+		GfxTextureDesc desc{};
+		desc.type = img.Depth() > 1 ? GfxTextureType_3D : GfxTextureType_2D;
+		desc.width = std::max(img.Width() >> first_mip, 1u);
+		desc.height = std::max(img.Height() >> first_mip, 1u);
+		desc.array_size = img.IsCubemap() ? 6 : 1;
+		desc.depth = img.Depth();
+		desc.bind_flags = GfxBindFlag::ShaderResource;
+		desc.format = img.Format();
+		desc.initial_state = GfxResourceState::AllSRV;
+		desc.heap_type = GfxResourceUsage::Default;
+		desc.mip_levels = img.MipLevels() - first_mip;
+		desc.misc_flags = img.IsCubemap() ? GfxTextureMiscFlag::TextureCube : GfxTextureMiscFlag::None;
+
+		std::vector<GfxTextureSubData> tex_data;
+		Image const* curr_img = &img;
+		while (curr_img)
+		{
+			for (Uint32 i = first_mip; i < img.MipLevels(); ++i)
+			{
+				GfxTextureSubData& data = tex_data.emplace_back();
+				data.data = curr_img->MipData(i);
+				data.row_pitch = GetRowPitch(curr_img->Format(), img.Width(), i);
+				data.slice_pitch = GetSlicePitch(img.Format(), img.Width(), img.Height(), i);
+			}
+			curr_img = curr_img->NextImage();
+		}
+
+		GfxTextureData init_data{};
+		init_data.sub_data = tex_data.data();
+		init_data.sub_count = (Uint32)tex_data.size();
+		return gfx->CreateTexture(desc, init_data);
+	}
+
 	void TextureManager::CreateViewForTexture(TextureHandle handle, Bool flag)
 	{
         if (!is_scene_initialized && !flag) return;
 
 		GfxTexture* texture = texture_map[handle].get();
 		ADRIA_ASSERT(texture);
+		if (auto it = texture_srv_map.find(handle); it != texture_srv_map.end() && it->second.IsValid())
+		{
+			gfx->FreeDescriptorCPU(it->second, GfxDescriptorHeapType::CBV_SRV_UAV);
+		}
         texture_srv_map[handle] = gfx->CreateTextureSRV(texture);
         gfx->CopyDescriptors(1, gfx->GetDescriptorGPU((Uint32)handle), texture_srv_map[handle]);
 	}
 
-}
\ No newline at end of file
+	Bool TextureManager::ApplyResidencyChange(TextureResidencyChange const& change)
+	{
+		std::unique_ptr<GfxTexture>& texture = texture_map[change.handle];
+		if (change.new_dropped_mips > change.old_dropped_mips)
+		{
+			//the remaining mips are still resident, they are copied into a smaller texture
+			Uint32 const trimmed_mips = change.new_dropped_mips - change.old_dropped_mips;
+			GfxTextureDesc desc = texture->GetDesc();
+			desc.width = std::max(desc.width >> trimmed_mips, 1u);
+			desc.height = std::max(desc.height >> trimmed_mips, 1u);
+			desc.mip_levels -= trimmed_mips;
+			desc.initial_state = GfxResourceState::AllSRV;
+			std::unique_ptr<GfxTexture> trimmed_texture = gfx->CreateTexture(desc);
+
+			GfxCommandList* cmd_list = gfx->GetCommandList();
+			cmd_list->TextureBarrier(*texture, GfxResourceState::AllSRV, GfxResourceState::CopySrc);
+			cmd_list->TextureBarrier(*trimmed_texture, GfxResourceState::AllSRV, GfxResourceState::CopyDst);
+			cmd_list->FlushBarriers();
+			for (Uint32 mip = 0; mip < desc.mip_levels; ++mip)
+			{
+				cmd_list->CopyTexture(*trimmed_texture, mip, 0, *texture, mip + trimmed_mips, 0);
+			}
+			cmd_list->TextureBarrier(*trimmed_texture, GfxResourceState::CopyDst, GfxResourceState::AllSRV);
+			cmd_list->FlushBarriers();
+			texture = std::move(trimmed_texture);
+		}
+		else
+		{
+			//dropped mips are gone from the gpu, the texture is loaded again. if the file cannot be loaded or has changed, the trimmed texture stays
+			Image img(residency_paths[change.handle]);
+			if (img.MipLevels() != texture->GetDesc().mip_levels + change.old_dropped_mips)
+			{
+				ADRIA_LOG(WARNING, "Failed to stream in the mips of '%s', the texture stays trimmed", residency_paths[change.handle].c_str());
+				return false;
+			}
+			texture = CreateTexture(img, change.new_dropped_mips);
+		}
+		CreateViewForTexture(change.handle);
+		return true;
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "TextureHandle.h"
+#include "TextureResidency.h"
 #include "Graphics/GfxDescriptor.h"
 #include "Utilities/Singleton.h"
 #include "Utilities/Ref.h"
@@ -8,6 +9,8 @@ namespace adria
 {
 	class GfxDevice;
 	class GfxTexture;
+	class Image;
+	class VFSFile;
 
 	class TextureManager : public Singleton<TextureManager>
 	{
@@ -21,11 +24,18 @@ namespace adria
 
 		ADRIA_NODISCARD TextureHandle LoadTexture(std::string_view path);
 		ADRIA_NODISCARD TextureHandle LoadCubemap(std::array<std::string, 6> const& cubemap_textures);
+		//decodes the already read files in parallel, LoadTexture returns the preloaded textures afterwards
+		void PreloadTextures(std::span<std::string const> paths, std::span<VFSFile const> files);
 		ADRIA_NODISCARD GfxDescriptor GetSRV(TextureHandle handle);
 		ADRIA_NODISCARD GfxTexture* GetTexture(TextureHandle handle) const;
 		void EnableMipMaps(Bool);
 		void OnSceneInitialized();
 
+		//textures marked as used in the last frames keep their top mips when the textures do not fit into the budget
+		void MarkTextureUsed(TextureHandle handle);
+		void UpdateResidency(TextureResidencySettings const& settings);
+		TextureResidencyStats const& GetResidencyStats() const { return residency.GetStats(); }
+
 	private:
 		GfxDevice* gfx = nullptr;
 		
@@ -36,11 +46,19 @@ namespace adria
 		Bool mipmaps = true;
 		Bool is_scene_initialized = false;
 
+		TextureResidency residency;
+		std::unordered_map<TextureHandle, TextureName> residency_paths;
+		std::vector<TextureResidencyChange> residency_changes;
+		Uint64 residency_frame = 0;
+
 	private:
 		TextureManager();
 		~TextureManager();
 
+		TextureHandle AddTexture(std::string const& texture_name, Image const& img);
+		std::unique_ptr<GfxTexture> CreateTexture(Image const& img, Uint32 first_mip = 0);
 		void CreateViewForTexture(TextureHandle handle, Bool flag = false);
+		Bool ApplyResidencyChange(TextureResidencyChange const& change);
 	};
 	#define g_TextureManager TextureManager::Get()
 
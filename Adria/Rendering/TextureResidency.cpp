@@ -0,0 +1,152 @@
+#include "TextureResidency.h"
+
+namespace adria
+{
+	void TextureResidency::AddTexture(TextureHandle handle, std::span<Uint64 const> mip_sizes, Uint32 max_dropped_mips, Uint64 frame)
+	{
+		ADRIA_ASSERT(!mip_sizes.empty() && max_dropped_mips < mip_sizes.size());
+		ADRIA_ASSERT(!texture_indices.contains(handle));
+		texture_indices[handle] = (Uint32)textures.size();
+		TextureState& texture = textures.emplace_back();
+		texture.handle = handle;
+		texture.mip_sizes.assign(mip_sizes.begin(), mip_sizes.end());
+		texture.max_dropped_mips = max_dropped_mips;
+		texture.dropped_mips = 0;
+		texture.last_used_frame = frame;
+
+		Uint64 const size = ResidentSize(texture, 0);
+		stats.resident_bytes += size;
+		stats.full_resolution_bytes += size;
+	}
+
+	void TextureResidency::MarkUsed(TextureHandle handle, Uint64 frame)
+	{
+		if (auto it = texture_indices.find(handle); it != texture_indices.end())
+		{
+			textures[it->second].last_used_frame = frame;
+		}
+	}
+
+	void TextureResidency::Update(Uint64 frame, TextureResidencySettings const& settings, std::vector<TextureResidencyChange>& changes)
+	{
+		changes.clear();
+		Uint32 const texture_count = (Uint32)textures.size();
+		auto IsInUse = [&](TextureState const& texture) { return texture.last_used_frame + settings.unused_frames >= frame; };
+
+		wanted_dropped_mips.resize(texture_count);
+		Uint64 total_size = 0;
+		for (Uint32 i = 0; i < texture_count; ++i)
+		{
+			wanted_dropped_mips[i] = textures[i].dropped_mips;
+			total_size += ResidentSize(textures[i], wanted_dropped_mips[i]);
+		}
+
+		//least recently used first, ties are broken by handle
+		texture_order.resize(texture_count);
+		for (Uint32 i = 0; i < texture_count; ++i) texture_order[i] = i;
+		std::sort(texture_order.begin(), texture_order.end(), [this](Uint32 a, Uint32 b)
+			{
+				if (textures[a].last_used_frame != textures[b].last_used_frame) return textures[a].last_used_frame < textures[b].last_used_frame;
+				return textures[a].handle < textures[b].handle;
+			});
+
+		//unused textures are trimmed as far as they go
+		auto TrimUnused = [&](Uint64 target_size)
+		{
+			for (Uint32 i : texture_order)
+			{
+				if (total_size <= target_size) break;
+				TextureState const& texture = textures[i];
+				if (IsInUse(texture) || wanted_dropped_mips[i] >= texture.max_dropped_mips) continue;
+				total_size -= ResidentSize(texture, wanted_dropped_mips[i]) - ResidentSize(texture, texture.max_dropped_mips);
+				wanted_dropped_mips[i] = texture.max_dropped_mips;
+			}
+		};
+
+		if (total_size > settings.budget)
+		{
+			Uint64 const target_size = (Uint64)(settings.budget * (1.0 - settings.headroom));
+			TrimUnused(target_size);
+			//textures in use lose one mip per sweep
+			Bool trimmed = true;
+			while (total_size > target_size && trimmed)
+			{
+				trimmed = false;
+				for (Uint32 i : texture_order)
+				{
+					if (total_size <= target_size) break;
+					TextureState const& texture = textures[i];
+					if (wanted_dropped_mips[i] >= texture.max_dropped_mips) continue;
+					total_size -= ResidentSize(texture, wanted_dropped_mips[i]) - ResidentSize(texture, wanted_dropped_mips[i] + 1);
+					++wanted_dropped_mips[i];
+					trimmed = true;
+				}
+			}
+		}
+
+		//trimmed textures in use are streamed back in, most recently used first. only as many mips as fit into the budget
+		//come back, unused textures make room for them, so a texture trimmed under pressure is not streamed in again right away.
+		//a stream in reuploads the whole texture
+		Uint64 stream_in_bytes = 0;
+		Uint32 streamed_in_textures = 0;
+		for (auto it = texture_order.rbegin(); it != texture_order.rend(); ++it)
+		{
+			Uint32 const i = *it;
+			TextureState const& texture = textures[i];
+			//textures trimmed by this update stay trimmed
+			if (wanted_dropped_mips[i] == 0 || wanted_dropped_mips[i] != texture.dropped_mips || !IsInUse(texture)) continue;
+
+			Uint64 const current_size = ResidentSize(texture, wanted_dropped_mips[i]);
+			Uint64 const full_size = ResidentSize(texture, 0);
+			if (streamed_in_textures > 0 && stream_in_bytes + full_size > settings.stream_in_limit) break;
+			if (total_size - current_size + full_size > settings.budget)
+			{
+				Uint64 const growth = full_size - current_size;
+				TrimUnused(settings.budget > growth ? settings.budget - growth : 0);
+			}
+
+			Uint32 dropped_mips = 0;
+			while (dropped_mips < wanted_dropped_mips[i] && total_size - current_size + ResidentSize(texture, dropped_mips) > settings.budget) ++dropped_mips;
+			if (dropped_mips == wanted_dropped_mips[i]) continue;
+
+			total_size = total_size - current_size + ResidentSize(texture, dropped_mips);
+			wanted_dropped_mips[i] = dropped_mips;
+			stream_in_bytes += ResidentSize(texture, dropped_mips);
+			++streamed_in_textures;
+		}
+
+		stats = TextureResidencyStats{};
+		stats.streamed_in_textures = streamed_in_textures;
+		for (Uint32 i = 0; i < texture_count; ++i)
+		{
+			TextureState& texture = textures[i];
+			if (wanted_dropped_mips[i] != texture.dropped_mips)
+			{
+				changes.push_back(TextureResidencyChange{ .handle = texture.handle, .old_dropped_mips = texture.dropped_mips, .new_dropped_mips = wanted_dropped_mips[i] });
+				texture.dropped_mips = wanted_dropped_mips[i];
+			}
+			stats.resident_bytes += ResidentSize(texture, texture.dropped_mips);
+			stats.full_resolution_bytes += ResidentSize(texture, 0);
+			stats.trimmed_textures += texture.dropped_mips > 0;
+			stats.dropped_mips += texture.dropped_mips;
+		}
+	}
+
+	void TextureResidency::RevertChange(TextureResidencyChange const& change)
+	{
+		if (auto it = texture_indices.find(change.handle); it != texture_indices.end()) textures[it->second].dropped_mips = change.old_dropped_mips;
+	}
+
+	Uint32 TextureResidency::GetDroppedMips(TextureHandle handle) const
+	{
+		if (auto it = texture_indices.find(handle); it != texture_indices.end()) return textures[it->second].dropped_mips;
+		return 0;
+	}
+
+	Uint64 TextureResidency::ResidentSize(TextureState const& texture, Uint32 dropped_mips)
+	{
+		Uint64 size = 0;
+		for (Uint64 i = dropped_mips; i < texture.mip_sizes.size(); ++i) size += texture.mip_sizes[i];
+		return size;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "TextureHandle.h"
+
+namespace adria
+{
+	struct TextureResidencySettings
+	{
+		Uint64 budget = 0;
+		//once over the budget, textures are trimmed until they fit into budget * (1 - headroom), so the next frames do not trim again
+		Float headroom = 0.1f;
+		//textures not used for this many frames are trimmed before the ones still in use and are not streamed back in
+		Uint64 unused_frames = 60;
+		//bytes of mips streamed back in by one update, at least one texture is always streamed in
+		Uint64 stream_in_limit = 64ull << 20;
+	};
+
+	struct TextureResidencyChange
+	{
+		TextureHandle handle;
+		Uint32 old_dropped_mips;
+		Uint32 new_dropped_mips;
+	};
+
+	struct TextureResidencyStats
+	{
+		Uint64 resident_bytes = 0;
+		Uint64 full_resolution_bytes = 0;
+		Uint32 trimmed_textures = 0;
+		Uint32 dropped_mips = 0;
+		Uint32 streamed_in_textures = 0;
+	};
+
+	//decides how many of the top mips of each texture are resident so that the textures fit into a memory budget.
+	//does not touch the gpu, the caller applies the returned changes. the result only depends on the registered
+	//textures, their last used frames and the settings, ties are broken by handle
+	class TextureResidency
+	{
+		struct TextureState
+		{
+			TextureHandle handle;
+			std::vector<Uint64> mip_sizes;
+			Uint32 max_dropped_mips;
+			Uint32 dropped_mips;
+			Uint64 last_used_frame;
+		};
+
+	public:
+		//mip_sizes are the byte sizes of the full mip chain, max_dropped_mips is the number of top mips that can be trimmed
+		void AddTexture(TextureHandle handle, std::span<Uint64 const> mip_sizes, Uint32 max_dropped_mips, Uint64 frame);
+		void MarkUsed(TextureHandle handle, Uint64 frame);
+		void Update(Uint64 frame, TextureResidencySettings const& settings, std::vector<TextureResidencyChange>& changes);
+		//restores the dropped mips of a change the caller could not apply, the stats catch up in the next update
+		void RevertChange(TextureResidencyChange const& change);
+
+		Bool IsTracked(TextureHandle handle) const { return texture_indices.contains(handle); }
+		Uint32 GetDroppedMips(TextureHandle handle) const;
+		Uint64 GetResidentBytes() const { return stats.resident_bytes; }
+		TextureResidencyStats const& GetStats() const { return stats; }
+
+	private:
+		std::vector<TextureState> textures;
+		std::unordered_map<TextureHandle, Uint32> texture_indices;
+		std::vector<Uint32> wanted_dropped_mips;
+		std::vector<Uint32> texture_order;
+		TextureResidencyStats stats;
+
+	private:
+		static Uint64 ResidentSize(TextureState const& texture, Uint32 dropped_mips);
+	};
+}
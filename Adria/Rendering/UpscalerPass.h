@@ -10,14 +10,31 @@ namespace adria
 	public:
 		RenderResolutionChanged& GetRenderResolutionChangedEvent() { return render_resolution_changed_event; }
 
+		//scales the render resolution of the quality mode, the upscaler contexts are created for the unscaled resolution
+		//so changing the scale does not recreate them
+		void SetDynamicResolutionScale(Float scale)
+		{
+			if (dynamic_resolution_scale == scale) return;
+			dynamic_resolution_scale = scale;
+			OnDynamicResolutionScaleChanged();
+		}
+
 	private:
 		RenderResolutionChanged render_resolution_changed_event;
 
+	protected:
+		Float dynamic_resolution_scale = 1.0f;
+
 	protected:
 		void BroadcastRenderResolutionChanged(Uint32 w, Uint32 h)
 		{
 			render_resolution_changed_event.Broadcast(w, h);
 		}
+		Uint32 ApplyDynamicResolutionScale(Uint32 size, Uint32 min_size = 1) const
+		{
+			return std::clamp((Uint32)(size * dynamic_resolution_scale), std::min(min_size, size), size);
+		}
+		virtual void OnDynamicResolutionScaleChanged() {}
 	};
 
 	class EmptyUpscalerPass : public UpscalerPass
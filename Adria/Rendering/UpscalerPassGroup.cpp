@@ -37,6 +37,7 @@ namespace adria
 		post_effects[(Uint32)FSR3]  = std::make_unique<FSR3Pass>(gfx, width, height);
 		post_effects[(Uint32)XeSS]  = std::make_unique<XeSSPass>(gfx, width, height);
 		post_effects[(Uint32)DLSS3] = std::make_unique<DLSS3Pass>(gfx, width, height);
+		for (auto& post_effect : post_effects) post_effect->GetRenderResolutionChangedEvent().AddMember(&UpscalerPassGroup::OnRenderResolutionChanged, *this);
 	}
 
 	void UpscalerPassGroup::OnResize(Uint32 w, Uint32 h)
@@ -48,10 +49,23 @@ namespace adria
 		}
 		else
 		{
-			upscaler_disabled_event.Broadcast(display_width, display_height);
+			render_resolution_changed_event.Broadcast(display_width, display_height);
 		}
 	}
 
+	void UpscalerPassGroup::SetDynamicResolutionScale(Float scale)
+	{
+		if (upscaler_type != UpscalerType::None)
+		{
+			post_effects[(Uint32)upscaler_type]->SetDynamicResolutionScale(scale);
+		}
+	}
+
+	void UpscalerPassGroup::OnRenderResolutionChanged(Uint32 w, Uint32 h)
+	{
+		render_resolution_changed_event.Broadcast(w, h);
+	}
+
 	void UpscalerPassGroup::GroupGUI()
 	{
 		QueueGUI([&]()
@@ -74,7 +88,7 @@ namespace adria
 					}
 					else
 					{
-						upscaler_disabled_event.Broadcast(display_width, display_height);
+						render_resolution_changed_event.Broadcast(display_width, display_height);
 					}
 				}
 			}, GUICommandGroup_PostProcessing, GUICommandSubGroup_Upscaler);
@@ -11,24 +11,27 @@ namespace adria
 
 	class UpscalerPassGroup final : public TPostEffectGroup<UpscalerPass>
 	{
-		DECLARE_EVENT(UpscalerDisabledEvent, UpscalerPassGroup, Uint32, Uint32)
+		DECLARE_EVENT(RenderResolutionChangedEvent, UpscalerPassGroup, Uint32, Uint32)
 	public:
 		UpscalerPassGroup(GfxDevice* gfx, Uint32 width, Uint32 height);
 		virtual void OnResize(Uint32 w, Uint32 h) override;
 
-		void AddRenderResolutionChangedCallback(RenderResolutionChangedDelegate delegate)
+		void AddRenderResolutionChangedCallback(RenderResolutionChangedDelegate&& delegate)
 		{
-			for (auto& post_effect : post_effects) post_effect->GetRenderResolutionChangedEvent().Add(delegate);
-			upscaler_disabled_event.Add(delegate);
+			render_resolution_changed_event.Add(std::move(delegate));
 		}
+		//only the active upscaler is rescaled, the others pick up their scale the next time they are active
+		void SetDynamicResolutionScale(Float scale);
 
 	private:
 		UpscalerType upscaler_type;
-		UpscalerDisabledEvent upscaler_disabled_event;
+		//the upscalers forward their resolution changes to this event, it is also broadcast when the upscaler is disabled
+		RenderResolutionChangedEvent render_resolution_changed_event;
 		Uint32 display_width, display_height;
 
 	private:
 		virtual void GroupGUI() override;
+		void OnRenderResolutionChanged(Uint32 w, Uint32 h);
 	};
 }
 
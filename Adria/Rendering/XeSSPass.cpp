@@ -38,7 +38,7 @@ namespace adria
 	
 
 	XeSSPass::XeSSPass(GfxDevice* gfx, Uint32 w, Uint32 h) 
-		: gfx(gfx), display_width(), display_height(), render_width(), render_height()
+		: gfx(gfx), display_width(), display_height(), render_width(), render_height(), max_render_width(), max_render_height(), min_render_width(), min_render_height()
 	{
 		if (!gfx->GetCapabilities().SupportsRayTracing()) return;
 
@@ -172,10 +172,19 @@ namespace adria
 	void XeSSPass::RecreateRenderResolution()
 	{
 		xess_2d_t output_resolution = { display_width, display_height };
-		xess_2d_t input_resolution;
-		xessGetInputResolution(context, &output_resolution, quality_setting, &input_resolution);
-		render_width = input_resolution.x;
-		render_height = input_resolution.y;
+		xess_2d_t input_resolution, min_input_resolution, max_input_resolution;
+		xessGetOptimalInputResolution(context, &output_resolution, quality_setting, &input_resolution, &min_input_resolution, &max_input_resolution);
+		max_render_width = input_resolution.x;
+		max_render_height = input_resolution.y;
+		min_render_width = min_input_resolution.x;
+		min_render_height = min_input_resolution.y;
+		OnDynamicResolutionScaleChanged();
+	}
+
+	void XeSSPass::OnDynamicResolutionScaleChanged()
+	{
+		render_width = ApplyDynamicResolutionScale(max_render_width, min_render_width);
+		render_height = ApplyDynamicResolutionScale(max_render_height, min_render_height);
 		BroadcastRenderResolutionChanged(render_width, render_height);
 	}
 }
@@ -30,6 +30,8 @@ namespace adria
 		GfxDevice* gfx = nullptr;
 		Uint32 display_width, display_height;
 		Uint32 render_width, render_height;
+		Uint32 max_render_width, max_render_height;
+		Uint32 min_render_width, min_render_height;
 
 		xess_context_handle_t context{};
 		xess_quality_settings_t quality_setting = XESS_QUALITY_SETTING_QUALITY;
@@ -38,5 +40,6 @@ namespace adria
 	private:
 		void XeSSInit();
 		void RecreateRenderResolution();
+		virtual void OnDynamicResolutionScaleChanged() override;
 	};
 }
\ No newline at end of file
@@ -48,6 +48,8 @@ struct FrameCBuffer
 	int	   rainSplashBumpIdx;
 	int	   rainBlockerMapIdx;
 	float  rainTotalTime;
+
+	int    shadowAtlasRectsIdx;
 };
 ConstantBuffer<FrameCBuffer> FrameCB  : register(b0);
 
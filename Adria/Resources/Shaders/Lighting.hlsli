@@ -37,12 +37,12 @@ struct Light
 ///Shadows
 
 float CalcShadowFactor_PCF3x3(SamplerComparisonState shadowSampler,
-	Texture2D<float> shadowMap, float3 uvd, int shadowMapSize)
+	Texture2D<float> shadowMap, float3 uvd, float4 tileBounds, float texelSize)
 {
 	if (uvd.z > 1.0f) return 1.0;
 
 	float depth = uvd.z;
-	const float dx = 1.0f / shadowMapSize;
+	const float dx = texelSize;
 	float2 offsets[9] =
 	{
 		float2(-dx, -dx),  float2(0.0f, -dx),  float2(dx, -dx),
@@ -54,16 +54,39 @@ float CalcShadowFactor_PCF3x3(SamplerComparisonState shadowSampler,
 	[unroll(9)] 
 	for (int i = 0; i < 9; ++i)
 	{
-		percentLit += shadowMap.SampleCmpLevelZero(shadowSampler,
-			uvd.xy + offsets[i], depth);
+		//keep the taps inside the tile, neighbouring tiles belong to other views
+		float2 uv = clamp(uvd.xy + offsets[i], tileBounds.xy, tileBounds.zw);
+		percentLit += shadowMap.SampleCmpLevelZero(shadowSampler, uv, depth);
 	}
     percentLit /= 9.0f;
     return percentLit;
 }
 
-float GetShadowMapFactorWS(Light light, float3 worldPosition)
+//shadow atlas rect of a light matrix: xy is the tile size and zw the tile offset in atlas uv, zero when the view has no tile
+float CalcShadowFactor_Atlas(Light light, uint shadowMatrixIndex, float4 worldPosition)
 {
 	StructuredBuffer<float4x4> lightViewProjections = ResourceDescriptorHeap[FrameCB.lightsMatricesIdx];
+	StructuredBuffer<float4> shadowAtlasRects = ResourceDescriptorHeap[FrameCB.shadowAtlasRectsIdx];
+	float4 atlasRect = shadowAtlasRects[shadowMatrixIndex];
+	if (atlasRect.x == 0.0f) return 1.0f;
+
+	float4x4 lightViewProjection = lightViewProjections[shadowMatrixIndex];
+	float4 shadowMapPosition = mul(worldPosition, lightViewProjection);
+	float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
+	UVD.xy = 0.5 * UVD.xy + 0.5;
+	UVD.y = 1.0 - UVD.y;
+	UVD.xy = atlasRect.zw + saturate(UVD.xy) * atlasRect.xy;
+
+	Texture2D<float> shadowAtlas = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex)];
+	uint atlasWidth, atlasHeight;
+	shadowAtlas.GetDimensions(atlasWidth, atlasHeight);
+	float texelSize = 1.0f / atlasWidth;
+	float4 tileBounds = float4(atlasRect.zw + 0.5f * texelSize, atlasRect.zw + atlasRect.xy - 0.5f * texelSize);
+	return CalcShadowFactor_PCF3x3(ShadowClampSampler, shadowAtlas, UVD, tileBounds, texelSize);
+}
+
+float GetShadowMapFactorWS(Light light, float3 worldPosition)
+{
 	bool castsShadows = light.shadowTextureIndex >= 0;
 	float shadowFactor = 1.0f;
 	if (castsShadows)
@@ -78,29 +101,16 @@ float GetShadowMapFactorWS(Light light, float3 worldPosition)
 				float viewDepth = viewPosition.z;
 				for (uint i = 0; i < 4; ++i)
 				{
-					float4x4 lightViewProjection = lightViewProjections[light.shadowMatrixIndex + i];
-					float4 shadowMapPosition = mul(float4(worldPosition, 1.0f), lightViewProjection);
-					float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
-					UVD.xy = 0.5 * UVD.xy + 0.5;
-					UVD.y = 1.0 - UVD.y;
-
 					if (viewDepth < FrameCB.cascadeSplits[i])
 					{
-						Texture2D<float> shadowMap = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex + i)];
-						shadowFactor = CalcShadowFactor_PCF3x3(ShadowWrapSampler, shadowMap, UVD, 2048);
+						shadowFactor = CalcShadowFactor_Atlas(light, light.shadowMatrixIndex + i, float4(worldPosition, 1.0f));
 						break;
 					}
 				}
 			}
 			else
 			{
-				float4x4 lightViewProjection = lightViewProjections[light.shadowMatrixIndex];
-				float4 shadowMapPosition = mul(float4(worldPosition, 1.0f), lightViewProjection);
-				float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
-				UVD.xy = 0.5 * UVD.xy + 0.5;
-				UVD.y = 1.0 - UVD.y;
-				Texture2D<float> shadowMap = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex)];
-				shadowFactor = CalcShadowFactor_PCF3x3(ShadowWrapSampler, shadowMap, UVD, 1024);
+				shadowFactor = CalcShadowFactor_Atlas(light, light.shadowMatrixIndex, float4(worldPosition, 1.0f));
 			}
 		}
 		break;
@@ -108,24 +118,12 @@ float GetShadowMapFactorWS(Light light, float3 worldPosition)
 		{
 			float3 lightToPixelWS = worldPosition - light.position.xyz;
 			uint cubeFaceIndex = GetCubeFaceIndex(lightToPixelWS);
-			float4x4 lightViewProjection = lightViewProjections[light.shadowMatrixIndex + cubeFaceIndex];
-			float4 shadowMapPosition = mul(float4(worldPosition, 1.0f), lightViewProjection);
-			float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
-			UVD.xy = 0.5 * UVD.xy + 0.5;
-			UVD.y = 1.0 - UVD.y;
-			Texture2D<float> shadowMap = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex + cubeFaceIndex)];
-			shadowFactor = CalcShadowFactor_PCF3x3(ShadowWrapSampler, shadowMap, UVD, 512);
+			shadowFactor = CalcShadowFactor_Atlas(light, light.shadowMatrixIndex + cubeFaceIndex, float4(worldPosition, 1.0f));
 		}
 		break;
 		case SPOT_LIGHT:
 		{
-			float4x4 lightViewProjection = lightViewProjections[light.shadowMatrixIndex];
-			float4 shadowMapPosition = mul(float4(worldPosition, 1.0f), lightViewProjection);
-			float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
-			UVD.xy = 0.5 * UVD.xy + 0.5;
-			UVD.y = 1.0 - UVD.y;
-			Texture2D<float> shadowMap = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex)];
-			shadowFactor = CalcShadowFactor_PCF3x3(ShadowWrapSampler, shadowMap, UVD, 1024);
+			shadowFactor = CalcShadowFactor_Atlas(light, light.shadowMatrixIndex, float4(worldPosition, 1.0f));
 		}
 		break;
 		}
@@ -135,11 +133,12 @@ float GetShadowMapFactorWS(Light light, float3 worldPosition)
 
 float GetShadowMapFactor(Light light, float3 viewPosition)
 {
-	StructuredBuffer<float4x4> lightViewProjections = ResourceDescriptorHeap[FrameCB.lightsMatricesIdx];
 	bool castsShadows = light.shadowTextureIndex >= 0;
 	float shadowFactor = 1.0f;
 	if (castsShadows)
 	{
+		float4 worldPosition = mul(float4(viewPosition, 1.0f), FrameCB.inverseView);
+		worldPosition /= worldPosition.w;
 		switch (light.type)
 		{
 		case DIRECTIONAL_LIGHT:
@@ -149,33 +148,16 @@ float GetShadowMapFactor(Light light, float3 viewPosition)
 				float viewDepth = viewPosition.z;
 				for (uint i = 0; i < 4; ++i)
 				{
-					float4 worldPosition = mul(float4(viewPosition, 1.0f), FrameCB.inverseView);
-					worldPosition /= worldPosition.w;
-					float4x4 lightViewProjection = lightViewProjections[light.shadowMatrixIndex + i];
-					float4 shadowMapPosition = mul(worldPosition, lightViewProjection);
-					float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
-					UVD.xy = 0.5 * UVD.xy + 0.5;
-					UVD.y = 1.0 - UVD.y;
-
 					if (viewDepth < FrameCB.cascadeSplits[i])
 					{
-						Texture2D<float> shadowMap = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex + i)];
-						shadowFactor = CalcShadowFactor_PCF3x3(ShadowWrapSampler, shadowMap, UVD, 2048);
+						shadowFactor = CalcShadowFactor_Atlas(light, light.shadowMatrixIndex + i, worldPosition);
 						break;
 					}
 				}
 			}
 			else
 			{
-				float4 worldPosition = mul(float4(viewPosition, 1.0f), FrameCB.inverseView);
-				worldPosition /= worldPosition.w;
-				float4x4 lightViewProjection = lightViewProjections[light.shadowMatrixIndex];
-				float4 shadowMapPosition = mul(worldPosition, lightViewProjection);
-				float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
-				UVD.xy = 0.5 * UVD.xy + 0.5;
-				UVD.y = 1.0 - UVD.y;
-				Texture2D<float> shadowMap = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex)];
-				shadowFactor = CalcShadowFactor_PCF3x3(ShadowWrapSampler, shadowMap, UVD, 1024);
+				shadowFactor = CalcShadowFactor_Atlas(light, light.shadowMatrixIndex, worldPosition);
 			}
 		}
 		break;
@@ -183,28 +165,12 @@ float GetShadowMapFactor(Light light, float3 viewPosition)
 		{
 			float3 lightToPixelWS = mul(float4(viewPosition - light.position.xyz, 0.0f), FrameCB.inverseView).xyz;
 			uint cubeFaceIndex = GetCubeFaceIndex(lightToPixelWS);
-			float4 worldPosition = mul(float4(viewPosition, 1.0f), FrameCB.inverseView);
-			worldPosition /= worldPosition.w;
-			float4x4 lightViewProjection = lightViewProjections[light.shadowMatrixIndex + cubeFaceIndex];
-			float4 shadowMapPosition = mul(worldPosition, lightViewProjection);
-			float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
-			UVD.xy = 0.5 * UVD.xy + 0.5;
-			UVD.y = 1.0 - UVD.y;
-			Texture2D<float> shadowMap = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex + cubeFaceIndex)];
-			shadowFactor = CalcShadowFactor_PCF3x3(ShadowWrapSampler, shadowMap, UVD, 512);
+			shadowFactor = CalcShadowFactor_Atlas(light, light.shadowMatrixIndex + cubeFaceIndex, worldPosition);
 		}
 		break;
 		case SPOT_LIGHT:
 		{
-			float4 worldPosition = mul(float4(viewPosition, 1.0f), FrameCB.inverseView);
-			worldPosition /= worldPosition.w;
-			float4x4 lightViewProjection = lightViewProjections[light.shadowMatrixIndex];
-			float4 shadowMapPosition = mul(worldPosition, lightViewProjection);
-			float3 UVD = shadowMapPosition.xyz / shadowMapPosition.w;
-			UVD.xy = 0.5 * UVD.xy + 0.5;
-			UVD.y = 1.0 - UVD.y;
-			Texture2D<float> shadowMap = ResourceDescriptorHeap[NonUniformResourceIndex(light.shadowTextureIndex)];
-			shadowFactor = CalcShadowFactor_PCF3x3(ShadowWrapSampler, shadowMap, UVD, 1024);
+			shadowFactor = CalcShadowFactor_Atlas(light, light.shadowMatrixIndex, worldPosition);
 		}
 		break;
 		}
@@ -85,7 +85,7 @@ void ClusterCullingCS(CSInput input)
 		GroupMemoryBarrierWithGroupSync();
 		for (uint i = 0; i < batchSize; i++)
 		{
-			Light light = lightBuffer[i];
+			Light light = SharedLights[i];
 			if (!light.active) continue;
 			if (visibleLightCount < MAX_CLUSTER_LIGHTS && LightIntersectsCluster(light, cluster))
 			{
@@ -94,6 +94,7 @@ void ClusterCullingCS(CSInput input)
 			}
 		}
 		lightOffset += batchSize;
+		GroupMemoryBarrierWithGroupSync();
 	}
 	GroupMemoryBarrierWithGroupSync();
 	uint offset = 0;
@@ -34,13 +34,13 @@ VSToPS ShadowVS(uint VertexId : SV_VertexID)
 	Instance instanceData = GetInstanceData(ModelCB.instanceId);
 	Mesh meshData = GetMeshData(instanceData.meshIndex);
 
-	float3 pos = LoadMeshBuffer<float3>(meshData.bufferIdx, meshData.positionsOffset, VertexId);
+	float3 pos = LoadMeshPosition(meshData, VertexId);
 	float4 posWS = mul(float4(pos, 1.0f), instanceData.worldMatrix);
 	float4 posLS = mul(posWS, lightViewProjection);
 	output.Pos = posLS;
 
 #if TRANSPARENT
-	float2 uv = LoadMeshBuffer<float2>(meshData.bufferIdx, meshData.uvsOffset, VertexId);
+	float2 uv = LoadMeshUV(meshData, VertexId);
 	output.TexCoords = uv;
 #endif
 	return output;
@@ -13,6 +13,10 @@
 #define OCCLUSION_CULL 1
 #endif
 
+#ifndef CONE_CULL
+#define CONE_CULL 1
+#endif
+
 
 struct CullMeshletsConstants
 {
@@ -21,6 +25,7 @@ struct CullMeshletsConstants
 	uint candidateMeshletsCounterIdx;
 	uint visibleMeshletsIdx;
 	uint visibleMeshletsCounterIdx;
+	float lodErrorScale;
 };
 ConstantBuffer<CullMeshletsConstants> CullMeshletsPassCB : register(b1);
 
@@ -47,10 +52,17 @@ void CullMeshletsCS(uint ThreadId : SV_DispatchThreadID)
 	Instance instance = GetInstanceData(candidate.instanceID);
 	Mesh mesh = GetMeshData(instance.meshIndex);
 	Meshlet meshlet = GetMeshletData(mesh.bufferIdx, mesh.meshletOffset, candidate.meshletIndex);
+	//meshlets outside the lod cut are neither drawn nor retested in the second phase
+	if (!IsMeshletInLODCut(meshlet, instance.worldMatrix, FrameCB.cameraPosition.xyz, CullMeshletsPassCB.lodErrorScale)) return;
+
 	FrustumCullData cullData = FrustumCull(meshlet.center, meshlet.radius.xxx, instance.worldMatrix, FrameCB.viewProjection);
 	bool isVisible = cullData.isVisible;
 	bool wasOccluded = false;
 
+#if CONE_CULL
+	isVisible = isVisible && !ConeCull(meshlet, instance.worldMatrix, FrameCB.cameraPosition.xyz);
+#endif
+
 #if OCCLUSION_CULL
 	if (isVisible)
 	{
@@ -196,15 +196,25 @@ struct MeshletTriangle
 	uint : 2;
 };
 
+struct MeshletLODBounds
+{
+	float3 center;
+	float  radius;
+	float  error;
+};
+
 struct Meshlet
 {
 	float3 center;
 	float  radius;
-	//add cone stuff
+	float3 coneApex;
+	uint   coneAxisCutoff;
 	uint vertexCount;
 	uint triangleCount;
 	uint vertexOffset;
 	uint triangleOffset;
+	MeshletLODBounds lodBounds;
+	MeshletLODBounds parentLodBounds;
 };
 
 Meshlet GetMeshletData(uint bufferIdx, uint bufferOffset, uint meshletIdx)
@@ -213,4 +223,42 @@ Meshlet GetMeshletData(uint bufferIdx, uint bufferOffset, uint meshletIdx)
 	return meshBuffer.Load<Meshlet>(bufferOffset + sizeof(Meshlet) * meshletIdx);
 }
 
+//axis in xyz and cutoff in w, packed as 8 bit snorm
+float4 UnpackMeshletCone(uint coneAxisCutoff)
+{
+	int4 cone = asint(uint4(coneAxisCutoff << 24, coneAxisCutoff << 16, coneAxisCutoff << 8, coneAxisCutoff)) >> 24;
+	return cone / 127.0f;
+}
+
+//true if all triangles of the meshlet face away from the camera, a cutoff of 1 disables the test
+bool ConeCull(Meshlet meshlet, float4x4 localToWorld, float3 cameraPosition)
+{
+	float4 cone = UnpackMeshletCone(meshlet.coneAxisCutoff);
+	if (cone.w >= 1.0f) return false;
+
+	float3 apex = mul(float4(meshlet.coneApex, 1), localToWorld).xyz;
+	//normals transform with the cofactor matrix, the inverse transpose scaled by the determinant
+	float3x3 cofactor = float3x3(cross(localToWorld[1].xyz, localToWorld[2].xyz), cross(localToWorld[2].xyz, localToWorld[0].xyz), cross(localToWorld[0].xyz, localToWorld[1].xyz));
+	float3 axis = normalize(mul(cone.xyz, cofactor));
+	return dot(normalize(apex - cameraPosition), axis) >= cone.w;
+}
+
+#define MESHLET_LOD_MIN_DISTANCE 1e-4f
+
+//object space error projected to the screen in units of the lod threshold, errorScale is 0.5 * viewport height * projection._22 / threshold
+float MeshletLODProjectedError(MeshletLODBounds bounds, float4x4 localToWorld, float3 cameraPosition, float errorScale)
+{
+	float3 center = mul(float4(bounds.center, 1), localToWorld).xyz;
+	float scale = sqrt(max(max(dot(localToWorld[0].xyz, localToWorld[0].xyz), dot(localToWorld[1].xyz, localToWorld[1].xyz)), dot(localToWorld[2].xyz, localToWorld[2].xyz)));
+	float distance = max(length(center - cameraPosition) - bounds.radius * scale, MESHLET_LOD_MIN_DISTANCE);
+	return bounds.error * scale * errorScale / distance;
+}
+
+//the cut of the cluster lod hierarchy, meshlets that are detailed enough while their parents are not
+bool IsMeshletInLODCut(Meshlet meshlet, float4x4 localToWorld, float3 cameraPosition, float errorScale)
+{
+	return MeshletLODProjectedError(meshlet.lodBounds, localToWorld, cameraPosition, errorScale) <= 1.0f &&
+		   MeshletLODProjectedError(meshlet.parentLodBounds, localToWorld, cameraPosition, errorScale) > 1.0f;
+}
+
 #endif
\ No newline at end of file
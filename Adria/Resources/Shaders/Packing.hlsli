@@ -79,4 +79,27 @@ float3 DecodeNormal16x2(uint f)
     return DecodeNormalOctahedron(n * 2.0 - 1.0);
 }
 
+uint EncodeTangent15x2(float4 t)
+{
+    float2 v = EncodeNormalOctahedron(t.xyz) * 0.5 + 0.5;
+    uint2 u15 = (uint2)round(v * 32767.0);
+    uint sign = t.w < 0.0 ? 1 : 0;
+
+    return (sign << 31) | (u15.x << 15) | u15.y;
+}
+
+float4 DecodeTangent15x2(uint f)
+{
+    uint2 u15 = uint2((f >> 15) & 0x7fff, f & 0x7fff);
+    float2 n = u15 / 32767.0;
+
+    return float4(DecodeNormalOctahedron(n * 2.0 - 1.0), (f >> 31) ? -1.0 : 1.0);
+}
+
+float3 DequantizePosition(uint2 packed, float3 bias, float3 scale)
+{
+    float3 unorm = float3(packed.x & 0xffff, packed.x >> 16, packed.y & 0xffff) / 65535.0;
+    return bias + unorm * scale;
+}
+
 #endif
\ No newline at end of file
@@ -1,6 +1,11 @@
 #ifndef _SCENE_
 #define _SCENE_
 #include "CommonResources.hlsli"
+#include "Packing.hlsli"
+
+#define MESH_QUANTIZED_POSITIONS  0x1
+#define MESH_QUANTIZED_NORMALS	  0x2
+#define MESH_QUANTIZED_UVS		  0x4
 
 struct Mesh
 {
@@ -14,6 +19,9 @@ struct Mesh
 	uint meshletVerticesOffset;
 	uint meshletTrianglesOffset;
 	uint meshletCount;
+	uint vertexFlags;
+	float3 positionBias;
+	float3 positionScale;
 };
 
 struct Material
@@ -68,6 +76,41 @@ T LoadMeshBuffer(uint bufferIdx, uint bufferOffset, uint vertexId)
 	return meshBuffer.Load<T>(bufferOffset + sizeof(T) * vertexId);
 }
 
+//quantized streams: positions are uint2 (16 bit unorm in the mesh bounding box), normals and tangents
+//are octahedral encoded uints and uvs are half2, see EntityLoader
+float3 LoadMeshPosition(Mesh mesh, uint vertexId)
+{
+	if (mesh.vertexFlags & MESH_QUANTIZED_POSITIONS)
+	{
+		return DequantizePosition(LoadMeshBuffer<uint2>(mesh.bufferIdx, mesh.positionsOffset, vertexId), mesh.positionBias, mesh.positionScale);
+	}
+	return LoadMeshBuffer<float3>(mesh.bufferIdx, mesh.positionsOffset, vertexId);
+}
+float2 LoadMeshUV(Mesh mesh, uint vertexId)
+{
+	if (mesh.vertexFlags & MESH_QUANTIZED_UVS)
+	{
+		return UnpackHalf2(LoadMeshBuffer<uint>(mesh.bufferIdx, mesh.uvsOffset, vertexId));
+	}
+	return LoadMeshBuffer<float2>(mesh.bufferIdx, mesh.uvsOffset, vertexId);
+}
+float3 LoadMeshNormal(Mesh mesh, uint vertexId)
+{
+	if (mesh.vertexFlags & MESH_QUANTIZED_NORMALS)
+	{
+		return DecodeNormal16x2(LoadMeshBuffer<uint>(mesh.bufferIdx, mesh.normalsOffset, vertexId));
+	}
+	return LoadMeshBuffer<float3>(mesh.bufferIdx, mesh.normalsOffset, vertexId);
+}
+float4 LoadMeshTangent(Mesh mesh, uint vertexId)
+{
+	if (mesh.vertexFlags & MESH_QUANTIZED_NORMALS)
+	{
+		return DecodeTangent15x2(LoadMeshBuffer<uint>(mesh.bufferIdx, mesh.tangentsOffset, vertexId));
+	}
+	return LoadMeshBuffer<float4>(mesh.bufferIdx, mesh.tangentsOffset, vertexId);
+}
+
 struct VertexData
 {
 	float3 pos;
@@ -90,19 +133,19 @@ VertexData LoadVertexData(Mesh meshData, uint triangleIndex, float2 barycentrics
 	uint i1 = LoadMeshBuffer<uint>(meshData.bufferIdx, meshData.indicesOffset, 3 * triangleIndex + 1);
 	uint i2 = LoadMeshBuffer<uint>(meshData.bufferIdx, meshData.indicesOffset, 3 * triangleIndex + 2);
 
-	float3 pos0 = LoadMeshBuffer<float3>(meshData.bufferIdx, meshData.positionsOffset, i0);
-	float3 pos1 = LoadMeshBuffer<float3>(meshData.bufferIdx, meshData.positionsOffset, i1);
-	float3 pos2 = LoadMeshBuffer<float3>(meshData.bufferIdx, meshData.positionsOffset, i2);
+	float3 pos0 = LoadMeshPosition(meshData, i0);
+	float3 pos1 = LoadMeshPosition(meshData, i1);
+	float3 pos2 = LoadMeshPosition(meshData, i2);
 	float3 pos = Interpolate(pos0, pos1, pos2, barycentrics);
 
-	float2 uv0 = LoadMeshBuffer<float2>(meshData.bufferIdx, meshData.uvsOffset, i0);
-	float2 uv1 = LoadMeshBuffer<float2>(meshData.bufferIdx, meshData.uvsOffset, i1);
-	float2 uv2 = LoadMeshBuffer<float2>(meshData.bufferIdx, meshData.uvsOffset, i2);
+	float2 uv0 = LoadMeshUV(meshData, i0);
+	float2 uv1 = LoadMeshUV(meshData, i1);
+	float2 uv2 = LoadMeshUV(meshData, i2);
 	float2 uv = Interpolate(uv0, uv1, uv2, barycentrics);
 
-	float3 nor0 = LoadMeshBuffer<float3>(meshData.bufferIdx, meshData.normalsOffset, i0);
-	float3 nor1 = LoadMeshBuffer<float3>(meshData.bufferIdx, meshData.normalsOffset, i1);
-	float3 nor2 = LoadMeshBuffer<float3>(meshData.bufferIdx, meshData.normalsOffset, i2);
+	float3 nor0 = LoadMeshNormal(meshData, i0);
+	float3 nor1 = LoadMeshNormal(meshData, i1);
+	float3 nor2 = LoadMeshNormal(meshData, i2);
 	float3 nor = normalize(Interpolate(nor0, nor1, nor2, barycentrics));
 
 	VertexData vertex = (VertexData)0;
@@ -0,0 +1,153 @@
+#include <bit>
+#include "AtlasAllocator.h"
+
+namespace adria
+{
+	AtlasAllocator::AtlasAllocator(Uint32 atlas_size, Uint32 min_tile_size) : atlas_size(atlas_size), min_tile_size(min_tile_size)
+	{
+		ADRIA_ASSERT(std::has_single_bit(atlas_size) && std::has_single_bit(min_tile_size) && min_tile_size <= atlas_size);
+		level_count = std::countr_zero(atlas_size / min_tile_size) + 1;
+
+		Uint32 node_count = 0;
+		level_offsets.resize(level_count);
+		for (Uint32 level = 0; level < level_count; ++level)
+		{
+			level_offsets[level] = node_count;
+			node_count += LevelTileCount(level) * LevelTileCount(level);
+		}
+		nodes.resize(node_count);
+		free_list_positions.resize(node_count);
+		free_lists.resize(level_count);
+		Reset();
+	}
+
+	AtlasTile AtlasAllocator::Allocate(Uint32 tile_size)
+	{
+		tile_size = std::max(std::bit_ceil(tile_size), min_tile_size);
+		if (tile_size > atlas_size) return AtlasTile{};
+		Uint32 const target_level = std::countr_zero(atlas_size / tile_size);
+
+		//take the smallest free tile that fits, splitting it down to the requested size
+		Sint32 level = (Sint32)target_level;
+		while (level >= 0 && free_lists[level].empty()) --level;
+		if (level < 0) return AtlasTile{};
+
+		Uint32 node = free_lists[level].back();
+		RemoveFree(level, node);
+		for (; level < (Sint32)target_level; ++level)
+		{
+			nodes[node] = NodeState::Split;
+			Uint32 const local_index = node - level_offsets[level];
+			Uint32 const x = (local_index % LevelTileCount(level)) * 2;
+			Uint32 const y = (local_index / LevelTileCount(level)) * 2;
+			PushFree(level + 1, NodeIndex(level + 1, x + 1, y + 1));
+			PushFree(level + 1, NodeIndex(level + 1, x, y + 1));
+			PushFree(level + 1, NodeIndex(level + 1, x + 1, y));
+			node = NodeIndex(level + 1, x, y);
+		}
+		nodes[node] = NodeState::Allocated;
+		++allocation_count;
+		allocated_area += (Uint64)tile_size * tile_size;
+
+		Uint32 const local_index = node - level_offsets[target_level];
+		AtlasTile tile{};
+		tile.x = (local_index % LevelTileCount(target_level)) * tile_size;
+		tile.y = (local_index / LevelTileCount(target_level)) * tile_size;
+		tile.size = tile_size;
+		tile.node = node;
+		return tile;
+	}
+
+	void AtlasAllocator::Free(AtlasTile const& tile)
+	{
+		if (!tile.IsValid()) return;
+		ADRIA_ASSERT(nodes[tile.node] == NodeState::Allocated);
+
+		--allocation_count;
+		allocated_area -= (Uint64)tile.size * tile.size;
+
+		Uint32 level = std::countr_zero(atlas_size / tile.size);
+		Uint32 x = tile.x / tile.size;
+		Uint32 y = tile.y / tile.size;
+		Uint32 node = tile.node;
+		while (level > 0)
+		{
+			Uint32 const sibling_x = x & ~1u;
+			Uint32 const sibling_y = y & ~1u;
+			Bool siblings_free = true;
+			for (Uint32 i = 0; i < 4; ++i)
+			{
+				Uint32 const sibling = NodeIndex(level, sibling_x + (i & 1), sibling_y + (i >> 1));
+				if (sibling != node && nodes[sibling] != NodeState::Free)
+				{
+					siblings_free = false;
+					break;
+				}
+			}
+			if (!siblings_free) break;
+
+			for (Uint32 i = 0; i < 4; ++i)
+			{
+				Uint32 const sibling = NodeIndex(level, sibling_x + (i & 1), sibling_y + (i >> 1));
+				if (sibling != node) RemoveFree(level, sibling);
+				nodes[sibling] = NodeState::Unused;
+			}
+			--level;
+			x /= 2;
+			y /= 2;
+			node = NodeIndex(level, x, y);
+		}
+		PushFree(level, node);
+	}
+
+	void AtlasAllocator::Reset()
+	{
+		std::fill(nodes.begin(), nodes.end(), NodeState::Unused);
+		for (auto& free_list : free_lists) free_list.clear();
+		allocation_count = 0;
+		allocated_area = 0;
+		PushFree(0, 0);
+	}
+
+	Uint32 AtlasAllocator::GetLargestFreeTileSize() const
+	{
+		for (Uint32 level = 0; level < level_count; ++level)
+		{
+			if (!free_lists[level].empty()) return LevelTileSize(level);
+		}
+		return 0;
+	}
+
+	AtlasAllocatorStats AtlasAllocator::GetStats() const
+	{
+		AtlasAllocatorStats stats{};
+		stats.total_area = (Uint64)atlas_size * atlas_size;
+		stats.allocated_area = allocated_area;
+		stats.free_area = stats.total_area - allocated_area;
+		stats.allocation_count = allocation_count;
+		for (auto const& free_list : free_lists) stats.free_tile_count += (Uint32)free_list.size();
+		stats.largest_free_tile = GetLargestFreeTileSize();
+		if (stats.free_area > 0)
+		{
+			Uint64 const largest_free_area = (Uint64)stats.largest_free_tile * stats.largest_free_tile;
+			stats.fragmentation = 1.0f - (Float)((Float64)largest_free_area / stats.free_area);
+		}
+		return stats;
+	}
+
+	void AtlasAllocator::PushFree(Uint32 level, Uint32 node)
+	{
+		nodes[node] = NodeState::Free;
+		free_list_positions[node] = (Uint32)free_lists[level].size();
+		free_lists[level].push_back(node);
+	}
+
+	void AtlasAllocator::RemoveFree(Uint32 level, Uint32 node)
+	{
+		std::vector<Uint32>& free_list = free_lists[level];
+		Uint32 const position = free_list_positions[node];
+		free_list[position] = free_list.back();
+		free_list_positions[free_list[position]] = position;
+		free_list.pop_back();
+	}
+}
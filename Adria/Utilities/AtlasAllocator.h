@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+
+namespace adria
+{
+	struct AtlasTile
+	{
+		static constexpr Uint32 InvalidNode = Uint32(-1);
+
+		Uint32 x = 0;
+		Uint32 y = 0;
+		Uint32 size = 0;
+		Uint32 node = InvalidNode;
+
+		Bool IsValid() const { return node != InvalidNode; }
+	};
+
+	struct AtlasAllocatorStats
+	{
+		Uint64 total_area = 0;
+		Uint64 allocated_area = 0;
+		Uint64 free_area = 0;
+		Uint32 allocation_count = 0;
+		Uint32 free_tile_count = 0;
+		Uint32 largest_free_tile = 0;
+		//1 - largest free tile area / free area, 0 when all free space is in one tile
+		Float fragmentation = 0.0f;
+	};
+
+	//quadtree (2D buddy) allocator of square, power of two tiles inside a square atlas.
+	//freed tiles are merged with their siblings so the atlas can be reused for differently sized tiles
+	class AtlasAllocator
+	{
+		enum class NodeState : Uint8
+		{
+			Unused,
+			Free,
+			Split,
+			Allocated
+		};
+
+	public:
+		AtlasAllocator(Uint32 atlas_size, Uint32 min_tile_size);
+
+		//tile_size is rounded up to a power of two, returns an invalid tile if there is no space
+		AtlasTile Allocate(Uint32 tile_size);
+		void Free(AtlasTile const& tile);
+		void Reset();
+
+		Uint32 GetAtlasSize() const { return atlas_size; }
+		Uint32 GetMinTileSize() const { return min_tile_size; }
+		Uint32 GetLargestFreeTileSize() const;
+		AtlasAllocatorStats GetStats() const;
+
+	private:
+		Uint32 atlas_size;
+		Uint32 min_tile_size;
+		Uint32 level_count;
+		std::vector<Uint32> level_offsets;
+		std::vector<NodeState> nodes;
+		std::vector<std::vector<Uint32>> free_lists;
+		std::vector<Uint32> free_list_positions;
+		Uint32 allocation_count = 0;
+		Uint64 allocated_area = 0;
+
+	private:
+		Uint32 LevelTileCount(Uint32 level) const { return 1u << level; }
+		Uint32 LevelTileSize(Uint32 level) const { return atlas_size >> level; }
+		Uint32 NodeIndex(Uint32 level, Uint32 x, Uint32 y) const { return level_offsets[level] + y * LevelTileCount(level) + x; }
+		void PushFree(Uint32 level, Uint32 node);
+		void RemoveFree(Uint32 level, Uint32 node);
+	};
+}
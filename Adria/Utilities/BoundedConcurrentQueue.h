@@ -0,0 +1,291 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+namespace adria
+{
+	//bounded lock-free multi-producer multi-consumer ring (Vyukov). Every cell carries a sequence number:
+	//sequence == position means the cell is free for the producer of that position,
+	//sequence == position + 1 means it holds a value for the consumer of that position
+	template<typename T>
+	class BoundedConcurrentQueue
+	{
+		static constexpr Uint64 CacheLineSize = 64;
+
+		struct alignas(CacheLineSize) Cell
+		{
+			std::atomic<Uint64> sequence;
+			alignas(T) Uint8 storage[sizeof(T)];
+
+			T* Get() { return std::launder(reinterpret_cast<T*>(storage)); }
+		};
+
+	public:
+		explicit BoundedConcurrentQueue(Uint64 capacity = 1024) : cells(new Cell[capacity]), mask(capacity - 1)
+		{
+			ADRIA_ASSERT_MSG(capacity >= 2 && (capacity & (capacity - 1)) == 0, "BoundedConcurrentQueue capacity must be a power of two");
+			for (Uint64 i = 0; i < capacity; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		ADRIA_NONCOPYABLE_NONMOVABLE(BoundedConcurrentQueue)
+		~BoundedConcurrentQueue()
+		{
+			Uint64 const end = enqueue_position.load(std::memory_order_acquire);
+			for (Uint64 position = dequeue_position.load(std::memory_order_acquire); position != end; ++position)
+			{
+				Cell& cell = cells[position & mask];
+				if (cell.sequence.load(std::memory_order_acquire) == position + 1) cell.Get()->~T();
+			}
+		}
+
+		template<typename... Args>
+		Bool TryEmplace(Args&&... args)
+		{
+			Uint64 position = enqueue_position.load(std::memory_order_relaxed);
+			while (true)
+			{
+				Cell& cell = cells[position & mask];
+				Uint64 const sequence = cell.sequence.load(std::memory_order_acquire);
+				Sint64 const diff = (Sint64)sequence - (Sint64)position;
+				if (diff == 0)
+				{
+					if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						new (cell.storage) T(std::forward<Args>(args)...);
+						cell.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0) return false;
+				else position = enqueue_position.load(std::memory_order_relaxed);
+			}
+		}
+		Bool TryPush(T const& value)
+		{
+			return TryEmplace(value);
+		}
+		Bool TryPush(T&& value)
+		{
+			return TryEmplace(std::move(value));
+		}
+
+		Bool TryPop(T& value)
+		{
+			Uint64 position = dequeue_position.load(std::memory_order_relaxed);
+			while (true)
+			{
+				Cell& cell = cells[position & mask];
+				Uint64 const sequence = cell.sequence.load(std::memory_order_acquire);
+				Sint64 const diff = (Sint64)sequence - (Sint64)(position + 1);
+				if (diff == 0)
+				{
+					if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						T* stored = cell.Get();
+						value = std::move(*stored);
+						stored->~T();
+						cell.sequence.store(position + mask + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0) return false;
+				else position = dequeue_position.load(std::memory_order_relaxed);
+			}
+		}
+
+		//claims the run of consecutive free cells at the enqueue position, up to count, with a single CAS and
+		//returns the number of values pushed. only values that are pushed are moved from
+		template<typename It>
+		Uint64 TryPushBatch(It first, Uint64 count)
+		{
+			if (count == 0) return 0;
+			Uint64 position = enqueue_position.load(std::memory_order_relaxed);
+			Uint64 batch_size = 0;
+			while (true)
+			{
+				Sint64 const diff = (Sint64)cells[position & mask].sequence.load(std::memory_order_acquire) - (Sint64)position;
+				if (diff < 0) return 0;
+				if (diff > 0)
+				{
+					position = enqueue_position.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				//a free cell stays free until its position is claimed, which would fail the CAS below
+				batch_size = 1;
+				while (batch_size < count && cells[(position + batch_size) & mask].sequence.load(std::memory_order_acquire) == position + batch_size) ++batch_size;
+				if (enqueue_position.compare_exchange_weak(position, position + batch_size, std::memory_order_relaxed)) break;
+			}
+
+			for (Uint64 i = 0; i < batch_size; ++i, ++first)
+			{
+				Cell& cell = cells[(position + i) & mask];
+				new (cell.storage) T(std::move(*first));
+				cell.sequence.store(position + i + 1, std::memory_order_release);
+			}
+			return batch_size;
+		}
+
+		//claims the run of consecutive published values at the dequeue position, up to max_count, with a single CAS
+		//and returns the number of values popped
+		template<typename It>
+		Uint64 TryPopBatch(It out, Uint64 max_count)
+		{
+			if (max_count == 0) return 0;
+			Uint64 position = dequeue_position.load(std::memory_order_relaxed);
+			Uint64 batch_size = 0;
+			while (true)
+			{
+				Sint64 const diff = (Sint64)cells[position & mask].sequence.load(std::memory_order_acquire) - (Sint64)(position + 1);
+				if (diff < 0) return 0;
+				if (diff > 0)
+				{
+					position = dequeue_position.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				batch_size = 1;
+				while (batch_size < max_count && cells[(position + batch_size) & mask].sequence.load(std::memory_order_acquire) == position + batch_size + 1) ++batch_size;
+				if (dequeue_position.compare_exchange_weak(position, position + batch_size, std::memory_order_relaxed)) break;
+			}
+
+			for (Uint64 i = 0; i < batch_size; ++i, ++out)
+			{
+				Cell& cell = cells[(position + i) & mask];
+				T* stored = cell.Get();
+				*out = std::move(*stored);
+				stored->~T();
+				cell.sequence.store(position + i + mask + 1, std::memory_order_release);
+			}
+			return batch_size;
+		}
+
+		//Empty and Size are snapshots, other threads may change the queue right after they return
+		Bool Empty() const
+		{
+			return Size() == 0;
+		}
+		Uint64 Size() const
+		{
+			Sint64 const size = (Sint64)(enqueue_position.load(std::memory_order_acquire) - dequeue_position.load(std::memory_order_acquire));
+			return size < 0 ? 0 : (std::min)((Uint64)size, Capacity());
+		}
+		Uint64 Capacity() const
+		{
+			return mask + 1;
+		}
+
+	private:
+		std::unique_ptr<Cell[]> cells;
+		Uint64 const mask;
+		alignas(CacheLineSize) std::atomic<Uint64> enqueue_position = 0;
+		alignas(CacheLineSize) std::atomic<Uint64> dequeue_position = 0;
+	};
+
+	//blocking front-end for BoundedConcurrentQueue: Push waits while the queue is full, WaitPop waits while it is empty.
+	//waiting uses atomic wait/notify and notifications are only issued when somebody is actually waiting
+	template<typename T>
+	class BlockingConcurrentQueue
+	{
+	public:
+		explicit BlockingConcurrentQueue(Uint64 capacity = 1024) : queue(capacity) {}
+		ADRIA_NONCOPYABLE_NONMOVABLE(BlockingConcurrentQueue)
+		~BlockingConcurrentQueue() = default;
+
+		void Push(T const& value)
+		{
+			T copy(value);
+			Push(std::move(copy));
+		}
+		void Push(T&& value)
+		{
+			while (true)
+			{
+				if (TryPush(std::move(value))) return;
+
+				Uint32 const epoch = pop_epoch.load(std::memory_order_seq_cst);
+				push_waiters.fetch_add(1, std::memory_order_seq_cst);
+				if (TryPush(std::move(value)))
+				{
+					push_waiters.fetch_sub(1, std::memory_order_seq_cst);
+					return;
+				}
+				pop_epoch.wait(epoch, std::memory_order_seq_cst);
+				push_waiters.fetch_sub(1, std::memory_order_seq_cst);
+			}
+		}
+		Bool TryPush(T&& value)
+		{
+			if (!queue.TryPush(std::move(value))) return false;
+			NotifyPushed();
+			return true;
+		}
+		Bool TryPush(T const& value)
+		{
+			if (!queue.TryPush(value)) return false;
+			NotifyPushed();
+			return true;
+		}
+
+		void WaitPop(T& value)
+		{
+			while (true)
+			{
+				if (TryPop(value)) return;
+
+				Uint32 const epoch = push_epoch.load(std::memory_order_seq_cst);
+				pop_waiters.fetch_add(1, std::memory_order_seq_cst);
+				if (TryPop(value))
+				{
+					pop_waiters.fetch_sub(1, std::memory_order_seq_cst);
+					return;
+				}
+				push_epoch.wait(epoch, std::memory_order_seq_cst);
+				pop_waiters.fetch_sub(1, std::memory_order_seq_cst);
+			}
+		}
+		Bool TryPop(T& value)
+		{
+			if (!queue.TryPop(value)) return false;
+			NotifyPopped();
+			return true;
+		}
+
+		template<typename It>
+		Uint64 TryPushBatch(It first, Uint64 count)
+		{
+			Uint64 const pushed = queue.TryPushBatch(first, count);
+			if (pushed) NotifyPushed();
+			return pushed;
+		}
+		template<typename It>
+		Uint64 TryPopBatch(It out, Uint64 max_count)
+		{
+			Uint64 const popped = queue.TryPopBatch(out, max_count);
+			if (popped) NotifyPopped();
+			return popped;
+		}
+
+		Bool Empty() const { return queue.Empty(); }
+		Uint64 Size() const { return queue.Size(); }
+		Uint64 Capacity() const { return queue.Capacity(); }
+
+	private:
+		BoundedConcurrentQueue<T> queue;
+		alignas(64) std::atomic<Uint32> push_epoch = 0;
+		std::atomic<Uint32> pop_waiters = 0;
+		alignas(64) std::atomic<Uint32> pop_epoch = 0;
+		std::atomic<Uint32> push_waiters = 0;
+
+	private:
+		void NotifyPushed()
+		{
+			push_epoch.fetch_add(1, std::memory_order_seq_cst);
+			if (pop_waiters.load(std::memory_order_seq_cst)) push_epoch.notify_all();
+		}
+		void NotifyPopped()
+		{
+			pop_epoch.fetch_add(1, std::memory_order_seq_cst);
+			if (push_waiters.load(std::memory_order_seq_cst)) pop_epoch.notify_all();
+		}
+	};
+}
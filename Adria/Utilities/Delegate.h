@@ -1,7 +1,7 @@
 #pragma once
-#include <functional>
 #include <vector>
 #include <concepts>
+#include "InlineFunction.h"
 
 namespace adria
 {
@@ -24,22 +24,26 @@ namespace adria
 		using MultiCastDelegate<__VA_ARGS__>::Remove; \
 	};
 
-	template<typename...>
+	inline constexpr Uint64 DELEGATE_INLINE_CAPACITY = 32;
+
+	//delegates store the callback inline and are move-only, bind lambdas that capture at most DELEGATE_INLINE_CAPACITY bytes
+	template<typename Signature, Uint64 Capacity = DELEGATE_INLINE_CAPACITY>
 	class Delegate;
 
-	template<typename R, typename... Args>
-	class Delegate<R(Args...)>
+	template<typename R, typename... Args, Uint64 Capacity>
+	class Delegate<R(Args...), Capacity>
 	{
-		using DelegateType = std::function<R(Args...)>;
+		using DelegateType = InlineFunction<R(Args...), Capacity>;
 	public:
 		Delegate() = default;
-		ADRIA_DEFAULT_COPYABLE_MOVABLE(Delegate)
+		ADRIA_NONCOPYABLE(Delegate)
+		ADRIA_DEFAULT_MOVABLE(Delegate)
 		~Delegate() = default;
 
 		template<typename F> requires std::is_constructible_v<DelegateType, F>
 		void BindLambda(F&& lambda)
 		{
-			callback = lambda;
+			callback = DelegateType(std::forward<F>(lambda));
 		}
 
 		void BindStatic(R(*pf)(Args...))
@@ -60,16 +64,16 @@ namespace adria
 
 		R Execute(Args... args) const
 		{
-			return callback(args...);
+			return callback(std::forward<Args>(args)...);
 		}
 		R ExecuteIfBound(Args... args) const
 		{
-			return IsBound() ? callback(args...) : R();
+			return IsBound() ? callback(std::forward<Args>(args)...) : R();
 		}
 
 		R operator()(Args... args) const
 		{
-			return callback(args...);
+			return callback(std::forward<Args>(args)...);
 		}
 
 		Bool IsBound() const { return callback != nullptr; }
@@ -163,17 +167,13 @@ namespace adria
 
 	public:
 		MultiCastDelegate() = default;
-		ADRIA_DEFAULT_COPYABLE_MOVABLE(MultiCastDelegate)
+		ADRIA_NONCOPYABLE(MultiCastDelegate)
+		ADRIA_DEFAULT_MOVABLE(MultiCastDelegate)
 		~MultiCastDelegate() = default;
 
 		ADRIA_MAYBE_UNUSED DelegateHandle Add(DelegateType&& handler)
 		{
-			delegate_array.emplace_back(DelegateHandle(0), std::forward<DelegateType>(handler));
-			return delegate_array.back().first;
-		}
-		ADRIA_MAYBE_UNUSED DelegateHandle Add(DelegateType const& handler)
-		{
-			delegate_array.emplace_back(DelegateHandle(0), handler);
+			delegate_array.emplace_back(DelegateHandle(0), std::move(handler));
 			return delegate_array.back().first;
 		}
 
@@ -232,7 +232,7 @@ namespace adria
 			{
 				for (Uint64 i = 0; i < delegate_array.size(); ++i)
 				{
-					if (delegate_array[i].Handle == handle) return true;
+					if (delegate_array[i].first == handle) return true;
 				}
 			}
 			return false;
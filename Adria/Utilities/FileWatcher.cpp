@@ -0,0 +1,331 @@
+#include <atomic>
+#include <chrono>
+#include "FileWatcher.h"
+#include "Logging/Logger.h"
+
+namespace fs = std::filesystem;
+
+namespace adria
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		constexpr Uint32 NotifyBufferSize = 64 * 1024;
+		constexpr DWORD NotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+		constexpr std::chrono::milliseconds PollInterval(500);
+
+		struct WatchedDirectory
+		{
+			fs::path path;
+			Bool recursive = true;
+			HANDLE directory = INVALID_HANDLE_VALUE;
+			HANDLE event = nullptr;
+			OVERLAPPED overlapped{};
+			std::unique_ptr<DWORD[]> buffer;
+			std::unordered_map<std::string, fs::file_time_type> polled_files;
+
+			Bool IsPolled() const { return directory == INVALID_HANDLE_VALUE; }
+		};
+
+		template<typename F>
+		void ForEachFile(fs::path const& path, Bool recursive, F&& callback)
+		{
+			std::error_code ec;
+			if (recursive)
+			{
+				for (auto const& entry : fs::recursive_directory_iterator(path, ec))
+				{
+					if (entry.is_regular_file(ec)) callback(entry);
+				}
+			}
+			else
+			{
+				for (auto const& entry : fs::directory_iterator(path, ec))
+				{
+					if (entry.is_regular_file(ec)) callback(entry);
+				}
+			}
+		}
+	}
+
+	class FileWatcherImpl
+	{
+	public:
+		FileWatcherImpl()
+		{
+			wake_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+			watch_thread = std::thread(&FileWatcherImpl::WatchThread, this);
+		}
+		~FileWatcherImpl()
+		{
+			stop.store(true, std::memory_order_release);
+			SetEvent(wake_event);
+			watch_thread.join();
+			CloseHandle(wake_event);
+		}
+
+		void AddPathToWatch(std::string const& path, Bool recursive)
+		{
+			{
+				std::lock_guard lock(mutex);
+				added_directories.emplace_back(path, recursive);
+			}
+			SetEvent(wake_event);
+		}
+		void SetDebounceInterval(Uint32 milliseconds)
+		{
+			debounce_interval.store(milliseconds, std::memory_order_relaxed);
+		}
+		Bool HasPendingChanges() const
+		{
+			return has_ready_files.load(std::memory_order_acquire);
+		}
+		std::vector<std::string> TakeChangedFiles()
+		{
+			std::vector<std::string> changed_files;
+			if (!HasPendingChanges()) return changed_files;
+
+			std::lock_guard lock(mutex);
+			changed_files.swap(ready_files);
+			has_ready_files.store(false, std::memory_order_release);
+			return changed_files;
+		}
+
+	private:
+		std::thread watch_thread;
+		HANDLE wake_event = nullptr;
+		std::atomic<Bool> stop = false;
+		std::atomic<Uint32> debounce_interval = 50;
+
+		std::mutex mutex;
+		std::vector<std::pair<std::string, Bool>> added_directories;
+		std::vector<std::string> ready_files;
+		std::atomic<Bool> has_ready_files = false;
+
+		//only touched by the watch thread
+		std::vector<std::unique_ptr<WatchedDirectory>> directories;
+		std::unordered_map<std::string, Clock::time_point> pending_files;
+		Clock::time_point last_poll_time;
+
+	private:
+		void WatchThread()
+		{
+			std::vector<HANDLE> wait_handles;
+			while (!stop.load(std::memory_order_acquire))
+			{
+				wait_handles.clear();
+				wait_handles.push_back(wake_event);
+				Bool has_polled_directories = false;
+				for (auto const& directory : directories)
+				{
+					if (directory->IsPolled()) has_polled_directories = true;
+					else wait_handles.push_back(directory->event);
+				}
+
+				DWORD timeout = INFINITE;
+				if (!pending_files.empty()) timeout = debounce_interval.load(std::memory_order_relaxed);
+				if (has_polled_directories) timeout = (std::min)(timeout, (DWORD)PollInterval.count());
+
+				DWORD const result = WaitForMultipleObjects((DWORD)wait_handles.size(), wait_handles.data(), FALSE, timeout);
+				if (stop.load(std::memory_order_acquire)) break;
+
+				if (result == WAIT_OBJECT_0)
+				{
+					OpenAddedDirectories();
+				}
+				else if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + wait_handles.size())
+				{
+					for (auto& directory : directories)
+					{
+						if (directory->event == wait_handles[result - WAIT_OBJECT_0])
+						{
+							ReadDirectoryNotifications(*directory);
+							break;
+						}
+					}
+				}
+
+				if (has_polled_directories && Clock::now() - last_poll_time >= PollInterval)
+				{
+					for (auto& directory : directories)
+					{
+						if (directory->IsPolled()) PollDirectory(*directory);
+					}
+					last_poll_time = Clock::now();
+				}
+				PromoteSettledFiles();
+			}
+
+			for (auto& directory : directories) CloseDirectory(*directory);
+			directories.clear();
+		}
+
+		void OpenAddedDirectories()
+		{
+			std::vector<std::pair<std::string, Bool>> new_directories;
+			{
+				std::lock_guard lock(mutex);
+				new_directories.swap(added_directories);
+			}
+
+			for (auto const& [path, recursive] : new_directories)
+			{
+				std::unique_ptr<WatchedDirectory> directory = std::make_unique<WatchedDirectory>();
+				directory->path = fs::path(path);
+				directory->recursive = recursive;
+				directory->directory = CreateFileW(directory->path.c_str(), FILE_LIST_DIRECTORY,
+												   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+												   FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+				//WaitForMultipleObjects is limited to MAXIMUM_WAIT_OBJECTS handles, the rest is polled
+				if (directory->directory != INVALID_HANDLE_VALUE && directories.size() + 1 < MAXIMUM_WAIT_OBJECTS)
+				{
+					directory->event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+					directory->overlapped.hEvent = directory->event;
+					directory->buffer = std::make_unique<DWORD[]>(NotifyBufferSize / sizeof(DWORD));
+					if (!IssueRead(*directory)) FallBackToPolling(*directory);
+				}
+				else FallBackToPolling(*directory);
+				directories.push_back(std::move(directory));
+			}
+		}
+
+		Bool IssueRead(WatchedDirectory& directory)
+		{
+			return ReadDirectoryChangesW(directory.directory, directory.buffer.get(), NotifyBufferSize, directory.recursive,
+										 NotifyFilter, nullptr, &directory.overlapped, nullptr);
+		}
+
+		void ReadDirectoryNotifications(WatchedDirectory& directory)
+		{
+			DWORD bytes_transferred = 0;
+			if (!GetOverlappedResult(directory.directory, &directory.overlapped, &bytes_transferred, FALSE))
+			{
+				FallBackToPolling(directory);
+				return;
+			}
+
+			if (bytes_transferred == 0)
+			{
+				//the notification buffer overflowed, treat every file in the directory as changed
+				ForEachFile(directory.path, directory.recursive, [this](fs::directory_entry const& entry)
+					{
+						pending_files[entry.path().string()] = Clock::now();
+					});
+			}
+			else
+			{
+				Uint8 const* notification_data = reinterpret_cast<Uint8 const*>(directory.buffer.get());
+				while (true)
+				{
+					FILE_NOTIFY_INFORMATION const* notification = reinterpret_cast<FILE_NOTIFY_INFORMATION const*>(notification_data);
+					if (notification->Action == FILE_ACTION_ADDED || notification->Action == FILE_ACTION_MODIFIED ||
+						notification->Action == FILE_ACTION_RENAMED_NEW_NAME)
+					{
+						std::wstring_view file_name(notification->FileName, notification->FileNameLength / sizeof(WCHAR));
+						pending_files[(directory.path / file_name).string()] = Clock::now();
+					}
+					if (notification->NextEntryOffset == 0) break;
+					notification_data += notification->NextEntryOffset;
+				}
+			}
+
+			if (!IssueRead(directory)) FallBackToPolling(directory);
+		}
+
+		void FallBackToPolling(WatchedDirectory& directory)
+		{
+			ADRIA_LOG(WARNING, "Cannot watch directory %s for changes, falling back to polling", directory.path.string().c_str());
+			CloseDirectory(directory);
+			ForEachFile(directory.path, directory.recursive, [&directory](fs::directory_entry const& entry)
+				{
+					std::error_code ec;
+					directory.polled_files[entry.path().string()] = entry.last_write_time(ec);
+				});
+		}
+
+		void PollDirectory(WatchedDirectory& directory)
+		{
+			ForEachFile(directory.path, directory.recursive, [this, &directory](fs::directory_entry const& entry)
+				{
+					std::error_code ec;
+					std::string file = entry.path().string();
+					fs::file_time_type const last_write_time = entry.last_write_time(ec);
+					auto it = directory.polled_files.find(file);
+					if (it == directory.polled_files.end() || it->second != last_write_time)
+					{
+						directory.polled_files[file] = last_write_time;
+						pending_files[file] = Clock::now();
+					}
+				});
+		}
+
+		void PromoteSettledFiles()
+		{
+			if (pending_files.empty()) return;
+
+			std::chrono::milliseconds const debounce(debounce_interval.load(std::memory_order_relaxed));
+			Clock::time_point const now = Clock::now();
+			std::vector<std::string> settled_files;
+			for (auto it = pending_files.begin(); it != pending_files.end();)
+			{
+				if (now - it->second >= debounce)
+				{
+					std::error_code ec;
+					if (fs::is_regular_file(it->first, ec)) settled_files.push_back(it->first);
+					it = pending_files.erase(it);
+				}
+				else ++it;
+			}
+			if (settled_files.empty()) return;
+
+			std::lock_guard lock(mutex);
+			for (std::string& file : settled_files)
+			{
+				if (std::find(ready_files.begin(), ready_files.end(), file) == ready_files.end()) ready_files.push_back(std::move(file));
+			}
+			has_ready_files.store(true, std::memory_order_release);
+		}
+
+		void CloseDirectory(WatchedDirectory& directory)
+		{
+			if (directory.directory != INVALID_HANDLE_VALUE)
+			{
+				CancelIoEx(directory.directory, &directory.overlapped);
+				DWORD bytes_transferred = 0;
+				GetOverlappedResult(directory.directory, &directory.overlapped, &bytes_transferred, TRUE);
+				CloseHandle(directory.directory);
+				directory.directory = INVALID_HANDLE_VALUE;
+			}
+			if (directory.event)
+			{
+				CloseHandle(directory.event);
+				directory.event = nullptr;
+			}
+		}
+	};
+
+	FileWatcher::FileWatcher() : pimpl(std::make_unique<FileWatcherImpl>()) {}
+	FileWatcher::~FileWatcher()
+	{
+		pimpl = nullptr;
+		file_modified_event.RemoveAll();
+	}
+
+	void FileWatcher::AddPathToWatch(std::string const& path, Bool recursive)
+	{
+		pimpl->AddPathToWatch(path, recursive);
+	}
+	void FileWatcher::SetDebounceInterval(Uint32 milliseconds)
+	{
+		pimpl->SetDebounceInterval(milliseconds);
+	}
+	Bool FileWatcher::HasPendingChanges() const
+	{
+		return pimpl->HasPendingChanges();
+	}
+	void FileWatcher::CheckWatchedFiles()
+	{
+		for (std::string const& file : pimpl->TakeChangedFiles()) file_modified_event.Broadcast(file);
+	}
+}
@@ -13,49 +13,25 @@ namespace adria
 
 	DECLARE_EVENT(FileModifiedEvent, FileWatcher, std::string const&)
 
+	//directories are watched on a background thread with ReadDirectoryChangesW (directories that cannot be opened fall back to polling).
+	//changes are debounced, an editor saving a file in several steps produces a single event once the file stops changing.
+	//CheckWatchedFiles broadcasts the settled changes on the calling thread
 	class FileWatcher
 	{
 	public:
-		FileWatcher() = default;
-		~FileWatcher()
-		{
-			file_modified_event.RemoveAll();
-		}
+		FileWatcher();
+		ADRIA_NONCOPYABLE_NONMOVABLE(FileWatcher)
+		~FileWatcher();
 
-		void AddPathToWatch(std::string const& path, Bool recursive = true)
-		{
-			if (recursive)
-			{
-				for (auto& path : std::filesystem::recursive_directory_iterator(path))
-				{
-					if (path.is_regular_file()) files_map[path.path().string()] = std::filesystem::last_write_time(path);
-				}
-			}
-			else
-			{
-				for (auto& path : std::filesystem::directory_iterator(path))
-				{
-					if (path.is_regular_file()) files_map[path.path().string()] = std::filesystem::last_write_time(path);
-				}
-			}
-		}
-		void CheckWatchedFiles()
-		{
-			for (auto const& [file, ft] : files_map)
-			{
-				auto current_file_last_write_time = std::filesystem::last_write_time(file);
-				if (files_map[file] != current_file_last_write_time)
-				{
-					files_map[file] = current_file_last_write_time;
-					file_modified_event.Broadcast(file);
-				}
-			}
-		}
+		void AddPathToWatch(std::string const& path, Bool recursive = true);
+		void SetDebounceInterval(Uint32 milliseconds);
+		Bool HasPendingChanges() const;
+		void CheckWatchedFiles();
 
 		FileModifiedEvent& GetFileModifiedEvent() { return file_modified_event; }
+
 	private:
-		std::vector<std::string> paths_to_watch;
-		std::unordered_map<std::string, std::filesystem::file_time_type> files_map;
+		std::unique_ptr<class FileWatcherImpl> pimpl;
 		FileModifiedEvent file_modified_event;
 	};
-}
\ No newline at end of file
+}
@@ -35,6 +35,19 @@ namespace adria
 		fs::path p(file_path);
 		return fs::last_write_time(p).time_since_epoch().count();
 	}
+	Bool ReadFileBytes(std::string_view file_path, std::vector<Uint8>& data)
+	{
+		FILE* file = nullptr;
+		fopen_s(&file, std::string(file_path).c_str(), "rb");
+		if (!file) return false;
+
+		_fseeki64(file, 0, SEEK_END);
+		data.resize((Uint64)_ftelli64(file));
+		_fseeki64(file, 0, SEEK_SET);
+		Bool const result = data.empty() || fread(data.data(), data.size(), 1, file) == 1;
+		fclose(file);
+		return result;
+	}
 
 	void NormalizePathInline(std::string& file_path)
 	{
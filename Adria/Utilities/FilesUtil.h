@@ -9,6 +9,7 @@ namespace adria
 	Bool FileExists(std::string_view file_path);
 	std::string GetExtension(std::string_view path);
 	long long GetFileLastWriteTime(std::string_view file_path);
+	Bool ReadFileBytes(std::string_view file_path, std::vector<Uint8>& data);
 
 	void NormalizePathInline(std::string& file_path);
 	std::string NormalizePath(std::string_view file_path);
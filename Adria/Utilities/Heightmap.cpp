@@ -1,9 +1,18 @@
+#include <execution>
+#include <numeric>
+#include <bit>
+#include <stb_image.h>
 #include "Heightmap.h"
+#include "MemoryMappedFile.h"
+#include "StringUtil.h"
+#include "FilesUtil.h"
 #include "Cpp/FastNoiseLite.h"
+#include "Logging/Logger.h"
 
 namespace adria
 {
-	
+	static constexpr Uint64 NoiseTileSize = 64;
+
 	constexpr FastNoiseLite::NoiseType GetNoiseType(NoiseType type)
 	{
 		switch (type)
@@ -43,7 +52,7 @@ namespace adria
 		return FastNoiseLite::FractalType_None;
 	}
 
-	Heightmap::Heightmap(NoiseDesc const& desc)
+	Heightmap::Heightmap(NoiseDesc const& desc) : width(desc.width), depth(desc.depth)
 	{
 		FastNoiseLite noise{};
 		noise.SetFractalType(GetFractalType(desc.fractal_type));
@@ -53,37 +62,196 @@ namespace adria
 		noise.SetFractalLacunarity(desc.lacunarity);
 		noise.SetFractalGain(desc.persistence);
 		noise.SetFrequency(0.1f);
-		hm.resize(desc.depth);
+		heights.resize(width * depth);
 
-		for (Uint32 z = 0; z < desc.depth; z++)
-		{
-			hm[z].resize(desc.width);
-			for (Uint32 x = 0; x < desc.width; x++)
+		Uint64 const tile_count_x = (width + NoiseTileSize - 1) / NoiseTileSize;
+		Uint64 const tile_count_z = (depth + NoiseTileSize - 1) / NoiseTileSize;
+		std::vector<Uint64> tiles(tile_count_x * tile_count_z);
+		std::iota(tiles.begin(), tiles.end(), 0);
+
+		Float const x_scale = desc.noise_scale / desc.width;
+		Float const z_scale = desc.noise_scale / desc.depth;
+		Float const max_height = (Float)desc.max_height;
+		std::for_each(std::execution::par, tiles.begin(), tiles.end(), [&](Uint64 tile)
 			{
+				//FastNoiseLite::GetNoise is not const, every tile works on its own copy
+				FastNoiseLite tile_noise = noise;
+				Uint64 const x_begin = (tile % tile_count_x) * NoiseTileSize;
+				Uint64 const z_begin = (tile / tile_count_x) * NoiseTileSize;
+				Uint64 const x_end = (std::min)(x_begin + NoiseTileSize, width);
+				Uint64 const z_end = (std::min)(z_begin + NoiseTileSize, depth);
+				for (Uint64 z = z_begin; z < z_end; ++z)
+				{
+					Float const zf = z * z_scale;
+					Float* row = heights.data() + z * width;
+					for (Uint64 x = x_begin; x < x_end; ++x)
+					{
+						row[x] = tile_noise.GetNoise(x * x_scale, zf) * max_height;
+					}
+				}
+			});
+		BuildBoundsPyramid();
+	}
 
-				Float xf = x * desc.noise_scale / desc.width; // - desc.width / 2;
-				Float zf = z * desc.noise_scale / desc.depth; // - desc.depth / 2;
+	Heightmap::Heightmap(HeightmapFileDesc const& desc)
+	{
+		MemoryMappedFile file(desc.path);
+		if (!file.IsOpen())
+		{
+			ADRIA_LOG(ERROR, "Failed to open heightmap %s", std::string(desc.path).c_str());
+			return;
+		}
 
-				Float total = noise.GetNoise(xf, zf);
+		std::string extension = ToLower(GetExtension(desc.path));
+		Bool loaded = false;
+		if (extension == ".png") loaded = LoadPNG(file.Bytes(), desc.max_height);
+		else if (extension == ".raw" || extension == ".r16") loaded = LoadRAW(file.Bytes(), desc.max_height, desc.raw_width);
+		else ADRIA_LOG(ERROR, "Unsupported heightmap format %s", extension.c_str());
 
-				hm[z][x] = total * desc.max_height;
-			}
+		if (!loaded)
+		{
+			ADRIA_LOG(ERROR, "Failed to load heightmap %s", std::string(desc.path).c_str());
+			width = depth = 0;
+			heights.clear();
+			return;
 		}
+		BuildBoundsPyramid();
 	}
-	Heightmap::Heightmap(std::string_view heightmap_path)
+
+	Heightmap::Heightmap(std::string_view heightmap_path) : Heightmap(HeightmapFileDesc{ .path = heightmap_path })
 	{
-		//todo
 	}
-	Float Heightmap::HeightAt(Uint64 x, Uint64 z)
+
+	Float Heightmap::SampleHeight(Float x, Float z) const
 	{
-		return hm[z][x];
+		x = std::clamp(x, 0.0f, (Float)(width - 1));
+		z = std::clamp(z, 0.0f, (Float)(depth - 1));
+		Uint64 const x0 = (Uint64)x;
+		Uint64 const z0 = (Uint64)z;
+		Uint64 const x1 = (std::min)(x0 + 1, width - 1);
+		Uint64 const z1 = (std::min)(z0 + 1, depth - 1);
+		Float const tx = x - x0;
+		Float const tz = z - z0;
+
+		Float const h0 = std::lerp(HeightAt(x0, z0), HeightAt(x1, z0), tx);
+		Float const h1 = std::lerp(HeightAt(x0, z1), HeightAt(x1, z1), tx);
+		return std::lerp(h0, h1, tz);
+	}
+
+	HeightBounds Heightmap::GetHeightBounds(Uint64 x0, Uint64 z0, Uint64 x1, Uint64 z1) const
+	{
+		x1 = (std::min)(x1, width - 1);
+		z1 = (std::min)(z1, depth - 1);
+		ADRIA_ASSERT(x0 <= x1 && z0 <= z1);
+
+		//pick the level whose blocks are at most as large as the query, so at most 3x3 blocks overlap it
+		Uint64 const extent = (std::max)(x1 - x0, z1 - z0) + 1;
+		Uint64 const level = (std::min)((Uint64)std::bit_width(extent) - 1, (Uint64)bounds_pyramid.size());
+
+		HeightBounds bounds{ FLT_MAX, -FLT_MAX };
+		if (level == 0)
+		{
+			for (Uint64 z = z0; z <= z1; ++z)
+			{
+				for (Uint64 x = x0; x <= x1; ++x)
+				{
+					bounds.min = (std::min)(bounds.min, HeightAt(x, z));
+					bounds.max = (std::max)(bounds.max, HeightAt(x, z));
+				}
+			}
+			return bounds;
+		}
+
+		std::vector<HeightBounds> const& level_bounds = bounds_pyramid[level - 1];
+		Uint64 const level_width = LevelWidth(level);
+		for (Uint64 z = z0 >> level; z <= z1 >> level; ++z)
+		{
+			for (Uint64 x = x0 >> level; x <= x1 >> level; ++x)
+			{
+				HeightBounds const& block_bounds = level_bounds[z * level_width + x];
+				bounds.min = (std::min)(bounds.min, block_bounds.min);
+				bounds.max = (std::max)(bounds.max, block_bounds.max);
+			}
+		}
+		return bounds;
 	}
+
 	Uint64 Heightmap::Width() const
 	{
-		return hm[0].size();
+		return width;
 	}
 	Uint64 Heightmap::Depth() const
 	{
-		return hm.size();
+		return depth;
+	}
+
+	Bool Heightmap::LoadPNG(std::span<Uint8 const> file_data, Float max_height)
+	{
+		Sint32 png_width = 0, png_depth = 0, components = 0;
+		Uint16* samples = stbi_load_16_from_memory(file_data.data(), (Sint32)file_data.size(), &png_width, &png_depth, &components, 1);
+		if (!samples) return false;
+
+		width = (Uint64)png_width;
+		depth = (Uint64)png_depth;
+		heights.resize(width * depth);
+		Float const scale = max_height / 65535.0f;
+		for (Uint64 i = 0; i < heights.size(); ++i) heights[i] = samples[i] * scale;
+		stbi_image_free(samples);
+		return true;
+	}
+
+	Bool Heightmap::LoadRAW(std::span<Uint8 const> file_data, Float max_height, Uint32 raw_width)
+	{
+		Uint64 const sample_count = file_data.size() / sizeof(Uint16);
+		if (sample_count == 0 || file_data.size() % sizeof(Uint16) != 0) return false;
+
+		width = raw_width ? raw_width : (Uint64)std::sqrt((Float64)sample_count);
+		if (width == 0 || sample_count % width != 0) return false;
+		depth = sample_count / width;
+		if (!raw_width && width != depth) return false;
+
+		heights.resize(width * depth);
+		Float const scale = max_height / 65535.0f;
+		Uint8 const* samples = file_data.data();
+		for (Uint64 i = 0; i < heights.size(); ++i)
+		{
+			Uint16 sample;
+			std::memcpy(&sample, samples + i * sizeof(Uint16), sizeof(Uint16));
+			heights[i] = sample * scale;
+		}
+		return true;
+	}
+
+	void Heightmap::BuildBoundsPyramid()
+	{
+		bounds_pyramid.clear();
+		if (heights.empty()) return;
+
+		for (Uint64 level = 1; LevelWidth(level - 1) > 1 || LevelDepth(level - 1) > 1; ++level)
+		{
+			Uint64 const src_width = LevelWidth(level - 1);
+			Uint64 const src_depth = LevelDepth(level - 1);
+			Uint64 const dst_width = LevelWidth(level);
+			Uint64 const dst_depth = LevelDepth(level);
+			std::vector<HeightBounds>& dst = bounds_pyramid.emplace_back(dst_width * dst_depth);
+			std::vector<HeightBounds> const* src = level > 1 ? &bounds_pyramid[level - 2] : nullptr;
+			for (Uint64 z = 0; z < dst_depth; ++z)
+			{
+				for (Uint64 x = 0; x < dst_width; ++x)
+				{
+					HeightBounds bounds{ FLT_MAX, -FLT_MAX };
+					for (Uint64 sz = 2 * z; sz < (std::min)(2 * z + 2, src_depth); ++sz)
+					{
+						for (Uint64 sx = 2 * x; sx < (std::min)(2 * x + 2, src_width); ++sx)
+						{
+							HeightBounds const sample = src ? (*src)[sz * src_width + sx] : HeightBounds{ HeightAt(sx, sz), HeightAt(sx, sz) };
+							bounds.min = (std::min)(bounds.min, sample.min);
+							bounds.max = (std::max)(bounds.max, sample.max);
+						}
+					}
+					dst[z * dst_width + x] = bounds;
+				}
+			}
+		}
 	}
-}
\ No newline at end of file
+}
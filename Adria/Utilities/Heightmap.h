@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <span>
 #include <string_view>
 
 namespace adria
@@ -34,18 +35,54 @@ namespace adria
 		Float noise_scale = 10;
 	};
 
-	
+	//16-bit heightmaps: .png (16 or 8-bit grayscale) or .raw (square, little-endian Uint16).
+	//samples are normalized to [0, 1] and scaled by max_height
+	struct HeightmapFileDesc
+	{
+		std::string_view path;
+		Float max_height = 1.0f;
+		Uint32 raw_width = 0;	//0 = derive from the file size, raw files are assumed to be square
+	};
+
+	struct HeightBounds
+	{
+		Float min;
+		Float max;
+	};
+
 	class Heightmap
 	{
-	public:	
+	public:
 		explicit Heightmap(NoiseDesc const& desc);
+		explicit Heightmap(HeightmapFileDesc const& desc);
 		explicit Heightmap(std::string_view heightmap_path);
 
-		Float HeightAt(Uint64 x, Uint64 z);
+		Float HeightAt(Uint64 x, Uint64 z) const
+		{
+			return heights[z * width + x];
+		}
+		//bilinear sample, x and z are in sample units and clamped to the heightmap
+		Float SampleHeight(Float x, Float z) const;
+		//conservative height bounds of the samples in [x0, x1] x [z0, z1], answered from the min/max pyramid
+		HeightBounds GetHeightBounds(Uint64 x0, Uint64 z0, Uint64 x1, Uint64 z1) const;
+
 		Uint64 Width() const;
 		Uint64 Depth() const;
+		std::span<Float const> Data() const { return heights; }
+		Bool IsValid() const { return !heights.empty(); }
+
+	private:
+		Uint64 width = 0;
+		Uint64 depth = 0;
+		std::vector<Float> heights;
+		//level i covers blocks of 2^(i+1) x 2^(i+1) samples, level 0 would be the heights themselves
+		std::vector<std::vector<HeightBounds>> bounds_pyramid;
 
 	private:
-		std::vector<std::vector<Float>> hm;
+		Bool LoadPNG(std::span<Uint8 const> file_data, Float max_height);
+		Bool LoadRAW(std::span<Uint8 const> file_data, Float max_height, Uint32 raw_width);
+		void BuildBoundsPyramid();
+		Uint64 LevelWidth(Uint64 level) const { return (width + (1ull << level) - 1) >> level; }
+		Uint64 LevelDepth(Uint64 level) const { return (depth + (1ull << level) - 1) >> level; }
 	};
-}
\ No newline at end of file
+}
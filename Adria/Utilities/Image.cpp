@@ -4,6 +4,7 @@
 #include "Logging/Logger.h"
 #include "Utilities/FilesUtil.h"
 #include "Utilities/StringUtil.h"
+#include "Utilities/VirtualFileSystem.h"
 
 namespace adria
 {
@@ -53,13 +54,26 @@ namespace adria
 	}
 
 	Image::Image(std::string_view file_path)
+	{
+		VFSFile file;
+		Bool const result = g_VirtualFileSystem.ReadFile(file_path, file) && Load(file_path, file.Bytes());
+		ADRIA_ASSERT(result);
+	}
+
+	Image::Image(std::string_view file_path, std::span<Uint8 const> file_data)
+	{
+		Bool const result = Load(file_path, file_data);
+		ADRIA_ASSERT(result);
+	}
+
+	Bool Image::Load(std::string_view file_path, std::span<Uint8 const> file_data)
 	{
 		ImageFormat format = GetImageFormat(file_path);
-		Bool result;
+		Bool result = false;
 		switch (format)
 		{
 		case ImageFormat::DDS:
-			result = LoadDDS(file_path);
+			result = LoadDDS(file_data);
 			break;
 		case ImageFormat::BMP:
 		case ImageFormat::PNG:
@@ -68,13 +82,13 @@ namespace adria
 		case ImageFormat::TIFF:
 		case ImageFormat::GIF:
 		case ImageFormat::HDR:
-			result = LoadSTB(file_path);
+			result = LoadSTB(file_data);
 			break;
 		case ImageFormat::NotSupported:
 		default:
 			ADRIA_ASSERT_MSG(false, "Unsupported Texture Format!");
 		}
-		ADRIA_ASSERT(result);
+		return result;
 	}
 
 	Uint64 Image::SetData(Uint32 _width, Uint32 _height, Uint32 _depth, Uint32 _mip_levels, void const* _data)
@@ -89,21 +103,11 @@ namespace adria
 		return texture_byte_size;
 	}
 
-	Bool Image::LoadDDS(std::string_view texture_path)
+	Bool Image::LoadDDS(std::span<Uint8 const> file_data)
 	{
 		//https://github.com/simco50/D3D12_Research/blob/master/D3D12/Content/Image.cpp - LoadDDS
 
-		FILE* file = nullptr;
-		fopen_s(&file, texture_path.data(), "rb");
-		if (!file)
-			return false;
-
-		fseek(file, 0, SEEK_END);
-		std::vector<Char> data((Uint64)ftell(file));
-		fseek(file, 0, SEEK_SET);
-		fread(data.data(), data.size(), 1, file);
-
-		Char* bytes = data.data();
+		Char const* bytes = reinterpret_cast<Char const*>(file_data.data());
 #pragma pack(push,1)
 		struct PixelFormatHeader
 		{
@@ -163,7 +167,7 @@ namespace adria
 		auto MakeFourCC = [](Uint32 a, Uint32 b, Uint32 c, Uint32 d) { return a | (b << 8u) | (c << 16u) | (d << 24u); };
 
 		constexpr const Char magic[] = "DDS ";
-		if (memcmp(magic, bytes, 4) != 0) return false;
+		if (file_data.size() < 4 + sizeof(FileHeader) || memcmp(magic, bytes, 4) != 0) return false;
 		bytes += 4;
 
 		const FileHeader* dds_header = (FileHeader*)bytes;
@@ -261,14 +265,14 @@ namespace adria
 		return true;
 	}
 
-	Bool Image::LoadSTB(std::string_view texture_path)
+	Bool Image::LoadSTB(std::span<Uint8 const> file_data)
 	{
 		Sint32 components = 0;
-		is_hdr = stbi_is_hdr(texture_path.data());
+		is_hdr = stbi_is_hdr_from_memory(file_data.data(), (Sint32)file_data.size());
 		if (is_hdr)
 		{
 			Sint32 _width, _height;
-			Float* _pixels = stbi_loadf(texture_path.data(), &_width, &_height, &components, 4);
+			Float* _pixels = stbi_loadf_from_memory(file_data.data(), (Sint32)file_data.size(), &_width, &_height, &components, 4);
 			if (_pixels == nullptr) return false;
 			width = (Uint32)_width;
 			height = (Uint32)_height;
@@ -283,7 +287,7 @@ namespace adria
 		else
 		{
 			int _width, _height;
-			stbi_uc* _pixels = stbi_load(texture_path.data(), &_width, &_height, &components, 4);
+			stbi_uc* _pixels = stbi_load_from_memory(file_data.data(), (Sint32)file_data.size(), &_width, &_height, &components, 4);
 			if (_pixels == nullptr) return false;
 			width = (Uint32)_width;
 			height = (Uint32)_height;
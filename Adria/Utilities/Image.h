@@ -10,6 +10,8 @@ namespace adria
 	public:
 		explicit Image(GfxFormat format) : format(format) {}
 		explicit Image(std::string_view file_path);
+		//the format is picked from the extension of file_path, file_data holds the contents of the file
+		Image(std::string_view file_path, std::span<Uint8 const> file_data);
 
 		Uint32 Width() const
 		{
@@ -53,8 +55,9 @@ namespace adria
 	private:
 		Uint64 SetData(Uint32 width, Uint32 height, Uint32 depth, Uint32 mip_levels, void const* data);
 
-		Bool LoadDDS(std::string_view texture_path);
-		Bool LoadSTB(std::string_view texture_path);
+		Bool Load(std::string_view file_path, std::span<Uint8 const> file_data);
+		Bool LoadDDS(std::span<Uint8 const> file_data);
+		Bool LoadSTB(std::span<Uint8 const> file_data);
 	};
 
 	template<typename T>
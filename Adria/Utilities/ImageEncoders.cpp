@@ -0,0 +1,666 @@
+#include <bit>
+#include "ImageEncoders.h"
+
+namespace adria
+{
+	namespace
+	{
+		void AppendBytes(std::vector<Uint8>& output, void const* data, Uint64 size)
+		{
+			Uint8 const* bytes = static_cast<Uint8 const*>(data);
+			output.insert(output.end(), bytes, bytes + size);
+		}
+		void AppendUint32BE(std::vector<Uint8>& output, Uint32 value)
+		{
+			Uint8 const bytes[4] = { Uint8(value >> 24), Uint8(value >> 16), Uint8(value >> 8), Uint8(value) };
+			AppendBytes(output, bytes, sizeof(bytes));
+		}
+		void AppendString(std::vector<Uint8>& output, std::string const& string)
+		{
+			AppendBytes(output, string.data(), string.size());
+		}
+
+		Float HalfToFloat(Uint16 half)
+		{
+			Uint32 const sign = Uint32(half & 0x8000u) << 16;
+			Uint32 const exponent = (half >> 10) & 0x1fu;
+			Uint32 mantissa = half & 0x3ffu;
+			Uint32 bits = 0;
+			if (exponent == 0)
+			{
+				if (mantissa == 0)
+				{
+					bits = sign;
+				}
+				else
+				{
+					Uint32 shift = 0;
+					while ((mantissa & 0x400u) == 0)
+					{
+						mantissa <<= 1;
+						++shift;
+					}
+					bits = sign | ((127 - 14 - shift) << 23) | ((mantissa & 0x3ffu) << 13);
+				}
+			}
+			else if (exponent == 31)
+			{
+				bits = sign | 0x7f800000u | (mantissa << 13);
+			}
+			else
+			{
+				bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+			}
+			return std::bit_cast<Float>(bits);
+		}
+
+		struct CRC32Table
+		{
+			Uint32 entries[256];
+
+			CRC32Table()
+			{
+				for (Uint32 i = 0; i < 256; ++i)
+				{
+					Uint32 crc = i;
+					for (Uint32 j = 0; j < 8; ++j) crc = (crc & 1) ? (0xedb88320u ^ (crc >> 1)) : (crc >> 1);
+					entries[i] = crc;
+				}
+			}
+		};
+
+		Uint32 CRC32(Uint8 const* data, Uint64 size, Uint32 crc = 0)
+		{
+			static CRC32Table const table;
+			crc = ~crc;
+			for (Uint64 i = 0; i < size; ++i) crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+			return ~crc;
+		}
+
+		Uint32 Adler32(Uint8 const* data, Uint64 size)
+		{
+			//5552 is the largest number of bytes that can be summed before the sums overflow 32 bits
+			static constexpr Uint32 ADLER_MOD = 65521;
+			Uint32 a = 1, b = 0;
+			while (size > 0)
+			{
+				Uint64 const chunk_size = std::min<Uint64>(size, 5552);
+				for (Uint64 i = 0; i < chunk_size; ++i)
+				{
+					a += data[i];
+					b += a;
+				}
+				a %= ADLER_MOD;
+				b %= ADLER_MOD;
+				data += chunk_size;
+				size -= chunk_size;
+			}
+			return (b << 16) | a;
+		}
+
+		class BitWriter
+		{
+		public:
+			explicit BitWriter(std::vector<Uint8>& output) : output(output) {}
+
+			//bits are written least significant bit first, as deflate expects
+			void Write(Uint32 bits, Uint32 bit_count)
+			{
+				ADRIA_ASSERT(bit_count <= 32);
+				buffer |= Uint64(bits) << buffered_bit_count;
+				buffered_bit_count += bit_count;
+				if (buffered_bit_count >= 32)
+				{
+					Uint8 const bytes[4] = { Uint8(buffer), Uint8(buffer >> 8), Uint8(buffer >> 16), Uint8(buffer >> 24) };
+					AppendBytes(output, bytes, sizeof(bytes));
+					buffer >>= 32;
+					buffered_bit_count -= 32;
+				}
+			}
+
+			void Flush()
+			{
+				while (buffered_bit_count > 0)
+				{
+					output.push_back(Uint8(buffer));
+					buffer >>= 8;
+					buffered_bit_count = buffered_bit_count > 8 ? buffered_bit_count - 8 : 0;
+				}
+				buffer = 0;
+			}
+
+		private:
+			std::vector<Uint8>& output;
+			Uint64 buffer = 0;
+			Uint32 buffered_bit_count = 0;
+		};
+
+		//deflate constants, RFC 1951
+		constexpr Uint32 DEFLATE_WINDOW_SIZE = 32768;
+		constexpr Uint32 DEFLATE_MIN_MATCH = 3;
+		constexpr Uint32 DEFLATE_MAX_MATCH = 258;
+		constexpr Uint32 LITLEN_SYMBOL_COUNT = 286;
+		constexpr Uint32 DISTANCE_SYMBOL_COUNT = 30;
+		constexpr Uint32 CODE_LENGTH_SYMBOL_COUNT = 19;
+		constexpr Uint32 END_OF_BLOCK = 256;
+
+		constexpr Uint16 LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		constexpr Uint8 LENGTH_EXTRA_BITS[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		constexpr Uint16 DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		constexpr Uint8 DISTANCE_EXTRA_BITS[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+		constexpr Uint8 CODE_LENGTH_ORDER[CODE_LENGTH_SYMBOL_COUNT] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		//tokens are literals or matches with the match flag set, the length in bits 16-24 and the distance in bits 0-15
+		constexpr Uint32 MATCH_FLAG = 1u << 31;
+
+		struct LengthSymbolTable
+		{
+			Uint8 symbols[DEFLATE_MAX_MATCH + 1];
+
+			LengthSymbolTable()
+			{
+				for (Uint32 code = 0; code < 29; ++code)
+				{
+					Uint32 const end = code + 1 < 29 ? LENGTH_BASE[code + 1] : DEFLATE_MAX_MATCH + 1;
+					for (Uint32 length = LENGTH_BASE[code]; length < end; ++length) symbols[length] = (Uint8)code;
+				}
+				symbols[DEFLATE_MAX_MATCH] = 28;
+			}
+		};
+
+		Uint32 GetLengthCode(Uint32 length)
+		{
+			static LengthSymbolTable const table;
+			return table.symbols[length];
+		}
+
+		Uint32 GetDistanceCode(Uint32 distance)
+		{
+			if (distance <= 4) return distance - 1;
+			Uint32 const d = distance - 1;
+			Uint32 const msb = (Uint32)std::bit_width(d) - 1;
+			return 2 * msb + ((d >> (msb - 1)) & 1);
+		}
+
+		Uint32 ReverseBits(Uint32 code, Uint32 length)
+		{
+			Uint32 reversed = 0;
+			for (Uint32 i = 0; i < length; ++i)
+			{
+				reversed = (reversed << 1) | (code & 1);
+				code >>= 1;
+			}
+			return reversed;
+		}
+
+		//huffman code lengths limited to max_length, the most frequent symbols get the shortest codes
+		void BuildCodeLengths(Uint32 const* frequencies, Uint32 symbol_count, Uint32 max_length, Uint8* lengths)
+		{
+			std::fill_n(lengths, symbol_count, Uint8(0));
+
+			std::vector<Uint32> symbols;
+			for (Uint32 symbol = 0; symbol < symbol_count; ++symbol)
+			{
+				if (frequencies[symbol] > 0) symbols.push_back(symbol);
+			}
+			if (symbols.empty())
+			{
+				lengths[0] = 1;
+				return;
+			}
+			if (symbols.size() == 1)
+			{
+				lengths[symbols[0]] = 1;
+				return;
+			}
+
+			struct Node
+			{
+				Uint64 frequency;
+				Uint32 parent;
+			};
+			std::vector<Node> nodes(symbols.size());
+			using HeapEntry = std::pair<Uint64, Uint32>;
+			std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+			for (Uint32 i = 0; i < symbols.size(); ++i)
+			{
+				nodes[i].frequency = frequencies[symbols[i]];
+				heap.emplace(nodes[i].frequency, i);
+			}
+			while (heap.size() > 1)
+			{
+				HeapEntry const first = heap.top(); heap.pop();
+				HeapEntry const second = heap.top(); heap.pop();
+				Uint32 const parent = (Uint32)nodes.size();
+				nodes.push_back(Node{ .frequency = first.first + second.first, .parent = 0 });
+				nodes[first.second].parent = parent;
+				nodes[second.second].parent = parent;
+				heap.emplace(first.first + second.first, parent);
+			}
+
+			//parents are always created after their children so depths can be resolved from the root down
+			std::vector<Uint32> depths(nodes.size(), 0);
+			for (Sint64 i = (Sint64)nodes.size() - 2; i >= 0; --i) depths[i] = depths[nodes[i].parent] + 1;
+
+			std::vector<Uint32> length_counts(max_length + 1, 0);
+			for (Uint32 i = 0; i < symbols.size(); ++i) ++length_counts[std::min(depths[i], max_length)];
+
+			//clamping made the code oversubscribed, trade one max length code for splitting a shorter code until it is complete again
+			Uint64 kraft_sum = 0;
+			for (Uint32 length = 1; length <= max_length; ++length) kraft_sum += Uint64(length_counts[length]) << (max_length - length);
+			while (kraft_sum > (1ull << max_length))
+			{
+				--length_counts[max_length];
+				for (Uint32 length = max_length - 1; length > 0; --length)
+				{
+					if (length_counts[length] > 0)
+					{
+						--length_counts[length];
+						length_counts[length + 1] += 2;
+						break;
+					}
+				}
+				--kraft_sum;
+			}
+
+			std::stable_sort(symbols.begin(), symbols.end(), [frequencies](Uint32 lhs, Uint32 rhs) { return frequencies[lhs] > frequencies[rhs]; });
+			Uint32 symbol_index = 0;
+			for (Uint32 length = 1; length <= max_length; ++length)
+			{
+				for (Uint32 i = 0; i < length_counts[length]; ++i) lengths[symbols[symbol_index++]] = (Uint8)length;
+			}
+		}
+
+		//canonical codes, bit reversed so they can be written least significant bit first
+		void BuildCodes(Uint8 const* lengths, Uint32 symbol_count, Uint16* codes)
+		{
+			Uint32 length_counts[16] = {};
+			for (Uint32 symbol = 0; symbol < symbol_count; ++symbol) ++length_counts[lengths[symbol]];
+			length_counts[0] = 0;
+
+			Uint32 next_code[16] = {};
+			Uint32 code = 0;
+			for (Uint32 length = 1; length < 16; ++length)
+			{
+				code = (code + length_counts[length - 1]) << 1;
+				next_code[length] = code;
+			}
+			for (Uint32 symbol = 0; symbol < symbol_count; ++symbol)
+			{
+				Uint32 const length = lengths[symbol];
+				codes[symbol] = length ? (Uint16)ReverseBits(next_code[length]++, length) : 0;
+			}
+		}
+
+		class Deflater
+		{
+			static constexpr Uint32 HASH_BITS = 15;
+			static constexpr Uint64 BLOCK_SIZE = 1 << 20;
+
+		public:
+			Deflater(Uint8 const* data, Uint64 size) : data(data), size(size), hash_table(1u << HASH_BITS, 0) {}
+
+			void Compress(std::vector<Uint8>& output)
+			{
+				BitWriter writer(output);
+				std::vector<Uint32> tokens;
+				tokens.reserve(BLOCK_SIZE);
+				for (Uint64 block_start = 0; block_start < size || block_start == 0; block_start += BLOCK_SIZE)
+				{
+					Uint64 const block_end = std::min(block_start + BLOCK_SIZE, size);
+					Tokenize(block_start, block_end, tokens);
+					WriteBlock(writer, tokens, block_end == size);
+				}
+				writer.Flush();
+			}
+
+		private:
+			Uint8 const* data;
+			Uint64 size;
+			std::vector<Uint32> hash_table;
+
+		private:
+			Uint32 Hash(Uint64 position) const
+			{
+				Uint32 value;
+				memcpy(&value, data + position, sizeof(value));
+				return (value * 2654435761u) >> (32 - HASH_BITS);
+			}
+
+			//single probe matcher, positions covered by a match are not inserted into the hash table
+			void Tokenize(Uint64 start, Uint64 end, std::vector<Uint32>& tokens)
+			{
+				tokens.clear();
+				Uint32* table = hash_table.data();
+				Uint64 position = start;
+				while (position < end)
+				{
+					if (position + 4 <= size)
+					{
+						Uint32 const hash = Hash(position);
+						Uint64 const candidate = table[hash];
+						table[hash] = (Uint32)position;
+						Uint64 const distance = position - candidate;
+						if (candidate < position && distance <= DEFLATE_WINDOW_SIZE && memcmp(data + candidate, data + position, 4) == 0)
+						{
+							Uint64 const max_length = std::min<Uint64>(DEFLATE_MAX_MATCH, end - position);
+							Uint64 length = 4;
+							while (length < max_length && data[candidate + length] == data[position + length]) ++length;
+							if (length >= DEFLATE_MIN_MATCH && length <= max_length)
+							{
+								tokens.push_back(MATCH_FLAG | Uint32(length << 16) | Uint32(distance));
+								position += length;
+								continue;
+							}
+						}
+					}
+					tokens.push_back(data[position]);
+					++position;
+				}
+			}
+
+			void WriteBlock(BitWriter& writer, std::vector<Uint32> const& tokens, Bool final_block) const
+			{
+				Uint32 litlen_frequencies[LITLEN_SYMBOL_COUNT] = {};
+				Uint32 distance_frequencies[DISTANCE_SYMBOL_COUNT] = {};
+				for (Uint32 token : tokens)
+				{
+					if (token & MATCH_FLAG)
+					{
+						++litlen_frequencies[257 + GetLengthCode((token >> 16) & 0x1ff)];
+						++distance_frequencies[GetDistanceCode(token & 0xffff)];
+					}
+					else ++litlen_frequencies[token];
+				}
+				litlen_frequencies[END_OF_BLOCK] = 1;
+
+				Uint8 lengths[LITLEN_SYMBOL_COUNT + DISTANCE_SYMBOL_COUNT] = {};
+				Uint8* litlen_lengths = lengths;
+				Uint8* distance_lengths = lengths + LITLEN_SYMBOL_COUNT;
+				BuildCodeLengths(litlen_frequencies, LITLEN_SYMBOL_COUNT, 15, litlen_lengths);
+				BuildCodeLengths(distance_frequencies, DISTANCE_SYMBOL_COUNT, 15, distance_lengths);
+
+				Uint32 litlen_count = LITLEN_SYMBOL_COUNT;
+				while (litlen_count > 257 && litlen_lengths[litlen_count - 1] == 0) --litlen_count;
+				Uint32 distance_count = DISTANCE_SYMBOL_COUNT;
+				while (distance_count > 1 && distance_lengths[distance_count - 1] == 0) --distance_count;
+
+				//run length encode the code lengths of both trees as one sequence
+				std::vector<Uint8> length_sequence(litlen_lengths, litlen_lengths + litlen_count);
+				length_sequence.insert(length_sequence.end(), distance_lengths, distance_lengths + distance_count);
+				std::vector<std::pair<Uint8, Uint8>> length_tokens;
+				Uint32 code_length_frequencies[CODE_LENGTH_SYMBOL_COUNT] = {};
+				auto AddLengthToken = [&](Uint8 symbol, Uint8 extra)
+					{
+						length_tokens.emplace_back(symbol, extra);
+						++code_length_frequencies[symbol];
+					};
+				for (Uint64 i = 0; i < length_sequence.size();)
+				{
+					Uint8 const length = length_sequence[i];
+					Uint64 run = 1;
+					while (i + run < length_sequence.size() && length_sequence[i + run] == length) ++run;
+					i += run;
+
+					if (length == 0)
+					{
+						while (run >= 11)
+						{
+							Uint64 const count = std::min<Uint64>(run, 138);
+							AddLengthToken(18, Uint8(count - 11));
+							run -= count;
+						}
+						if (run >= 3)
+						{
+							AddLengthToken(17, Uint8(run - 3));
+							run = 0;
+						}
+					}
+					else
+					{
+						AddLengthToken(length, 0);
+						--run;
+						while (run >= 3)
+						{
+							Uint64 const count = std::min<Uint64>(run, 6);
+							AddLengthToken(16, Uint8(count - 3));
+							run -= count;
+						}
+					}
+					for (; run > 0; --run) AddLengthToken(length, 0);
+				}
+
+				Uint8 code_length_lengths[CODE_LENGTH_SYMBOL_COUNT] = {};
+				Uint16 code_length_codes[CODE_LENGTH_SYMBOL_COUNT] = {};
+				BuildCodeLengths(code_length_frequencies, CODE_LENGTH_SYMBOL_COUNT, 7, code_length_lengths);
+				BuildCodes(code_length_lengths, CODE_LENGTH_SYMBOL_COUNT, code_length_codes);
+				Uint32 code_length_count = CODE_LENGTH_SYMBOL_COUNT;
+				while (code_length_count > 4 && code_length_lengths[CODE_LENGTH_ORDER[code_length_count - 1]] == 0) --code_length_count;
+
+				Uint16 litlen_codes[LITLEN_SYMBOL_COUNT] = {};
+				Uint16 distance_codes[DISTANCE_SYMBOL_COUNT] = {};
+				BuildCodes(litlen_lengths, LITLEN_SYMBOL_COUNT, litlen_codes);
+				BuildCodes(distance_lengths, DISTANCE_SYMBOL_COUNT, distance_codes);
+
+				writer.Write(final_block ? 1 : 0, 1);
+				writer.Write(2, 2);
+				writer.Write(litlen_count - 257, 5);
+				writer.Write(distance_count - 1, 5);
+				writer.Write(code_length_count - 4, 4);
+				for (Uint32 i = 0; i < code_length_count; ++i) writer.Write(code_length_lengths[CODE_LENGTH_ORDER[i]], 3);
+				for (auto const& [symbol, extra] : length_tokens)
+				{
+					writer.Write(code_length_codes[symbol], code_length_lengths[symbol]);
+					if (symbol == 16) writer.Write(extra, 2);
+					else if (symbol == 17) writer.Write(extra, 3);
+					else if (symbol == 18) writer.Write(extra, 7);
+				}
+
+				for (Uint32 token : tokens)
+				{
+					if (token & MATCH_FLAG)
+					{
+						Uint32 const length = (token >> 16) & 0x1ff;
+						Uint32 const distance = token & 0xffff;
+						Uint32 const length_code = GetLengthCode(length);
+						Uint32 const distance_code = GetDistanceCode(distance);
+						writer.Write(litlen_codes[257 + length_code], litlen_lengths[257 + length_code]);
+						writer.Write(length - LENGTH_BASE[length_code], LENGTH_EXTRA_BITS[length_code]);
+						writer.Write(distance_codes[distance_code], distance_lengths[distance_code]);
+						writer.Write(distance - DISTANCE_BASE[distance_code], DISTANCE_EXTRA_BITS[distance_code]);
+					}
+					else writer.Write(litlen_codes[token], litlen_lengths[token]);
+				}
+				writer.Write(litlen_codes[END_OF_BLOCK], litlen_lengths[END_OF_BLOCK]);
+			}
+		};
+
+		void AppendPNGChunk(std::vector<Uint8>& output, Char const* type, Uint8 const* data, Uint64 size)
+		{
+			AppendUint32BE(output, (Uint32)size);
+			Uint64 const type_offset = output.size();
+			AppendBytes(output, type, 4);
+			AppendBytes(output, data, size);
+			AppendUint32BE(output, CRC32(output.data() + type_offset, size + 4));
+		}
+	}
+
+	Bool EncodeQOI(ImageView const& image, std::vector<Uint8>& output)
+	{
+		if (image.format != ImagePixelFormat::RGBA8) return false;
+
+		struct Pixel
+		{
+			Uint8 r, g, b, a;
+			Bool operator==(Pixel const&) const = default;
+		};
+		auto Hash = [](Pixel const& p) { return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64; };
+
+		AppendBytes(output, "qoif", 4);
+		AppendUint32BE(output, image.width);
+		AppendUint32BE(output, image.height);
+		output.push_back(4);
+		output.push_back(0);
+
+		//worst case is 5 bytes per pixel, the output is written through a pointer and trimmed at the end
+		Uint64 const pixel_count = Uint64(image.width) * image.height;
+		Uint64 const data_offset = output.size();
+		output.resize(data_offset + pixel_count * 5 + 8);
+		Uint8* out = output.data() + data_offset;
+
+		Pixel index[64] = {};
+		Pixel previous{ 0, 0, 0, 255 };
+		Uint32 run = 0;
+		Uint64 pixel_index = 0;
+		for (Uint32 y = 0; y < image.height; ++y)
+		{
+			Pixel const* row = reinterpret_cast<Pixel const*>(static_cast<Uint8 const*>(image.data) + y * image.row_pitch);
+			for (Uint32 x = 0; x < image.width; ++x, ++pixel_index)
+			{
+				Pixel const pixel = row[x];
+				if (pixel == previous)
+				{
+					++run;
+					if (run == 62 || pixel_index + 1 == pixel_count)
+					{
+						*out++ = Uint8(0xc0 | (run - 1));
+						run = 0;
+					}
+					continue;
+				}
+				if (run > 0)
+				{
+					*out++ = Uint8(0xc0 | (run - 1));
+					run = 0;
+				}
+
+				Uint32 const hash = Hash(pixel);
+				if (index[hash] == pixel)
+				{
+					*out++ = Uint8(hash);
+				}
+				else
+				{
+					index[hash] = pixel;
+					if (pixel.a == previous.a)
+					{
+						Sint32 const dr = Sint8(pixel.r - previous.r);
+						Sint32 const dg = Sint8(pixel.g - previous.g);
+						Sint32 const db = Sint8(pixel.b - previous.b);
+						Sint32 const dr_dg = dr - dg;
+						Sint32 const db_dg = db - dg;
+						if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+						{
+							*out++ = Uint8(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+						}
+						else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+						{
+							*out++ = Uint8(0x80 | (dg + 32));
+							*out++ = Uint8(((dr_dg + 8) << 4) | (db_dg + 8));
+						}
+						else
+						{
+							Uint8 const rgb[4] = { 0xfe, pixel.r, pixel.g, pixel.b };
+							memcpy(out, rgb, sizeof(rgb));
+							out += sizeof(rgb);
+						}
+					}
+					else
+					{
+						Uint8 const rgba[5] = { 0xff, pixel.r, pixel.g, pixel.b, pixel.a };
+						memcpy(out, rgba, sizeof(rgba));
+						out += sizeof(rgba);
+					}
+				}
+				previous = pixel;
+			}
+		}
+		Uint8 const end_marker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+		memcpy(out, end_marker, sizeof(end_marker));
+		out += sizeof(end_marker);
+		output.resize(out - output.data());
+		return true;
+	}
+
+	Bool EncodePNG(ImageView const& image, std::vector<Uint8>& output)
+	{
+		if (image.format != ImagePixelFormat::RGBA8) return false;
+
+		Uint64 const row_size = Uint64(image.width) * 4;
+		std::vector<Uint8> filtered((row_size + 1) * image.height);
+		for (Uint32 y = 0; y < image.height; ++y)
+		{
+			Uint8 const* row = static_cast<Uint8 const*>(image.data) + y * image.row_pitch;
+			Uint8* filtered_row = filtered.data() + y * (row_size + 1);
+			if (y == 0)
+			{
+				filtered_row[0] = 0;
+				memcpy(filtered_row + 1, row, row_size);
+				continue;
+			}
+			Uint8 const* previous_row = row - image.row_pitch;
+			filtered_row[0] = 2;
+			for (Uint64 i = 0; i < row_size; ++i) filtered_row[i + 1] = Uint8(row[i] - previous_row[i]);
+		}
+
+		std::vector<Uint8> zlib_stream;
+		zlib_stream.reserve(filtered.size() / 2);
+		zlib_stream.push_back(0x78);
+		zlib_stream.push_back(0x01);
+		Deflater deflater(filtered.data(), filtered.size());
+		deflater.Compress(zlib_stream);
+		AppendUint32BE(zlib_stream, Adler32(filtered.data(), filtered.size()));
+
+		Uint8 const signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		AppendBytes(output, signature, sizeof(signature));
+
+		std::vector<Uint8> header;
+		AppendUint32BE(header, image.width);
+		AppendUint32BE(header, image.height);
+		Uint8 const header_tail[5] = { 8, 6, 0, 0, 0 }; //8 bit RGBA, deflate, adaptive filtering, no interlace
+		AppendBytes(header, header_tail, sizeof(header_tail));
+		AppendPNGChunk(output, "IHDR", header.data(), header.size());
+		AppendPNGChunk(output, "IDAT", zlib_stream.data(), zlib_stream.size());
+		AppendPNGChunk(output, "IEND", nullptr, 0);
+		return true;
+	}
+
+	Bool EncodePFM(ImageView const& image, std::vector<Uint8>& output)
+	{
+		//negative scale marks little endian data, rows are stored bottom to top
+		AppendString(output, "PF\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n-1.0\n");
+		Uint64 const data_offset = output.size();
+		output.resize(data_offset + Uint64(image.width) * image.height * 3 * sizeof(Float));
+		Uint8* pixels = output.data() + data_offset;
+		for (Uint32 y = 0; y < image.height; ++y)
+		{
+			Uint8 const* row = static_cast<Uint8 const*>(image.data) + Uint64(image.height - 1 - y) * image.row_pitch;
+			Uint8* output_row = pixels + Uint64(y) * image.width * 3 * sizeof(Float);
+			for (Uint32 x = 0; x < image.width; ++x)
+			{
+				for (Uint32 c = 0; c < 3; ++c)
+				{
+					Float value = 0.0f;
+					switch (image.format)
+					{
+					case ImagePixelFormat::RGBA8:
+						value = row[x * 4 + c] / 255.0f;
+						break;
+					case ImagePixelFormat::RGBA16F:
+					{
+						Uint16 half;
+						memcpy(&half, row + (x * 4 + c) * sizeof(Uint16), sizeof(half));
+						value = HalfToFloat(half);
+						break;
+					}
+					case ImagePixelFormat::RGBA32F:
+						memcpy(&value, row + (x * 4 + c) * sizeof(Float), sizeof(value));
+						break;
+					}
+					memcpy(output_row + (x * 3 + c) * sizeof(Float), &value, sizeof(value));
+				}
+			}
+		}
+		return true;
+	}
+}
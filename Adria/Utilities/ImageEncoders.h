@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+
+namespace adria
+{
+	enum class ImagePixelFormat : Uint8
+	{
+		RGBA8,
+		RGBA16F,
+		RGBA32F
+	};
+
+	//rows are row_pitch bytes apart, readback buffers have their rows padded to 256 bytes
+	struct ImageView
+	{
+		void const* data = nullptr;
+		Uint32 width = 0;
+		Uint32 height = 0;
+		Uint64 row_pitch = 0;
+		ImagePixelFormat format = ImagePixelFormat::RGBA8;
+	};
+
+	//encoders append the complete file to output and return false if the pixel format is not supported.
+	//they have no dependencies on the rest of the engine so they can be run on any thread
+
+	//QOI, RGBA8 only
+	Bool EncodeQOI(ImageView const& image, std::vector<Uint8>& output);
+	//PNG tuned for speed: every row uses the up filter and is deflated with a single probe LZ77 matcher, RGBA8 only
+	Bool EncodePNG(ImageView const& image, std::vector<Uint8>& output);
+	//PFM with RGB float pixels, alpha is dropped, all formats
+	Bool EncodePFM(ImageView const& image, std::vector<Uint8>& output);
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <functional>
+
+namespace adria
+{
+	//std::function replacement that never allocates: the callable is stored in a fixed size buffer inside the object
+	//and a callable that does not fit fails to compile instead of falling back to the heap.
+	//it is move-only, so callables that capture move-only types can be stored as well.
+	//the default alignment covers lambdas that capture SIMD types such as XMMATRIX
+	template<typename Signature, Uint64 Capacity = 32, Uint64 Alignment = 16>
+	class InlineFunction;
+
+	template<typename R, typename... Args, Uint64 Capacity, Uint64 Alignment>
+	class InlineFunction<R(Args...), Capacity, Alignment>
+	{
+		using InvokeFn = R(*)(void*, Args&&...);
+		//moves the callable from src to dst and destroys src, if dst is null src is only destroyed
+		using ManageFn = void(*)(void* dst, void* src);
+
+		template<typename F>
+		static constexpr Bool IsTriviallyRelocatable = std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>;
+
+	public:
+		static constexpr Uint64 CAPACITY = Capacity;
+		static constexpr Uint64 ALIGNMENT = Alignment;
+
+		InlineFunction() = default;
+		InlineFunction(std::nullptr_t) {}
+
+		template<typename F> requires (!std::is_same_v<std::decay_t<F>, InlineFunction> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+		InlineFunction(F&& callable)
+		{
+			using Callable = std::decay_t<F>;
+			static_assert(sizeof(Callable) <= Capacity, "Callable does not fit into the inline storage of InlineFunction, increase its capacity!");
+			static_assert(alignof(Callable) <= Alignment, "Callable is over-aligned for the inline storage of InlineFunction, increase its alignment!");
+
+			if constexpr (std::is_pointer_v<Callable> || std::is_member_pointer_v<Callable>)
+			{
+				if (callable == nullptr) return;
+			}
+			new(storage) Callable(std::forward<F>(callable));
+			invoke = [](void* object, Args&&... args) -> R
+				{
+					//invoke_r discards the result of value returning callables stored in a function returning void
+					return std::invoke_r<R>(*static_cast<Callable*>(object), std::forward<Args>(args)...);
+				};
+			if constexpr (!IsTriviallyRelocatable<Callable>)
+			{
+				manage = [](void* dst, void* src)
+					{
+						Callable* object = static_cast<Callable*>(src);
+						if (dst) new(dst) Callable(std::move(*object));
+						object->~Callable();
+					};
+			}
+		}
+
+		ADRIA_NONCOPYABLE(InlineFunction)
+		InlineFunction(InlineFunction&& that) noexcept
+		{
+			MoveFrom(that);
+		}
+		InlineFunction& operator=(InlineFunction&& that) noexcept
+		{
+			if (this != &that)
+			{
+				Reset();
+				MoveFrom(that);
+			}
+			return *this;
+		}
+		InlineFunction& operator=(std::nullptr_t)
+		{
+			Reset();
+			return *this;
+		}
+		~InlineFunction()
+		{
+			Reset();
+		}
+
+		R operator()(Args... args) const
+		{
+			ADRIA_ASSERT(invoke != nullptr);
+			return invoke(storage, std::forward<Args>(args)...);
+		}
+
+		explicit operator Bool() const { return invoke != nullptr; }
+		Bool operator==(std::nullptr_t) const { return invoke == nullptr; }
+
+		void Reset()
+		{
+			if (manage) manage(nullptr, storage);
+			invoke = nullptr;
+			manage = nullptr;
+		}
+
+	private:
+		alignas(Alignment) mutable Uint8 storage[Capacity];
+		InvokeFn invoke = nullptr;
+		ManageFn manage = nullptr;
+
+	private:
+		void MoveFrom(InlineFunction& that)
+		{
+			if (that.manage) that.manage(storage, that.storage);
+			else if (that.invoke) memcpy(storage, that.storage, Capacity);
+			invoke = that.invoke;
+			manage = that.manage;
+			that.invoke = nullptr;
+			that.manage = nullptr;
+		}
+	};
+}
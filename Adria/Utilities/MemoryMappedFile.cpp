@@ -0,0 +1,79 @@
+#include "MemoryMappedFile.h"
+#include "StringUtil.h"
+
+namespace adria
+{
+	MemoryMappedFile::MemoryMappedFile(std::string_view file_path)
+	{
+		Open(file_path);
+	}
+
+	MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
+		: file(std::exchange(other.file, nullptr)), mapping(std::exchange(other.mapping, nullptr)),
+		  data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0))
+	{
+	}
+
+	MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			file = std::exchange(other.file, nullptr);
+			mapping = std::exchange(other.mapping, nullptr);
+			data = std::exchange(other.data, nullptr);
+			size = std::exchange(other.size, 0);
+		}
+		return *this;
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		Close();
+	}
+
+	Bool MemoryMappedFile::Open(std::string_view file_path)
+	{
+		Close();
+
+		std::wstring wide_path = ToWideString(std::string(file_path));
+		HANDLE file_handle = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file_handle == INVALID_HANDLE_VALUE) return false;
+		file = file_handle;
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+
+		HANDLE mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping_handle)
+		{
+			Close();
+			return false;
+		}
+		mapping = mapping_handle;
+
+		data = static_cast<Uint8 const*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+		if (!data)
+		{
+			Close();
+			return false;
+		}
+		size = static_cast<Uint64>(file_size.QuadPart);
+		return true;
+	}
+
+	void MemoryMappedFile::Close()
+	{
+		if (data) UnmapViewOfFile(data);
+		if (mapping) CloseHandle(mapping);
+		if (file) CloseHandle(file);
+		file = nullptr;
+		mapping = nullptr;
+		data = nullptr;
+		size = 0;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <string_view>
+#include <span>
+
+namespace adria
+{
+	//read-only view of a whole file mapped into the address space
+	class MemoryMappedFile
+	{
+	public:
+		MemoryMappedFile() = default;
+		explicit MemoryMappedFile(std::string_view file_path);
+		ADRIA_NONCOPYABLE(MemoryMappedFile)
+		MemoryMappedFile(MemoryMappedFile&&) noexcept;
+		MemoryMappedFile& operator=(MemoryMappedFile&&) noexcept;
+		~MemoryMappedFile();
+
+		Bool Open(std::string_view file_path);
+		void Close();
+
+		Bool IsOpen() const { return data != nullptr; }
+		Uint8 const* Data() const { return data; }
+		Uint64 Size() const { return size; }
+		std::span<Uint8 const> Bytes() const { return std::span<Uint8 const>(data, size); }
+
+	private:
+		void* file = nullptr;
+		void* mapping = nullptr;
+		Uint8 const* data = nullptr;
+		Uint64 size = 0;
+	};
+}
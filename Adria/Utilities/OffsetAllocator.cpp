@@ -0,0 +1,290 @@
+#include <bit>
+#include <algorithm>
+#include "OffsetAllocator.h"
+
+namespace adria
+{
+	namespace
+	{
+		//sizes are binned as small floats: 5 bit exponent and 3 bit mantissa, sizes below 8 are exact
+		constexpr Uint32 MantissaBits = 3;
+		constexpr Uint32 MantissaValue = 1 << MantissaBits;
+		constexpr Uint32 MantissaMask = MantissaValue - 1;
+
+		Uint32 SizeToBinRoundUp(Uint32 size)
+		{
+			Uint32 exponent = 0;
+			Uint32 mantissa = 0;
+			if (size < MantissaValue)
+			{
+				mantissa = size;
+			}
+			else
+			{
+				Uint32 const highest_set_bit = 31 - std::countl_zero(size);
+				Uint32 const mantissa_start_bit = highest_set_bit - MantissaBits;
+				exponent = mantissa_start_bit + 1;
+				mantissa = (size >> mantissa_start_bit) & MantissaMask;
+				Uint32 const low_bits_mask = (1u << mantissa_start_bit) - 1;
+				if (size & low_bits_mask) ++mantissa;
+			}
+			//mantissa overflow carries into the exponent
+			return (exponent << MantissaBits) + mantissa;
+		}
+
+		Uint32 SizeToBinRoundDown(Uint32 size)
+		{
+			Uint32 exponent = 0;
+			Uint32 mantissa = 0;
+			if (size < MantissaValue)
+			{
+				mantissa = size;
+			}
+			else
+			{
+				Uint32 const highest_set_bit = 31 - std::countl_zero(size);
+				Uint32 const mantissa_start_bit = highest_set_bit - MantissaBits;
+				exponent = mantissa_start_bit + 1;
+				mantissa = (size >> mantissa_start_bit) & MantissaMask;
+			}
+			return (exponent << MantissaBits) | mantissa;
+		}
+
+		constexpr Uint32 NoSpace = Uint32(-1);
+		Uint32 FindLowestSetBitAfter(Uint32 mask, Uint32 start_bit)
+		{
+			if (start_bit >= 32) return NoSpace;
+			Uint32 const masked = mask & ~((1u << start_bit) - 1);
+			return masked ? std::countr_zero(masked) : NoSpace;
+		}
+	}
+
+	OffsetAllocator::OffsetAllocator(Uint32 size, Uint32 max_allocations) : size(size), max_allocations(max_allocations)
+	{
+		ADRIA_ASSERT(size > 0 && max_allocations > 1);
+		Reset();
+	}
+
+	OffsetAllocation OffsetAllocator::Allocate(Uint32 alloc_size)
+	{
+		ADRIA_ASSERT(alloc_size > 0);
+		//a split needs a node for the remainder
+		if (free_node_count == 0) return OffsetAllocation{};
+
+		//round up so that every node in the found bin is large enough
+		Uint32 const min_bin_index = SizeToBinRoundUp(alloc_size);
+		Uint32 const min_top_bin_index = min_bin_index >> MantissaBits;
+		Uint32 const min_leaf_bin_index = min_bin_index & MantissaMask;
+
+		Uint32 top_bin_index = min_top_bin_index;
+		Uint32 leaf_bin_index = NoSpace;
+		if (top_bin_index < TopBinCount && (used_bins_top & (1u << top_bin_index)))
+		{
+			leaf_bin_index = FindLowestSetBitAfter(used_bins[top_bin_index], min_leaf_bin_index);
+		}
+		if (leaf_bin_index == NoSpace)
+		{
+			top_bin_index = FindLowestSetBitAfter(used_bins_top, min_top_bin_index + 1);
+			if (top_bin_index == NoSpace) return OffsetAllocation{};
+			leaf_bin_index = std::countr_zero(used_bins[top_bin_index]);
+		}
+
+		Uint32 const bin_index = (top_bin_index << MantissaBits) | leaf_bin_index;
+		Uint32 const node_index = bin_indices[bin_index];
+		Node& node = nodes[node_index];
+		Uint32 const node_total_size = node.data_size;
+		ADRIA_ASSERT(node_total_size >= alloc_size);
+
+		node.data_size = alloc_size;
+		node.used = true;
+		bin_indices[bin_index] = node.bin_list_next;
+		if (node.bin_list_next != Unused) nodes[node.bin_list_next].bin_list_prev = Unused;
+		free_size -= node_total_size;
+		if (bin_indices[bin_index] == Unused)
+		{
+			used_bins[top_bin_index] &= ~(1u << leaf_bin_index);
+			if (used_bins[top_bin_index] == 0) used_bins_top &= ~(1u << top_bin_index);
+		}
+
+		Uint32 const remainder_size = node_total_size - alloc_size;
+		if (remainder_size > 0)
+		{
+			Uint32 const new_node_index = InsertNodeIntoBin(remainder_size, node.data_offset + alloc_size);
+			Node& new_node = nodes[new_node_index];
+			if (node.neighbor_next != Unused) nodes[node.neighbor_next].neighbor_prev = new_node_index;
+			new_node.neighbor_prev = node_index;
+			new_node.neighbor_next = node.neighbor_next;
+			node.neighbor_next = new_node_index;
+		}
+
+		++allocation_count;
+		return OffsetAllocation{ .offset = node.data_offset, .node = node_index };
+	}
+
+	void OffsetAllocator::Free(OffsetAllocation const& allocation)
+	{
+		if (!allocation.IsValid()) return;
+
+		Uint32 const node_index = allocation.node;
+		Node& node = nodes[node_index];
+		ADRIA_ASSERT_MSG(node.used, "Double free of an offset allocation!");
+
+		Uint32 offset = node.data_offset;
+		Uint32 region_size = node.data_size;
+		if (node.neighbor_prev != Unused && !nodes[node.neighbor_prev].used)
+		{
+			Node& prev_node = nodes[node.neighbor_prev];
+			offset = prev_node.data_offset;
+			region_size += prev_node.data_size;
+			RemoveNodeFromBin(node.neighbor_prev);
+			ADRIA_ASSERT(prev_node.neighbor_next == node_index);
+			node.neighbor_prev = prev_node.neighbor_prev;
+		}
+		if (node.neighbor_next != Unused && !nodes[node.neighbor_next].used)
+		{
+			Node& next_node = nodes[node.neighbor_next];
+			region_size += next_node.data_size;
+			RemoveNodeFromBin(node.neighbor_next);
+			ADRIA_ASSERT(next_node.neighbor_prev == node_index);
+			node.neighbor_next = next_node.neighbor_next;
+		}
+
+		Uint32 const neighbor_next = node.neighbor_next;
+		Uint32 const neighbor_prev = node.neighbor_prev;
+		node = Node{};
+		free_nodes[free_node_count++] = node_index;
+		--allocation_count;
+
+		Uint32 const combined_node_index = InsertNodeIntoBin(region_size, offset);
+		if (neighbor_next != Unused)
+		{
+			nodes[combined_node_index].neighbor_next = neighbor_next;
+			nodes[neighbor_next].neighbor_prev = combined_node_index;
+		}
+		if (neighbor_prev != Unused)
+		{
+			nodes[combined_node_index].neighbor_prev = neighbor_prev;
+			nodes[neighbor_prev].neighbor_next = combined_node_index;
+		}
+	}
+
+	void OffsetAllocator::Reset()
+	{
+		free_size = 0;
+		allocation_count = 0;
+		used_bins_top = 0;
+		std::fill(std::begin(used_bins), std::end(used_bins), Uint8(0));
+		std::fill(std::begin(bin_indices), std::end(bin_indices), Unused);
+
+		nodes.assign(max_allocations, Node{});
+		free_nodes.resize(max_allocations);
+		for (Uint32 i = 0; i < max_allocations; ++i) free_nodes[i] = max_allocations - i - 1;
+		free_node_count = max_allocations;
+
+		InsertNodeIntoBin(size, 0);
+	}
+
+	Uint32 OffsetAllocator::GetAllocationSize(OffsetAllocation const& allocation) const
+	{
+		if (!allocation.IsValid()) return 0;
+		return nodes[allocation.node].data_size;
+	}
+
+	OffsetAllocatorStats OffsetAllocator::GetStats() const
+	{
+		OffsetAllocatorStats stats{};
+		stats.total_size = size;
+		stats.free_size = free_size;
+		stats.allocation_count = allocation_count;
+		for (Uint32 bin_index = 0; bin_index < LeafBinCount; ++bin_index)
+		{
+			for (Uint32 node_index = bin_indices[bin_index]; node_index != Unused; node_index = nodes[node_index].bin_list_next)
+			{
+				stats.largest_free_region = std::max(stats.largest_free_region, nodes[node_index].data_size);
+				++stats.free_region_count;
+			}
+		}
+		stats.fragmentation = free_size > 0 ? 1.0f - (Float)stats.largest_free_region / free_size : 0.0f;
+		return stats;
+	}
+
+	std::vector<OffsetAllocatorMove> OffsetAllocator::CreateDefragmentationPlan(Uint32 max_moved_size)
+	{
+		std::vector<OffsetAllocation> allocations;
+		allocations.reserve(allocation_count);
+		for (Uint32 node_index = 0; node_index < max_allocations; ++node_index)
+		{
+			if (nodes[node_index].used) allocations.push_back(OffsetAllocation{ .offset = nodes[node_index].data_offset, .node = node_index });
+		}
+		std::sort(allocations.begin(), allocations.end(), [](OffsetAllocation const& a, OffsetAllocation const& b) { return a.offset > b.offset; });
+
+		std::vector<OffsetAllocatorMove> moves;
+		Uint32 moved_size = 0;
+		for (OffsetAllocation const& allocation : allocations)
+		{
+			Uint32 const allocation_size = nodes[allocation.node].data_size;
+			if (moved_size + allocation_size > max_moved_size) continue;
+
+			//both regions are live while the data is copied, so the move never overlaps itself
+			OffsetAllocation new_allocation = Allocate(allocation_size);
+			if (!new_allocation.IsValid()) continue;
+			if (new_allocation.offset > allocation.offset)
+			{
+				Free(new_allocation);
+				continue;
+			}
+			moves.push_back(OffsetAllocatorMove{ .from = allocation, .to = new_allocation, .size = allocation_size });
+			moved_size += allocation_size;
+		}
+		return moves;
+	}
+
+	Uint32 OffsetAllocator::InsertNodeIntoBin(Uint32 region_size, Uint32 data_offset)
+	{
+		//round down so that the bin never promises more than the node has
+		Uint32 const bin_index = SizeToBinRoundDown(region_size);
+		Uint32 const top_bin_index = bin_index >> MantissaBits;
+		Uint32 const leaf_bin_index = bin_index & MantissaMask;
+		if (bin_indices[bin_index] == Unused)
+		{
+			used_bins[top_bin_index] |= 1u << leaf_bin_index;
+			used_bins_top |= 1u << top_bin_index;
+		}
+
+		ADRIA_ASSERT(free_node_count > 0);
+		Uint32 const top_node_index = bin_indices[bin_index];
+		Uint32 const node_index = free_nodes[--free_node_count];
+		nodes[node_index] = Node{ .data_offset = data_offset, .data_size = region_size, .bin_list_next = top_node_index };
+		if (top_node_index != Unused) nodes[top_node_index].bin_list_prev = node_index;
+		bin_indices[bin_index] = node_index;
+
+		free_size += region_size;
+		return node_index;
+	}
+
+	void OffsetAllocator::RemoveNodeFromBin(Uint32 node_index)
+	{
+		Node& node = nodes[node_index];
+		if (node.bin_list_prev != Unused)
+		{
+			nodes[node.bin_list_prev].bin_list_next = node.bin_list_next;
+			if (node.bin_list_next != Unused) nodes[node.bin_list_next].bin_list_prev = node.bin_list_prev;
+		}
+		else
+		{
+			Uint32 const bin_index = SizeToBinRoundDown(node.data_size);
+			Uint32 const top_bin_index = bin_index >> MantissaBits;
+			Uint32 const leaf_bin_index = bin_index & MantissaMask;
+
+			bin_indices[bin_index] = node.bin_list_next;
+			if (node.bin_list_next != Unused) nodes[node.bin_list_next].bin_list_prev = Unused;
+			if (bin_indices[bin_index] == Unused)
+			{
+				used_bins[top_bin_index] &= ~(1u << leaf_bin_index);
+				if (used_bins[top_bin_index] == 0) used_bins_top &= ~(1u << top_bin_index);
+			}
+		}
+		free_nodes[free_node_count++] = node_index;
+		free_size -= node.data_size;
+	}
+}
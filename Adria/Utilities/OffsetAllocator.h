@@ -0,0 +1,93 @@
+#pragma once
+#include <vector>
+
+namespace adria
+{
+	struct OffsetAllocation
+	{
+		static constexpr Uint32 InvalidOffset = Uint32(-1);
+		static constexpr Uint32 InvalidNode = Uint32(-1);
+
+		Uint32 offset = InvalidOffset;
+		Uint32 node = InvalidNode;
+
+		Bool IsValid() const { return node != InvalidNode; }
+	};
+
+	struct OffsetAllocatorStats
+	{
+		Uint32 total_size = 0;
+		Uint32 free_size = 0;
+		Uint32 largest_free_region = 0;
+		Uint32 allocation_count = 0;
+		Uint32 free_region_count = 0;
+		//1 - largest free region / free size, 0 when all free space is in one region
+		Float fragmentation = 0.0f;
+	};
+
+	//move of an allocation to a lower offset. both allocations are live when the plan is returned:
+	//the caller copies the data, switches its users to the new allocation and frees the old one once the gpu is done with it
+	struct OffsetAllocatorMove
+	{
+		OffsetAllocation from;
+		OffsetAllocation to;
+		Uint32 size;
+	};
+
+	//TLSF-style allocator of ranges inside a linear resource (e.g. a buffer), it never touches the memory it manages.
+	//free regions are binned by size with a 3 bit mantissa floating point scheme and found with two bit scans,
+	//so both allocation and free are O(1). freed regions are merged with their free neighbours
+	class OffsetAllocator
+	{
+		static constexpr Uint32 TopBinCount = 32;
+		static constexpr Uint32 BinsPerLeaf = 8;
+		static constexpr Uint32 LeafBinCount = TopBinCount * BinsPerLeaf;
+		static constexpr Uint32 Unused = Uint32(-1);
+
+		struct Node
+		{
+			Uint32 data_offset = 0;
+			Uint32 data_size = 0;
+			Uint32 bin_list_prev = Unused;
+			Uint32 bin_list_next = Unused;
+			Uint32 neighbor_prev = Unused;
+			Uint32 neighbor_next = Unused;
+			Bool used = false;
+		};
+
+	public:
+		OffsetAllocator(Uint32 size, Uint32 max_allocations = 128 * 1024);
+
+		//returns an invalid allocation if there is no free region large enough
+		OffsetAllocation Allocate(Uint32 size);
+		void Free(OffsetAllocation const& allocation);
+		void Reset();
+
+		Uint32 GetAllocationSize(OffsetAllocation const& allocation) const;
+		Uint32 GetSize() const { return size; }
+		Uint32 GetFreeSize() const { return free_size; }
+		OffsetAllocatorStats GetStats() const;
+
+		//moves allocations from the end of the range into lower free regions until max_moved_size is reached,
+		//call it every frame with a small budget to defragment incrementally
+		std::vector<OffsetAllocatorMove> CreateDefragmentationPlan(Uint32 max_moved_size);
+
+	private:
+		Uint32 size;
+		Uint32 max_allocations;
+		Uint32 free_size = 0;
+		Uint32 allocation_count = 0;
+
+		Uint32 used_bins_top = 0;
+		Uint8 used_bins[TopBinCount] = {};
+		Uint32 bin_indices[LeafBinCount] = {};
+
+		std::vector<Node> nodes;
+		std::vector<Uint32> free_nodes;
+		Uint32 free_node_count = 0;
+
+	private:
+		Uint32 InsertNodeIntoBin(Uint32 size, Uint32 data_offset);
+		void RemoveNodeFromBin(Uint32 node_index);
+	};
+}
@@ -0,0 +1,322 @@
+#include <filesystem>
+#include <stb_image.h>
+#include "PakFile.h"
+#include "HashUtil.h"
+#include "FilesUtil.h"
+#include "Logging/Logger.h"
+
+//defined in ImageWrite.cpp together with the rest of stb_image_write
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+namespace fs = std::filesystem;
+
+namespace adria
+{
+	namespace
+	{
+		constexpr Uint64 AlignPakOffset(Uint64 offset, Uint64 alignment)
+		{
+			return (offset + alignment - 1) & ~(alignment - 1);
+		}
+
+		Bool WritePadding(FILE* file, Uint64 from, Uint64 to)
+		{
+			static constexpr Uint8 zeros[256] = {};
+			while (from < to)
+			{
+				Uint64 const count = std::min<Uint64>(to - from, sizeof(zeros));
+				if (fwrite(zeros, count, 1, file) != 1) return false;
+				from += count;
+			}
+			return true;
+		}
+	}
+
+	std::string NormalizePakPath(std::string_view path)
+	{
+		std::vector<std::string_view> segments;
+		Uint64 segment_start = 0;
+		for (Uint64 i = 0; i <= path.size(); ++i)
+		{
+			if (i < path.size() && path[i] != '/' && path[i] != '\\') continue;
+			std::string_view const segment = path.substr(segment_start, i - segment_start);
+			segment_start = i + 1;
+			if (segment.empty() || segment == ".") continue;
+			if (segment == ".." && !segments.empty() && segments.back() != "..") segments.pop_back();
+			else segments.push_back(segment);
+		}
+
+		std::string normalized;
+		normalized.reserve(path.size());
+		for (std::string_view segment : segments)
+		{
+			if (!normalized.empty()) normalized += '/';
+			for (Char c : segment) normalized += (Char)std::tolower((unsigned char)c);
+		}
+		return normalized;
+	}
+
+	Uint64 HashPakPath(std::string_view normalized_path)
+	{
+		return crc64(normalized_path.data(), normalized_path.size());
+	}
+
+	PakWriter::PakWriter(PakWriteOptions const& _options) : options(_options)
+	{
+		options.alignment = std::max(options.alignment, (Uint32)alignof(PakEntry));
+		ADRIA_ASSERT((options.alignment & (options.alignment - 1)) == 0);
+	}
+
+	Bool PakWriter::AddFile(std::string_view path, std::string_view source_path)
+	{
+		std::string normalized_path = NormalizePakPath(path);
+		if (normalized_path.empty() || file_indices.contains(normalized_path))
+		{
+			ADRIA_LOG(WARNING, "Pak: file '%s' is empty or already added", std::string(path).c_str());
+			return false;
+		}
+		file_indices[normalized_path] = (Uint32)files.size();
+		files.push_back(PakFileSource{ .path = std::move(normalized_path), .source_path = std::string(source_path) });
+		return true;
+	}
+
+	Bool PakWriter::AddData(std::string_view path, std::span<Uint8 const> data)
+	{
+		std::string normalized_path = NormalizePakPath(path);
+		if (normalized_path.empty() || file_indices.contains(normalized_path))
+		{
+			ADRIA_LOG(WARNING, "Pak: file '%s' is empty or already added", std::string(path).c_str());
+			return false;
+		}
+		file_indices[normalized_path] = (Uint32)files.size();
+		files.push_back(PakFileSource{ .path = std::move(normalized_path), .data = std::vector<Uint8>(data.begin(), data.end()) });
+		return true;
+	}
+
+	Bool PakWriter::Write(std::string_view pak_path)
+	{
+		stats = PakWriteStats{};
+		FILE* pak_file = nullptr;
+		fopen_s(&pak_file, std::string(pak_path).c_str(), "wb");
+		if (!pak_file)
+		{
+			ADRIA_LOG(ERROR, "Pak: failed to create '%s'", std::string(pak_path).c_str());
+			return false;
+		}
+
+		//blobs are written in path order, files of one directory end up next to each other
+		std::vector<PakFileSource const*> sorted_files(files.size());
+		for (Uint64 i = 0; i < files.size(); ++i) sorted_files[i] = &files[i];
+		std::sort(sorted_files.begin(), sorted_files.end(), [](PakFileSource const* a, PakFileSource const* b) { return a->path < b->path; });
+
+		std::vector<PakEntry> entries;
+		entries.reserve(files.size());
+		std::string names;
+		std::vector<Uint8> source_data;
+		Uint64 offset = sizeof(PakHeader);
+		Bool result = WritePadding(pak_file, 0, offset);
+		for (PakFileSource const* file : sorted_files)
+		{
+			if (!result) break;
+			std::span<Uint8 const> data = file->data;
+			if (!file->source_path.empty())
+			{
+				if (!ReadFileBytes(file->source_path, source_data))
+				{
+					ADRIA_LOG(ERROR, "Pak: failed to read '%s'", file->source_path.c_str());
+					result = false;
+					break;
+				}
+				data = source_data;
+			}
+
+			std::span<Uint8 const> stored_data = data;
+			Uint8* compressed_data = nullptr;
+			if (options.compress && !data.empty() && data.size() < INT_MAX)
+			{
+				Sint32 compressed_size = 0;
+				compressed_data = stbi_zlib_compress(const_cast<Uint8*>(data.data()), (Sint32)data.size(), &compressed_size, 8);
+				if (compressed_data && compressed_size < data.size() * options.max_compressed_ratio)
+				{
+					stored_data = std::span<Uint8 const>(compressed_data, (Uint64)compressed_size);
+				}
+			}
+
+			Uint64 const aligned_offset = AlignPakOffset(offset, options.alignment);
+			PakEntry& entry = entries.emplace_back();
+			entry.path_hash = HashPakPath(file->path);
+			entry.offset = aligned_offset;
+			entry.size = data.size();
+			entry.stored_size = stored_data.size();
+			entry.data_hash = crc64((Char const*)stored_data.data(), stored_data.size());
+			entry.name_offset = (Uint32)names.size();
+			entry.name_length = (Uint32)file->path.size();
+			entry.flags = stored_data.data() != data.data() ? PakEntryFlag_Compressed : PakEntryFlag_None;
+			entry.padding = 0;
+			names += file->path;
+
+			result = WritePadding(pak_file, offset, aligned_offset) && (stored_data.empty() || fwrite(stored_data.data(), stored_data.size(), 1, pak_file) == 1);
+			free(compressed_data);
+			offset = aligned_offset + stored_data.size();
+
+			++stats.file_count;
+			stats.compressed_count += (entry.flags & PakEntryFlag_Compressed) != 0;
+			stats.total_size += entry.size;
+			stats.stored_size += entry.stored_size;
+		}
+
+		if (result)
+		{
+			//the toc is searched by hash, equal hashes are ordered by name
+			std::sort(entries.begin(), entries.end(), [&names](PakEntry const& a, PakEntry const& b)
+				{
+					if (a.path_hash != b.path_hash) return a.path_hash < b.path_hash;
+					return std::string_view(names).substr(a.name_offset, a.name_length) < std::string_view(names).substr(b.name_offset, b.name_length);
+				});
+
+			std::vector<Uint8> toc(entries.size() * sizeof(PakEntry) + names.size());
+			if (!entries.empty()) memcpy(toc.data(), entries.data(), entries.size() * sizeof(PakEntry));
+			if (!names.empty()) memcpy(toc.data() + entries.size() * sizeof(PakEntry), names.data(), names.size());
+
+			PakHeader header{};
+			header.magic = PAK_MAGIC;
+			header.version = PAK_VERSION;
+			header.entry_count = (Uint32)entries.size();
+			header.alignment = options.alignment;
+			header.toc_offset = AlignPakOffset(offset, options.alignment);
+			header.toc_size = toc.size();
+			header.toc_hash = crc64((Char const*)toc.data(), toc.size());
+
+			result = WritePadding(pak_file, offset, header.toc_offset) && (toc.empty() || fwrite(toc.data(), toc.size(), 1, pak_file) == 1);
+			result = result && fseek(pak_file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, pak_file) == 1;
+		}
+		result = fclose(pak_file) == 0 && result;
+		if (!result) ADRIA_LOG(ERROR, "Pak: failed to write '%s'", std::string(pak_path).c_str());
+		return result;
+	}
+
+	Bool PackDirectory(std::string_view directory, std::string_view pak_path, PakWriteOptions const& options)
+	{
+		std::error_code error;
+		if (!fs::is_directory(directory, error))
+		{
+			ADRIA_LOG(ERROR, "Pak: '%s' is not a directory", std::string(directory).c_str());
+			return false;
+		}
+
+		std::string const normalized_pak_path = NormalizePakPath(fs::absolute(pak_path, error).string());
+		PakWriter writer(options);
+		for (fs::directory_entry const& entry : fs::recursive_directory_iterator(directory, error))
+		{
+			if (!entry.is_regular_file()) continue;
+			if (NormalizePakPath(fs::absolute(entry.path(), error).string()) == normalized_pak_path) continue;
+			std::string const relative_path = fs::relative(entry.path(), directory, error).generic_string();
+			writer.AddFile(std::string(directory) + "/" + relative_path, entry.path().string());
+		}
+		if (!writer.Write(pak_path)) return false;
+
+		PakWriteStats const& stats = writer.GetStats();
+		ADRIA_LOG(INFO, "Pak: packed %u files (%u compressed) from '%s' into '%s', %.1f MB -> %.1f MB", stats.file_count, stats.compressed_count,
+			std::string(directory).c_str(), std::string(pak_path).c_str(), stats.total_size / (1024.0 * 1024.0), stats.stored_size / (1024.0 * 1024.0));
+		return true;
+	}
+
+	PakArchive::PakArchive(std::string_view pak_path)
+	{
+		Open(pak_path);
+	}
+
+	Bool PakArchive::Open(std::string_view pak_path)
+	{
+		Close();
+		if (!file.Open(pak_path))
+		{
+			ADRIA_LOG(ERROR, "Pak: failed to open '%s'", std::string(pak_path).c_str());
+			return false;
+		}
+
+		auto Fail = [&](Char const* reason)
+		{
+			ADRIA_LOG(ERROR, "Pak: '%s' is invalid, %s", std::string(pak_path).c_str(), reason);
+			Close();
+			return false;
+		};
+
+		if (file.Size() < sizeof(PakHeader)) return Fail("file too small");
+		PakHeader const* pak_header = reinterpret_cast<PakHeader const*>(file.Data());
+		if (pak_header->magic != PAK_MAGIC || pak_header->version != PAK_VERSION) return Fail("unknown format or version");
+		if (pak_header->toc_offset % alignof(PakEntry) != 0 || pak_header->toc_offset > file.Size() || pak_header->toc_size > file.Size() - pak_header->toc_offset ||
+			pak_header->toc_size < (Uint64)pak_header->entry_count * sizeof(PakEntry)) return Fail("table of contents out of bounds");
+
+		Uint8 const* toc = file.Data() + pak_header->toc_offset;
+		if (crc64((Char const*)toc, pak_header->toc_size) != pak_header->toc_hash) return Fail("table of contents hash mismatch");
+
+		std::span<PakEntry const> pak_entries(reinterpret_cast<PakEntry const*>(toc), pak_header->entry_count);
+		Uint64 const names_size = pak_header->toc_size - pak_entries.size_bytes();
+		for (PakEntry const& entry : pak_entries)
+		{
+			if ((Uint64)entry.name_offset + entry.name_length > names_size || entry.offset > pak_header->toc_offset ||
+				entry.stored_size > pak_header->toc_offset - entry.offset) return Fail("entry out of bounds");
+			if (!(entry.flags & PakEntryFlag_Compressed) && entry.stored_size != entry.size) return Fail("uncompressed entry with a stored size different from its size");
+		}
+
+		header = pak_header;
+		entries = pak_entries;
+		names = reinterpret_cast<Char const*>(toc + pak_entries.size_bytes());
+		return true;
+	}
+
+	void PakArchive::Close()
+	{
+		file.Close();
+		header = nullptr;
+		entries = {};
+		names = nullptr;
+	}
+
+	PakEntry const* PakArchive::FindEntry(std::string_view normalized_path) const
+	{
+		Uint64 const path_hash = HashPakPath(normalized_path);
+		auto it = std::lower_bound(entries.begin(), entries.end(), path_hash, [](PakEntry const& entry, Uint64 hash) { return entry.path_hash < hash; });
+		for (; it != entries.end() && it->path_hash == path_hash; ++it)
+		{
+			if (GetName(*it) == normalized_path) return &*it;
+		}
+		return nullptr;
+	}
+
+	std::string_view PakArchive::GetName(PakEntry const& entry) const
+	{
+		return std::string_view(names + entry.name_offset, entry.name_length);
+	}
+
+	std::span<Uint8 const> PakArchive::GetStoredData(PakEntry const& entry) const
+	{
+		return std::span<Uint8 const>(file.Data() + entry.offset, entry.stored_size);
+	}
+
+	Bool PakArchive::ReadEntry(PakEntry const& entry, std::vector<Uint8>& data) const
+	{
+		std::span<Uint8 const> stored_data = GetStoredData(entry);
+		data.resize(entry.size);
+		if (!(entry.flags & PakEntryFlag_Compressed))
+		{
+			if (!data.empty()) memcpy(data.data(), stored_data.data(), data.size());
+			return true;
+		}
+		if (entry.size > INT_MAX || entry.stored_size > INT_MAX) return false;
+		Sint32 const decompressed_size = stbi_zlib_decode_buffer((char*)data.data(), (Sint32)data.size(), (char const*)stored_data.data(), (Sint32)stored_data.size());
+		if (decompressed_size != (Sint32)entry.size)
+		{
+			ADRIA_LOG(ERROR, "Pak: failed to decompress '%s'", std::string(GetName(entry)).c_str());
+			return false;
+		}
+		return true;
+	}
+
+	Bool PakArchive::VerifyEntry(PakEntry const& entry) const
+	{
+		std::span<Uint8 const> stored_data = GetStoredData(entry);
+		return crc64((Char const*)stored_data.data(), stored_data.size()) == entry.data_hash;
+	}
+}
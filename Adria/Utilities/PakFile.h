@@ -0,0 +1,120 @@
+#pragma once
+#include <string>
+#include "MemoryMappedFile.h"
+
+namespace adria
+{
+	//pak layout: header, blobs at aligned offsets, table of contents at an aligned offset after the last blob.
+	//the toc is sorted by path hash and followed by the names of the entries
+	inline constexpr Uint32 PAK_MAGIC = 0x4B504441; //"ADPK"
+	inline constexpr Uint32 PAK_VERSION = 1;
+
+	enum PakEntryFlag : Uint32
+	{
+		PakEntryFlag_None = 0x0,
+		PakEntryFlag_Compressed = 0x1,
+	};
+
+	struct PakHeader
+	{
+		Uint32 magic;
+		Uint32 version;
+		Uint32 entry_count;
+		Uint32 alignment;
+		Uint64 toc_offset;
+		Uint64 toc_size;
+		//crc64 of the entries and names
+		Uint64 toc_hash;
+	};
+
+	struct PakEntry
+	{
+		Uint64 path_hash;
+		Uint64 offset;
+		Uint64 size;
+		Uint64 stored_size;
+		//crc64 of the stored bytes
+		Uint64 data_hash;
+		Uint32 name_offset;
+		Uint32 name_length;
+		Uint32 flags;
+		Uint32 padding;
+	};
+	static_assert(sizeof(PakEntry) == 56);
+
+	//paths in a pak are lowercase, use '/' and have no "." or ".." segments
+	std::string NormalizePakPath(std::string_view path);
+	Uint64 HashPakPath(std::string_view normalized_path);
+
+	struct PakWriteOptions
+	{
+		Uint32 alignment = 4096;
+		Bool compress = true;
+		//blobs that do not compress below this fraction of their size are stored, png and jpg usually are
+		Float max_compressed_ratio = 0.9f;
+	};
+
+	struct PakWriteStats
+	{
+		Uint32 file_count = 0;
+		Uint32 compressed_count = 0;
+		Uint64 total_size = 0;
+		Uint64 stored_size = 0;
+	};
+
+	class PakWriter
+	{
+		struct PakFileSource
+		{
+			std::string path;
+			std::string source_path;
+			std::vector<Uint8> data;
+		};
+
+	public:
+		explicit PakWriter(PakWriteOptions const& options = {});
+
+		//the source file is read when the pak is written
+		Bool AddFile(std::string_view path, std::string_view source_path);
+		Bool AddData(std::string_view path, std::span<Uint8 const> data);
+		Bool Write(std::string_view pak_path);
+
+		PakWriteStats const& GetStats() const { return stats; }
+
+	private:
+		PakWriteOptions options;
+		std::vector<PakFileSource> files;
+		std::unordered_map<std::string, Uint32> file_indices;
+		PakWriteStats stats;
+	};
+
+	//packs every file under the directory. the archive stores the paths the loaders open,
+	//so the directory has to be given relative to the working directory of the engine
+	Bool PackDirectory(std::string_view directory, std::string_view pak_path, PakWriteOptions const& options = {});
+
+	class PakArchive
+	{
+	public:
+		PakArchive() = default;
+		explicit PakArchive(std::string_view pak_path);
+
+		Bool Open(std::string_view pak_path);
+		void Close();
+		Bool IsOpen() const { return header != nullptr; }
+
+		PakEntry const* FindEntry(std::string_view normalized_path) const;
+		std::span<PakEntry const> GetEntries() const { return entries; }
+		std::string_view GetName(PakEntry const& entry) const;
+
+		//the bytes as stored in the mapped file, compressed entries have to go through ReadEntry
+		std::span<Uint8 const> GetStoredData(PakEntry const& entry) const;
+		Bool ReadEntry(PakEntry const& entry, std::vector<Uint8>& data) const;
+		Bool VerifyEntry(PakEntry const& entry) const;
+
+	private:
+		MemoryMappedFile file;
+		PakHeader const* header = nullptr;
+		std::span<PakEntry const> entries;
+		Char const* names = nullptr;
+	};
+}
@@ -0,0 +1,172 @@
+#include "ReadbackScheduler.h"
+#include "AllocatorUtil.h"
+
+namespace adria
+{
+	ReadbackScheduler::ReadbackScheduler(Uint64 page_size, Uint32 latency, Uint32 retire_frames)
+		: page_size(page_size), latency(std::max(latency, 1u)), retire_frames(retire_frames)
+	{
+		ADRIA_ASSERT(page_size > 0);
+	}
+
+	ReadbackAllocation ReadbackScheduler::Allocate(Uint64 size, Uint64 alignment, ReadbackCallback&& callback)
+	{
+		ADRIA_ASSERT(size > 0);
+		ADRIA_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		ReadbackAllocation allocation{ .ticket = next_ticket++, .page = InvalidPage, .offset = 0, .new_page = false };
+		if (size <= page_size)
+		{
+			if (shared_page != InvalidPage)
+			{
+				Page& page = pages[shared_page];
+				Uint64 const offset = AlignToPowerOfTwo(page.used, alignment);
+				if (offset + size <= page.size)
+				{
+					allocation.page = shared_page;
+					allocation.offset = offset;
+				}
+			}
+			if (allocation.page == InvalidPage)
+			{
+				shared_page = AcquirePage(page_size, allocation.new_page);
+				allocation.page = shared_page;
+			}
+		}
+		else
+		{
+			allocation.page = AcquirePage(AlignToPowerOfTwo(size, page_size), allocation.new_page);
+		}
+
+		Page& page = pages[allocation.page];
+		page.used = allocation.offset + size;
+		requests.push_back(Request{ .ticket = allocation.ticket, .page = allocation.page, .offset = allocation.offset, .size = size, .callback = std::move(callback) });
+
+		++stats.requests;
+		stats.requested_size += size;
+		return allocation;
+	}
+
+	Bool ReadbackScheduler::Cancel(ReadbackTicket ticket)
+	{
+		for (Request& request : requests)
+		{
+			if (request.ticket != ticket) continue;
+			if (request.callback)
+			{
+				request.callback = nullptr;
+				++stats.cancelled_requests;
+				return true;
+			}
+			return false;
+		}
+		return false;
+	}
+
+	void ReadbackScheduler::Submit(Uint64 fence_value)
+	{
+		for (Uint32 page_index : recording_pages)
+		{
+			Page& page = pages[page_index];
+			page.state = PageState::InFlight;
+			page.fence_value = fence_value;
+		}
+		recording_pages.clear();
+		shared_page = InvalidPage;
+		++frame;
+	}
+
+	void ReadbackScheduler::Update(Uint64 completed_fence_value, ReadbackPageDataFn const& page_data)
+	{
+		//fence values and latency grow with the request order, so the finished requests are always at the front
+		while (!requests.empty())
+		{
+			Page const& page = pages[requests.front().page];
+			if (!IsPageResolved(page, completed_fence_value)) break;
+
+			//callbacks may request new readbacks, which can grow the pages and the request queue
+			Uint32 const resolve_latency = (Uint32)(frame - page.frame);
+			Request request = std::move(requests.front());
+			requests.pop_front();
+			if (!request.callback) continue;
+
+			Uint8 const* data = static_cast<Uint8 const*>(page_data(request.page));
+			ADRIA_ASSERT(data != nullptr);
+			request.callback(data + request.offset, request.size);
+			++stats.resolved_requests;
+			stats.max_resolve_latency = std::max(stats.max_resolve_latency, resolve_latency);
+		}
+
+		for (Page& page : pages)
+		{
+			if (page.state == PageState::InFlight && IsPageResolved(page, completed_fence_value))
+			{
+				page.state = PageState::Free;
+				page.used = 0;
+				page.frame = frame;
+			}
+			else if (page.state == PageState::Free && page.frame + retire_frames <= frame)
+			{
+				page.state = PageState::Released;
+				stats.pool_size -= page.size;
+				page.size = 0;
+				++stats.released_pages;
+			}
+		}
+	}
+
+	void ReadbackScheduler::Reset()
+	{
+		requests.clear();
+		recording_pages.clear();
+		shared_page = InvalidPage;
+		for (Page& page : pages)
+		{
+			if (page.state == PageState::Released) continue;
+			page = Page{};
+			++stats.released_pages;
+		}
+		stats.pool_size = 0;
+	}
+
+	Uint32 ReadbackScheduler::AcquirePage(Uint64 size, Bool& new_page)
+	{
+		//best fit among the free pages, so small pages are not taken by requests that could share a page
+		Uint32 page_index = InvalidPage;
+		Uint32 released_index = InvalidPage;
+		for (Uint32 i = 0; i < (Uint32)pages.size(); ++i)
+		{
+			Page const& page = pages[i];
+			if (page.state == PageState::Free && page.size >= size && (page_index == InvalidPage || page.size < pages[page_index].size)) page_index = i;
+			else if (page.state == PageState::Released && released_index == InvalidPage) released_index = i;
+		}
+
+		new_page = page_index == InvalidPage;
+		if (new_page)
+		{
+			if (released_index == InvalidPage)
+			{
+				released_index = (Uint32)pages.size();
+				pages.emplace_back();
+			}
+			page_index = released_index;
+			pages[page_index].size = size;
+
+			++stats.created_pages;
+			stats.pool_size += size;
+			stats.peak_pool_size = std::max(stats.peak_pool_size, stats.pool_size);
+		}
+
+		Page& page = pages[page_index];
+		page.state = PageState::Recording;
+		page.used = 0;
+		page.frame = frame;
+		recording_pages.push_back(page_index);
+		return page_index;
+	}
+
+	Bool ReadbackScheduler::IsPageResolved(Page const& page, Uint64 completed_fence_value) const
+	{
+		return page.state == PageState::InFlight && completed_fence_value >= page.fence_value && frame >= page.frame + latency;
+	}
+}
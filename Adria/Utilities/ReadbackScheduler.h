@@ -0,0 +1,116 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include "InlineFunction.h"
+
+namespace adria
+{
+	//receives the data of a finished readback, data is only valid during the call
+	using ReadbackCallback = InlineFunction<void(void const*, Uint64), 48>;
+	//returns the mapped storage of a page
+	using ReadbackPageDataFn = InlineFunction<void const*(Uint32)>;
+	//0 is never returned for a request
+	using ReadbackTicket = Uint64;
+
+	struct ReadbackAllocation
+	{
+		ReadbackTicket ticket;
+		Uint32 page;
+		Uint64 offset;
+		//the storage of page has to be (re)created with GetPageSize(page) bytes before the readback is recorded
+		Bool new_page;
+	};
+
+	struct ReadbackSchedulerStats
+	{
+		Uint64 requested_size = 0;
+		Uint32 requests = 0;
+		Uint32 resolved_requests = 0;
+		Uint32 cancelled_requests = 0;
+		Uint32 created_pages = 0;
+		Uint32 released_pages = 0;
+		Uint64 pool_size = 0;
+		Uint64 peak_pool_size = 0;
+		Uint32 max_resolve_latency = 0;
+	};
+
+	//scheduling and pooling of gpu readbacks, independent of the gpu so it can be driven by a mock fence.
+	//requests are sub-allocated from pooled pages, small ones share the page of the frame and large ones get a page of their own.
+	//a frame is closed with the fence value that is signaled after its commands, and its callbacks run in the first Update
+	//that sees the fence passed and at least latency frames since the request. nothing ever waits for the fence:
+	//when no pooled page is free a new one is created, and pages that stay unused for retire_frames frames are released
+	class ReadbackScheduler
+	{
+		static constexpr Uint32 InvalidPage = Uint32(-1);
+
+		enum class PageState : Uint8
+		{
+			Released,
+			Free,
+			Recording,
+			InFlight
+		};
+
+		struct Page
+		{
+			Uint64 size = 0;
+			Uint64 used = 0;
+			Uint64 frame = 0;		//frame of the requests, or the frame of the last use for free pages
+			Uint64 fence_value = 0;
+			PageState state = PageState::Released;
+		};
+
+		struct Request
+		{
+			ReadbackTicket ticket;
+			Uint32 page;
+			Uint64 offset;
+			Uint64 size;
+			ReadbackCallback callback;
+		};
+
+	public:
+		ReadbackScheduler(Uint64 page_size, Uint32 latency = 1, Uint32 retire_frames = 64);
+		ADRIA_NONCOPYABLE(ReadbackScheduler)
+		ADRIA_DEFAULT_MOVABLE(ReadbackScheduler)
+		~ReadbackScheduler() = default;
+
+		//alignment has to be a power of two
+		ReadbackAllocation Allocate(Uint64 size, Uint64 alignment, ReadbackCallback&& callback);
+		//the callback of a cancelled request is never called, returns false if the request already resolved
+		Bool Cancel(ReadbackTicket ticket);
+		//closes the frame, fence_value is signaled after all readbacks allocated since the last submit
+		void Submit(Uint64 fence_value);
+		//runs the callbacks of the finished requests in request order
+		void Update(Uint64 completed_fence_value, ReadbackPageDataFn const& page_data);
+		//drops all requests without calling their callbacks and releases every page
+		void Reset();
+
+		void SetLatency(Uint32 _latency) { latency = std::max(_latency, 1u); }
+		Uint32 GetLatency() const { return latency; }
+		Uint64 GetFrame() const { return frame; }
+
+		Uint32 GetPageCount() const { return (Uint32)pages.size(); }
+		Uint64 GetPageSize(Uint32 page) const { return pages[page].size; }
+		Bool IsPageAllocated(Uint32 page) const { return pages[page].state != PageState::Released; }
+		Uint64 GetPendingRequestCount() const { return requests.size(); }
+		ReadbackSchedulerStats const& GetStats() const { return stats; }
+
+	private:
+		Uint64 page_size;
+		Uint32 latency;
+		Uint32 retire_frames;
+		Uint64 frame = 0;
+		ReadbackTicket next_ticket = 1;
+
+		std::vector<Page> pages;
+		std::vector<Uint32> recording_pages;
+		Uint32 shared_page = InvalidPage;
+		std::deque<Request> requests;
+		ReadbackSchedulerStats stats;
+
+	private:
+		Uint32 AcquirePage(Uint64 size, Bool& new_page);
+		Bool IsPageResolved(Page const& page, Uint64 completed_fence_value) const;
+	};
+}
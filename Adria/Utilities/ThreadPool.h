@@ -51,6 +51,13 @@ namespace adria
 			return result_future;
 		}
 
+		Uint32 GetThreadCount() const { return (Uint32)threads.size(); }
+		//number of tasks to submit for work split into work_count parts when the calling thread takes part in it as well
+		Uint32 GetHelperCount(Uint32 work_count) const
+		{
+			return work_count == 0 ? 0 : std::min<Uint32>(work_count - 1, GetThreadCount());
+		}
+
 	private:
 		std::vector<std::thread> threads;
 		ConcurrentQueue<std::function<void()>> task_queue;
@@ -0,0 +1,135 @@
+#include <atomic>
+#include "VirtualFileSystem.h"
+#include "FilesUtil.h"
+#include "ThreadPool.h"
+#include "Logging/Logger.h"
+
+namespace adria
+{
+	Bool VirtualFileSystem::Mount(std::string_view pak_path)
+	{
+		std::unique_ptr<PakArchive> archive = std::make_unique<PakArchive>();
+		if (!archive->Open(pak_path)) return false;
+		ADRIA_LOG(INFO, "VFS: mounted '%s' with %llu files", std::string(pak_path).c_str(), (Uint64)archive->GetEntries().size());
+		mounted_paks.push_back(MountedPak{ .path = std::string(pak_path), .archive = std::move(archive) });
+		return true;
+	}
+
+	void VirtualFileSystem::Unmount(std::string_view pak_path)
+	{
+		std::erase_if(mounted_paks, [pak_path](MountedPak const& mounted_pak) { return mounted_pak.path == pak_path; });
+	}
+
+	void VirtualFileSystem::UnmountAll()
+	{
+		mounted_paks.clear();
+	}
+
+	Bool VirtualFileSystem::ReadFile(std::string_view path, VFSFile& file) const
+	{
+		file = VFSFile{};
+		Read(Resolve(path, file));
+		return file.IsValid();
+	}
+
+	std::vector<VFSFile> VirtualFileSystem::ReadFiles(std::span<std::string const> paths) const
+	{
+		struct ReadBatch
+		{
+			std::vector<ReadRequest> requests;
+			std::atomic<Uint32> next_request = 0;
+			std::atomic<Uint32> finished_requests = 0;
+		};
+
+		std::vector<VFSFile> files(paths.size());
+		std::vector<ReadRequest> pak_requests;
+		std::shared_ptr<ReadBatch> batch = std::make_shared<ReadBatch>();
+		for (Uint64 i = 0; i < paths.size(); ++i)
+		{
+			ReadRequest const request = Resolve(paths[i], files[i]);
+			if (request.entry) pak_requests.push_back(request);
+			//uncompressed pak entries are views, they need no worker
+			if (!request.entry || (request.entry->flags & PakEntryFlag_Compressed)) batch->requests.push_back(request);
+			else Read(request);
+		}
+
+		//one prefetch for all pak ranges in file order instead of a page fault per touched page later
+		if (!pak_requests.empty())
+		{
+			std::vector<WIN32_MEMORY_RANGE_ENTRY> ranges;
+			ranges.reserve(pak_requests.size());
+			for (ReadRequest const& request : pak_requests)
+			{
+				std::span<Uint8 const> stored_data = request.archive->GetStoredData(*request.entry);
+				if (!stored_data.empty()) ranges.push_back(WIN32_MEMORY_RANGE_ENTRY{ .VirtualAddress = (void*)stored_data.data(), .NumberOfBytes = stored_data.size() });
+			}
+			std::sort(ranges.begin(), ranges.end(), [](WIN32_MEMORY_RANGE_ENTRY const& a, WIN32_MEMORY_RANGE_ENTRY const& b) { return a.VirtualAddress < b.VirtualAddress; });
+			if (!ranges.empty()) PrefetchVirtualMemory(GetCurrentProcess(), ranges.size(), ranges.data(), 0);
+		}
+
+		Uint32 const request_count = (Uint32)batch->requests.size();
+		if (request_count == 0) return files;
+
+		auto ReadRequests = [batch, request_count]()
+		{
+			for (Uint32 i = batch->next_request++; i < request_count; i = batch->next_request++)
+			{
+				Read(batch->requests[i]);
+				if (++batch->finished_requests == request_count) batch->finished_requests.notify_all();
+			}
+		};
+		Uint32 const worker_count = g_ThreadPool.GetHelperCount(request_count);
+		for (Uint32 i = 0; i < worker_count; ++i) g_ThreadPool.Submit(ReadRequests);
+		ReadRequests();
+		for (Uint32 finished = batch->finished_requests.load(); finished < request_count; finished = batch->finished_requests.load())
+		{
+			batch->finished_requests.wait(finished);
+		}
+		return files;
+	}
+
+	std::future<std::vector<VFSFile>> VirtualFileSystem::ReadFilesAsync(std::vector<std::string> paths) const
+	{
+		//a pool without threads would never run the task, read in place and hand out a ready future
+		if (g_ThreadPool.GetThreadCount() == 0)
+		{
+			std::promise<std::vector<VFSFile>> files;
+			files.set_value(ReadFiles(paths));
+			return files.get_future();
+		}
+		return g_ThreadPool.Submit([this, paths = std::move(paths)]() { return ReadFiles(paths); });
+	}
+
+	VirtualFileSystem::ReadRequest VirtualFileSystem::Resolve(std::string_view path, VFSFile& file) const
+	{
+		if (!mounted_paks.empty())
+		{
+			std::string const normalized_path = NormalizePakPath(path);
+			for (auto it = mounted_paks.rbegin(); it != mounted_paks.rend(); ++it)
+			{
+				PakArchive const* archive = it->archive.get();
+				if (PakEntry const* entry = archive->FindEntry(normalized_path)) return ReadRequest{ .archive = archive, .entry = entry, .path = path, .file = &file };
+			}
+		}
+		return ReadRequest{ .archive = nullptr, .entry = nullptr, .path = path, .file = &file };
+	}
+
+	void VirtualFileSystem::Read(ReadRequest const& request)
+	{
+		VFSFile& file = *request.file;
+		std::vector<Uint8> data;
+		if (!request.entry)
+		{
+			if (ReadFileBytes(request.path, data)) file.SetStorage(std::move(data));
+		}
+		else if (!(request.entry->flags & PakEntryFlag_Compressed))
+		{
+			file.view = request.archive->GetStoredData(*request.entry);
+			file.is_valid = true;
+		}
+		else if (request.archive->ReadEntry(*request.entry, data))
+		{
+			file.SetStorage(std::move(data));
+		}
+	}
+}
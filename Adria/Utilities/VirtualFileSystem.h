@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <future>
+#include "PakFile.h"
+#include "Singleton.h"
+
+namespace adria
+{
+	//contents of a file read through the virtual file system. uncompressed pak entries are views into the
+	//mapped archive and stay valid while the archive is mounted, everything else is owned by the file
+	class VFSFile
+	{
+		friend class VirtualFileSystem;
+	public:
+		VFSFile() = default;
+		ADRIA_NONCOPYABLE(VFSFile)
+		ADRIA_DEFAULT_MOVABLE(VFSFile)
+
+		Bool IsValid() const { return is_valid; }
+		Uint8 const* Data() const { return view.data(); }
+		Uint64 Size() const { return view.size(); }
+		std::span<Uint8 const> Bytes() const { return view; }
+
+	private:
+		std::vector<Uint8> storage;
+		std::span<Uint8 const> view;
+		Bool is_valid = false;
+
+	private:
+		void SetStorage(std::vector<Uint8>&& data)
+		{
+			storage = std::move(data);
+			view = storage;
+			is_valid = true;
+		}
+	};
+
+	//resolves paths against the mounted paks first and falls back to the disk. mounting is not thread safe,
+	//reading is and happens from loader threads
+	class VirtualFileSystem : public Singleton<VirtualFileSystem>
+	{
+		friend class Singleton<VirtualFileSystem>;
+
+		struct MountedPak
+		{
+			std::string path;
+			std::unique_ptr<PakArchive> archive;
+		};
+
+		struct ReadRequest
+		{
+			PakArchive const* archive;
+			PakEntry const* entry;
+			std::string_view path;
+			VFSFile* file;
+		};
+
+	public:
+		//later mounts take precedence over earlier ones
+		Bool Mount(std::string_view pak_path);
+		void Unmount(std::string_view pak_path);
+		void UnmountAll();
+
+		Bool ReadFile(std::string_view path, VFSFile& file) const;
+		//reads the files in one batch: the pak ranges are prefetched together and in file order, decompression
+		//and disk reads are spread over the thread pool. the calling thread takes part, so it never waits on an idle pool
+		std::vector<VFSFile> ReadFiles(std::span<std::string const> paths) const;
+		std::future<std::vector<VFSFile>> ReadFilesAsync(std::vector<std::string> paths) const;
+
+	private:
+		std::vector<MountedPak> mounted_paks;
+
+	private:
+		VirtualFileSystem() = default;
+
+		ReadRequest Resolve(std::string_view path, VFSFile& file) const;
+		static void Read(ReadRequest const& request);
+	};
+	#define g_VirtualFileSystem VirtualFileSystem::Get()
+}
@@ -6,6 +6,8 @@
 #include "Editor/Editor.h"
 #include "Utilities/MemoryDebugger.h"
 #include "Utilities/CLIParser.h"
+#include "Utilities/PakFile.h"
+#include "Core/ConsoleManager.h"
 
 using namespace adria;
 
@@ -30,8 +32,17 @@ int APIENTRY wWinMain(
 	CLIArg& gpu_validation = parser.AddArg(false, "-gpuvalidation");
 	CLIArg& pix = parser.AddArg(false, "-pix");
 	CLIArg& aftermath = parser.AddArg(false, "-aftermath");
+	CLIArg& benchmark = parser.AddArg(true, "-benchmark", "--benchmark");
+	CLIArg& benchmark_filter = parser.AddArg(true, "-benchmarkfilter", "--benchmarkfilter");
+	CLIArg& render_graph_stats = parser.AddArg(false, "-rgstats", "--rendergraphstats");
+	CLIArg& capture_sequence = parser.AddArg(false, "-capture", "--capturesequence");
+	CLIArg& pak = parser.AddArg(true, "-pak", "--pakfile");
+	CLIArg& pack = parser.AddArg(true, "-pack", "--packdirectory");
+	CLIArg& pack_uncompressed = parser.AddArg(false, "-packuncompressed");
 
 	parser.Parse(lpCmdLine);
+	if (render_graph_stats) g_ConsoleManager.ProcessInput("r.RenderGraph.ExportStats 2");
+	if (capture_sequence) g_ConsoleManager.ProcessInput("r.Capture.Sequence 1");
     //MemoryDebugger::SetAllocHook(MemoryAllocHook);
     {
         std::string log_file = log.AsStringOr("adria.log");
@@ -39,6 +50,19 @@ int APIENTRY wWinMain(
         g_Log.Register(new FileLogger(log_file.c_str(), log_level));
         g_Log.Register(new OutputDebugStringLogger(log_level));
 
+        //packs the directory into the -pak file and exits without starting the engine
+        if (pack)
+        {
+            if (!pak)
+            {
+                ADRIA_LOG(ERROR, "-pack needs the output file in -pak");
+                return 1;
+            }
+            PakWriteOptions pak_options{};
+            pak_options.compress = !pack_uncompressed;
+            return PackDirectory(pack.AsString(), pak.AsString(), pak_options) ? 0 : 1;
+        }
+
 		std::string title_str = title.AsStringOr("Adria").c_str();
         WindowInit window_init{};
         window_init.width = width.AsIntOr(1080);
@@ -50,6 +74,9 @@ int APIENTRY wWinMain(
 
         EngineInit engine_init{};
         engine_init.scene_file = scene.AsStringOr("sponza.json");
+		engine_init.benchmark_file = benchmark.AsStringOr("");
+		engine_init.benchmark_filter = benchmark_filter.AsStringOr("");
+		engine_init.pak_file = pak.AsStringOr("");
 		engine_init.window = &window;
 		engine_init.gfx_options.vsync = vsync;
 		engine_init.gfx_options.debug_device = debug_device;
@@ -67,6 +94,7 @@ int APIENTRY wWinMain(
             g_Editor.Run();
         }
         g_Editor.Destroy();
+        return window.ExitCode();
     }
 }
 